@@ -262,6 +262,9 @@ const AP_Scheduler::Task Copter::scheduler_tasks[] = {
 #if HAL_BUTTON_ENABLED
     SCHED_TASK_CLASS(AP_Button,            &copter.button,              update,           5, 100, 168),
 #endif
+#if AC_WPNAV_PLANNER_ENABLED
+    SCHED_TASK_CLASS(AC_WPNav_Planner,     &copter.mission_planner,     update,          10,  50, 171),
+#endif
 #if AP_INERTIALSENSOR_FAST_SAMPLE_WINDOW_ENABLED
     // don't delete this, there is an equivalent (virtual) in AP_Vehicle for the non-rate loop case
     SCHED_TASK(update_dynamic_notch_at_specified_rate_main,                       LOOP_RATE, 200, 215),
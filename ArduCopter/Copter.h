@@ -107,6 +107,9 @@
 #if AP_AVOIDANCE_ENABLED
  #include <AC_Avoidance/AC_Avoid.h>
 #endif
+#if AC_WPNAV_PLANNER_ENABLED
+ #include <AC_WPNav/AC_WPNav_Planner.h>
+#endif
 #if AP_OAPATHPLANNER_ENABLED
  #include <AC_WPNav/AC_WPNav_OA.h>
  #include <AC_Avoidance/AP_OAPathPlanner.h>
@@ -483,6 +486,11 @@ private:
     AC_WPNav *wp_nav;
     AC_Loiter *loiter_nav;
 
+#if AC_WPNAV_PLANNER_ENABLED
+    // whole-mission time and distance estimates
+    AC_WPNav_Planner mission_planner{wp_nav};
+#endif
+
 #if AC_CUSTOMCONTROL_MULTI_ENABLED
     AC_CustomControl custom_control{ahrs_view, attitude_control, motors, scheduler.get_loop_period_s()};
 #endif
@@ -922,6 +930,7 @@ private:
     void Log_Write_SysID_Data(float waveform_time, float waveform_sample, float waveform_freq, float angle_x, float angle_y, float angle_z, float accel_x, float accel_y, float accel_z);
     void Log_Write_Vehicle_Startup_Messages();
     void Log_Write_Rate_Thread_Dt(float dt, float dtAvg, float dtMax, float dtMin);
+    void Log_Write_Rate_Thread_Latency();
 #endif  // HAL_LOGGING_ENABLED
 
     // mode.cpp
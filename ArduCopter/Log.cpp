@@ -354,6 +354,19 @@ struct PACKED log_Rate_Thread_Dt {
     float dtMin;
 };
 
+// rate thread gyro to motor output latency
+struct PACKED log_Rate_Thread_Latency {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint16_t filter;
+    uint16_t queue;
+    uint16_t rate;
+    uint16_t motors;
+    uint16_t push;
+    uint16_t total;
+    uint16_t total_max;
+};
+
 // Write a Guided mode position target
 // pos_target is lat, lon, alt OR offset from ekf origin in cm
 // terrain should be 0 if pos_target.z is alt-above-ekf-origin, 1 if alt-above-terrain
@@ -416,6 +429,30 @@ void Copter::Log_Write_Rate_Thread_Dt(float dt, float dtAvg, float dtMax, float
 #endif
 }
 
+// Write the average latency of each stage of the rate thread pipeline
+void Copter::Log_Write_Rate_Thread_Latency()
+{
+#if AP_INERTIALSENSOR_FAST_SAMPLE_WINDOW_ENABLED
+    uint16_t avg_us[uint8_t(AP_InertialSensor::FastRateStage::NUM_STAGES)];
+    uint16_t max_us[uint8_t(AP_InertialSensor::FastRateStage::NUM_STAGES)];
+    if (!ins.get_fast_rate_latency(avg_us, max_us)) {
+        return;
+    }
+    const log_Rate_Thread_Latency pkt {
+        LOG_PACKET_HEADER_INIT(LOG_RATE_THREAD_LATENCY_MSG),
+        time_us         : AP_HAL::micros64(),
+        filter          : avg_us[uint8_t(AP_InertialSensor::FastRateStage::FILTER)],
+        queue           : avg_us[uint8_t(AP_InertialSensor::FastRateStage::QUEUE)],
+        rate            : avg_us[uint8_t(AP_InertialSensor::FastRateStage::RATE)],
+        motors          : avg_us[uint8_t(AP_InertialSensor::FastRateStage::MOTORS)],
+        push            : avg_us[uint8_t(AP_InertialSensor::FastRateStage::PUSH)],
+        total           : avg_us[uint8_t(AP_InertialSensor::FastRateStage::TOTAL)],
+        total_max       : max_us[uint8_t(AP_InertialSensor::FastRateStage::TOTAL)]
+    };
+    logger.WriteBlock(&pkt, sizeof(pkt));
+#endif
+}
+
 // type and unit information can be found in
 // libraries/AP_Logger/Logstructure.h; search for "log_Units" for
 // units and "Format characters" for field type information
@@ -569,6 +606,20 @@ const struct LogStructure Copter::log_structure[] = {
     { LOG_RATE_THREAD_DT_MSG, sizeof(log_Rate_Thread_Dt),
       "RTDT", "Qffff", "TimeUS,dt,dtAvg,dtMax,dtMin", "sssss", "F----" , true },
 
+// @LoggerMessage: RTLT
+// @Description: Rate thread gyro to motor output latency, averaged since the last message
+// @Field: TimeUS: Time since system startup
+// @Field: Filt: raw gyro sample to filtered sample available to the rate thread
+// @Field: Queue: filtered sample available to read by the rate thread
+// @Field: Rate: rate controller run time
+// @Field: Mot: motor mixer output time
+// @Field: Push: RCOutput push time
+// @Field: Tot: raw gyro sample to RCOutput push
+// @Field: TotMax: maximum raw gyro sample to RCOutput push since the last message
+
+    { LOG_RATE_THREAD_LATENCY_MSG, sizeof(log_Rate_Thread_Latency),
+      "RTLT", "QHHHHHHH", "TimeUS,Filt,Queue,Rate,Mot,Push,Tot,TotMax", "ssssssss", "FFFFFFFF" , true },
+
 };
 
 uint8_t Copter::get_num_log_structures() const
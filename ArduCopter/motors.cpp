@@ -1,4 +1,5 @@
 #include "Copter.h"
+#include <AP_InertialSensor/AP_InertialSensor_rate_config.h>
 
 #define ARM_DELAY               20  // called at 10hz so 2 seconds
 #define DISARM_DELAY            20  // called at 10hz so 2 seconds
@@ -172,6 +173,9 @@ void Copter::motors_output(bool full_push)
         // send output signals to motors
         flightmode->output_to_motors();
     }
+#if AP_INERTIALSENSOR_FAST_SAMPLE_WINDOW_ENABLED
+    ins.fast_rate_stage_done(AP_InertialSensor::FastRateStage::MOTORS);
+#endif
 
     // push all channels
     if (full_push) {
@@ -181,6 +185,9 @@ void Copter::motors_output(bool full_push)
         // motor output only at main loop rate or faster
         hal.rcout->push();
     }
+#if AP_INERTIALSENSOR_FAST_SAMPLE_WINDOW_ENABLED
+    ins.fast_rate_stage_done(AP_InertialSensor::FastRateStage::PUSH);
+#endif
 }
 
 // motors_output from main thread at main loop rate
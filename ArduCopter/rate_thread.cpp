@@ -233,7 +233,7 @@ void Copter::rate_controller_thread()
 
         // wait for an IMU sample
         Vector3f gyro;
-        if (!ins.get_next_gyro_sample(gyro)) {
+        if (!ins.get_next_gyro_sample_timed(gyro)) {
             continue;   // go around again
         }
 
@@ -263,6 +263,7 @@ void Copter::rate_controller_thread()
         // it is important not to drop samples otherwise the filtering will be fubar
         // there is no need to output to the motors more than once for every batch of samples
         attitude_control->rate_controller_run_dt(gyro + ahrs.get_gyro_drift(), sensor_dt);
+        ins.fast_rate_stage_done(AP_InertialSensor::FastRateStage::RATE);
 
 #ifdef RATE_LOOP_TIMING_DEBUG
         rate_controller_time_us += AP_HAL::micros() - rate_now_us;
@@ -288,6 +289,7 @@ void Copter::rate_controller_thread()
 #if HAL_LOGGING_ENABLED
         if (now_ms - last_rtdt_log_ms >= 100) {    // 10 Hz
             Log_Write_Rate_Thread_Dt(dt, sensor_dt, max_dt, min_dt);
+            Log_Write_Rate_Thread_Latency();
             max_dt = sensor_dt;
             min_dt = sensor_dt;
             last_rtdt_log_ms = now_ms;
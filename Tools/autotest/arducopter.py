@@ -6526,6 +6526,49 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
         self.context_pop()
         self.reboot_sitl()
 
+    def RateThreadLatency(self):
+        '''check the rate thread gyro to motor output latency is measured'''
+        self.set_parameters({
+            "FSTRATE_ENABLE": 1,
+            "LOG_DISARMED": 0,
+        })
+        self.reboot_sitl()
+
+        self.takeoff(10, mode="ALT_HOLD")
+        self.delay_sim_time(10)
+
+        self.progress("Checking latency histograms")
+        content = self.fetch_file_via_ftp("@SYS/rate_latency.txt")
+        self.progress("Got content (%s)" % str(content))
+        lines = content.split("\n")
+        if not lines[0].startswith("STAGE"):
+            raise NotAchievedException("Expected STAGE as first line not (%s)" % lines[0])
+        counts = {}
+        for line in lines[1:]:
+            fields = line.split()
+            if len(fields) == 0:
+                continue
+            counts[fields[0]] = sum([int(x) for x in fields[1:]])
+        for stage in ["FILTER", "QUEUE", "RATE", "MOTORS", "PUSH", "TOTAL"]:
+            if counts.get(stage, 0) == 0:
+                raise NotAchievedException("No latency samples for %s" % stage)
+
+        self.do_RTL()
+
+        self.progress("Checking RTLT messages in log")
+        dfreader = self.dfreader_for_current_onboard_log()
+        count = 0
+        while True:
+            m = dfreader.recv_match(type="RTLT")
+            if m is None:
+                break
+            count += 1
+            if m.TotMax < m.Tot:
+                raise NotAchievedException("TotMax %u less than Tot %u" % (m.TotMax, m.Tot))
+        # logged at 10Hz for the whole flight
+        if count < 100:
+            raise NotAchievedException("Only %u RTLT messages" % count)
+
     def hover_and_check_matched_frequency(self, dblevel=-15, minhz=200, maxhz=300, fftLength=32, peakhz=None):
         '''do a simple up-and-down test flight with current vehicle state.
         Check that the onboard filter comes up with the same peak-frequency that
@@ -13340,6 +13383,7 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
             self.PositionWhenGPSIsZero,
             self.DynamicRpmNotches, # Do not add attempts to this - failure is sign of a bug
             self.DynamicRpmNotchesRateThread,
+            self.RateThreadLatency,
             self.PIDNotches,
             self.StaticNotches,
             self.RefindGPS,
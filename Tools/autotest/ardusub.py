@@ -1085,6 +1085,7 @@ class AutoTestSub(vehicle_test_suite.TestSuite):
             self.SET_POSITION_TARGET_GLOBAL_INT,
             self.TestLogDownloadMAVProxy,
             self.TestLogDownloadMAVProxyNetwork,
+            self.TestLogDownloadMAVProxyNetworkEventLoop,
             self.TestLogDownloadLogRestart,
             self.MAV_CMD_NAV_LOITER_UNLIM,
             self.MAV_CMD_NAV_LAND,
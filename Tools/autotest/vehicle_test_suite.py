@@ -4837,6 +4837,17 @@ class TestSuite(ABC):
 
         self.context_pop()
 
+    def TestLogDownloadMAVProxyNetworkEventLoop(self, upload_logs=False):
+        """Download latest log over network ports serviced by a single event loop thread"""
+        self.context_push()
+        self.set_parameter("NET_ENABLE", 1)
+        self.reboot_sitl()
+        # NET_OPTIONS bit 5: single thread for all network ports
+        self.set_parameter("NET_OPTIONS", 32)
+        self.TestLogDownloadMAVProxyNetwork(upload_logs=upload_logs)
+        self.context_pop()
+        self.reboot_sitl()
+
     def TestLogDownloadMAVProxyCAN(self, upload_logs=False):
         """Download latest log over CAN serial port"""
         self.context_push()
@@ -0,0 +1,155 @@
+# Copyright 2023 ArduPilot.org.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+"""
+Bring up ArduPilot SITL and check that topic rates can be changed at runtime.
+
+Measures the IMU topic rate, lowers it with the DDS_RATE_IMU parameter
+through the set_parameters service, and checks the new rate.
+
+colcon test --packages-select ardupilot_dds_tests \
+--event-handlers=console_cohesion+ --pytest-args -k test_topic_rate
+
+"""
+
+import launch_pytest
+import pytest
+import rclpy
+import rclpy.node
+import threading
+import time
+
+from launch import LaunchDescription
+
+from launch_pytest.tools import process as process_tools
+
+from rclpy.qos import QoSProfile
+from rclpy.qos import QoSReliabilityPolicy
+from rclpy.qos import QoSHistoryPolicy
+
+from rcl_interfaces.srv import SetParameters
+from rcl_interfaces.msg import Parameter
+from sensor_msgs.msg import Imu
+
+TOPIC = "ap/imu/experimental/data"
+PARAMETER_INTEGER = 2
+NEW_RATE_HZ = 20
+
+
+class ImuRateListener(rclpy.node.Node):
+    """Count Imu messages and set the IMU topic rate."""
+
+    def __init__(self):
+        """Initialise the node."""
+        super().__init__("imu_rate_listener")
+        self.msg_event_object = threading.Event()
+        self.lock = threading.Lock()
+        self.count = 0
+
+    def start_subscriber(self):
+        """Start the subscriber and the parameter client."""
+        qos_profile = QoSProfile(
+            reliability=QoSReliabilityPolicy.BEST_EFFORT,
+            history=QoSHistoryPolicy.KEEP_LAST,
+            depth=5,
+        )
+        self.subscription = self.create_subscription(Imu, TOPIC, self.subscriber_callback, qos_profile)
+
+        self.set_cli = self.create_client(SetParameters, 'ap/set_parameters')
+        while not self.set_cli.wait_for_service(timeout_sec=1.0):
+            self.get_logger().info('SetParameters service not available, waiting again...')
+
+        # Add a spin thread.
+        self.ros_spin_thread = threading.Thread(target=lambda node: rclpy.spin(node), args=(self,))
+        self.ros_spin_thread.start()
+
+    def subscriber_callback(self, msg):
+        """Count an Imu message."""
+        with self.lock:
+            self.count += 1
+        self.msg_event_object.set()
+
+    def measure_rate(self, duration_s):
+        """Return the received message rate over duration_s seconds."""
+        with self.lock:
+            self.count = 0
+        time.sleep(duration_s)
+        with self.lock:
+            count = self.count
+        rate = count / duration_s
+        self.get_logger().info("IMU rate {:.1f}Hz".format(rate))
+        return rate
+
+    def set_rate(self, rate_hz):
+        """Set the IMU topic rate, returning True on success."""
+        req = SetParameters.Request()
+        param = Parameter()
+        param.name = "DDS_RATE_IMU"
+        param.value.type = PARAMETER_INTEGER
+        param.value.integer_value = rate_hz
+        req.parameters.append(param)
+
+        future = self.set_cli.call_async(req)
+        while not future.done():
+            self.get_logger().info("Waiting for SetParameters service response...")
+            time.sleep(0.1)
+        return future.result().results[0].successful
+
+
+@launch_pytest.fixture
+def launch_sitl_copter_dds_udp(sitl_copter_dds_udp):
+    """Fixture to create the launch description."""
+    sitl_ld, sitl_actions = sitl_copter_dds_udp
+
+    ld = LaunchDescription(
+        [
+            sitl_ld,
+            launch_pytest.actions.ReadyToTest(),
+        ]
+    )
+    actions = sitl_actions
+    yield ld, actions
+
+
+@pytest.mark.launch(fixture=launch_sitl_copter_dds_udp)
+def test_dds_udp_topic_rate(launch_context, launch_sitl_copter_dds_udp):
+    """Test the IMU topic rate can be changed at runtime."""
+    _, actions = launch_sitl_copter_dds_udp
+    micro_ros_agent = actions["micro_ros_agent"].action
+    mavproxy = actions["mavproxy"].action
+    sitl = actions["sitl"].action
+
+    # Wait for process to start.
+    process_tools.wait_for_start_sync(launch_context, micro_ros_agent, timeout=2)
+    process_tools.wait_for_start_sync(launch_context, mavproxy, timeout=2)
+    process_tools.wait_for_start_sync(launch_context, sitl, timeout=2)
+
+    rclpy.init()
+    try:
+        node = ImuRateListener()
+        node.start_subscriber()
+        msgs_received_flag = node.msg_event_object.wait(timeout=10.0)
+        assert msgs_received_flag, f"Did not receive '{TOPIC}' msgs."
+
+        default_rate = node.measure_rate(5.0)
+
+        assert node.set_rate(NEW_RATE_HZ), "Could not set DDS_RATE_IMU"
+        new_rate = node.measure_rate(5.0)
+
+        assert new_rate < default_rate, f"IMU rate did not drop from {default_rate:.1f}Hz"
+        assert abs(new_rate - NEW_RATE_HZ) < 0.25 * NEW_RATE_HZ, f"IMU rate {new_rate:.1f}Hz, expected {NEW_RATE_HZ}Hz"
+    finally:
+        rclpy.shutdown()
+    yield
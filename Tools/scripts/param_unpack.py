@@ -15,15 +15,21 @@ data = open(args.file,'rb').read()
 last_name = ""
 
 magic = 0x671b
+magic_defaults = 0x671c
+magic_ext = 0x671d
 
-# header of 6 bytes
+# header of 6 bytes, or 12 bytes for the extended header
 magic2,num_params,total_params = struct.unpack("<HHH", data[0:6])
-if magic != magic2:
+if magic2 == magic_ext:
+    hflags,reserved,generation = struct.unpack("<BBI", data[6:12])
+    print("Generation %u%s" % (generation, " (delta)" if hflags & 2 else ""))
+    data = data[12:]
+elif magic2 in [magic, magic_defaults]:
+    data = data[6:]
+else:
     print("Bad magic 0x%x expected 0x%x" % (magic2, magic))
     sys.exit(1)
 
-data = data[6:]
-
 # mapping of data type to type length and format
 data_types = {
     1: (1, 'b'),
@@ -62,10 +68,21 @@ while True:
     name_len = ((plen>>4) & 0x0F) + 1
     common_len = (plen & 0x0F)
     name = last_name[0:common_len] + data[2:2+name_len].decode('utf-8')
-    vdata = data[2+name_len:2+name_len+type_len]
     last_name = name
-    data = data[2+name_len+type_len:]
-    v, = struct.unpack("<" + type_format, vdata)
+    data = data[2+name_len:]
+    if flags & 2:
+        # compact zero value
+        v = 0
+    elif flags & 4:
+        # compact one byte value
+        v, = struct.unpack("<b", data[0:1])
+        data = data[1:]
+    else:
+        v, = struct.unpack("<" + type_format, data[0:type_len])
+        data = data[type_len:]
+    if flags & 1:
+        # skip default value
+        data = data[type_len:]
     count += 1
     print("%-16s %f" % (name, float(v)))
 
@@ -869,25 +869,44 @@ void AC_Avoid::adjust_velocity_inclusion_and_exclusion_polygons(float kP, float
     // for backing away
     Vector2f quad_1_back_vel, quad_2_back_vel, quad_3_back_vel, quad_4_back_vel;
 
-    // iterate through inclusion polygons
     const uint8_t num_inclusion_polygons = fence->polyfence().get_inclusion_polygon_count();
+    const uint8_t num_exclusion_polygons = fence->polyfence().get_exclusion_polygon_count();
+
+    // indexes of the polygons' edges, rebuilt only when the fence is
+    // reloaded. Without them every edge is checked
+    const uint16_t num_polygons = num_inclusion_polygons + num_exclusion_polygons;
+    if (num_polygons > _fence_index_count) {
+        delete[] _fence_index;
+        _fence_index = NEW_NOTHROW AC_Avoid_PolygonIndex[num_polygons];
+        _fence_index_count = (_fence_index != nullptr) ? num_polygons : 0;
+    }
+
+    // iterate through inclusion polygons
     for (uint8_t i = 0; i < num_inclusion_polygons; i++) {
         uint16_t num_points;
         const Vector2f* boundary = fence->polyfence().get_inclusion_polygon(i, num_points);
+        AC_Avoid_PolygonIndex *index = (i < _fence_index_count) ? &_fence_index[i] : nullptr;
+        if (index != nullptr && !index->update(boundary, num_points, fence->polyfence().get_inclusion_polygon_update_ms())) {
+            index = nullptr;
+        }
         Vector2f backup_vel_inc;
         // adjust velocity
-        adjust_velocity_polygon(kP, accel_cmss, desired_vel_cms, backup_vel_inc, boundary, num_points, fence->get_margin(), dt, true);
+        adjust_velocity_polygon(kP, accel_cmss, desired_vel_cms, backup_vel_inc, boundary, num_points, fence->get_margin(), dt, true, index);
         find_max_quadrant_velocity(backup_vel_inc, quad_1_back_vel, quad_2_back_vel, quad_3_back_vel, quad_4_back_vel);
     }
 
     // iterate through exclusion polygons
-    const uint8_t num_exclusion_polygons = fence->polyfence().get_exclusion_polygon_count();
     for (uint8_t i = 0; i < num_exclusion_polygons; i++) {
         uint16_t num_points;
         const Vector2f* boundary = fence->polyfence().get_exclusion_polygon(i, num_points);
+        const uint16_t slot = num_inclusion_polygons + i;
+        AC_Avoid_PolygonIndex *index = (slot < _fence_index_count) ? &_fence_index[slot] : nullptr;
+        if (index != nullptr && !index->update(boundary, num_points, fence->polyfence().get_exclusion_polygon_update_ms())) {
+            index = nullptr;
+        }
         Vector2f backup_vel_exc;
         // adjust velocity
-        adjust_velocity_polygon(kP, accel_cmss, desired_vel_cms, backup_vel_exc, boundary, num_points, fence->get_margin(), dt, false);
+        adjust_velocity_polygon(kP, accel_cmss, desired_vel_cms, backup_vel_exc, boundary, num_points, fence->get_margin(), dt, false, index);
         find_max_quadrant_velocity(backup_vel_exc, quad_1_back_vel, quad_2_back_vel, quad_3_back_vel, quad_4_back_vel);
     }
     // desired backup velocity is sum of maximum velocity component in each quadrant 
@@ -1186,7 +1205,7 @@ void AC_Avoid::adjust_velocity_beacon_fence(float kP, float accel_cmss, Vector2f
         margin = AP::fence()->get_margin();
     }
 #endif
-    adjust_velocity_polygon(kP, accel_cmss, desired_vel_cms, backup_vel, boundary, num_points, margin, dt, true);
+    adjust_velocity_polygon(kP, accel_cmss, desired_vel_cms, backup_vel, boundary, num_points, margin, dt, true, nullptr);
 }
 #endif  // AP_BEACON_ENABLED
 
@@ -1204,7 +1223,7 @@ void AC_Avoid::adjust_velocity_proximity(float kP, float accel_cmss, Vector3f &d
 
     AP_Proximity &_proximity = *proximity;
     // get total number of obstacles
-    const uint8_t obstacle_num = _proximity.get_obstacle_count();
+    const uint16_t obstacle_num = _proximity.get_obstacle_count();
     if (obstacle_num == 0) {
         // no obstacles
         return;
@@ -1233,7 +1252,7 @@ void AC_Avoid::adjust_velocity_proximity(float kP, float accel_cmss, Vector3f &d
         stopping_point_plus_margin = safe_vel * ((2.0f + margin_cm + get_stopping_distance(kP, accel_cmss, speed))/speed);
     }
 
-    for (uint8_t i = 0; i<obstacle_num; i++) {
+    for (uint16_t i = 0; i<obstacle_num; i++) {
         // get obstacle from proximity library
         Vector3f vector_to_obstacle;
         if (!_proximity.get_obstacle(i, vector_to_obstacle)) {
@@ -1333,7 +1352,7 @@ void AC_Avoid::adjust_velocity_proximity(float kP, float accel_cmss, Vector3f &d
 /*
  * Adjusts the desired velocity for the polygon fence.
  */
-void AC_Avoid::adjust_velocity_polygon(float kP, float accel_cmss, Vector2f &desired_vel_cms, Vector2f &backup_vel, const Vector2f* boundary, uint16_t num_points, float margin, float dt, bool stay_inside)
+void AC_Avoid::adjust_velocity_polygon(float kP, float accel_cmss, Vector2f &desired_vel_cms, Vector2f &backup_vel, const Vector2f* boundary, uint16_t num_points, float margin, float dt, bool stay_inside, AC_Avoid_PolygonIndex *index)
 {
     // exit if there are no points
     if (boundary == nullptr || num_points == 0) {
@@ -1353,7 +1372,7 @@ void AC_Avoid::adjust_velocity_polygon(float kP, float accel_cmss, Vector2f &des
 
 
     // return if we have already breached polygon
-    const bool inside_polygon = !Polygon_outside(position_xy, boundary, num_points);
+    const bool inside_polygon = (index != nullptr) ? !index->outside(position_xy) : !Polygon_outside(position_xy, boundary, num_points);
     if (inside_polygon != stay_inside) {
         return;
     }
@@ -1376,8 +1395,21 @@ void AC_Avoid::adjust_velocity_polygon(float kP, float accel_cmss, Vector2f &des
 
     // for backing away
     Vector2f quad_1_back_vel, quad_2_back_vel, quad_3_back_vel, quad_4_back_vel;
-   
-    for (uint16_t i=0; i<num_points; i++) {
+
+    // edges further away than the vehicle can travel before stopping,
+    // and outside the margin, can't change either velocity
+    uint16_t num_edges = num_points;
+    const uint16_t *edges = nullptr;
+    if (index != nullptr) {
+        const float reach_cm = get_polygon_reach(kP, accel_cmss, speed, margin_cm, dt);
+        if (!is_negative(reach_cm)) {
+            num_edges = index->find_edges_near(position_xy, reach_cm);
+            edges = index->edges();
+        }
+    }
+
+    for (uint16_t e=0; e<num_edges; e++) {
+        const uint16_t i = (edges != nullptr) ? edges[e] : e;
         uint16_t j = i+1;
         if (j >= num_points) {
             j = 0;
@@ -1447,6 +1479,37 @@ void AC_Avoid::adjust_velocity_polygon(float kP, float accel_cmss, Vector2f &des
     backup_vel = desired_back_vel_cms;
 }
 
+/*
+ * Computes the distance beyond which a polygon edge can not change the
+ * velocity or back away velocity from adjust_velocity_polygon().
+ * Edges within the margin are backed away from, and the velocity is
+ * only limited by edges closer than the margin plus the distance at
+ * which get_max_speed() gives the current speed (the inverse of
+ * get_stopping_distance(), or the distance covered in one time step
+ * for very short distances)
+ */
+float AC_Avoid::get_polygon_reach(float kP, float accel_cmss, float speed_cms, float margin_cm, float dt) const
+{
+    float stop_cm;
+    if (is_positive(accel_cmss)) {
+        stop_cm = get_stopping_distance(kP, accel_cmss, speed_cms);
+    } else if (is_positive(kP)) {
+        // sqrt controller is linear without an acceleration limit
+        stop_cm = speed_cms / kP;
+    } else if (is_zero(speed_cms)) {
+        stop_cm = 0.0f;
+    } else {
+        // any edge can stop the vehicle
+        return -1.0f;
+    }
+    if (is_positive(dt)) {
+        stop_cm = MAX(stop_cm, speed_cms * dt);
+    }
+    // the stopping point used for BEHAVIOR_STOP is 2cm further, and
+    // allow a little more for rounding
+    return margin_cm + stop_cm + 2.0f + 10.0f;
+}
+
 /*
  * Computes distance required to stop, given current speed.
  *
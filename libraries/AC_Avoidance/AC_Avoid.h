@@ -8,6 +8,7 @@
 #include <AP_Param/AP_Param.h>
 #include <AP_Math/AP_Math.h>
 #include <AC_AttitudeControl/AC_AttitudeControl.h> // Attitude controller library for sqrt controller
+#include "AC_Avoid_PolygonIndex.h"
 
 #define AC_AVOID_ACCEL_CMSS_MAX         100.0f  // maximum acceleration/deceleration in cm/s/s used to avoid hitting fence
 
@@ -152,8 +153,16 @@ private:
      * The boundary must be in Earth Frame
      * margin is the distance (in meters) that the vehicle should stop short of the polygon
      * stay_inside should be true for fences, false for exclusion polygons
+     * index may be nullptr, otherwise only the edges it finds near the vehicle are checked
      */
-    void adjust_velocity_polygon(float kP, float accel_cmss, Vector2f &desired_vel_cms, Vector2f &backup_vel, const Vector2f* boundary, uint16_t num_points, float margin, float dt, bool stay_inside);
+    void adjust_velocity_polygon(float kP, float accel_cmss, Vector2f &desired_vel_cms, Vector2f &backup_vel, const Vector2f* boundary, uint16_t num_points, float margin, float dt, bool stay_inside, AC_Avoid_PolygonIndex *index);
+
+    /*
+     * Computes the distance beyond which a polygon edge can not change the
+     * velocity or back away velocity from adjust_velocity_polygon().
+     * Returns a negative number if every edge can.
+     */
+    float get_polygon_reach(float kP, float accel_cmss, float speed_cms, float margin_cm, float dt) const;
 
     /*
      * Computes distance required to stop, given current speed.
@@ -220,6 +229,12 @@ private:
     uint32_t _last_log_ms;          // the last time simple avoidance was logged
     Vector3f _prev_avoid_vel;       // copy of avoidance adjusted velocity
 
+#if AP_FENCE_ENABLED
+    // edge indexes of the inclusion polygons followed by the exclusion polygons
+    AC_Avoid_PolygonIndex *_fence_index;
+    uint16_t _fence_index_count;
+#endif
+
     static AC_Avoid *_singleton;
 };
 
@@ -0,0 +1,297 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AC_Avoid_PolygonIndex.h"
+
+#if AP_AVOIDANCE_ENABLED
+
+#include <AP_HAL/AP_HAL.h>
+
+// rebuild the index if the boundary has changed
+bool AC_Avoid_PolygonIndex::update(const Vector2f *boundary, uint16_t num_points, uint32_t update_ms)
+{
+    if (boundary != _boundary || num_points != _num_points || update_ms != _update_ms) {
+        _boundary = boundary;
+        _num_points = num_points;
+        _update_ms = update_ms;
+        _valid = build();
+    }
+    return _valid;
+}
+
+void AC_Avoid_PolygonIndex::free_index()
+{
+    delete[] _cell_start;
+    delete[] _cell_edges;
+    delete[] _found;
+    delete[] _edge_search;
+    _cell_start = nullptr;
+    _cell_edges = nullptr;
+    _found = nullptr;
+    _edge_search = nullptr;
+}
+
+// grid column and row of a position, clamped to the grid
+uint16_t AC_Avoid_PolygonIndex::col(float x) const
+{
+    const float c = (x - _origin.x) / _cell_size;
+    if (!(c > 0)) {
+        return 0;
+    }
+    if (c >= _cols) {
+        return _cols - 1;
+    }
+    return uint16_t(c);
+}
+
+uint16_t AC_Avoid_PolygonIndex::row(float y) const
+{
+    const float r = (y - _origin.y) / _cell_size;
+    if (!(r > 0)) {
+        return 0;
+    }
+    if (r >= _rows) {
+        return _rows - 1;
+    }
+    return uint16_t(r);
+}
+
+/*
+  list an edge in each cell it passes through, returning the number
+  of cells. Without fill the cells' edge counts are incremented, if
+  they have been allocated
+ */
+uint32_t AC_Avoid_PolygonIndex::add_edge(uint16_t edge, bool fill)
+{
+    Vector2f a = _boundary[edge];
+    Vector2f b = _boundary[(edge + 1 < _num_points) ? edge + 1 : 0];
+    if (a.x > b.x) {
+        const Vector2f tmp = a;
+        a = b;
+        b = tmp;
+    }
+    // pad so rounding can't leave out a cell the edge touches
+    const float pad = _cell_size * 0.001f;
+    const float dx = b.x - a.x;
+    const uint16_t c0 = col(a.x - pad);
+    const uint16_t c1 = col(b.x + pad);
+    uint32_t count = 0;
+    for (uint16_t c = c0; c <= c1; c++) {
+        // the part of the edge within this column
+        const float x0 = constrain_float(_origin.x + c * _cell_size, a.x, b.x);
+        const float x1 = constrain_float(_origin.x + (c + 1) * _cell_size, a.x, b.x);
+        float y0 = a.y;
+        float y1 = b.y;
+        if (is_positive(dx)) {
+            y0 = a.y + (b.y - a.y) * (x0 - a.x) / dx;
+            y1 = a.y + (b.y - a.y) * (x1 - a.x) / dx;
+        }
+        if (y0 > y1) {
+            const float tmp = y0;
+            y0 = y1;
+            y1 = tmp;
+        }
+        const uint16_t r0 = row(y0 - pad);
+        const uint16_t r1 = row(y1 + pad);
+        for (uint16_t r = r0; r <= r1; r++) {
+            const uint32_t cell = uint32_t(r) * _cols + c;
+            if (fill) {
+                _cell_edges[_cell_start[cell]++] = edge;
+            } else if (_cell_start != nullptr) {
+                _cell_start[cell + 1]++;
+            }
+            count++;
+        }
+    }
+    return count;
+}
+
+bool AC_Avoid_PolygonIndex::build()
+{
+    free_index();
+    const uint16_t n = _num_points;
+    if (_boundary == nullptr || n == 0) {
+        return false;
+    }
+
+    Vector2f lo = _boundary[0];
+    Vector2f hi = _boundary[0];
+    for (uint16_t i = 1; i < n; i++) {
+        lo.x = MIN(lo.x, _boundary[i].x);
+        lo.y = MIN(lo.y, _boundary[i].y);
+        hi.x = MAX(hi.x, _boundary[i].x);
+        hi.y = MAX(hi.y, _boundary[i].y);
+    }
+    const float width = hi.x - lo.x;
+    const float height = hi.y - lo.y;
+    _origin = lo;
+
+    // about one cell per point, and no more than one per point along
+    // either side so long thin polygons don't get a huge grid
+    float cell_size = MAX(sqrtf(width * height / n), MAX(width, height) / n);
+    if (!is_positive(cell_size)) {
+        cell_size = 1.0f;
+    }
+
+    // polygons with long edges across many cells get larger cells,
+    // keeping the size of the index proportional to the points
+    const uint32_t max_cell_edges = MIN(8U * n + 64U, 0xFFFFU);
+    uint32_t num_cell_edges;
+    while (true) {
+        _cell_size = cell_size;
+        _cols = uint16_t(width / cell_size) + 1;
+        _rows = uint16_t(height / cell_size) + 1;
+        num_cell_edges = 0;
+        for (uint16_t i = 0; i < n; i++) {
+            num_cell_edges += add_edge(i, false);
+        }
+        if (num_cell_edges <= max_cell_edges) {
+            break;
+        }
+        cell_size *= 2;
+    }
+
+    const uint32_t num_cells = uint32_t(_cols) * _rows;
+    _cell_start = NEW_NOTHROW uint16_t[num_cells + 1];
+    _cell_edges = NEW_NOTHROW uint16_t[num_cell_edges];
+    _found = NEW_NOTHROW uint16_t[n];
+    _edge_search = NEW_NOTHROW uint16_t[n];
+    if (_cell_start == nullptr || _cell_edges == nullptr || _found == nullptr || _edge_search == nullptr) {
+        free_index();
+        return false;
+    }
+    memset(_cell_start, 0, (num_cells + 1) * sizeof(uint16_t));
+    memset(_edge_search, 0, n * sizeof(uint16_t));
+    _search = 0;
+
+    // count the edges in each cell, then make the counts into the
+    // start of each cell's edges
+    for (uint16_t i = 0; i < n; i++) {
+        add_edge(i, false);
+    }
+    for (uint32_t c = 1; c <= num_cells; c++) {
+        _cell_start[c] += _cell_start[c - 1];
+    }
+    // filling moves each cell's start to the start of the next cell
+    for (uint16_t i = 0; i < n; i++) {
+        add_edge(i, true);
+    }
+    for (uint32_t c = num_cells - 1; c > 0; c--) {
+        _cell_start[c] = _cell_start[c - 1];
+    }
+    _cell_start[0] = 0;
+
+    return true;
+}
+
+// start a search, edges found by earlier searches are no longer marked
+void AC_Avoid_PolygonIndex::next_search()
+{
+    _search++;
+    if (_search == 0) {
+        memset(_edge_search, 0, _num_points * sizeof(uint16_t));
+        _search = 1;
+    }
+}
+
+// true if point is outside the polygon
+bool AC_Avoid_PolygonIndex::outside(const Vector2f &point)
+{
+    if (!_valid) {
+        return Polygon_outside(point, _boundary, _num_points);
+    }
+
+    // only edges with an end on each side of the line through point
+    // parallel to the x axis can be crossed, and they all pass
+    // through the row of cells containing point
+    if (point.y < _origin.y || point.y >= _origin.y + _rows * _cell_size) {
+        return true;
+    }
+    next_search();
+    const uint32_t first_cell = uint32_t(row(point.y)) * _cols;
+    bool outside = true;
+    for (uint32_t cell = first_cell; cell < first_cell + _cols; cell++) {
+        for (uint16_t k = _cell_start[cell]; k < _cell_start[cell + 1]; k++) {
+            const uint16_t e = _cell_edges[k];
+            if (_edge_search[e] == _search) {
+                continue;
+            }
+            _edge_search[e] = _search;
+            const uint16_t next = (e + 1 < _num_points) ? e + 1 : 0;
+            if (Polygon_edge_crossing(point, _boundary[e], _boundary[next])) {
+                outside = !outside;
+            }
+        }
+    }
+    return outside;
+}
+
+// find the edges in the cells within radius of point
+uint16_t AC_Avoid_PolygonIndex::find_edges_near(const Vector2f &point, float radius)
+{
+    if (!_valid) {
+        return 0;
+    }
+    const float grid_width = _cols * _cell_size;
+    const float grid_height = _rows * _cell_size;
+    if (point.x + radius < _origin.x || point.x - radius > _origin.x + grid_width ||
+        point.y + radius < _origin.y || point.y - radius > _origin.y + grid_height) {
+        return 0;
+    }
+
+    next_search();
+    uint16_t count = 0;
+    const uint16_t c0 = col(point.x - radius);
+    const uint16_t c1 = col(point.x + radius);
+    const uint16_t r0 = row(point.y - radius);
+    const uint16_t r1 = row(point.y + radius);
+    for (uint16_t r = r0; r <= r1; r++) {
+        for (uint16_t c = c0; c <= c1; c++) {
+            const uint32_t cell = uint32_t(r) * _cols + c;
+            for (uint16_t k = _cell_start[cell]; k < _cell_start[cell + 1]; k++) {
+                const uint16_t e = _cell_edges[k];
+                if (_edge_search[e] == _search) {
+                    continue;
+                }
+                _edge_search[e] = _search;
+                _found[count++] = e;
+            }
+        }
+    }
+
+    // callers use the edges in the same order as a scan of the whole
+    // boundary would
+    if (count > _num_points / 8U) {
+        count = 0;
+        for (uint16_t e = 0; e < _num_points; e++) {
+            if (_edge_search[e] == _search) {
+                _found[count++] = e;
+            }
+        }
+    } else {
+        for (uint16_t i = 1; i < count; i++) {
+            const uint16_t e = _found[i];
+            uint16_t j = i;
+            while (j > 0 && _found[j - 1] > e) {
+                _found[j] = _found[j - 1];
+                j--;
+            }
+            _found[j] = e;
+        }
+    }
+    return count;
+}
+
+#endif  // AP_AVOIDANCE_ENABLED
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "AC_Avoidance_config.h"
+
+#if AP_AVOIDANCE_ENABLED
+
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+
+/*
+  Index of the edges of a polygon fence, so that the edges near the
+  vehicle, and the edges crossed by the ray used to test if the
+  vehicle is inside, can be found without looking at every edge.
+
+  The polygon's bounding box is divided into a grid of roughly one
+  cell per point, and each edge is listed in every cell it passes
+  through. The index is only rebuilt when the boundary is reloaded.
+  Edge i runs from boundary point i to point i+1, the last edge back
+  to point 0.
+ */
+class AC_Avoid_PolygonIndex
+{
+public:
+    AC_Avoid_PolygonIndex() {}
+    ~AC_Avoid_PolygonIndex() { free_index(); }
+
+    CLASS_NO_COPY(AC_Avoid_PolygonIndex);
+
+    // rebuild the index if the boundary, its number of points or the
+    // time it was loaded have changed. The boundary must not change
+    // without its load time changing
+    // returns false if the index could not be built
+    bool update(const Vector2f *boundary, uint16_t num_points, uint32_t update_ms) WARN_IF_UNUSED;
+
+    // true if point is outside the polygon, the same result as
+    // Polygon_outside() on the whole boundary
+    bool outside(const Vector2f &point);
+
+    // find the edges which come within radius of point along both
+    // axes, including some further away. Returns the number found,
+    // their indexes are given by edges() in ascending order
+    uint16_t find_edges_near(const Vector2f &point, float radius);
+    const uint16_t *edges() const { return _found; }
+
+private:
+    const Vector2f *_boundary = nullptr;
+    uint16_t _num_points;
+    uint32_t _update_ms;
+    bool _valid;
+
+    // grid covering the boundary
+    Vector2f _origin;
+    float _cell_size;
+    uint16_t _cols;
+    uint16_t _rows;
+
+    // edges in each cell, cell c has _cell_edges[_cell_start[c]] up
+    // to _cell_edges[_cell_start[c+1]]
+    uint16_t *_cell_start = nullptr;
+    uint16_t *_cell_edges = nullptr;
+
+    uint16_t *_found = nullptr;             // edges found by the last search
+    uint16_t *_edge_search = nullptr;       // search each edge was last found by
+    uint16_t _search;
+
+    uint16_t col(float x) const;
+    uint16_t row(float y) const;
+    uint32_t add_edge(uint16_t edge, bool fill);
+    bool build();
+    void free_index();
+    void next_search();
+};
+
+#endif  // AP_AVOIDANCE_ENABLED
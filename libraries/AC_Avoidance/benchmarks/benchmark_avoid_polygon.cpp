@@ -0,0 +1,91 @@
+#include <AP_gbenchmark.h>
+
+#include <AC_Avoidance/AC_Avoid_PolygonIndex.h>
+
+#include <random>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_AVOIDANCE_ENABLED
+
+/*
+  per loop cost of the polygon fence checks in
+  AC_Avoid::adjust_velocity_polygon() for a vehicle inside a 1km fence
+  of 10 to 500 points, stopping within 15m: testing if the vehicle is
+  inside and finding the closest point of each edge it could reach,
+  before with every edge and now with the edges from the index
+ */
+
+static const uint16_t max_points = 500;
+static const float reach_cm = 1500;
+
+static Vector2f points[max_points];
+
+static void make_fence(uint16_t num_points)
+{
+    std::minstd_rand rng(1);
+    std::uniform_real_distribution<float> radius(60000, 100000);
+    for (uint16_t i = 0; i < num_points; i++) {
+        const float r = radius(rng);
+        const float angle = M_2PI * i / num_points;
+        points[i] = Vector2f(cosf(angle) * r, sinf(angle) * r);
+    }
+}
+
+static void BM_AvoidPolygonFullScan(benchmark::State &state)
+{
+    const uint16_t n = state.range(0);
+    make_fence(n);
+    Vector2f pos(1000, 2000);
+    while (state.KeepRunning()) {
+        pos.x += 1;
+        bool outside = Polygon_outside(pos, points, n);
+        gbenchmark_escape(&outside);
+        for (uint16_t i = 0; i < n; i++) {
+            const uint16_t j = (i + 1 < n) ? i + 1 : 0;
+            float dist = (Vector2f::closest_point(pos, points[j], points[i]) - pos).length();
+            gbenchmark_escape(&dist);
+        }
+    }
+}
+BENCHMARK(BM_AvoidPolygonFullScan)->Arg(10)->Arg(50)->Arg(100)->Arg(500);
+
+static void BM_AvoidPolygonIndex(benchmark::State &state)
+{
+    const uint16_t n = state.range(0);
+    make_fence(n);
+    AC_Avoid_PolygonIndex index;
+    IGNORE_RETURN(index.update(points, n, 1));
+    Vector2f pos(1000, 2000);
+    while (state.KeepRunning()) {
+        pos.x += 1;
+        bool outside = index.outside(pos);
+        gbenchmark_escape(&outside);
+        const uint16_t count = index.find_edges_near(pos, reach_cm);
+        for (uint16_t k = 0; k < count; k++) {
+            const uint16_t i = index.edges()[k];
+            const uint16_t j = (i + 1 < n) ? i + 1 : 0;
+            float dist = (Vector2f::closest_point(pos, points[j], points[i]) - pos).length();
+            gbenchmark_escape(&dist);
+        }
+    }
+}
+BENCHMARK(BM_AvoidPolygonIndex)->Arg(10)->Arg(50)->Arg(100)->Arg(500);
+
+// the cost of rebuilding the index when the fence is reloaded
+static void BM_AvoidPolygonIndexBuild(benchmark::State &state)
+{
+    const uint16_t n = state.range(0);
+    make_fence(n);
+    AC_Avoid_PolygonIndex index;
+    uint32_t update_ms = 0;
+    while (state.KeepRunning()) {
+        bool ret = index.update(points, n, ++update_ms);
+        gbenchmark_escape(&ret);
+    }
+}
+BENCHMARK(BM_AvoidPolygonIndexBuild)->Arg(10)->Arg(50)->Arg(100)->Arg(500);
+
+#endif  // AP_AVOIDANCE_ENABLED
+
+BENCHMARK_MAIN();
@@ -0,0 +1,129 @@
+#include <AP_gtest.h>
+
+#include <AC_Avoidance/AC_Avoid_PolygonIndex.h>
+
+#include <random>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_AVOIDANCE_ENABLED
+
+// fixed seed so every run tests the same polygons
+static std::minstd_rand rng(1);
+
+// random value between -range and range
+static float rand_float(float range)
+{
+    return std::uniform_real_distribution<float>(-range, range)(rng);
+}
+
+/*
+  star shaped polygons with up to 500 points, some closed, some long
+  and thin and some with points on a coarse grid so edges line up
+  with each other
+ */
+static uint16_t make_polygon(uint16_t trial, Vector2f *points, Vector2f &centre, float &radius, float &squash)
+{
+    const uint16_t n = 3 + (trial * 37) % 498;
+    radius = 1000 + fabsf(rand_float(200000));
+    centre = Vector2f(rand_float(100000), rand_float(100000));
+    squash = (trial % 5 == 0) ? 0.01f : 1.0f;
+    for (uint16_t i = 0; i < n; i++) {
+        const float angle = M_2PI * i / n;
+        const float r = radius * (0.3f + 0.7f * fabsf(rand_float(1)));
+        points[i] = centre + Vector2f(cosf(angle) * r, sinf(angle) * r * squash);
+        if (trial % 7 == 0) {
+            points[i] = Vector2f(roundf(points[i].x * 0.001f) * 1000, roundf(points[i].y * 0.001f) * 1000);
+        }
+    }
+    if (trial % 3 == 0) {
+        points[n] = points[0];
+        return n + 1;
+    }
+    return n;
+}
+
+/*
+  outside() must agree with Polygon_outside() everywhere, including on
+  the points and edges of the polygon, and find_edges_near() must find
+  every edge within the radius, in ascending order
+ */
+TEST(AC_Avoid_PolygonIndex, matches_full_scan)
+{
+    static Vector2f points[501];
+    for (uint16_t trial = 0; trial < 100; trial++) {
+        Vector2f centre;
+        float radius, squash;
+        const uint16_t n = make_polygon(trial, points, centre, radius, squash);
+
+        AC_Avoid_PolygonIndex *index = NEW_NOTHROW AC_Avoid_PolygonIndex();
+        ASSERT_NE(index, nullptr);
+        ASSERT_TRUE(index->update(points, n, 1000 + trial));
+
+        for (uint16_t k = 0; k < 500; k++) {
+            Vector2f p = centre + Vector2f(rand_float(radius * 1.3f), rand_float(radius * 1.3f * squash));
+            switch (k % 10) {
+            case 0:
+                p = points[k % n];
+                break;
+            case 1:
+                p = (points[k % n] + points[(k + 1) % n]) * 0.5f;
+                break;
+            case 2:
+                p.y = points[k % n].y;
+                break;
+            }
+            EXPECT_EQ(index->outside(p), Polygon_outside(p, points, n));
+
+            const float r = fabsf(rand_float(radius * 0.3f));
+            const uint16_t count = index->find_edges_near(p, r);
+            const uint16_t *edges = index->edges();
+            for (uint16_t i = 1; i < count; i++) {
+                EXPECT_LT(edges[i-1], edges[i]);
+            }
+            uint16_t j = 0;
+            for (uint16_t i = 0; i < n; i++) {
+                const Vector2f &start = points[i];
+                const Vector2f &end = points[(i + 1) % n];
+                while (j < count && edges[j] < i) {
+                    j++;
+                }
+                if ((Vector2f::closest_point(p, start, end) - p).length() <= r) {
+                    EXPECT_TRUE(j < count && edges[j] == i);
+                }
+            }
+        }
+        delete index;
+    }
+}
+
+// the index is rebuilt when the boundary is reloaded
+TEST(AC_Avoid_PolygonIndex, rebuild)
+{
+    Vector2f square[4] { {0, 0}, {1000, 0}, {1000, 1000}, {0, 1000} };
+    AC_Avoid_PolygonIndex index;
+    EXPECT_FALSE(index.update(square, 0, 1));
+    ASSERT_TRUE(index.update(square, 4, 1));
+    EXPECT_FALSE(index.outside(Vector2f(500, 500)));
+
+    // reloaded somewhere else
+    for (auto &p : square) {
+        p += Vector2f(5000, 0);
+    }
+    ASSERT_TRUE(index.update(square, 4, 2));
+    EXPECT_TRUE(index.outside(Vector2f(500, 500)));
+    EXPECT_FALSE(index.outside(Vector2f(5500, 500)));
+    EXPECT_EQ(index.find_edges_near(Vector2f(8000, 500), 100), 0);
+
+    // the left side is found, the right side is too far away to be
+    const uint16_t count = index.find_edges_near(Vector2f(5050, 500), 100);
+    ASSERT_GE(count, 1);
+    EXPECT_EQ(index.edges()[count-1], 3);
+    for (uint16_t i = 0; i < count; i++) {
+        EXPECT_NE(index.edges()[i], 1);
+    }
+}
+
+#endif  // AP_AVOIDANCE_ENABLED
+
+AP_GTEST_MAIN()
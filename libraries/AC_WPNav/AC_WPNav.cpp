@@ -904,22 +904,31 @@ bool AC_WPNav::get_vector_NEU(const Location &loc, Vector3f &vec, bool &terrain_
 // updates _scurve_jerk and _scurve_snap
 void AC_WPNav::calc_scurve_jerk_and_snap()
 {
+    get_scurve_jerk_and_snap(_scurve_jerk, _scurve_snap);
+}
+
+// calculate the scurve jerk (m/s/s/s) and snap (m/s/s/s/s) limits
+void AC_WPNav::get_scurve_jerk_and_snap(float &jerk, float &snap) const
+{
+    // WPNAV_JERK is fixed up by wp_and_spline_init() but may not have been yet
+    const float wp_jerk = is_positive(_wp_jerk) ? _wp_jerk.get() : get_wp_acceleration();
+
     // calculate jerk
-    _scurve_jerk = MIN(_attitude_control.get_ang_vel_roll_max_rads() * GRAVITY_MSS, _attitude_control.get_ang_vel_pitch_max_rads() * GRAVITY_MSS);
-    if (is_zero(_scurve_jerk)) {
-        _scurve_jerk = _wp_jerk;
+    jerk = MIN(_attitude_control.get_ang_vel_roll_max_rads() * GRAVITY_MSS, _attitude_control.get_ang_vel_pitch_max_rads() * GRAVITY_MSS);
+    if (is_zero(jerk)) {
+        jerk = wp_jerk;
     } else {
-        _scurve_jerk = MIN(_scurve_jerk, _wp_jerk);
+        jerk = MIN(jerk, wp_jerk);
     }
 
     // calculate maximum snap
     // Snap (the rate of change of jerk) uses the attitude control input time constant because multicopters
     // lean to accelerate. This means the change in angle is equivalent to the change in acceleration
-    _scurve_snap = (_scurve_jerk * M_PI) / (2.0 * MAX(_attitude_control.get_input_tc(), 0.1f));
-    const float snap = MIN(_attitude_control.get_accel_roll_max_radss(), _attitude_control.get_accel_pitch_max_radss()) * GRAVITY_MSS;
-    if (is_positive(snap)) {
-        _scurve_snap = MIN(_scurve_snap, snap);
+    snap = (jerk * M_PI) / (2.0 * MAX(_attitude_control.get_input_tc(), 0.1f));
+    const float snap_max = MIN(_attitude_control.get_accel_roll_max_radss(), _attitude_control.get_accel_pitch_max_radss()) * GRAVITY_MSS;
+    if (is_positive(snap_max)) {
+        snap = MIN(snap, snap_max);
     }
     // reduce maximum snap by a factor of two from what the aircraft is capable of
-    _scurve_snap *= 0.5;
+    snap *= 0.5;
 }
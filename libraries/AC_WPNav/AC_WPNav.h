@@ -157,6 +157,9 @@ public:
     // get wp_radius parameter value in cm
     float get_wp_radius_cm() const { return _wp_radius_cm; }
 
+    /// get_scurve_jerk_and_snap - scurve jerk (m/s/s/s) and snap (m/s/s/s/s) limits used for straight line legs
+    void get_scurve_jerk_and_snap(float &jerk, float &snap) const;
+
     /// update_wpnav - run the wp controller - should be called at 100hz or higher
     virtual bool update_wpnav();
 
@@ -0,0 +1,680 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  whole-mission time, distance and energy estimates
+
+  The mission is flown in simulation with perfect tracking: each
+  straight leg is an SCurve and each spline leg a SplineCurve, set up
+  the way AC_WPNav sets them up, including the blending of fast
+  waypoints through corners. The simulation advances a few hundred
+  steps per IO thread callback, and is restarted from the beginning
+  whenever the mission or the limits change.
+ */
+
+#include "AC_WPNav_Planner.h"
+
+#if AC_WPNAV_PLANNER_ENABLED
+
+#include "AC_WPNav.h"
+#include <AP_AHRS/AP_AHRS.h>
+#include <AP_BattMonitor/AP_BattMonitor.h>
+#include <AP_Common/ExpandingString.h>
+
+extern const AP_HAL::HAL& hal;
+
+// simulation time step
+#define AC_WPNAV_PLANNER_DT 0.05f
+
+// simulation steps per IO thread callback
+#ifndef AC_WPNAV_PLANNER_STEPS
+#define AC_WPNAV_PLANNER_STEPS 200
+#endif
+
+// a mission longer than this is treated as never completing
+#define AC_WPNAV_PLANNER_MAX_TIME_S (24 * 3600.0f)
+
+// mission commands read looking for a single destination
+#define AC_WPNAV_PLANNER_MAX_READS 64
+
+AC_WPNav_Planner *AC_WPNav_Planner::_singleton;
+
+AC_WPNav_Planner::AC_WPNav_Planner(AC_WPNav *&wp_nav) :
+    _wp_nav(wp_nav)
+{
+    _singleton = this;
+}
+
+/*
+  watch for changes to the mission and limits, and track progress
+  through the running mission. Called from the main loop at 10Hz
+ */
+void AC_WPNav_Planner::update(void)
+{
+    const AP_Mission *mission = AP::mission();
+    if (_wp_nav == nullptr || mission == nullptr || !AP::ahrs().home_is_set()) {
+        return;
+    }
+    if (!io_registered) {
+        hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&AC_WPNav_Planner::io_update, void));
+        io_registered = true;
+    }
+
+    Kinematics k;
+    k.speed_xy = _wp_nav->get_default_speed_xy();
+    k.speed_up = _wp_nav->get_default_speed_up();
+    k.speed_down = _wp_nav->get_default_speed_down();
+    k.accel_xy = _wp_nav->get_wp_acceleration();
+    k.accel_z = _wp_nav->get_accel_z();
+    k.accel_corner = _wp_nav->get_corner_acceleration();
+    _wp_nav->get_scurve_jerk_and_snap(k.jerk, k.snap);
+    k.radius = _wp_nav->get_wp_radius_cm();
+    const Location &ahrs_home = AP::ahrs().get_home();
+
+    WITH_SEMAPHORE(sem);
+
+    if (memcmp(&k, &kin, sizeof(k)) != 0 ||
+        mission->last_change_time_ms() != mission_change_ms ||
+        home.get_distance(ahrs_home) > 1.0f) {
+        kin = k;
+        home = ahrs_home;
+        mission_change_ms = mission->last_change_time_ms();
+        request_gen++;
+    }
+
+    if (mission->state() == AP_Mission::MISSION_RUNNING) {
+        current_index = mission->get_current_nav_index();
+        current_dist_m = _wp_nav->get_wp_distance_to_destination() * 0.01f;
+    } else {
+        current_index = 0;
+        current_dist_m = 0.0f;
+    }
+
+#if AP_BATTERY_ENABLED
+    float current_amps;
+    if (hal.util->get_soft_armed() && AP::battery().current_amps(current_amps)) {
+        const float power_w = AP::battery().voltage() * current_amps;
+        if (is_zero(average_power_w)) {
+            average_power_w = power_w;
+        } else {
+            average_power_w += (power_w - average_power_w) * 0.01f;
+        }
+    }
+#endif
+}
+
+/*
+  run the planner from the IO thread
+ */
+void AC_WPNav_Planner::io_update(void)
+{
+    bool restart = false;
+    {
+        WITH_SEMAPHORE(sem);
+        if (work_gen != request_gen) {
+            work_gen = request_gen;
+            restart = true;
+        }
+    }
+    if (restart) {
+        start();
+    }
+    if (!planning) {
+        return;
+    }
+    const uint32_t start_us = AP_HAL::micros();
+    for (uint16_t i=0; i<AC_WPNAV_PLANNER_STEPS && planning; i++) {
+        step();
+    }
+    planning_us += AP_HAL::micros() - start_us;
+}
+
+/*
+  start planning from the first command of the mission
+ */
+void AC_WPNav_Planner::start(void)
+{
+    planning = false;
+    planning_us = 0;
+    if (work == nullptr) {
+        work = NEW_NOTHROW Work;
+        if (work == nullptr) {
+            return;
+        }
+    }
+    Work &w = *work;
+    if (w.legs == nullptr) {
+        w.legs = NEW_NOTHROW Leg[AC_WPNAV_PLANNER_MAX_LEGS];
+        if (w.legs == nullptr) {
+            return;
+        }
+    }
+
+    {
+        WITH_SEMAPHORE(sem);
+        w.kin = kin;
+        w.home = home;
+    }
+
+    // the vehicle starts on the ground at home
+    w.num_jumps = 0;
+    w.last_pos.zero();
+    w.speed_xy = w.kin.speed_xy;
+    w.land_pending = false;
+    w.unbounded = false;
+
+    w.origin.zero();
+    w.pos.zero();
+    w.vel.zero();
+    w.scurve_prev_leg.init();
+    w.scurve_this_leg.init();
+    w.scurve_next_leg.init();
+    w.this_leg_is_spline = false;
+    w.fast_waypoint = false;
+
+    w.time_s = 0.0f;
+    w.distance_m = 0.0f;
+    w.leg_start_s = 0.0f;
+    w.leg_start_m = 0.0f;
+    w.leg_peak_speed = 0.0f;
+    w.num_legs = 0;
+    w.truncated = false;
+
+    // skip home
+    w.cmd_index = 1;
+
+    planning = true;
+    if (!next_target(w.this_target)) {
+        complete();
+        return;
+    }
+    w.have_next = next_target(w.next_target);
+    begin_leg(false, false);
+}
+
+/*
+  advance the simulated vehicle by one time step
+ */
+void AC_WPNav_Planner::step(void)
+{
+    Work &w = *work;
+    const float dt = AC_WPNAV_PLANNER_DT;
+
+    Vector3f pos, vel, accel;
+    bool finished;
+    if (w.this_leg_is_spline) {
+        vel = w.vel;
+        w.spline_this_leg.advance_target_along_track(dt, pos, vel);
+        finished = w.spline_this_leg.reached_destination();
+    } else {
+        pos = w.origin;
+        finished = w.scurve_this_leg.advance_target_along_track(w.scurve_prev_leg, w.scurve_next_leg, w.kin.radius, w.kin.accel_corner, w.fast_waypoint, dt, pos, vel, accel);
+    }
+
+    w.distance_m += (pos - w.pos).length() * 0.01f;
+    w.pos = pos;
+    w.vel = vel;
+    w.time_s += dt;
+    w.leg_peak_speed = MAX(w.leg_peak_speed, vel.length() * 0.01f);
+
+    if (finished) {
+        finish_leg();
+    } else if (w.time_s > AC_WPNAV_PLANNER_MAX_TIME_S) {
+        w.unbounded = true;
+        complete();
+    }
+}
+
+/*
+  record the leg just flown and start the next one
+ */
+void AC_WPNav_Planner::finish_leg(void)
+{
+    Work &w = *work;
+    const Target &t = w.this_target;
+
+    w.time_s += t.hold_s;
+
+    // legs are recorded the first time they are flown, in mission
+    // order so they can be searched by index
+    Leg *last = w.num_legs > 0 ? &w.legs[w.num_legs-1] : nullptr;
+    if (t.continued && last != nullptr && last->index == t.index) {
+        last->duration_s = w.time_s - last->start_s;
+        last->length_m = w.distance_m - last->start_m;
+        last->peak_speed = MAX(last->peak_speed, w.leg_peak_speed);
+    } else if (last == nullptr || t.index > last->index) {
+        if (w.num_legs < AC_WPNAV_PLANNER_MAX_LEGS) {
+            Leg &leg = w.legs[w.num_legs++];
+            leg.index = t.index;
+            leg.start_s = w.leg_start_s;
+            leg.duration_s = w.time_s - w.leg_start_s;
+            leg.start_m = w.leg_start_m;
+            leg.length_m = w.distance_m - w.leg_start_m;
+            leg.peak_speed = w.leg_peak_speed;
+        } else {
+            w.truncated = true;
+        }
+    }
+    w.leg_start_s = w.time_s;
+    w.leg_start_m = w.distance_m;
+    w.leg_peak_speed = 0.0f;
+
+    if (!w.have_next || w.time_s > AC_WPNAV_PLANNER_MAX_TIME_S) {
+        if (w.have_next) {
+            w.unbounded = true;
+        }
+        complete();
+        return;
+    }
+
+    const bool prev_fast = w.fast_waypoint;
+    const bool prev_is_spline = w.this_leg_is_spline;
+    w.origin = t.pos;
+    w.this_target = w.next_target;
+    w.have_next = next_target(w.next_target);
+    begin_leg(prev_fast, prev_is_spline);
+}
+
+/*
+  set up the leg to this_target the way AC_WPNav's set_wp_destination()
+  and set_spline_destination() do
+ */
+void AC_WPNav_Planner::begin_leg(bool prev_fast, bool prev_is_spline)
+{
+    Work &w = *work;
+    const Kinematics &k = w.kin;
+    const Target &t = w.this_target;
+    const bool next_fast = w.have_next && !t.stop && !w.next_target.stop_before;
+
+    if (!prev_fast) {
+        w.vel.zero();
+    }
+
+    if (t.spline) {
+        Vector3f origin_vector;
+        if (prev_fast) {
+            origin_vector = prev_is_spline ? w.spline_this_leg.get_destination_vel() : w.scurve_this_leg.get_track();
+        }
+        Vector3f destination_vector;
+        if (next_fast) {
+            if (w.next_target.spline) {
+                destination_vector = w.next_target.pos - w.origin;
+            } else {
+                destination_vector = w.next_target.pos - t.pos;
+            }
+        }
+        w.fast_waypoint = !destination_vector.is_zero();
+
+        w.spline_this_leg.set_speed_accel(t.speed_xy, k.speed_up, k.speed_down, k.accel_xy, k.accel_z);
+        w.spline_this_leg.set_origin_and_destination(w.origin, t.pos, origin_vector, destination_vector);
+        w.this_leg_is_spline = true;
+
+        // limit the speed at the end of the spline to what the
+        // following straight leg can start with
+        w.scurve_next_leg.init();
+        if (w.fast_waypoint && !w.next_target.spline) {
+            w.scurve_next_leg.calculate_track(t.pos, w.next_target.pos,
+                                              w.next_target.speed_xy, k.speed_up, k.speed_down,
+                                              k.accel_xy, k.accel_z,
+                                              k.snap * 100.0f, k.jerk * 100.0f);
+            const float origin_speed = w.scurve_next_leg.set_origin_speed_max(w.spline_this_leg.get_destination_speed_max());
+            w.spline_this_leg.set_destination_speed_max(origin_speed);
+        }
+        return;
+    }
+
+    // straight leg
+    float origin_speed = 0.0f;
+    w.scurve_prev_leg.init();
+    if (prev_is_spline) {
+        origin_speed = w.vel.length();
+    } else {
+        w.scurve_prev_leg = w.scurve_this_leg;
+    }
+
+    if (prev_fast && !prev_is_spline && !w.scurve_next_leg.finished()) {
+        // already calculated as the previous leg's next leg
+        w.scurve_this_leg = w.scurve_next_leg;
+    } else {
+        w.scurve_this_leg.calculate_track(w.origin, t.pos,
+                                          t.speed_xy, k.speed_up, k.speed_down,
+                                          k.accel_xy, k.accel_z,
+                                          k.snap * 100.0f, k.jerk * 100.0f);
+        if (!is_zero(origin_speed)) {
+            w.scurve_this_leg.set_origin_speed_max(origin_speed);
+        }
+    }
+    w.this_leg_is_spline = false;
+
+    w.scurve_next_leg.init();
+    w.fast_waypoint = next_fast;
+    if (next_fast && !w.next_target.spline) {
+        w.scurve_next_leg.calculate_track(t.pos, w.next_target.pos,
+                                          w.next_target.speed_xy, k.speed_up, k.speed_down,
+                                          k.accel_xy, k.accel_z,
+                                          k.snap * 100.0f, k.jerk * 100.0f);
+    }
+}
+
+/*
+  publish the finished plan
+ */
+void AC_WPNav_Planner::complete(void)
+{
+    Work &w = *work;
+    planning = false;
+
+    WITH_SEMAPHORE(sem);
+    if (work_gen != request_gen) {
+        // already out of date, a new plan will be started
+        return;
+    }
+    // swap the leg arrays rather than copy them
+    Leg *legs = plan.legs;
+    plan.legs = w.legs;
+    w.legs = legs;
+    plan.num_legs = w.num_legs;
+    plan.total_s = w.time_s;
+    plan.total_m = w.distance_m;
+    plan.truncated = w.truncated;
+    plan.unbounded = w.unbounded;
+    plan.plan_us = planning_us;
+    plan.valid = true;
+}
+
+/*
+  convert a command's location to a position relative to home. A zero
+  latitude and longitude or altitude keeps the previous value
+ */
+Vector3f AC_WPNav_Planner::target_pos(const Location &loc) const
+{
+    const Work &w = *work;
+    Vector3f pos = w.last_pos;
+    if (loc.lat != 0 || loc.lng != 0) {
+        const Vector2f ne = w.home.get_distance_NE(loc) * 100.0f;
+        pos.x = ne.x;
+        pos.y = ne.y;
+    }
+    if (loc.alt != 0) {
+        int32_t alt_cm;
+        if (!loc.get_alt_cm(Location::AltFrame::ABOVE_HOME, alt_cm)) {
+            // terrain relative, assume flat terrain
+            alt_cm = loc.alt;
+        }
+        pos.z = alt_cm;
+    }
+    return pos;
+}
+
+/*
+  walk the mission to the next destination, following DO_JUMPs and
+  applying speed changes. Returns false at the end of the mission or
+  after a command which never completes
+ */
+bool AC_WPNav_Planner::next_target(Target &target)
+{
+    Work &w = *work;
+    const AP_Mission *mission = AP::mission();
+
+    target = {};
+    target.speed_xy = w.speed_xy;
+
+    if (w.land_pending) {
+        // descend at the position of the previous target
+        w.land_pending = false;
+        target.pos = w.last_pos;
+        target.pos.z = 0.0f;
+        target.index = w.this_target.index;
+        target.stop = true;
+        target.stop_before = true;
+        target.continued = true;
+        w.last_pos = target.pos;
+        return true;
+    }
+
+    for (uint8_t reads=0; reads<AC_WPNAV_PLANNER_MAX_READS; reads++) {
+        AP_Mission::Mission_Command cmd;
+        if (w.unbounded ||
+            mission == nullptr ||
+            w.cmd_index >= mission->num_commands() ||
+            !mission->read_cmd_from_storage(w.cmd_index, cmd)) {
+            return false;
+        }
+        const uint16_t index = w.cmd_index++;
+
+        switch (cmd.id) {
+        case MAV_CMD_DO_JUMP: {
+            if (cmd.content.jump.num_times == AP_MISSION_JUMP_REPEAT_FOREVER) {
+                w.unbounded = true;
+                return false;
+            }
+            uint8_t j = 0;
+            while (j < w.num_jumps && w.jumps[j].index != index) {
+                j++;
+            }
+            if (j == w.num_jumps) {
+                if (w.num_jumps >= ARRAY_SIZE(w.jumps)) {
+                    // too many jumps to track, don't repeat
+                    continue;
+                }
+                w.jumps[j].index = index;
+                w.jumps[j].count = 0;
+                w.num_jumps++;
+            }
+            if (w.jumps[j].count < cmd.content.jump.num_times) {
+                w.jumps[j].count++;
+                w.cmd_index = cmd.content.jump.target;
+            }
+            continue;
+        }
+
+        case MAV_CMD_DO_CHANGE_SPEED:
+            if (is_positive(cmd.content.speed.target_ms)) {
+                w.speed_xy = cmd.content.speed.target_ms * 100.0f;
+                target.speed_xy = w.speed_xy;
+            }
+            continue;
+
+        case MAV_CMD_NAV_WAYPOINT:
+        case MAV_CMD_NAV_SPLINE_WAYPOINT:
+            target.pos = target_pos(cmd.content.location);
+            target.hold_s = cmd.p1;
+            target.stop = cmd.p1 > 0;
+            target.spline = cmd.id == MAV_CMD_NAV_SPLINE_WAYPOINT;
+            break;
+
+        case MAV_CMD_NAV_LOITER_TIME:
+            target.pos = target_pos(cmd.content.location);
+            target.hold_s = cmd.p1;
+            target.stop = true;
+            break;
+
+        case MAV_CMD_NAV_LOITER_TURNS: {
+            target.pos = target_pos(cmd.content.location);
+            target.stop = true;
+            float radius_m = HIGHBYTE(cmd.p1);
+            if (cmd.type_specific_bits & (1U << 0)) {
+                radius_m *= 10;
+            }
+            if (is_positive(radius_m)) {
+                // circle at the lower of the waypoint speed and the
+                // speed the acceleration limit allows
+                const float speed_ms = MIN(target.speed_xy * 0.01f, safe_sqrt(w.kin.accel_xy * 0.01f * radius_m));
+                if (is_positive(speed_ms)) {
+                    target.hold_s = cmd.get_loiter_turns() * M_2PI * radius_m / speed_ms;
+                }
+            }
+            break;
+        }
+
+        case MAV_CMD_NAV_LOITER_UNLIM:
+            target.pos = target_pos(cmd.content.location);
+            target.stop = true;
+            w.unbounded = true;
+            break;
+
+        case MAV_CMD_NAV_TAKEOFF:
+            target.pos = w.last_pos;
+            target.pos.z = target_pos(cmd.content.location).z;
+            target.stop = true;
+            target.stop_before = true;
+            break;
+
+        case MAV_CMD_NAV_LAND:
+            if (cmd.content.location.lat == 0 && cmd.content.location.lng == 0) {
+                target.pos = w.last_pos;
+                target.pos.z = 0.0f;
+            } else {
+                // fly to the landing position, then descend
+                target.pos = target_pos(cmd.content.location);
+                target.pos.z = w.last_pos.z;
+                w.land_pending = true;
+            }
+            target.stop = true;
+            target.stop_before = true;
+            break;
+
+        case MAV_CMD_NAV_RETURN_TO_LAUNCH:
+            // return at the current altitude, then descend
+            target.pos = Vector3f{0.0f, 0.0f, w.last_pos.z};
+            target.stop = true;
+            target.stop_before = true;
+            w.land_pending = true;
+            break;
+
+        case MAV_CMD_NAV_DELAY:
+            target.pos = w.last_pos;
+            target.hold_s = MAX(cmd.content.nav_delay.seconds, 0.0f);
+            target.stop = true;
+            target.stop_before = true;
+            break;
+
+        default:
+            if (!AP_Mission::is_nav_cmd(cmd) || !AP_Mission::stored_in_location(cmd.id)) {
+                // no destination to fly to
+                continue;
+            }
+            // fly to other navigation commands as if they were waypoints
+            target.pos = target_pos(cmd.content.location);
+            target.stop = true;
+            target.stop_before = true;
+            break;
+        }
+
+        target.index = index;
+        w.last_pos = target.pos;
+        return true;
+    }
+    return false;
+}
+
+/*
+  time and distance to fly the whole mission
+ */
+bool AC_WPNav_Planner::get_total(float &time_s, float &distance_m)
+{
+    WITH_SEMAPHORE(sem);
+    if (!plan.valid) {
+        return false;
+    }
+    time_s = plan.total_s;
+    distance_m = plan.total_m;
+    return true;
+}
+
+/*
+  time, distance and energy to complete the mission from the current
+  position
+ */
+bool AC_WPNav_Planner::get_remaining(float &time_s, float &distance_m, float &energy_wh)
+{
+    WITH_SEMAPHORE(sem);
+    if (!plan.valid) {
+        return false;
+    }
+    if (current_index == 0) {
+        // not flying the mission, all of it remains
+        time_s = plan.total_s;
+        distance_m = plan.total_m;
+    } else {
+        // find the leg to the current command
+        uint16_t lo = 0;
+        uint16_t hi = plan.num_legs;
+        while (lo < hi) {
+            const uint16_t mid = (lo + hi) / 2;
+            if (plan.legs[mid].index < current_index) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo >= plan.num_legs || plan.legs[lo].index != current_index) {
+            return false;
+        }
+        const Leg &leg = plan.legs[lo];
+        // the part of the leg still to fly, from the distance to its
+        // destination
+        float frac_left = 0.0f;
+        if (is_positive(leg.length_m)) {
+            frac_left = constrain_float(current_dist_m / leg.length_m, 0.0f, 1.0f);
+        }
+        time_s = plan.total_s - (leg.start_s + leg.duration_s) + leg.duration_s * frac_left;
+        distance_m = plan.total_m - (leg.start_m + leg.length_m) + leg.length_m * frac_left;
+    }
+    energy_wh = average_power_w * time_s * (1.0f / 3600.0f);
+    return true;
+}
+
+/*
+  plan details for @SYS/mission_plan.txt
+ */
+void AC_WPNav_Planner::plan_info(ExpandingString &str)
+{
+    WITH_SEMAPHORE(sem);
+    if (!plan.valid) {
+        str.printf("%s\n", planning ? "planning" : "no plan");
+        return;
+    }
+    str.printf("total=%.1fs %.1fm legs=%u%s%s%s planned in %.1fms\n",
+               plan.total_s,
+               plan.total_m,
+               unsigned(plan.num_legs),
+               plan.truncated ? " truncated" : "",
+               plan.unbounded ? " unbounded" : "",
+               work_gen != request_gen || planning ? " replanning" : "",
+               plan.plan_us * 0.001f);
+    str.printf("%5s %8s %8s %8s %8s %6s\n", "index", "start_s", "time_s", "start_m", "len_m", "vmax");
+    for (uint16_t i=0; i<plan.num_legs; i++) {
+        const Leg &leg = plan.legs[i];
+        str.printf("%5u %8.1f %8.1f %8.1f %8.1f %6.1f\n",
+                   unsigned(leg.index),
+                   leg.start_s,
+                   leg.duration_s,
+                   leg.start_m,
+                   leg.length_m,
+                   leg.peak_speed);
+    }
+}
+
+namespace AP {
+
+AC_WPNav_Planner *wpnav_planner()
+{
+    return AC_WPNav_Planner::get_singleton();
+}
+
+};
+
+#endif  // AC_WPNAV_PLANNER_ENABLED
@@ -0,0 +1,183 @@
+#pragma once
+
+#include "AC_WPNav_config.h"
+
+#if AC_WPNAV_PLANNER_ENABLED
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/AP_Common.h>
+#include <AP_Common/Location.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/SCurve.h>
+#include <AP_Math/SplineCurve.h>
+#include <AP_Mission/AP_Mission.h>
+
+// maximum number of mission legs whose details are kept
+#ifndef AC_WPNAV_PLANNER_MAX_LEGS
+#define AC_WPNAV_PLANNER_MAX_LEGS 100
+#endif
+
+class AC_WPNav;
+class ExpandingString;
+
+/*
+  Estimates the time, distance and energy needed to fly the whole
+  mission by running the same S-Curve and spline kinematics AC_WPNav
+  uses for the active legs over every leg of the mission, with the
+  vehicle's current WPNAV limits. The mission is replanned whenever it
+  changes, the limits change or home moves, in small steps from the
+  IO thread so it never takes much time from any one callback.
+ */
+class AC_WPNav_Planner
+{
+public:
+    AC_WPNav_Planner(AC_WPNav *&wp_nav);
+
+    CLASS_NO_COPY(AC_WPNav_Planner);
+
+    static AC_WPNav_Planner *get_singleton(void) { return _singleton; }
+
+    // watch for changes to the mission and limits, and track progress
+    // through the running mission. Called from the main loop at 10Hz
+    void update(void);
+
+    // time and distance to fly the whole mission
+    // returns false until a plan is available
+    bool get_total(float &time_s, float &distance_m);
+
+    // time, distance and energy to complete the mission from the
+    // current position. Energy is zero until the vehicle has flown
+    // long enough to measure its average power
+    // returns false if no plan is available for the current command
+    bool get_remaining(float &time_s, float &distance_m, float &energy_wh);
+
+    // plan details for @SYS/mission_plan.txt
+    void plan_info(ExpandingString &str);
+
+private:
+    static AC_WPNav_Planner *_singleton;
+
+    AC_WPNav *&_wp_nav;
+
+    // limits the legs are planned with, in the units AC_WPNav uses
+    struct Kinematics {
+        float speed_xy;         // cm/s
+        float speed_up;         // cm/s
+        float speed_down;       // cm/s
+        float accel_xy;         // cm/s/s
+        float accel_z;          // cm/s/s
+        float accel_corner;     // cm/s/s
+        float jerk;             // m/s/s/s
+        float snap;             // m/s/s/s/s
+        float radius;           // cm
+    };
+
+    // one leg of the mission, recorded the first time it is flown
+    struct Leg {
+        uint16_t index;         // mission index of the command the leg flies to
+        float start_s;          // time from the start of the mission
+        float duration_s;       // including any hold at the destination
+        float start_m;          // distance from the start of the mission
+        float length_m;
+        float peak_speed;       // m/s
+    };
+
+    // a mission command's destination, as the simulation flies to it
+    struct Target {
+        Vector3f pos;           // NEU offset from home in cm
+        uint16_t index;
+        float hold_s;           // time spent at the destination
+        float speed_xy;         // cm/s, after any DO_CHANGE_SPEED
+        bool stop;              // vehicle comes to a stop at the destination
+        bool stop_before;       // vehicle comes to a stop before starting this leg
+        bool spline;
+        bool continued;         // second part of the same command (e.g. the descent of a LAND)
+    };
+
+    // state of the planning run, only touched from the IO thread
+    struct Work {
+        Kinematics kin;
+        Location home;
+
+        // mission walk
+        uint16_t cmd_index;
+        struct {
+            uint16_t index;
+            int16_t count;
+        } jumps[AP_MISSION_MAX_NUM_DO_JUMP_COMMANDS];
+        uint8_t num_jumps;
+        Vector3f last_pos;
+        float speed_xy;
+        bool land_pending;
+        bool unbounded;
+
+        // legs being flown
+        Target this_target;
+        Target next_target;
+        bool have_next;
+        Vector3f origin;
+        SCurve scurve_prev_leg;
+        SCurve scurve_this_leg;
+        SCurve scurve_next_leg;
+        SplineCurve spline_this_leg;
+        bool this_leg_is_spline;
+        bool fast_waypoint;
+        Vector3f pos;
+        Vector3f vel;
+
+        // totals
+        float time_s;
+        float distance_m;
+        float leg_start_s;
+        float leg_start_m;
+        float leg_peak_speed;
+        Leg *legs;
+        uint16_t num_legs;
+        bool truncated;
+    } *work;
+
+    // published plan
+    struct Plan {
+        Leg *legs;
+        uint16_t num_legs;
+        float total_s;
+        float total_m;
+        bool valid;
+        bool truncated;         // more legs than AC_WPNAV_PLANNER_MAX_LEGS
+        bool unbounded;         // mission contains a command which never completes
+        uint32_t plan_us;       // time spent planning
+    } plan;
+
+    HAL_Semaphore sem;
+
+    // requests from the main loop, protected by sem
+    Kinematics kin;
+    Location home;
+    uint32_t mission_change_ms;
+    uint32_t request_gen;
+    uint32_t work_gen;
+    bool planning;
+    uint32_t planning_us;
+
+    // progress through the running mission, protected by sem
+    uint16_t current_index;
+    float current_dist_m;
+    float average_power_w;
+
+    bool io_registered;
+
+    void io_update(void);
+    void start(void);
+    void step(void);
+    void finish_leg(void);
+    void begin_leg(bool prev_fast, bool prev_is_spline);
+    void complete(void);
+    bool next_target(Target &target);
+    Vector3f target_pos(const Location &loc) const;
+};
+
+namespace AP {
+    AC_WPNav_Planner *wpnav_planner();
+};
+
+#endif  // AC_WPNAV_PLANNER_ENABLED
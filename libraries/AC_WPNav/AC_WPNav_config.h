@@ -1,7 +1,12 @@
 #pragma once
 
 #include <AC_Avoidance/AC_Avoidance_config.h>
+#include <AP_Mission/AP_Mission_config.h>
 
 #ifndef AC_WPNAV_OA_ENABLED
 #define AC_WPNAV_OA_ENABLED AP_OAPATHPLANNER_ENABLED
 #endif
+
+#ifndef AC_WPNAV_PLANNER_ENABLED
+#define AC_WPNAV_PLANNER_ENABLED (AP_MISSION_ENABLED && HAL_PROGRAM_SIZE_LIMIT_KB > 1024)
+#endif
@@ -213,6 +213,8 @@ void AP_ADSB::init(void)
             return;
         }
         in_state.list_size_allocated = in_state.list_size_param;
+
+        IGNORE_RETURN(in_state.icao_index.allocate(in_state.list_size_allocated));
     }
 
     if (detected_num_instances == 0) {
@@ -492,7 +494,9 @@ void AP_ADSB::delete_vehicle(const uint16_t index)
         in_state.furthest_vehicle_distance = 0;
         in_state.furthest_vehicle_index = 0;
     }
+    in_state.icao_index.remove(index, icao_of{in_state.vehicle_list});
     if (index != (in_state.vehicle_count-1)) {
+        in_state.icao_index.move(in_state.vehicle_count-1, index, icao_of{in_state.vehicle_list});
         in_state.vehicle_list[index] = in_state.vehicle_list[in_state.vehicle_count-1];
     }
     // TODO: is memset needed? When we decrement the index we essentially forget about it
@@ -507,8 +511,12 @@ void AP_ADSB::delete_vehicle(const uint16_t index)
  */
 bool AP_ADSB::find_index(const adsb_vehicle_t &vehicle, uint16_t *index) const
 {
+    const uint32_t icao = vehicle.info.ICAO_address;
+    if (in_state.icao_index.allocated()) {
+        return in_state.icao_index.find(icao, *index, icao_of{in_state.vehicle_list});
+    }
     for (uint16_t i = 0; i < in_state.vehicle_count; i++) {
-        if (in_state.vehicle_list[i].info.ICAO_address == vehicle.info.ICAO_address) {
+        if (in_state.vehicle_list[i].info.ICAO_address == icao) {
             *index = i;
             return true;
         }
@@ -610,7 +618,16 @@ void AP_ADSB::set_vehicle(const uint16_t index, const adsb_vehicle_t &vehicle)
         // out of range
         return;
     }
+    // a new vehicle is either appended or replaces another
+    const bool is_new = index >= in_state.vehicle_count ||
+        in_state.vehicle_list[index].info.ICAO_address != vehicle.info.ICAO_address;
+    if (is_new && index < in_state.vehicle_count) {
+        in_state.icao_index.remove(index, icao_of{in_state.vehicle_list});
+    }
     in_state.vehicle_list[index] = vehicle;
+    if (is_new) {
+        in_state.icao_index.add(index, icao_of{in_state.vehicle_list});
+    }
 
 #if HAL_LOGGING_ENABLED
     write_log(vehicle);
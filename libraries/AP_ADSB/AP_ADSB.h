@@ -27,6 +27,7 @@
 #include <AP_Common/AP_Common.h>
 #include <AP_Param/AP_Param.h>
 #include <AP_Common/Location.h>
+#include <AP_Common/IndexHash.h>
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include <AP_GPS/AP_GPS_FixType.h>
 
@@ -239,6 +240,12 @@ private:
     // remove a vehicle from the list
     void delete_vehicle(const uint16_t index);
 
+    // key of the ICAO address hash of vehicle_list
+    struct icao_of {
+        const adsb_vehicle_t *list;
+        uint32_t operator()(uint16_t i) const { return list[i].info.ICAO_address; }
+    };
+
     void set_vehicle(const uint16_t index, const adsb_vehicle_t &vehicle);
 
     // Generates pseudorandom ICAO from gps time, lat, and lon
@@ -269,6 +276,10 @@ private:
         uint16_t    list_size_allocated;
         adsb_vehicle_t *vehicle_list;
         uint16_t    vehicle_count;
+
+        // hash of ICAO address to vehicle_list index. Linear search
+        // is used if this could not be allocated
+        IndexHash   icao_index;
         AP_Int32    list_radius;
         AP_Int16    list_altitude;
 
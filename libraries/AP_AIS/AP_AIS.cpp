@@ -62,7 +62,7 @@ const AP_Param::GroupInfo AP_AIS::var_info[] = {
     // @Param: LOGGING
     // @DisplayName: AIS logging options
     // @Description: Bitmask of AIS logging options
-    // @Bitmask: 0:Log all AIVDM messages,1:Log only unsupported AIVDM messages,2:Log decoded messages
+    // @Bitmask: 0:Log all AIVDM messages,1:Log only unsupported AIVDM messages,2:Log decoded messages,3:Log decode statistics
     // @User: Advanced
     AP_GROUPINFO("LOGGING", 4, AP_AIS, _log_options, AIS_OPTIONS_LOG_UNSUPPORTED_RAW | AIS_OPTIONS_LOG_DECODED),
 
@@ -108,6 +108,8 @@ void AP_AIS::update()
         return;
     }
 
+    const uint32_t start_us = AP_HAL::micros();
+
     // read any available lines
     uint32_t nbytes = MIN(_uart->available(),1024U);
     while (nbytes-- > 0) {
@@ -115,8 +117,10 @@ void AP_AIS::update()
         if (byte == -1) {
             break;
         }
+        _stats.bytes++;
         const char c = byte;
         if (decode(c)) {
+            _stats.sentences++;
             const bool log_all = (_log_options & AIS_OPTIONS_LOG_ALL_RAW) != 0;
             const bool log_unsupported = ((_log_options & AIS_OPTIONS_LOG_UNSUPPORTED_RAW) != 0) && !log_all; // only log unsupported if not logging all
 
@@ -231,18 +235,24 @@ void AP_AIS::update()
         }
     }
 
-    // remove expired items from the list
+    // remove expired items from the list, the least recently updated
+    // vessels are at the tail
     const uint32_t now =  AP_HAL::millis();
     const uint32_t timeout = _time_out * 1000;
-    if (now < timeout) {
-        return;
-    }
-    const uint32_t deadline = now - timeout;
-    for (uint16_t i = 0; i < _list.max_items(); i++) {
-        if (_list[i].last_update_ms < deadline && _list[i].last_update_ms != 0) {
-            clear_list_item(i);
+    if (now >= timeout) {
+        const uint32_t deadline = now - timeout;
+        while (_lru_tail != AIS_INDEX_NONE && _list[_lru_tail].lru_ms < deadline) {
+            clear_list_item(_lru_tail);
+            _stats.expired++;
         }
     }
+
+    const uint32_t dt_us = AP_HAL::micros() - start_us;
+    _stats.update_us += dt_us;
+    _stats.update_max_us = MAX(_stats.update_max_us, dt_us);
+    if (now - _stats.last_log_ms >= 1000) {
+        log_stats(now);
+    }
 }
 
 // Send a AIS mavlink message
@@ -293,49 +303,28 @@ void AP_AIS::buffer_shift(uint8_t i)
 // find vessel index in existing list, if not then return NEW_NOTHROW index if possible
 bool AP_AIS::get_vessel_index(uint32_t mmsi, uint16_t &index, uint32_t lat, uint32_t lon)
 {
-    const uint16_t list_size = _list.max_items();
-
-    uint16_t empty = 0;
-    bool found_empty = false;
-    for (uint16_t i = 0; i < list_size; i++) {
-        if (_list[i].info.MMSI == mmsi) {
-            index = i;
-            return true;
-        }
-        if (_list[i].last_update_ms == 0 && !found_empty) {
-            found_empty = true;
-            empty = i;
-        }
-    }
-
-    // got through the list without a match
-    if (found_empty) {
-        index = empty;
-        _list[index].info.MMSI = mmsi;
+    if (mmsi_index_find(mmsi, index)) {
         return true;
     }
 
-    // no space in the list
-    if (list_size < _max_list) {
+    // no free items in the list
+    if (_free_head == AIS_INDEX_NONE && _list.max_items() < _max_list) {
         // if we can try and expand
-        if (_list.expand(1)) {
-            index = list_size;
-            _list[index].info.MMSI = mmsi;
-            return true;
-        }
+        IGNORE_RETURN(expand_list());
+    }
+    if (vessel_add(mmsi, index)) {
+        return true;
     }
 
     // could not expand list, either because of memory or max list param
     // if we have a valid incoming location we can bump a further item from the list
-    if (lat == 0 && lon == 0) {
-        return false;
-    }
-
     Location current_loc;
-    if (!AP::ahrs().get_location(current_loc)) {
+    if ((lat == 0 && lon == 0) || !AP::ahrs().get_location(current_loc)) {
+        _stats.rejected++;
         return false;
     }
 
+    const uint16_t list_size = _list.max_items();
     Location loc;
     float dist;
     float max_dist = 0;
@@ -356,20 +345,132 @@ bool AP_AIS::get_vessel_index(uint32_t mmsi, uint16_t &index, uint32_t lat, uint
 
     if (dist < max_dist) {
         clear_list_item(index);
-        _list[index].info.MMSI = mmsi;
-        return true;
+        _stats.bumped++;
+        return vessel_add(mmsi, index);
     }
 
+    _stats.rejected++;
     return false;
 }
 
+// take an item from the free list for a new vessel
+bool AP_AIS::vessel_add(uint32_t mmsi, uint16_t &index)
+{
+    if (_free_head == AIS_INDEX_NONE) {
+        return false;
+    }
+    index = _free_head;
+    _free_head = _list[index].lru_prev;
+    _list[index].info.MMSI = mmsi;
+    _list[index].lru_ms = AP_HAL::millis();
+    _list[index].in_use = true;
+    _mmsi_index.add(index, mmsi_of{_list});
+    lru_push_head(index);
+    _vessel_count++;
+    return true;
+}
+
 void AP_AIS::clear_list_item(uint16_t index)
 {
-    if (index < _list.max_items()) {
-        memset(&_list[index],0,sizeof(ais_vehicle_t));
+    if (index >= _list.max_items() || !_list[index].in_use) {
+        // not in use
+        return;
+    }
+    _mmsi_index.remove(index, mmsi_of{_list});
+    lru_unlink(index);
+    memset(&_list[index],0,sizeof(ais_vehicle_t));
+    _list[index].lru_prev = _free_head;
+    _free_head = index;
+    _vessel_count--;
+}
+
+// record a location update to the vessel at index, moving it to the
+// head of the LRU list
+void AP_AIS::vessel_updated(uint16_t index)
+{
+    _list[index].last_update_ms = AP_HAL::millis();
+    _list[index].lru_ms = _list[index].last_update_ms;
+    if (index != _lru_head) {
+        lru_unlink(index);
+        lru_push_head(index);
     }
 }
 
+void AP_AIS::lru_unlink(uint16_t index)
+{
+    const ais_vehicle_t &v = _list[index];
+    if (v.lru_prev != AIS_INDEX_NONE) {
+        _list[v.lru_prev].lru_next = v.lru_next;
+    } else {
+        _lru_head = v.lru_next;
+    }
+    if (v.lru_next != AIS_INDEX_NONE) {
+        _list[v.lru_next].lru_prev = v.lru_prev;
+    } else {
+        _lru_tail = v.lru_prev;
+    }
+}
+
+void AP_AIS::lru_push_head(uint16_t index)
+{
+    ais_vehicle_t &v = _list[index];
+    v.lru_prev = AIS_INDEX_NONE;
+    v.lru_next = _lru_head;
+    if (_lru_head != AIS_INDEX_NONE) {
+        _list[_lru_head].lru_prev = index;
+    } else {
+        _lru_tail = index;
+    }
+    _lru_head = index;
+}
+
+// grow the list by one chunk, the new items go on the free list
+bool AP_AIS::expand_list()
+{
+    const uint16_t old_size = _list.max_items();
+    if (!_list.expand(1)) {
+        return false;
+    }
+    // lowest index first
+    for (uint16_t i = _list.max_items(); i > old_size; i--) {
+        _list[i-1].lru_prev = _free_head;
+        _free_head = i-1;
+    }
+    IGNORE_RETURN(mmsi_index_resize());
+    return true;
+}
+
+// make the MMSI hash big enough for the list, returns false if it
+// could not be allocated, leaving lookups to search the list
+bool AP_AIS::mmsi_index_resize()
+{
+    if (_mmsi_index.has_space(_list.max_items())) {
+        return true;
+    }
+    if (!_mmsi_index.allocate(_list.max_items())) {
+        return false;
+    }
+    for (uint16_t i = _lru_head; i != AIS_INDEX_NONE; i = _list[i].lru_next) {
+        _mmsi_index.add(i, mmsi_of{_list});
+    }
+    return true;
+}
+
+// find a vessel in use by MMSI
+bool AP_AIS::mmsi_index_find(uint32_t mmsi, uint16_t &index) const
+{
+    if (_mmsi_index.allocated()) {
+        return _mmsi_index.find(mmsi, index, mmsi_of{_list});
+    }
+    for (uint16_t i = _lru_head; i != AIS_INDEX_NONE; i = _list[i].lru_next) {
+        if (_list[i].info.MMSI == mmsi) {
+            index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Functions for decoding AIVDM payload messages
 
@@ -378,19 +479,30 @@ bool AP_AIS::payload_decode(const char *payload)
     // the message type is defined by the first character
     const uint8_t type = payload_char_decode(payload[0]);
 
+    bool ret = false;
     switch (type) {
         case 1: // Position Report Class A
         case 2: // Position Report Class A (Assigned schedule)
         case 3: // Position Report Class A (Response to interrogation)
-            return decode_position_report(payload, type);
+            ret = decode_position_report(payload, type);
+            break;
         case 4: // Base Station Report
-            return decode_base_station_report(payload);
+            ret = decode_base_station_report(payload);
+            break;
         case 5: // Static and Voyage Related Data
-            return decode_static_and_voyage_data(payload);
+            ret = decode_static_and_voyage_data(payload);
+            break;
 
         default:
-            return false;
+            break;
+    }
+
+    if (ret) {
+        _stats.decoded++;
+    } else {
+        _stats.unsupported++;
     }
+    return ret;
 }
 
 bool AP_AIS::decode_position_report(const char *payload, uint8_t type)
@@ -491,7 +603,7 @@ bool AP_AIS::decode_position_report(const char *payload, uint8_t type)
     _list[index].info.flags = flags; // uint16_t Bitmask to indicate various statuses including valid data fields
     _list[index].info.turn_rate = rot; // int8_t [cdeg/s] Turn rate
     _list[index].info.navigational_status = nav; // uint8_t Navigational status
-    _list[index].last_update_ms = AP_HAL::millis();
+    vessel_updated(index);
 
     return true;
 }
@@ -562,7 +674,7 @@ bool AP_AIS::decode_base_station_report(const char *payload)
 
     _list[index].info.lat = lat; // int32_t [degE7] Latitude
     _list[index].info.lon = lon; // int32_t [degE7] Longitude
-    _list[index].last_update_ms = AP_HAL::millis();
+    vessel_updated(index);
 
     return true;
 }
@@ -775,6 +887,32 @@ void AP_AIS::log_raw(const AIVDM *msg)
 }
 #endif
 
+// log decode throughput over the last second, and start counting again
+void AP_AIS::log_stats(uint32_t now_ms)
+{
+#if HAL_LOGGING_ENABLED
+    if ((_log_options & AIS_OPTIONS_LOG_STATS) != 0) {
+        struct log_AIS_stats pkt{
+            LOG_PACKET_HEADER_INIT(LOG_AIS_STATS_MSG),
+            time_us      : AP_HAL::micros64(),
+            bytes        : _stats.bytes,
+            sentences    : _stats.sentences,
+            decoded      : _stats.decoded,
+            unsupported  : _stats.unsupported,
+            rejected     : _stats.rejected,
+            expired      : _stats.expired,
+            bumped       : _stats.bumped,
+            vessels      : _vessel_count,
+            update_us    : _stats.update_us,
+            update_max_us: _stats.update_max_us
+        };
+        AP::logger().WriteBlock(&pkt, sizeof(pkt));
+    }
+#endif
+    memset(&_stats, 0, sizeof(_stats));
+    _stats.last_log_ms = now_ms;
+}
+
 // add a single character to the buffer and attempt to decode
 // returns true if a complete sentence was successfully decoded
 bool AP_AIS::decode(char c)
@@ -23,10 +23,12 @@
 
 #include <AP_Param/AP_Param.h>
 #include <AP_Common/AP_ExpandingArray.h>
+#include <AP_Common/IndexHash.h>
 #include <GCS_MAVLink/GCS_MAVLink.h>
 
 #define AIVDM_BUFFER_SIZE 10
 #define AIVDM_PAYLOAD_SIZE 65
+#define AIS_INDEX_NONE 0xFFFF // no vessel
 
 class AP_AIS
 {
@@ -70,6 +72,7 @@ private:
         AIS_OPTIONS_LOG_ALL_RAW         = 1<<0,
         AIS_OPTIONS_LOG_UNSUPPORTED_RAW = 1<<1,
         AIS_OPTIONS_LOG_DECODED         = 1<<2,
+        AIS_OPTIONS_LOG_STATS           = 1<<3,
     };
 
     struct AIVDM {
@@ -83,12 +86,62 @@ private:
 
     struct ais_vehicle_t {
         mavlink_ais_vessel_t info;
-        uint32_t last_update_ms; // last time this was refreshed, allows timeouts
+        uint32_t last_update_ms; // last time a location was received, zero if none has been
+        uint32_t lru_ms; // last time this was added or refreshed, allows timeouts
         uint32_t last_send_ms; // last time this message was sent via mavlink, stops us spamming the link
+        uint16_t lru_prev; // next more recently updated vessel, or the next free item
+        uint16_t lru_next; // next less recently updated vessel
+        bool in_use; // true if this item is a vessel rather than on the free list
     };
 
     // list of the vessels that are being tracked
     AP_ExpandingArray<ais_vehicle_t> _list {8};
+    uint16_t _vessel_count;
+
+    // vessels in use are kept in order of lru_ms, most recent
+    // first, so expired vessels are found at the tail without
+    // searching the list. Free items are chained through lru_prev
+    uint16_t _lru_head = AIS_INDEX_NONE;
+    uint16_t _lru_tail = AIS_INDEX_NONE;
+    uint16_t _free_head = AIS_INDEX_NONE;
+
+    // hash of MMSI to _list index. Linear search is used if this
+    // could not be allocated
+    IndexHash _mmsi_index;
+
+    // key of the MMSI hash of _list
+    struct mmsi_of {
+        const AP_ExpandingArray<ais_vehicle_t> &list;
+        uint32_t operator()(uint16_t i) const { return list[i].info.MMSI; }
+    };
+    bool mmsi_index_find(uint32_t mmsi, uint16_t &index) const;
+    bool mmsi_index_resize();
+
+    // grow the list by one chunk, adding the new items to the free list
+    bool expand_list();
+
+    // LRU list maintenance
+    void lru_unlink(uint16_t index);
+    void lru_push_head(uint16_t index);
+
+    // take a free item for a new vessel, and record an update to an existing one
+    bool vessel_add(uint32_t mmsi, uint16_t &index) WARN_IF_UNUSED;
+    void vessel_updated(uint16_t index);
+
+    // decode throughput, logged once a second
+    struct {
+        uint32_t bytes;          // bytes read from the receiver
+        uint16_t sentences;      // complete AIVDM sentences
+        uint16_t decoded;        // messages decoded into the vessel list
+        uint16_t unsupported;    // messages which could not be decoded or stored
+        uint16_t rejected;       // vessels not added because the list is full
+        uint16_t expired;        // vessels timed out
+        uint16_t bumped;         // vessels replaced by a closer one
+        uint32_t update_us;      // time spent in update()
+        uint32_t update_max_us;
+        uint32_t last_log_ms;
+    } _stats;
+    void log_stats(uint32_t now_ms);
 
     AP_HAL::UARTDriver *_uart;
 
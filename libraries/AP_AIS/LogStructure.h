@@ -7,7 +7,8 @@
     LOG_AIS_RAW_MSG,\
     LOG_AIS_MSG1, \
     LOG_AIS_MSG4, \
-    LOG_AIS_MSG5
+    LOG_AIS_MSG5, \
+    LOG_AIS_STATS_MSG
 
 struct PACKED log_AIS_raw {
     LOG_PACKET_HEADER;
@@ -77,6 +78,21 @@ struct PACKED log_AIS_msg5 {
     uint8_t dte;
 };
 
+struct PACKED log_AIS_stats {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint32_t bytes;
+    uint16_t sentences;
+    uint16_t decoded;
+    uint16_t unsupported;
+    uint16_t rejected;
+    uint16_t expired;
+    uint16_t bumped;
+    uint16_t vessels;
+    uint32_t update_us;
+    uint32_t update_max_us;
+};
+
 // @LoggerMessage: AISR
 // @Description: Raw AIS AVDIM messages contents, see: https://gpsd.gitlab.io/gpsd/AIVDM.html#_aivdmaivdo_sentence_layer
 // @Field: TimeUS: Time since system startup
@@ -141,6 +157,20 @@ struct PACKED log_AIS_msg5 {
 // @Field: dst: Destination
 // @Field: dte: DTE
 
+// @LoggerMessage: AISS
+// @Description: AIS decode throughput over the last second
+// @Field: TimeUS: Time since system startup
+// @Field: B: bytes read from the receiver
+// @Field: Sen: complete AIVDM sentences received
+// @Field: Dec: messages decoded into the vessel list
+// @Field: Uns: messages which could not be decoded or stored
+// @Field: Rej: new vessels not stored as the list is full
+// @Field: Exp: vessels removed as they timed out
+// @Field: Bmp: vessels replaced by a closer vessel
+// @Field: N: vessels in the list
+// @Field: T: time spent reading and decoding
+// @Field: TMax: longest time spent in one update
+
 #if AP_AIS_ENABLED
 #define LOG_STRUCTURE_FROM_AIS \
     { LOG_AIS_RAW_MSG, sizeof(log_AIS_raw), \
@@ -150,7 +180,9 @@ struct PACKED log_AIS_msg5 {
     { LOG_AIS_MSG4, sizeof(log_AIS_msg4), \
       "AIS4",  "QBIHBBBBBBLLBBI", "US,rep,mmsi,year,mth,day,h,m,s,fix,lon,lat,epfd,raim,rad", "s--------------", "F00000000000000" }, \
     { LOG_AIS_MSG5, sizeof(log_AIS_msg5), \
-      "AIS5",  "QBIBINZBHHBBBBZB", "US,rep,mmsi,ver,imo,cal,nam,typ,bow,stn,prt,str,fix,dght,dst,dte", "s-------mmmm-m--", "F------------A--" },
+      "AIS5",  "QBIBINZBHHBBBBZB", "US,rep,mmsi,ver,imo,cal,nam,typ,bow,stn,prt,str,fix,dght,dst,dte", "s-------mmmm-m--", "F------------A--" }, \
+    { LOG_AIS_STATS_MSG, sizeof(log_AIS_stats), \
+      "AISS",  "QIHHHHHHHII", "TimeUS,B,Sen,Dec,Uns,Rej,Exp,Bmp,N,T,TMax", "s--------ss", "F--------FF" },
 #else
 #define LOG_STRUCTURE_FROM_AIS
 #endif
@@ -144,9 +144,29 @@ void AP_Avoidance::init(void)
 {
     debug("ADSB initialisation: %d obstacles", _obstacles_max.get());
     if (_obstacles == nullptr) {
-        _obstacles = NEW_NOTHROW AP_Avoidance::Obstacle[_obstacles_max];
-
-        if (_obstacles == nullptr) {
+        const uint8_t n = _obstacles_max;
+        _obstacles = NEW_NOTHROW AP_Avoidance::Obstacle[n];
+        _tracks.lat = NEW_NOTHROW int32_t[n];
+        _tracks.lng = NEW_NOTHROW int32_t[n];
+        _tracks.alt = NEW_NOTHROW int32_t[n];
+        _tracks.vel_n = NEW_NOTHROW float[n];
+        _tracks.vel_e = NEW_NOTHROW float[n];
+        _tracks.vel_d = NEW_NOTHROW float[n];
+        _tracks.timestamp_ms = NEW_NOTHROW uint32_t[n];
+        _approach.fail_xy = NEW_NOTHROW float[n];
+        _approach.warn_xy = NEW_NOTHROW float[n];
+        _approach.fail_z = NEW_NOTHROW float[n];
+        _approach.warn_z = NEW_NOTHROW float[n];
+        _approach.distance_xy = NEW_NOTHROW float[n];
+
+        if (_obstacles == nullptr ||
+            _tracks.lat == nullptr || _tracks.lng == nullptr || _tracks.alt == nullptr ||
+            _tracks.vel_n == nullptr || _tracks.vel_e == nullptr || _tracks.vel_d == nullptr ||
+            _tracks.timestamp_ms == nullptr ||
+            _approach.fail_xy == nullptr || _approach.warn_xy == nullptr ||
+            _approach.fail_z == nullptr || _approach.warn_z == nullptr ||
+            _approach.distance_xy == nullptr) {
+            free_obstacles();
             // dynamic RAM allocation of _obstacles[] failed, disable gracefully
             DEV_PRINTF("Unable to initialize Avoidance obstacle list\n");
             // disable ourselves to avoid repeated allocation attempts
@@ -168,14 +188,33 @@ void AP_Avoidance::init(void)
 void AP_Avoidance::deinit(void)
 {
     if (_obstacles != nullptr) {
-        delete [] _obstacles;
-        _obstacles = nullptr;
+        free_obstacles();
         _obstacles_allocated = 0;
         handle_recovery(RecoveryAction::RTL);
     }
     _obstacle_count = 0;
 }
 
+void AP_Avoidance::free_obstacles(void)
+{
+    delete [] _obstacles;
+    _obstacles = nullptr;
+    delete [] _tracks.lat;
+    delete [] _tracks.lng;
+    delete [] _tracks.alt;
+    delete [] _tracks.vel_n;
+    delete [] _tracks.vel_e;
+    delete [] _tracks.vel_d;
+    delete [] _tracks.timestamp_ms;
+    _tracks = {};
+    delete [] _approach.fail_xy;
+    delete [] _approach.warn_xy;
+    delete [] _approach.fail_z;
+    delete [] _approach.warn_z;
+    delete [] _approach.distance_xy;
+    _approach = {};
+}
+
 bool AP_Avoidance::check_startup()
 {
     if (!_enabled) {
@@ -239,6 +278,14 @@ void AP_Avoidance::add_obstacle(const uint32_t obstacle_timestamp_ms,
     _obstacles[index]._location = loc;
     _obstacles[index]._velocity = vel_ned;
     _obstacles[index].timestamp_ms = obstacle_timestamp_ms;
+
+    _tracks.lat[index] = loc.lat;
+    _tracks.lng[index] = loc.lng;
+    _tracks.alt[index] = loc.alt;
+    _tracks.vel_n[index] = vel_ned.x;
+    _tracks.vel_e[index] = vel_ned.y;
+    _tracks.vel_d[index] = vel_ned.z;
+    _tracks.timestamp_ms[index] = obstacle_timestamp_ms;
 }
 
 void AP_Avoidance::add_obstacle(const uint32_t obstacle_timestamp_ms,
@@ -332,22 +379,86 @@ float closest_approach_z(const Location &my_loc,
     return ret*0.01f;
 }
 
-void AP_Avoidance::update_threat_level(const Location &my_loc,
-                                       const Vector3f &my_vel,
-                                       AP_Avoidance::Obstacle &obstacle)
+/*
+  closest approach of every obstacle, giving the same results as
+  closest_approach_xy() and closest_approach_z(). The longitude scale
+  is taken at our own latitude rather than the midpoint, which makes
+  no practical difference at ADS-B ranges but lets it be calculated
+  once for all obstacles
+ */
+void AP_Avoidance::closest_approach_tracks(const Location &my_loc,
+                                           const Vector3f &my_vel,
+                                           const ObstacleTracks &tracks,
+                                           const uint16_t count,
+                                           const uint32_t now_ms,
+                                           const uint8_t fail_time_horizon,
+                                           const uint8_t warn_time_horizon,
+                                           const ObstacleApproach &approach)
 {
+    const float scale_n = LATLON_TO_M;
+    const float scale_e = LATLON_TO_M * Location::longitude_scale(my_loc.lat);
+
+    for (uint16_t i=0; i<count; i++) {
+        // our position relative to the obstacle, and the obstacle's
+        // velocity relative to us
+        const float pos_n = (my_loc.lat - tracks.lat[i]) * scale_n;
+        const float pos_e = Location::diff_longitude(my_loc.lng, tracks.lng[i]) * scale_e;
+        const float vel_n = tracks.vel_n[i] - my_vel.x;
+        const float vel_e = tracks.vel_e[i] - my_vel.y;
+        const float vel_d = tracks.vel_d[i] - my_vel.z;
+        const float pos_d = tracks.alt[i] - my_loc.alt;
+
+        // horizons are extended by the age of the data in whole seconds
+        const uint32_t age_s = (now_ms - tracks.timestamp_ms[i]) / 1000;
+        const uint8_t horizon[2] { uint8_t(fail_time_horizon + age_s), uint8_t(warn_time_horizon + age_s) };
+        float xy[2];
+        float z[2];
+        for (uint8_t h=0; h<2; h++) {
+            // closest distance between the point and the line segment
+            // from the origin along the relative velocity
+            const float seg_n = vel_n * horizon[h];
+            const float seg_e = vel_e * horizon[h];
+            const float len_sq = sq(seg_n) + sq(seg_e);
+            float t = 1.0f;
+            if (len_sq >= FLT_EPSILON) {
+                t = constrain_float((pos_n * seg_n + pos_e * seg_e) / len_sq, 0.0f, 1.0f);
+            }
+            xy[h] = norm(seg_n * t - pos_n, seg_e * t - pos_e);
+
+            if (pos_d >= 0 && vel_d >= 0) {
+                z[h] = pos_d;
+            } else if (pos_d <= 0 && vel_d <= 0) {
+                z[h] = fabsf(pos_d);
+            } else {
+                z[h] = fabsf(pos_d - vel_d * horizon[h]);
+            }
+            z[h] *= 0.01f;
+        }
+        approach.fail_xy[i] = xy[0];
+        approach.warn_xy[i] = xy[1];
+        approach.fail_z[i] = z[0];
+        approach.warn_z[i] = z[1];
+        approach.distance_xy[i] = norm(pos_n, pos_e);
+    }
+}
 
-    Location &obstacle_loc = obstacle._location;
-    Vector3f &obstacle_vel = obstacle._velocity;
+/*
+  set the threat level of an obstacle from the results of
+  closest_approach_tracks()
+ */
+void AP_Avoidance::update_threat_level(const Vector3f &my_vel, const uint8_t index)
+{
+    AP_Avoidance::Obstacle &obstacle = _obstacles[index];
+    const Vector3f &obstacle_vel = obstacle._velocity;
 
     obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_NONE;
 
     const uint32_t obstacle_age = AP_HAL::millis() - obstacle.timestamp_ms;
-    float closest_xy = closest_approach_xy(my_loc, my_vel, obstacle_loc, obstacle_vel, _fail_time_horizon + obstacle_age/1000);
+    float closest_xy = _approach.fail_xy[index];
     if (closest_xy < _fail_distance_xy) {
         obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_HIGH;
     } else {
-        closest_xy = closest_approach_xy(my_loc, my_vel, obstacle_loc, obstacle_vel, _warn_time_horizon + obstacle_age/1000);
+        closest_xy = _approach.warn_xy[index];
         if (closest_xy < _warn_distance_xy) {
             obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_LOW;
         }
@@ -355,12 +466,12 @@ void AP_Avoidance::update_threat_level(const Location &my_loc,
 
     // check for vertical separation; our threat level is the minimum
     // of vertical and horizontal threat levels
-    float closest_z = closest_approach_z(my_loc, my_vel, obstacle_loc, obstacle_vel, _warn_time_horizon + obstacle_age/1000);
+    float closest_z = _approach.warn_z[index];
     if (obstacle.threat_level != MAV_COLLISION_THREAT_LEVEL_NONE) {
         if (closest_z > _warn_distance_z) {
             obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_NONE;
         } else {
-            closest_z = closest_approach_z(my_loc, my_vel, obstacle_loc, obstacle_vel, _fail_time_horizon + obstacle_age/1000);
+            closest_z = _approach.fail_z[index];
             if (closest_z > _fail_distance_z) {
                 obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_LOW;
             }
@@ -376,8 +487,7 @@ void AP_Avoidance::update_threat_level(const Location &my_loc,
     // level is none - but only *once the GCS has been informed*!
     obstacle.closest_approach_xy = closest_xy;
     obstacle.closest_approach_z = closest_z;
-    float current_distance = my_loc.get_distance(obstacle_loc);
-    obstacle.distance_to_closest_approach = current_distance - closest_xy;
+    obstacle.distance_to_closest_approach = _approach.distance_xy[index] - closest_xy;
     Vector2f net_velocity_ne = Vector2f(my_vel[0] - obstacle_vel[0], my_vel[1] - obstacle_vel[1]);
     obstacle.time_to_closest_approach = 0.0f;
     if (!is_zero(obstacle.distance_to_closest_approach) &&
@@ -477,13 +587,15 @@ void AP_Avoidance::check_for_threats()
     // is most likely our own position and/or velocity have changed
     // determine the current most-serious-threat
     _current_most_serious_threat = -1;
+    closest_approach_tracks(my_loc, my_vel, _tracks, _obstacle_count, AP_HAL::millis(),
+                            _fail_time_horizon, _warn_time_horizon, _approach);
     for (uint8_t i=0; i<_obstacle_count; i++) {
 
         AP_Avoidance::Obstacle &obstacle = _obstacles[i];
         const uint32_t obstacle_age = AP_HAL::millis() - obstacle.timestamp_ms;
         debug("i=%d src_id=%d timestamp=%u age=%d", i, obstacle.src_id, obstacle.timestamp_ms, obstacle_age);
 
-        update_threat_level(my_loc, my_vel, obstacle);
+        update_threat_level(my_vel, i);
         debug("   threat-level=%d", obstacle.threat_level);
 
         // ignore any really old data:
@@ -106,6 +106,40 @@ public:
     // for holding parameters
     static const struct AP_Param::GroupInfo var_info[];
 
+    // obstacle positions and velocities stored by field, so the
+    // closest approach of every obstacle can be found in a single
+    // pass over contiguous arrays
+    struct ObstacleTracks {
+        int32_t *lat;
+        int32_t *lng;
+        int32_t *alt;               // cm, same frame as Obstacle::_location
+        float *vel_n;               // m/s
+        float *vel_e;               // m/s
+        float *vel_d;               // m/s
+        uint32_t *timestamp_ms;
+    };
+
+    // closest approach of each obstacle, from closest_approach_tracks()
+    struct ObstacleApproach {
+        float *fail_xy;             // metres, within the fail time horizon
+        float *warn_xy;             // metres, within the warn time horizon
+        float *fail_z;              // metres, within the fail time horizon
+        float *warn_z;              // metres, within the warn time horizon
+        float *distance_xy;         // current horizontal distance in metres
+    };
+
+    // calculate closest_approach_xy() and closest_approach_z() for
+    // count obstacles over both time horizons, which are extended by
+    // each obstacle's age as update_threat_level() does
+    static void closest_approach_tracks(const Location &my_loc,
+                                        const Vector3f &my_vel,
+                                        const ObstacleTracks &tracks,
+                                        uint16_t count,
+                                        uint32_t now_ms,
+                                        uint8_t fail_time_horizon,
+                                        uint8_t warn_time_horizon,
+                                        const ObstacleApproach &approach);
+
 protected:
 
     // top level avoidance handler.  This calls the vehicle specific handle_avoidance with requested action
@@ -167,13 +201,14 @@ private:
     // free _obstacle_list
     void deinit();
 
+    // free _obstacles and the arrays which go with it
+    void free_obstacles();
+
     // get unique id for adsb
     uint32_t src_id_for_adsb_vehicle(const AP_ADSB::adsb_vehicle_t &vehicle) const;
 
     void check_for_threats();
-    void update_threat_level(const Location &my_loc,
-                             const Vector3f &my_vel,
-                             AP_Avoidance::Obstacle &obstacle);
+    void update_threat_level(const Vector3f &my_vel, uint8_t index);
 
     // calls into the AP_ADSB library to retrieve vehicle data
     void get_adsb_samples();
@@ -184,6 +219,8 @@ private:
 
     // internal variables
     AP_Avoidance::Obstacle *_obstacles;
+    ObstacleTracks _tracks;
+    ObstacleApproach _approach;
     uint8_t _obstacles_allocated;
     uint8_t _obstacle_count;
     int8_t _current_most_serious_threat;
@@ -0,0 +1,98 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Avoidance/AP_Avoidance.h>
+
+#include <random>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if HAL_ADSB_ENABLED
+
+/*
+  closest approach checks for synthetic traffic within 20km, comparing
+  the per-obstacle functions used by update_threat_level() before with
+  the single pass over all obstacles used now
+ */
+
+static const uint16_t max_obstacles = 1000;
+static const uint32_t now_ms = 100000;
+static const uint8_t fail_time = 30;
+static const uint8_t warn_time = 30;
+
+static const Location my_loc(-353632610, 1491652380, 58400, Location::AltFrame::ABSOLUTE);
+static const Vector3f my_vel(12.0f, -5.0f, 1.5f);
+
+static Location loc[max_obstacles];
+static Vector3f vel[max_obstacles];
+static uint32_t timestamp_ms[max_obstacles];
+
+static void make_traffic(void)
+{
+    std::minstd_rand rng(1);
+    auto rand_float = [&rng](float range) {
+        return std::uniform_real_distribution<float>(-range, range)(rng);
+    };
+    for (uint16_t i=0; i<max_obstacles; i++) {
+        loc[i] = my_loc;
+        loc[i].offset(rand_float(20000), rand_float(20000));
+        loc[i].alt += int32_t(rand_float(100000));
+        vel[i] = Vector3f(rand_float(100), rand_float(100), rand_float(10));
+        timestamp_ms[i] = now_ms - uint32_t(fabsf(rand_float(4000)));
+    }
+}
+
+static void BM_AvoidancePerObstacle(benchmark::State &state)
+{
+    make_traffic();
+    const uint16_t count = state.range(0);
+    while (state.KeepRunning()) {
+        for (uint16_t i=0; i<count; i++) {
+            const uint32_t age_s = (now_ms - timestamp_ms[i]) / 1000;
+            float xy = closest_approach_xy(my_loc, my_vel, loc[i], vel[i], fail_time + age_s);
+            float xy_warn = closest_approach_xy(my_loc, my_vel, loc[i], vel[i], warn_time + age_s);
+            float z = closest_approach_z(my_loc, my_vel, loc[i], vel[i], warn_time + age_s);
+            float z_fail = closest_approach_z(my_loc, my_vel, loc[i], vel[i], fail_time + age_s);
+            float distance = my_loc.get_distance(loc[i]);
+            gbenchmark_escape(&xy);
+            gbenchmark_escape(&xy_warn);
+            gbenchmark_escape(&z);
+            gbenchmark_escape(&z_fail);
+            gbenchmark_escape(&distance);
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * count);
+}
+BENCHMARK(BM_AvoidancePerObstacle)->Arg(50)->Arg(200)->Arg(1000);
+
+static void BM_AvoidanceTracks(benchmark::State &state)
+{
+    make_traffic();
+    static int32_t lat[max_obstacles], lng[max_obstacles], alt[max_obstacles];
+    static float vel_n[max_obstacles], vel_e[max_obstacles], vel_d[max_obstacles];
+    static float fail_xy[max_obstacles], warn_xy[max_obstacles];
+    static float fail_z[max_obstacles], warn_z[max_obstacles];
+    static float distance_xy[max_obstacles];
+    for (uint16_t i=0; i<max_obstacles; i++) {
+        lat[i] = loc[i].lat;
+        lng[i] = loc[i].lng;
+        alt[i] = loc[i].alt;
+        vel_n[i] = vel[i].x;
+        vel_e[i] = vel[i].y;
+        vel_d[i] = vel[i].z;
+    }
+    const AP_Avoidance::ObstacleTracks tracks { lat, lng, alt, vel_n, vel_e, vel_d, timestamp_ms };
+    const AP_Avoidance::ObstacleApproach approach { fail_xy, warn_xy, fail_z, warn_z, distance_xy };
+
+    const uint16_t count = state.range(0);
+    while (state.KeepRunning()) {
+        AP_Avoidance::closest_approach_tracks(my_loc, my_vel, tracks, count, now_ms, fail_time, warn_time, approach);
+        gbenchmark_escape(fail_xy);
+        gbenchmark_escape(warn_z);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * count);
+}
+BENCHMARK(BM_AvoidanceTracks)->Arg(50)->Arg(200)->Arg(1000);
+
+#endif  // HAL_ADSB_ENABLED
+
+BENCHMARK_MAIN();
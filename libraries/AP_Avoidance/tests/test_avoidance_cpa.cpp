@@ -0,0 +1,71 @@
+#include <AP_gtest.h>
+
+#include <AP_Avoidance/AP_Avoidance.h>
+
+#include <random>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if HAL_ADSB_ENABLED
+
+static const uint16_t num_obstacles = 500;
+
+/*
+  closest_approach_tracks() must agree with closest_approach_xy() and
+  closest_approach_z() for every obstacle
+ */
+TEST(AP_Avoidance, closest_approach_tracks)
+{
+    static int32_t lat[num_obstacles], lng[num_obstacles], alt[num_obstacles];
+    static float vel_n[num_obstacles], vel_e[num_obstacles], vel_d[num_obstacles];
+    static uint32_t timestamp_ms[num_obstacles];
+    static float fail_xy[num_obstacles], warn_xy[num_obstacles];
+    static float fail_z[num_obstacles], warn_z[num_obstacles];
+    static float distance_xy[num_obstacles];
+    const AP_Avoidance::ObstacleTracks tracks { lat, lng, alt, vel_n, vel_e, vel_d, timestamp_ms };
+    const AP_Avoidance::ObstacleApproach approach { fail_xy, warn_xy, fail_z, warn_z, distance_xy };
+
+    const Location my_loc(-353632610, 1491652380, 58400, Location::AltFrame::ABSOLUTE);
+    const Vector3f my_vel(12.0f, -5.0f, 1.5f);
+    const uint32_t now_ms = 100000;
+    const uint8_t fail_time = 30;
+    const uint8_t warn_time = 20;
+
+    std::minstd_rand rng(1);
+    auto rand_float = [&rng](float range) {
+        return std::uniform_real_distribution<float>(-range, range)(rng);
+    };
+    Location loc[num_obstacles];
+    Vector3f vel[num_obstacles];
+    for (uint16_t i=0; i<num_obstacles; i++) {
+        loc[i] = my_loc;
+        loc[i].offset(rand_float(20000), rand_float(20000));
+        loc[i].alt += int32_t(rand_float(100000));
+        vel[i] = Vector3f(rand_float(100), rand_float(100), rand_float(10));
+        lat[i] = loc[i].lat;
+        lng[i] = loc[i].lng;
+        alt[i] = loc[i].alt;
+        vel_n[i] = vel[i].x;
+        vel_e[i] = vel[i].y;
+        vel_d[i] = vel[i].z;
+        timestamp_ms[i] = now_ms - uint32_t(fabsf(rand_float(4000)));
+    }
+
+    AP_Avoidance::closest_approach_tracks(my_loc, my_vel, tracks, num_obstacles, now_ms, fail_time, warn_time, approach);
+
+    for (uint16_t i=0; i<num_obstacles; i++) {
+        const uint32_t age_s = (now_ms - timestamp_ms[i]) / 1000;
+        const float distance = my_loc.get_distance(loc[i]);
+        // the longitude scale differs slightly from Location's
+        const float tolerance = 0.002f * distance + 0.01f;
+        EXPECT_NEAR(distance_xy[i], distance, tolerance);
+        EXPECT_NEAR(fail_xy[i], closest_approach_xy(my_loc, my_vel, loc[i], vel[i], fail_time + age_s), tolerance);
+        EXPECT_NEAR(warn_xy[i], closest_approach_xy(my_loc, my_vel, loc[i], vel[i], warn_time + age_s), tolerance);
+        EXPECT_FLOAT_EQ(fail_z[i], closest_approach_z(my_loc, my_vel, loc[i], vel[i], fail_time + age_s));
+        EXPECT_FLOAT_EQ(warn_z[i], closest_approach_z(my_loc, my_vel, loc[i], vel[i], warn_time + age_s));
+    }
+}
+
+#endif  // HAL_ADSB_ENABLED
+
+AP_GTEST_MAIN()
@@ -160,6 +160,7 @@ public:
         SKIP_BOARD_VALIDATION = (1<<7),
         DISABLE_ARMING_GPIO = (1<<8),
         IO_SAFETY_PINS_AS_PROFILED = (1<<9),
+        STORAGE_WRITEBACK = (1<<10),
     };
 
     //return true if arming gpio output is disabled
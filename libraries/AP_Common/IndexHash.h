@@ -0,0 +1,171 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  open addressed hash of a 32 bit key to an index into an array owned
+  by the caller, such as a list of vehicles keyed by ICAO address.
+
+  Only the indexes are stored. The key of an entry is read back from
+  the caller's array with the key_of function passed to each method,
+  which takes an index and returns its key. The hash is kept at most
+  half full so probe sequences stay short, and removal shifts entries
+  back rather than leaving tombstones.
+
+  If allocation fails the hash is left unallocated, find() returns
+  false and the caller should search its array instead.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include <AP_Common/AP_Common.h>
+
+class IndexHash {
+public:
+    // marks an empty bucket
+    static constexpr uint16_t NONE = 0xFFFF;
+
+    IndexHash() {}
+    ~IndexHash() { delete[] buckets; }
+
+    /* Do not allow copies */
+    CLASS_NO_COPY(IndexHash);
+
+    // true if the hash could be allocated
+    bool allocated() const { return buckets != nullptr; }
+
+    // true if the hash is allocated and big enough for num_items
+    bool has_space(uint16_t num_items) const {
+        return buckets != nullptr && num_items <= MAX_ITEMS &&
+            num_buckets(num_items) <= mask + 1U;
+    }
+
+    /*
+      allocate an empty hash big enough for num_items, freeing any
+      existing one. Returns false if it could not be allocated
+     */
+    bool allocate(uint16_t num_items) {
+        delete[] buckets;
+        buckets = nullptr;
+        mask = 0;
+        if (num_items > MAX_ITEMS) {
+            return false;
+        }
+        const uint16_t n = num_buckets(num_items);
+        buckets = NEW_NOTHROW uint16_t[n];
+        if (buckets == nullptr) {
+            return false;
+        }
+        memset(buckets, 0xFF, n * sizeof(uint16_t));
+        mask = n - 1;
+        return true;
+    }
+
+    // find the index with the given key
+    template <typename KeyFn>
+    bool find(uint32_t key, uint16_t &index, KeyFn key_of) const {
+        if (buckets == nullptr) {
+            return false;
+        }
+        // the hash is never more than half full, so there is always an
+        // empty bucket to end the search
+        for (uint16_t b = bucket(key); ; b = (b+1) & mask) {
+            const uint16_t i = buckets[b];
+            if (i == NONE) {
+                return false;
+            }
+            if (key_of(i) == key) {
+                index = i;
+                return true;
+            }
+        }
+    }
+
+    // add index, which must not already be in the hash
+    template <typename KeyFn>
+    void add(uint16_t index, KeyFn key_of) {
+        if (buckets == nullptr) {
+            return;
+        }
+        uint16_t b = bucket(key_of(index));
+        while (buckets[b] != NONE) {
+            b = (b+1) & mask;
+        }
+        buckets[b] = index;
+    }
+
+    // remove index, shifting back any entries which probed past it
+    template <typename KeyFn>
+    void remove(uint16_t index, KeyFn key_of) {
+        if (buckets == nullptr) {
+            return;
+        }
+        uint16_t hole = bucket(key_of(index));
+        while (buckets[hole] != index) {
+            if (buckets[hole] == NONE) {
+                // not in the hash
+                return;
+            }
+            hole = (hole+1) & mask;
+        }
+        for (uint16_t b = (hole+1) & mask; buckets[b] != NONE; b = (b+1) & mask) {
+            const uint16_t i = buckets[b];
+            const uint16_t home = bucket(key_of(i));
+            // the entry can fill the hole if its home bucket is not
+            // between the hole and where it is now
+            if (((b - home) & mask) >= ((b - hole) & mask)) {
+                buckets[hole] = i;
+                hole = b;
+            }
+        }
+        buckets[hole] = NONE;
+    }
+
+    // point the entry for index from at index to. This must be called
+    // while key_of(from) still gives its key
+    template <typename KeyFn>
+    void move(uint16_t from, uint16_t to, KeyFn key_of) {
+        if (buckets == nullptr) {
+            return;
+        }
+        for (uint16_t b = bucket(key_of(from)); buckets[b] != NONE; b = (b+1) & mask) {
+            if (buckets[b] == from) {
+                buckets[b] = to;
+                return;
+            }
+        }
+    }
+
+private:
+    uint16_t *buckets = nullptr;
+    uint16_t mask = 0;
+
+    // the most items which keep the hash half full in 16 bit indexes
+    static constexpr uint16_t MAX_ITEMS = 0x4000;
+
+    // at least twice as many buckets as items, as a power of two
+    static uint16_t num_buckets(uint16_t num_items) {
+        uint16_t n = 16;
+        while (n < 2U * num_items) {
+            n *= 2;
+        }
+        return n;
+    }
+
+    uint16_t bucket(uint32_t key) const {
+        return ((key * 2654435761U) >> 16) & mask;
+    }
+};
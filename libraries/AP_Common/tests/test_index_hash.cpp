@@ -0,0 +1,108 @@
+#include <AP_gtest.h>
+#include <AP_HAL/AP_HAL.h>
+
+#include <AP_Common/IndexHash.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// keys indexed as a vehicle list would be, with 0 for a free slot
+static uint32_t keys[200];
+
+struct key_of {
+    uint32_t operator()(uint16_t i) const { return keys[i]; }
+};
+
+// check every used slot is found and a missing key is not
+static void check_all(const IndexHash &hash, uint16_t count)
+{
+    for (uint16_t i = 0; i < count; i++) {
+        uint16_t index = IndexHash::NONE;
+        if (keys[i] == 0) {
+            continue;
+        }
+        EXPECT_TRUE(hash.find(keys[i], index, key_of{}));
+        EXPECT_EQ(index, i);
+    }
+    uint16_t index;
+    EXPECT_FALSE(hash.find(0xDEADBEEF, index, key_of{}));
+}
+
+TEST(IndexHash, add_find)
+{
+    IndexHash hash;
+    uint16_t index;
+    EXPECT_FALSE(hash.allocated());
+    EXPECT_FALSE(hash.find(1, index, key_of{}));
+
+    ASSERT_TRUE(hash.allocate(100));
+    // buckets are a power of two at least twice the items
+    EXPECT_TRUE(hash.has_space(128));
+    EXPECT_FALSE(hash.has_space(129));
+    for (uint16_t i = 0; i < 100; i++) {
+        keys[i] = 1000 + i*7;
+        hash.add(i, key_of{});
+    }
+    check_all(hash, 100);
+}
+
+/*
+  removing from the middle of a probe sequence must leave the rest of
+  it reachable. A full hash has long probe sequences
+ */
+TEST(IndexHash, remove)
+{
+    IndexHash hash;
+    ASSERT_TRUE(hash.allocate(128));
+
+    for (uint8_t pass = 0; pass < 8; pass++) {
+        for (uint16_t i = 0; i < 128; i++) {
+            keys[i] = 1 + i * 1237U + pass * 100000U;
+            hash.add(i, key_of{});
+        }
+        check_all(hash, 128);
+
+        // remove in an order which visits every index once
+        for (uint16_t n = 0, i = pass; n < 128; n++, i = (i + 37) % 128) {
+            hash.remove(i, key_of{});
+            keys[i] = 0;
+            check_all(hash, 128);
+        }
+        // removing something not in the hash changes nothing
+        keys[0] = 99;
+        hash.remove(0, key_of{});
+        keys[0] = 0;
+    }
+}
+
+/*
+  moving an entry as a list does when it fills a gap from its end
+ */
+TEST(IndexHash, move)
+{
+    IndexHash hash;
+    ASSERT_TRUE(hash.allocate(50));
+    uint16_t count = 50;
+    for (uint16_t i = 0; i < count; i++) {
+        keys[i] = 0x1234 + (uint32_t(i) << 16);
+        hash.add(i, key_of{});
+    }
+    while (count > 1) {
+        const uint16_t i = count / 3;
+        hash.remove(i, key_of{});
+        hash.move(count-1, i, key_of{});
+        keys[i] = keys[count-1];
+        keys[count-1] = 0;
+        count--;
+        check_all(hash, count);
+    }
+}
+
+TEST(IndexHash, too_large)
+{
+    IndexHash hash;
+    EXPECT_FALSE(hash.allocate(0x4001));
+    EXPECT_FALSE(hash.allocated());
+    EXPECT_FALSE(hash.has_space(0x4001));
+}
+
+AP_GTEST_MAIN()
@@ -202,6 +202,8 @@ void CompassCalibrator::update()
         return;
     }
 
+    const uint32_t fit_start_us = AP_HAL::micros();
+
     if (_status == Status::RUNNING_STEP_ONE) {
         if (_fit_step >= 10) {
             if (is_equal(_fitness, _initial_fitness) || isnan(_fitness)) {  // if true, means that fitness is diverging instead of converging
@@ -218,6 +220,8 @@ void CompassCalibrator::update()
         }
     } else if (_status == Status::RUNNING_STEP_TWO) {
         if (_fit_step >= 35) {
+            GCS_SEND_TEXT(MAV_SEVERITY_DEBUG, "Mag(%u) fit %.1fms, longest step %.1fms", _compass_idx,
+                            (double)(_fit_time_us * 1.0e-3f), (double)(_fit_step_max_us * 1.0e-3f));
             if (fit_acceptable() && fix_radius() && calculate_orientation()) {
                 set_status(Status::SUCCESS);
             } else {
@@ -231,6 +235,10 @@ void CompassCalibrator::update()
             _fit_step++;
         }
     }
+
+    const uint32_t fit_us = AP_HAL::micros() - fit_start_us;
+    _fit_time_us += fit_us;
+    _fit_step_max_us = MAX(_fit_step_max_us, fit_us);
 }
 
 void CompassCalibrator::pull_sample()
@@ -381,6 +389,8 @@ void CompassCalibrator::reset_state()
 
     memset(_completion_mask, 0, sizeof(_completion_mask));
     initialize_fit();
+    _fit_time_us = 0;
+    _fit_step_max_us = 0;
 }
 
 bool CompassCalibrator::set_status(CompassCalibrator::Status status)
@@ -571,12 +581,7 @@ bool CompassCalibrator::accept_sample(const CompassSample& sample, uint16_t skip
 
 float CompassCalibrator::calc_residual(const Vector3f& sample, const param_t& params) const
 {
-    Matrix3f softiron(
-        params.diag.x    , params.offdiag.x , params.offdiag.y,
-        params.offdiag.x , params.diag.y    , params.offdiag.z,
-        params.offdiag.y , params.offdiag.z , params.diag.z
-    );
-    return params.radius - (softiron*(sample+params.offset)).length();
+    return params.radius - params.apply_softiron(sample+params.offset).length();
 }
 
 // calc the fitness given a set of parameters (offsets, diagonals, off diagonals)
@@ -595,6 +600,24 @@ float CompassCalibrator::calc_mean_squared_residuals(const param_t& params) cons
     return sum;
 }
 
+// calc the fitness of two sets of parameters in one pass over the samples
+void CompassCalibrator::calc_mean_squared_residuals(const param_t& params1, const param_t& params2, float &fitness1, float &fitness2) const
+{
+    if (_sample_buffer == nullptr || _samples_collected == 0) {
+        fitness1 = fitness2 = 1.0e30f;
+        return;
+    }
+    float sum1 = 0.0f;
+    float sum2 = 0.0f;
+    for (uint16_t i=0; i < _samples_collected; i++) {
+        const Vector3f sample = _sample_buffer[i].get();
+        sum1 += sq(calc_residual(sample, params1));
+        sum2 += sq(calc_residual(sample, params2));
+    }
+    fitness1 = sum1 / _samples_collected;
+    fitness2 = sum2 / _samples_collected;
+}
+
 // calculate initial offsets by simply taking the average values of the samples
 void CompassCalibrator::calc_initial_offset()
 {
@@ -606,21 +629,17 @@ void CompassCalibrator::calc_initial_offset()
     _params.offset /= _samples_collected;
 }
 
-void CompassCalibrator::calc_sphere_jacob(const Vector3f& sample, const param_t& params, float* ret) const
+float CompassCalibrator::calc_sphere_jacob(const Vector3f& sample, const param_t& params, float* ret) const
 {
-    const Vector3f &offset = params.offset;
     const Vector3f &diag = params.diag;
     const Vector3f &offdiag = params.offdiag;
-    Matrix3f softiron(
-        diag.x    , offdiag.x , offdiag.y,
-        offdiag.x , diag.y    , offdiag.z,
-        offdiag.y , offdiag.z , diag.z
-    );
 
-    float A =  (diag.x    * (sample.x + offset.x)) + (offdiag.x * (sample.y + offset.y)) + (offdiag.y * (sample.z + offset.z));
-    float B =  (offdiag.x * (sample.x + offset.x)) + (diag.y    * (sample.y + offset.y)) + (offdiag.z * (sample.z + offset.z));
-    float C =  (offdiag.y * (sample.x + offset.x)) + (offdiag.z * (sample.y + offset.y)) + (diag.z    * (sample.z + offset.z));
-    float length = (softiron*(sample+offset)).length();
+    // the corrected sample, its length is used for both the jacobian and the residual
+    const Vector3f corrected = params.apply_softiron(sample + params.offset);
+    const float A = corrected.x;
+    const float B = corrected.y;
+    const float C = corrected.z;
+    const float length = corrected.length();
 
     // 0: partial derivative (radius wrt fitness fn) fn operated on sample
     ret[0] = 1.0f;
@@ -628,6 +647,8 @@ void CompassCalibrator::calc_sphere_jacob(const Vector3f& sample, const param_t&
     ret[1] = -1.0f * (((diag.x    * A) + (offdiag.x * B) + (offdiag.y * C))/length);
     ret[2] = -1.0f * (((offdiag.x * A) + (diag.y    * B) + (offdiag.z * C))/length);
     ret[3] = -1.0f * (((offdiag.y * A) + (offdiag.z * B) + (diag.z    * C))/length);
+
+    return params.radius - length;
 }
 
 // run sphere fit to calculate diagonals and offdiagonals
@@ -655,18 +676,25 @@ void CompassCalibrator::run_sphere_fit()
 
         float sphere_jacob[COMPASS_CAL_NUM_SPHERE_PARAMS];
 
-        calc_sphere_jacob(sample, fit1_params, sphere_jacob);
+        const float residual = calc_sphere_jacob(sample, fit1_params, sphere_jacob);
 
         for (uint8_t i = 0;i < COMPASS_CAL_NUM_SPHERE_PARAMS; i++) {
-            // compute JTJ
-            for (uint8_t j = 0; j < COMPASS_CAL_NUM_SPHERE_PARAMS; j++) {
+            // compute JTJ, only the upper triangle as it is symmetric
+            for (uint8_t j = i; j < COMPASS_CAL_NUM_SPHERE_PARAMS; j++) {
                 JTJ[i*COMPASS_CAL_NUM_SPHERE_PARAMS+j] += sphere_jacob[i] * sphere_jacob[j];
-                JTJ2[i*COMPASS_CAL_NUM_SPHERE_PARAMS+j] += sphere_jacob[i] * sphere_jacob[j];   //a backup JTJ for LM
             }
             // compute JTFI
-            JTFI[i] += sphere_jacob[i] * calc_residual(sample, fit1_params);
+            JTFI[i] += sphere_jacob[i] * residual;
+        }
+    }
+
+    // fill in the lower triangle, and make a backup JTJ for LM
+    for (uint8_t i = 0; i < COMPASS_CAL_NUM_SPHERE_PARAMS; i++) {
+        for (uint8_t j = 0; j < i; j++) {
+            JTJ[i*COMPASS_CAL_NUM_SPHERE_PARAMS+j] = JTJ[j*COMPASS_CAL_NUM_SPHERE_PARAMS+i];
         }
     }
+    memcpy(JTJ2, JTJ, sizeof(JTJ2));
 
     //------------------------Levenberg-Marquardt-part-starts-here---------------------------------//
     // refer: http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm#Choice_of_damping_parameter
@@ -692,8 +720,7 @@ void CompassCalibrator::run_sphere_fit()
     }
 
     // calculate fitness of two possible sets of parameters
-    fit1 = calc_mean_squared_residuals(fit1_params);
-    fit2 = calc_mean_squared_residuals(fit2_params);
+    calc_mean_squared_residuals(fit1_params, fit2_params, fit1, fit2);
 
     // decide which of the two sets of parameters is best and store in fit1_params
     if (fit1 > _fitness && fit2 > _fitness) {
@@ -717,21 +744,18 @@ void CompassCalibrator::run_sphere_fit()
     }
 }
 
-void CompassCalibrator::calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret) const
+float CompassCalibrator::calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret) const
 {
     const Vector3f &offset = params.offset;
     const Vector3f &diag = params.diag;
     const Vector3f &offdiag = params.offdiag;
-    Matrix3f softiron(
-        diag.x    , offdiag.x , offdiag.y,
-        offdiag.x , diag.y    , offdiag.z,
-        offdiag.y , offdiag.z , diag.z
-    );
 
-    float A =  (diag.x    * (sample.x + offset.x)) + (offdiag.x * (sample.y + offset.y)) + (offdiag.y * (sample.z + offset.z));
-    float B =  (offdiag.x * (sample.x + offset.x)) + (diag.y    * (sample.y + offset.y)) + (offdiag.z * (sample.z + offset.z));
-    float C =  (offdiag.y * (sample.x + offset.x)) + (offdiag.z * (sample.y + offset.y)) + (diag.z    * (sample.z + offset.z));
-    float length = (softiron*(sample+offset)).length();
+    // the corrected sample, its length is used for both the jacobian and the residual
+    const Vector3f corrected = params.apply_softiron(sample + offset);
+    const float A = corrected.x;
+    const float B = corrected.y;
+    const float C = corrected.z;
+    const float length = corrected.length();
 
     // 0-2: partial derivative (offset wrt fitness fn) fn operated on sample
     ret[0] = -1.0f * (((diag.x    * A) + (offdiag.x * B) + (offdiag.y * C))/length);
@@ -745,6 +769,8 @@ void CompassCalibrator::calc_ellipsoid_jacob(const Vector3f& sample, const param
     ret[6] = -1.0f * (((sample.y + offset.y) * A) + ((sample.x + offset.x) * B))/length;
     ret[7] = -1.0f * (((sample.z + offset.z) * A) + ((sample.x + offset.x) * C))/length;
     ret[8] = -1.0f * (((sample.z + offset.z) * B) + ((sample.y + offset.y) * C))/length;
+
+    return params.radius - length;
 }
 
 void CompassCalibrator::run_ellipsoid_fit()
@@ -771,18 +797,25 @@ void CompassCalibrator::run_ellipsoid_fit()
 
         float ellipsoid_jacob[COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
 
-        calc_ellipsoid_jacob(sample, fit1_params, ellipsoid_jacob);
+        const float residual = calc_ellipsoid_jacob(sample, fit1_params, ellipsoid_jacob);
 
         for (uint8_t i = 0;i < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; i++) {
-            // compute JTJ
-            for (uint8_t j = 0; j < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; j++) {
+            // compute JTJ, only the upper triangle as it is symmetric
+            for (uint8_t j = i; j < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; j++) {
                 JTJ [i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+j] += ellipsoid_jacob[i] * ellipsoid_jacob[j];
-                JTJ2[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+j] += ellipsoid_jacob[i] * ellipsoid_jacob[j];
             }
             // compute JTFI
-            JTFI[i] += ellipsoid_jacob[i] * calc_residual(sample, fit1_params);
+            JTFI[i] += ellipsoid_jacob[i] * residual;
+        }
+    }
+
+    // fill in the lower triangle, and make a backup JTJ for LM
+    for (uint8_t i = 0; i < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; i++) {
+        for (uint8_t j = 0; j < i; j++) {
+            JTJ[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+j] = JTJ[j*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+i];
         }
     }
+    memcpy(JTJ2, JTJ, sizeof(JTJ2));
 
     //------------------------Levenberg-Marquardt-part-starts-here---------------------------------//
     //refer: http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm#Choice_of_damping_parameter
@@ -808,8 +841,7 @@ void CompassCalibrator::run_ellipsoid_fit()
     }
 
     // calculate fitness of two possible sets of parameters
-    fit1 = calc_mean_squared_residuals(fit1_params);
-    fit2 = calc_mean_squared_residuals(fit2_params);
+    calc_mean_squared_residuals(fit1_params, fit2_params, fit1, fit2);
 
     // decide which of the two sets of parameters is best and store in fit1_params
     if (fit1 > _fitness && fit2 > _fitness) {
@@ -11,6 +11,8 @@
 #define COMPASS_CAL_NUM_SAMPLES             300     // number of samples required before fitting begins
 
 class CompassCalibrator {
+    friend class CompassCalibrator_Test;
+
 public:
     CompassCalibrator();
 
@@ -116,6 +118,13 @@ private:
             return &offset.x;
         }
 
+        // multiply a vector by the soft iron matrix made from the diagonals and off diagonals
+        Vector3f apply_softiron(const Vector3f &v) const {
+            return Vector3f(diag.x * v.x + offdiag.x * v.y + offdiag.y * v.z,
+                            offdiag.x * v.x + diag.y * v.y + offdiag.z * v.z,
+                            offdiag.y * v.x + offdiag.z * v.y + diag.z * v.z);
+        }
+
         float radius;       // magnetic field strength calculated from samples
         Vector3f offset;    // offsets
         Vector3f diag;      // diagonal scaling
@@ -177,16 +186,19 @@ private:
     // calc the fitness of the parameters (offsets, diagonals, off diagonals) vs all the samples collected
     // returns 1.0e30f if the sample buffer is empty
     float calc_mean_squared_residuals(const param_t& params) const;
+    // calc the fitness of two sets of parameters in one pass over the samples
+    void calc_mean_squared_residuals(const param_t& params1, const param_t& params2, float &fitness1, float &fitness2) const;
 
     // calculate initial offsets by simply taking the average values of the samples
     void calc_initial_offset();
 
     // run sphere fit to calculate diagonals and offdiagonals
-    void calc_sphere_jacob(const Vector3f& sample, const param_t& params, float* ret) const;
+    // the jacobian functions return the residual of the sample
+    float calc_sphere_jacob(const Vector3f& sample, const param_t& params, float* ret) const;
     void run_sphere_fit();
 
     // run ellipsoid fit to calculate diagonals and offdiagonals
-    void calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret) const;
+    float calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret) const;
     void run_ellipsoid_fit();
 
     // update the completion mask based on a single sample
@@ -234,6 +246,8 @@ private:
     float _initial_fitness;                 // fitness before latest "fit" was attempted (used to determine if fit was an improvement)
     float _sphere_lambda;                   // sphere fit's lambda
     float _ellipsoid_lambda;                // ellipsoid fit's lambda
+    uint32_t _fit_time_us;                  // time spent fitting during this attempt
+    uint32_t _fit_step_max_us;              // longest time spent on one fit step during this attempt
 
     // variables for orientation checking
     enum Rotation _orientation;             // latest detected orientation
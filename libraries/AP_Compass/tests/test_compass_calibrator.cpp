@@ -0,0 +1,108 @@
+#include <AP_gtest.h>
+
+#include <AP_Compass/CompassCalibrator.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if COMPASS_CAL_ENABLED
+
+class CompassCalibrator_Test
+{
+public:
+    // fill the sample buffer with points spread evenly over the sphere
+    // of the given radius, distorted by soft iron and offset by hard
+    // iron as a compass would see them
+    void load_samples(float radius, const Vector3f &offset, const Matrix3f &softiron)
+    {
+        Matrix3f softiron_inv;
+        ASSERT_TRUE(softiron.inverse(softiron_inv));
+
+        cal.set_status(CompassCalibrator::Status::NOT_STARTED);
+        cal._sample_buffer = (CompassCalibrator::CompassSample*)calloc(COMPASS_CAL_NUM_SAMPLES, sizeof(CompassCalibrator::CompassSample));
+        ASSERT_NE(cal._sample_buffer, nullptr);
+        for (uint16_t i = 0; i < COMPASS_CAL_NUM_SAMPLES; i++) {
+            // golden angle spiral
+            const float z = 1.0f - 2.0f * (i + 0.5f) / COMPASS_CAL_NUM_SAMPLES;
+            const float r = sqrtf(1.0f - sq(z));
+            const float azimuth = i * 2.39996323f;
+            const Vector3f field = Vector3f(r * cosf(azimuth), r * sinf(azimuth), z) * radius;
+            cal._sample_buffer[i].set(softiron_inv * field - offset);
+        }
+        cal._samples_collected = COMPASS_CAL_NUM_SAMPLES;
+    }
+
+    // run the fit steps in the order update() runs them
+    void run_fit()
+    {
+        cal.initialize_fit();
+        const float initial_fitness = cal._fitness;
+        for (uint8_t step = 0; step < 10; step++) {
+            if (step == 0) {
+                cal.calc_initial_offset();
+            }
+            cal.run_sphere_fit();
+        }
+        EXPECT_LT(cal._fitness, initial_fitness);
+
+        cal.initialize_fit();
+        for (uint8_t step = 0; step < 15; step++) {
+            cal.run_sphere_fit();
+        }
+        const float sphere_fitness = cal._fitness;
+        for (uint8_t step = 15; step < 35; step++) {
+            cal.run_ellipsoid_fit();
+        }
+        EXPECT_LT(cal._fitness, sphere_fitness);
+    }
+
+    const CompassCalibrator::param_t &params() const { return cal._params; }
+    float fitness() const { return cal._fitness; }
+
+    void cleanup() { cal.set_status(CompassCalibrator::Status::NOT_STARTED); }
+
+private:
+    CompassCalibrator cal;
+};
+
+/*
+  the sphere and ellipsoid fits must recover the hard and soft iron
+  used to generate the samples
+ */
+TEST(CompassCalibrator, ellipsoid_fit)
+{
+    static CompassCalibrator_Test test;
+
+    const float radius = 450.0f;
+    const Vector3f offset(120.0f, -80.0f, 35.0f);
+    const Matrix3f softiron(1.10f, 0.05f, -0.03f,
+                            0.05f, 0.92f, 0.02f,
+                            -0.03f, 0.02f, 1.04f);
+
+    test.load_samples(radius, offset, softiron);
+    test.run_fit();
+
+    const auto &params = test.params();
+
+    // samples are stored as integers, so the fit can't be exact
+    EXPECT_LT(test.fitness(), 0.01f);
+
+    EXPECT_NEAR(params.offset.x, offset.x, 0.05f);
+    EXPECT_NEAR(params.offset.y, offset.y, 0.05f);
+    EXPECT_NEAR(params.offset.z, offset.z, 0.05f);
+
+    // the radius is fixed by the sphere fit before the ellipsoid fit
+    // runs, so the soft iron comes out scaled to suit it
+    const float scale = params.radius / radius;
+    EXPECT_NEAR(params.diag.x, softiron.a.x * scale, 0.001f);
+    EXPECT_NEAR(params.diag.y, softiron.b.y * scale, 0.001f);
+    EXPECT_NEAR(params.diag.z, softiron.c.z * scale, 0.001f);
+    EXPECT_NEAR(params.offdiag.x, softiron.a.y * scale, 0.001f);
+    EXPECT_NEAR(params.offdiag.y, softiron.a.z * scale, 0.001f);
+    EXPECT_NEAR(params.offdiag.z, softiron.b.z * scale, 0.001f);
+
+    test.cleanup();
+}
+
+#endif  // COMPASS_CAL_ENABLED
+
+AP_GTEST_MAIN()
@@ -43,44 +43,14 @@
 #include "AP_DDS_Service_Table.h"
 #include "AP_DDS_External_Odom.h"
 
+#include <AP_Common/ExpandingString.h>
+#include <AP_Math/crc.h>
+
 #define STRCPY(D,S) strncpy(D, S, ARRAY_SIZE(D))
 
 // Enable DDS at runtime by default
 static constexpr uint8_t ENABLED_BY_DEFAULT = 1;
-#if AP_DDS_TIME_PUB_ENABLED
-static constexpr uint16_t DELAY_TIME_TOPIC_MS = AP_DDS_DELAY_TIME_TOPIC_MS;
-#endif // AP_DDS_TIME_PUB_ENABLED
-#if AP_DDS_BATTERY_STATE_PUB_ENABLED
-static constexpr uint16_t DELAY_BATTERY_STATE_TOPIC_MS = AP_DDS_DELAY_BATTERY_STATE_TOPIC_MS;
-#endif // AP_DDS_BATTERY_STATE_PUB_ENABLED
-#if AP_DDS_IMU_PUB_ENABLED
-static constexpr uint16_t DELAY_IMU_TOPIC_MS = AP_DDS_DELAY_IMU_TOPIC_MS;
-#endif // AP_DDS_IMU_PUB_ENABLED
-#if AP_DDS_LOCAL_POSE_PUB_ENABLED
-static constexpr uint16_t DELAY_LOCAL_POSE_TOPIC_MS = AP_DDS_DELAY_LOCAL_POSE_TOPIC_MS;
-#endif // AP_DDS_LOCAL_POSE_PUB_ENABLED
-#if AP_DDS_LOCAL_VEL_PUB_ENABLED
-static constexpr uint16_t DELAY_LOCAL_VELOCITY_TOPIC_MS = AP_DDS_DELAY_LOCAL_VELOCITY_TOPIC_MS;
-#endif // AP_DDS_LOCAL_VEL_PUB_ENABLED
-#if AP_DDS_AIRSPEED_PUB_ENABLED
-static constexpr uint16_t DELAY_AIRSPEED_TOPIC_MS = AP_DDS_DELAY_AIRSPEED_TOPIC_MS;
-#endif // AP_DDS_AIRSPEED_PUB_ENABLED
-#if AP_DDS_GEOPOSE_PUB_ENABLED
-static constexpr uint16_t DELAY_GEO_POSE_TOPIC_MS = AP_DDS_DELAY_GEO_POSE_TOPIC_MS;
-#endif // AP_DDS_GEOPOSE_PUB_ENABLED
-#if AP_DDS_GOAL_PUB_ENABLED
-static constexpr uint16_t DELAY_GOAL_TOPIC_MS = AP_DDS_DELAY_GOAL_TOPIC_MS ;
-#endif // AP_DDS_GOAL_PUB_ENABLED
-#if AP_DDS_CLOCK_PUB_ENABLED
-static constexpr uint16_t DELAY_CLOCK_TOPIC_MS =AP_DDS_DELAY_CLOCK_TOPIC_MS;
-#endif // AP_DDS_CLOCK_PUB_ENABLED
-#if AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
-static constexpr uint16_t DELAY_GPS_GLOBAL_ORIGIN_TOPIC_MS = AP_DDS_DELAY_GPS_GLOBAL_ORIGIN_TOPIC_MS;
-#endif // AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
 static constexpr uint16_t DELAY_PING_MS = 500;
-#if AP_DDS_STATUS_PUB_ENABLED
-static constexpr uint16_t DELAY_STATUS_TOPIC_MS = AP_DDS_DELAY_STATUS_TOPIC_MS;
-#endif // AP_DDS_STATUS_PUB_ENABLED
 
 // Define the subscriber data members, which are static class scope.
 // If these are created on the stack in the subscriber,
@@ -109,6 +79,10 @@ rcl_interfaces_srv_GetParameters_Response AP_DDS_Client::get_parameters_response
 rcl_interfaces_msg_Parameter AP_DDS_Client::param {};
 #endif
 
+AP_DDS_Client::TopicStats AP_DDS_Client::topic_stats[ARRAY_SIZE(AP_DDS_Client::topics)];
+
+AP_DDS_Client *AP_DDS_Client::_singleton;
+
 const AP_Param::GroupInfo AP_DDS_Client::var_info[] {
 
     // @Param: _ENABLE
@@ -161,10 +135,147 @@ const AP_Param::GroupInfo AP_DDS_Client::var_info[] {
     // @User: Standard
     AP_GROUPINFO("_MAX_RETRY", 6, AP_DDS_Client, ping_max_retry, 10),
 
+    // @Param: _BATCH_MS
+    // @DisplayName: DDS output batching time
+    // @Description: The time in milliseconds to accumulate topic samples before they are sent to the XRCE agent together. Larger values send fewer, larger packets at the cost of latency. Incoming topics and service requests are also processed at this interval. Set to 0 to send on every update.
+    // @Units: ms
+    // @Range: 0 50
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_BATCH_MS", 7, AP_DDS_Client, batch_ms, 0),
+
+    // @Param: _OPTIONS
+    // @DisplayName: DDS options
+    // @Description: DDS options
+    // @Bitmask: 0:Only publish battery state and GPS global origin when changed
+    // @User: Advanced
+    AP_GROUPINFO("_OPTIONS", 8, AP_DDS_Client, options, 0),
+
+#if AP_DDS_TIME_PUB_ENABLED
+    // @Param: _RATE_TIME
+    // @DisplayName: DDS Time rate
+    // @Description: Rate at which the Time topic is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 1000
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_TIME", 9, AP_DDS_Client, pub_rate.time, 1000 / AP_DDS_DELAY_TIME_TOPIC_MS),
+#endif // AP_DDS_TIME_PUB_ENABLED
+
+#if AP_DDS_BATTERY_STATE_PUB_ENABLED
+    // @Param: _RATE_BATT
+    // @DisplayName: DDS battery state rate
+    // @Description: Rate at which the battery state topic is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 1000
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_BATT", 10, AP_DDS_Client, pub_rate.battery_state, 1000 / AP_DDS_DELAY_BATTERY_STATE_TOPIC_MS),
+#endif // AP_DDS_BATTERY_STATE_PUB_ENABLED
+
+#if AP_DDS_IMU_PUB_ENABLED
+    // @Param: _RATE_IMU
+    // @DisplayName: DDS IMU rate
+    // @Description: Rate at which the IMU topic is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 1000
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_IMU", 11, AP_DDS_Client, pub_rate.imu, 1000 / AP_DDS_DELAY_IMU_TOPIC_MS),
+#endif // AP_DDS_IMU_PUB_ENABLED
+
+#if AP_DDS_LOCAL_POSE_PUB_ENABLED
+    // @Param: _RATE_POSE
+    // @DisplayName: DDS local pose rate
+    // @Description: Rate at which the local pose topic is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 1000
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_POSE", 12, AP_DDS_Client, pub_rate.local_pose, 1000 / AP_DDS_DELAY_LOCAL_POSE_TOPIC_MS),
+#endif // AP_DDS_LOCAL_POSE_PUB_ENABLED
+
+#if AP_DDS_LOCAL_VEL_PUB_ENABLED
+    // @Param: _RATE_VEL
+    // @DisplayName: DDS local velocity rate
+    // @Description: Rate at which the local velocity topic is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 1000
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_VEL", 13, AP_DDS_Client, pub_rate.local_velocity, 1000 / AP_DDS_DELAY_LOCAL_VELOCITY_TOPIC_MS),
+#endif // AP_DDS_LOCAL_VEL_PUB_ENABLED
+
+#if AP_DDS_AIRSPEED_PUB_ENABLED
+    // @Param: _RATE_ASPD
+    // @DisplayName: DDS airspeed rate
+    // @Description: Rate at which the airspeed topic is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 1000
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_ASPD", 14, AP_DDS_Client, pub_rate.airspeed, 1000 / AP_DDS_DELAY_AIRSPEED_TOPIC_MS),
+#endif // AP_DDS_AIRSPEED_PUB_ENABLED
+
+#if AP_DDS_GEOPOSE_PUB_ENABLED
+    // @Param: _RATE_GEOPOSE
+    // @DisplayName: DDS GeoPose rate
+    // @Description: Rate at which the GeoPose topic is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 1000
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_GEOPOSE", 15, AP_DDS_Client, pub_rate.geo_pose, 1000 / AP_DDS_DELAY_GEO_POSE_TOPIC_MS),
+#endif // AP_DDS_GEOPOSE_PUB_ENABLED
+
+#if AP_DDS_CLOCK_PUB_ENABLED
+    // @Param: _RATE_CLOCK
+    // @DisplayName: DDS clock rate
+    // @Description: Rate at which the clock topic is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 1000
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_CLOCK", 16, AP_DDS_Client, pub_rate.clock, 1000 / AP_DDS_DELAY_CLOCK_TOPIC_MS),
+#endif // AP_DDS_CLOCK_PUB_ENABLED
+
+#if AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
+    // @Param: _RATE_ORIGIN
+    // @DisplayName: DDS GPS global origin rate
+    // @Description: Rate at which the GPS global origin topic is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 1000
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_ORIGIN", 17, AP_DDS_Client, pub_rate.gps_global_origin, 1000 / AP_DDS_DELAY_GPS_GLOBAL_ORIGIN_TOPIC_MS),
+#endif // AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
+
+#if AP_DDS_GOAL_PUB_ENABLED
+    // @Param: _RATE_GOAL
+    // @DisplayName: DDS goal rate
+    // @Description: Rate at which the goal topic is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 1000
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_GOAL", 18, AP_DDS_Client, pub_rate.goal, 1000 / AP_DDS_DELAY_GOAL_TOPIC_MS),
+#endif // AP_DDS_GOAL_PUB_ENABLED
+
+#if AP_DDS_STATUS_PUB_ENABLED
+    // @Param: _RATE_STATUS
+    // @DisplayName: DDS status check rate
+    // @Description: Rate at which the vehicle status is checked. The status topic is only published when the status changes. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 1000
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_STATUS", 19, AP_DDS_Client, pub_rate.status, 1000 / AP_DDS_DELAY_STATUS_TOPIC_MS),
+#endif // AP_DDS_STATUS_PUB_ENABLED
+
     AP_GROUPEND
 };
 
-#if AP_DDS_STATIC_TF_PUB_ENABLED | AP_DDS_LOCAL_POSE_PUB_ENABLED | AP_DDS_GEOPOSE_PUB_ENABLED | AP_DDS_IMU_PUB_ENABLED
+#if AP_DDS_STATIC_TF_PUB_ENABLED | AP_DDS_GEOPOSE_PUB_ENABLED
 static void initialize(geometry_msgs_msg_Quaternion& q)
 {
     q.x = 0.0;
@@ -172,7 +283,53 @@ static void initialize(geometry_msgs_msg_Quaternion& q)
     q.z = 0.0;
     q.w = 1.0;
 }
-#endif // AP_DDS_STATIC_TF_PUB_ENABLED | AP_DDS_LOCAL_POSE_PUB_ENABLED | AP_DDS_GEOPOSE_PUB_ENABLED | AP_DDS_IMU_PUB_ENABLED
+#endif // AP_DDS_STATIC_TF_PUB_ENABLED | AP_DDS_GEOPOSE_PUB_ENABLED
+
+#if AP_DDS_IMU_PUB_ENABLED || AP_DDS_LOCAL_POSE_PUB_ENABLED
+/*
+  helpers to serialize message fields directly into an output stream,
+  matching the generated serialize_topic() functions
+ */
+
+// header stamped with the UTC time of an INS sample
+static bool serialize_header(ucdrBuffer &ub, const uint32_t sample_us, const char *frame_id)
+{
+    uint64_t utc_usec;
+    if (!AP::rtc().get_utc_usec(utc_usec)) {
+        utc_usec = AP_HAL::micros64();
+    }
+    utc_usec -= AP_HAL::micros() - sample_us;
+    bool success = ucdr_serialize_int32_t(&ub, utc_usec / 1000000ULL);
+    success &= ucdr_serialize_uint32_t(&ub, (utc_usec % 1000000ULL) * 1000UL);
+    success &= ucdr_serialize_string(&ub, frame_id);
+    return success;
+}
+
+static bool serialize_vector3(ucdrBuffer &ub, const Vector3f &v)
+{
+    bool success = ucdr_serialize_double(&ub, v.x);
+    success &= ucdr_serialize_double(&ub, v.y);
+    success &= ucdr_serialize_double(&ub, v.z);
+    return success;
+}
+#endif // AP_DDS_IMU_PUB_ENABLED || AP_DDS_LOCAL_POSE_PUB_ENABLED
+
+#if AP_DDS_LOCAL_POSE_PUB_ENABLED
+// AP quaternion is w, x, y, z, ROS is x, y, z, w
+static bool serialize_quaternion(ucdrBuffer &ub, const Quaternion &q)
+{
+    bool success = ucdr_serialize_double(&ub, q[1]);
+    success &= ucdr_serialize_double(&ub, q[2]);
+    success &= ucdr_serialize_double(&ub, q[3]);
+    success &= ucdr_serialize_double(&ub, q[0]);
+    return success;
+}
+#endif // AP_DDS_LOCAL_POSE_PUB_ENABLED
+
+AP_DDS_Client::AP_DDS_Client()
+{
+    _singleton = this;
+}
 
 AP_DDS_Client::~AP_DDS_Client()
 {
@@ -401,57 +558,6 @@ void AP_DDS_Client::update_topic(sensor_msgs_msg_BatteryState& msg, const uint8_
 }
 #endif // AP_DDS_BATTERY_STATE_PUB_ENABLED
 
-#if AP_DDS_LOCAL_POSE_PUB_ENABLED
-void AP_DDS_Client::update_topic(geometry_msgs_msg_PoseStamped& msg)
-{
-    update_topic(msg.header.stamp);
-    STRCPY(msg.header.frame_id, BASE_LINK_FRAME_ID);
-
-    auto &ahrs = AP::ahrs();
-    WITH_SEMAPHORE(ahrs.get_semaphore());
-
-    // ROS REP 103 uses the ENU convention:
-    // X - East
-    // Y - North
-    // Z - Up
-    // https://www.ros.org/reps/rep-0103.html#axis-orientation
-    // AP_AHRS uses the NED convention
-    // X - North
-    // Y - East
-    // Z - Down
-    // As a consequence, to follow ROS REP 103, it is necessary to switch X and Y,
-    // as well as invert Z
-
-    Vector3f position;
-    if (ahrs.get_relative_position_NED_home(position)) {
-        msg.pose.position.x = position[1];
-        msg.pose.position.y = position[0];
-        msg.pose.position.z = -position[2];
-    }
-
-    // In ROS REP 103, axis orientation uses the following convention:
-    // X - Forward
-    // Y - Left
-    // Z - Up
-    // https://www.ros.org/reps/rep-0103.html#axis-orientation
-    // As a consequence, to follow ROS REP 103, it is necessary to switch X and Y,
-    // as well as invert Z (NED to ENU conversion) as well as a 90 degree rotation in the Z axis
-    // for x to point forward
-    Quaternion orientation;
-    if (ahrs.get_quaternion(orientation)) {
-        Quaternion aux(orientation[0], orientation[2], orientation[1], -orientation[3]); //NED to ENU transformation
-        Quaternion transformation (sqrtF(2) * 0.5,0,0,sqrtF(2) * 0.5); // Z axis 90 degree rotation
-        orientation = aux * transformation;
-        msg.pose.orientation.w = orientation[0];
-        msg.pose.orientation.x = orientation[1];
-        msg.pose.orientation.y = orientation[2];
-        msg.pose.orientation.z = orientation[3];
-    } else {
-        initialize(msg.pose.orientation);
-    }
-}
-#endif // AP_DDS_LOCAL_POSE_PUB_ENABLED
-
 #if AP_DDS_LOCAL_VEL_PUB_ENABLED
 void AP_DDS_Client::update_topic(geometry_msgs_msg_TwistStamped& msg)
 {
@@ -598,46 +704,6 @@ bool AP_DDS_Client::update_topic_goal(geographic_msgs_msg_GeoPointStamped& msg)
 }
 #endif // AP_DDS_GOAL_PUB_ENABLED
 
-#if AP_DDS_IMU_PUB_ENABLED
-void AP_DDS_Client::update_topic(sensor_msgs_msg_Imu& msg)
-{
-    update_topic(msg.header.stamp);
-    STRCPY(msg.header.frame_id, BASE_LINK_NED_FRAME_ID);
-
-    auto &imu = AP::ins();
-    auto &ahrs = AP::ahrs();
-
-    WITH_SEMAPHORE(ahrs.get_semaphore());
-
-    Quaternion orientation;
-    if (ahrs.get_quaternion(orientation)) {
-        msg.orientation.x = orientation[0];
-        msg.orientation.y = orientation[1];
-        msg.orientation.z = orientation[2];
-        msg.orientation.w = orientation[3];
-    } else {
-        initialize(msg.orientation);
-    }
-    msg.orientation_covariance[0] = -1;
-
-    uint8_t accel_index = ahrs.get_primary_accel_index();
-    uint8_t gyro_index = ahrs.get_primary_gyro_index();
-    const Vector3f accel_data = imu.get_accel(accel_index);
-    const Vector3f gyro_data = imu.get_gyro(gyro_index);
-
-    // Populate the message fields
-    msg.linear_acceleration.x = accel_data.x;
-    msg.linear_acceleration.y = accel_data.y;
-    msg.linear_acceleration.z = accel_data.z;
-
-    msg.angular_velocity.x = gyro_data.x;
-    msg.angular_velocity.y = gyro_data.y;
-    msg.angular_velocity.z = gyro_data.z;
-    msg.angular_velocity_covariance[0] = -1;
-    msg.linear_acceleration_covariance[0] = -1;
-}
-#endif // AP_DDS_IMU_PUB_ENABLED
-
 #if AP_DDS_CLOCK_PUB_ENABLED
 void AP_DDS_Client::update_topic(rosgraph_msgs_msg_Clock& msg)
 {
@@ -1458,8 +1524,11 @@ void AP_DDS_Client::write_time_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = builtin_interfaces_msg_Time_size_of_topic(&time_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::TIME_PUB)].dw_id, &ub, topic_size);
+        if (!prepare_topic(to_underlying(TopicIndex::TIME_PUB), ub, topic_size)) {
+            return;
+        }
         const bool success = builtin_interfaces_msg_Time_serialize_topic(&ub, &time_topic);
+        count_topic(to_underlying(TopicIndex::TIME_PUB), success);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
             // AP_HAL::panic("FATAL: XRCE_Client failed to serialize");
@@ -1474,8 +1543,11 @@ void AP_DDS_Client::write_nav_sat_fix_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = sensor_msgs_msg_NavSatFix_size_of_topic(&nav_sat_fix_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::NAV_SAT_FIX_PUB)].dw_id, &ub, topic_size);
+        if (!prepare_topic(to_underlying(TopicIndex::NAV_SAT_FIX_PUB), ub, topic_size)) {
+            return;
+        }
         const bool success = sensor_msgs_msg_NavSatFix_serialize_topic(&ub, &nav_sat_fix_topic);
+        count_topic(to_underlying(TopicIndex::NAV_SAT_FIX_PUB), success);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
             // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
@@ -1491,8 +1563,11 @@ void AP_DDS_Client::write_static_transforms()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = tf2_msgs_msg_TFMessage_size_of_topic(&tx_static_transforms_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::STATIC_TRANSFORMS_PUB)].dw_id, &ub, topic_size);
+        if (!prepare_topic(to_underlying(TopicIndex::STATIC_TRANSFORMS_PUB), ub, topic_size)) {
+            return;
+        }
         const bool success = tf2_msgs_msg_TFMessage_serialize_topic(&ub, &tx_static_transforms_topic);
+        count_topic(to_underlying(TopicIndex::STATIC_TRANSFORMS_PUB), success);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
             // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
@@ -1508,8 +1583,11 @@ void AP_DDS_Client::write_battery_state_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = sensor_msgs_msg_BatteryState_size_of_topic(&battery_state_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::BATTERY_STATE_PUB)].dw_id, &ub, topic_size);
+        if (!prepare_topic(to_underlying(TopicIndex::BATTERY_STATE_PUB), ub, topic_size)) {
+            return;
+        }
         const bool success = sensor_msgs_msg_BatteryState_serialize_topic(&ub, &battery_state_topic);
+        count_topic(to_underlying(TopicIndex::BATTERY_STATE_PUB), success);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
             // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
@@ -1519,19 +1597,57 @@ void AP_DDS_Client::write_battery_state_topic()
 #endif // AP_DDS_BATTERY_STATE_PUB_ENABLED
 
 #if AP_DDS_LOCAL_POSE_PUB_ENABLED
+/*
+  serialize the local pose at the latest INS sample directly into the
+  output stream. The field order must match
+  geometry_msgs_msg_PoseStamped_serialize_topic()
+ */
 void AP_DDS_Client::write_local_pose_topic()
 {
     WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = geometry_msgs_msg_PoseStamped_size_of_topic(&local_pose_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::LOCAL_POSE_PUB)].dw_id, &ub, topic_size);
-        const bool success = geometry_msgs_msg_PoseStamped_serialize_topic(&ub, &local_pose_topic);
-        if (!success) {
-            // TODO sometimes serialization fails on bootup. Determine why.
-            // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
+    if (!connected) {
+        return;
+    }
+    if (local_pose_topic_size == 0) {
+        geometry_msgs_msg_PoseStamped msg {};
+        STRCPY(msg.header.frame_id, BASE_LINK_FRAME_ID);
+        local_pose_topic_size = geometry_msgs_msg_PoseStamped_size_of_topic(&msg, 0);
+    }
+
+    auto &ahrs = AP::ahrs();
+    Quaternion orientation;
+    bool have_orientation;
+    uint32_t sample_us;
+    {
+        WITH_SEMAPHORE(ahrs.get_semaphore());
+        sample_us = AP::ins().get_last_update_usec();
+
+        // ROS REP 103 uses ENU, AP_AHRS uses NED, so swap X and Y and
+        // invert Z. The last position is kept if it is unavailable
+        Vector3f position;
+        if (ahrs.get_relative_position_NED_home(position)) {
+            local_pose_position = Vector3f{position.y, position.x, -position.z};
         }
+
+        // NED to ENU, then a 90 degree rotation about Z so X points forward
+        have_orientation = ahrs.get_quaternion(orientation);
     }
+    if (have_orientation) {
+        Quaternion aux(orientation[0], orientation[2], orientation[1], -orientation[3]);
+        Quaternion transformation (sqrtF(2) * 0.5,0,0,sqrtF(2) * 0.5);
+        orientation = aux * transformation;
+    } else {
+        orientation.initialise();
+    }
+
+    ucdrBuffer ub {};
+    if (!prepare_topic(to_underlying(TopicIndex::LOCAL_POSE_PUB), ub, local_pose_topic_size)) {
+        return;
+    }
+    bool success = serialize_header(ub, sample_us, BASE_LINK_FRAME_ID);
+    success &= serialize_vector3(ub, local_pose_position);
+    success &= serialize_quaternion(ub, orientation);
+    count_topic(to_underlying(TopicIndex::LOCAL_POSE_PUB), success);
 }
 #endif // AP_DDS_LOCAL_POSE_PUB_ENABLED
 
@@ -1542,8 +1658,11 @@ void AP_DDS_Client::write_tx_local_velocity_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = geometry_msgs_msg_TwistStamped_size_of_topic(&tx_local_velocity_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::LOCAL_VELOCITY_PUB)].dw_id, &ub, topic_size);
+        if (!prepare_topic(to_underlying(TopicIndex::LOCAL_VELOCITY_PUB), ub, topic_size)) {
+            return;
+        }
         const bool success = geometry_msgs_msg_TwistStamped_serialize_topic(&ub, &tx_local_velocity_topic);
+        count_topic(to_underlying(TopicIndex::LOCAL_VELOCITY_PUB), success);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
             // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
@@ -1558,8 +1677,11 @@ void AP_DDS_Client::write_tx_local_airspeed_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = geometry_msgs_msg_Vector3Stamped_size_of_topic(&tx_local_airspeed_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::LOCAL_AIRSPEED_PUB)].dw_id, &ub, topic_size);
+        if (!prepare_topic(to_underlying(TopicIndex::LOCAL_AIRSPEED_PUB), ub, topic_size)) {
+            return;
+        }
         const bool success = geometry_msgs_msg_Vector3Stamped_serialize_topic(&ub, &tx_local_airspeed_topic);
+        count_topic(to_underlying(TopicIndex::LOCAL_AIRSPEED_PUB), success);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
             // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
@@ -1568,19 +1690,58 @@ void AP_DDS_Client::write_tx_local_airspeed_topic()
 }
 #endif // AP_DDS_AIRSPEED_PUB_ENABLED
 #if AP_DDS_IMU_PUB_ENABLED
+/*
+  serialize the latest INS sample directly into the output stream. The
+  field order must match sensor_msgs_msg_Imu_serialize_topic()
+ */
 void AP_DDS_Client::write_imu_topic()
 {
     WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = sensor_msgs_msg_Imu_size_of_topic(&imu_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::IMU_PUB)].dw_id, &ub, topic_size);
-        const bool success = sensor_msgs_msg_Imu_serialize_topic(&ub, &imu_topic);
-        if (!success) {
-            // TODO sometimes serialization fails on bootup. Determine why.
-            // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
+    if (!connected) {
+        return;
+    }
+    if (imu_topic_size == 0) {
+        sensor_msgs_msg_Imu msg {};
+        STRCPY(msg.header.frame_id, BASE_LINK_NED_FRAME_ID);
+        imu_topic_size = sensor_msgs_msg_Imu_size_of_topic(&msg, 0);
+    }
+
+    auto &imu = AP::ins();
+    auto &ahrs = AP::ahrs();
+    Quaternion orientation;
+    Vector3f accel_data;
+    Vector3f gyro_data;
+    uint32_t sample_us;
+    {
+        WITH_SEMAPHORE(ahrs.get_semaphore());
+        if (!ahrs.get_quaternion(orientation)) {
+            // identity with w last
+            orientation = Quaternion(0, 0, 0, 1);
         }
+        sample_us = imu.get_last_update_usec();
+        accel_data = imu.get_accel(ahrs.get_primary_accel_index());
+        gyro_data = imu.get_gyro(ahrs.get_primary_gyro_index());
     }
+
+    // covariances are unknown
+    static const double unknown_covariance[9] { -1 };
+
+    ucdrBuffer ub {};
+    if (!prepare_topic(to_underlying(TopicIndex::IMU_PUB), ub, imu_topic_size)) {
+        return;
+    }
+    bool success = serialize_header(ub, sample_us, BASE_LINK_NED_FRAME_ID);
+    // the AHRS quaternion elements fill x, y, z, w in order, as before
+    success &= ucdr_serialize_double(&ub, orientation[0]);
+    success &= ucdr_serialize_double(&ub, orientation[1]);
+    success &= ucdr_serialize_double(&ub, orientation[2]);
+    success &= ucdr_serialize_double(&ub, orientation[3]);
+    success &= ucdr_serialize_array_double(&ub, unknown_covariance, ARRAY_SIZE(unknown_covariance));
+    success &= serialize_vector3(ub, gyro_data);
+    success &= ucdr_serialize_array_double(&ub, unknown_covariance, ARRAY_SIZE(unknown_covariance));
+    success &= serialize_vector3(ub, accel_data);
+    success &= ucdr_serialize_array_double(&ub, unknown_covariance, ARRAY_SIZE(unknown_covariance));
+    count_topic(to_underlying(TopicIndex::IMU_PUB), success);
 }
 #endif // AP_DDS_IMU_PUB_ENABLED
 
@@ -1591,8 +1752,11 @@ void AP_DDS_Client::write_geo_pose_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = geographic_msgs_msg_GeoPoseStamped_size_of_topic(&geo_pose_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::GEOPOSE_PUB)].dw_id, &ub, topic_size);
+        if (!prepare_topic(to_underlying(TopicIndex::GEOPOSE_PUB), ub, topic_size)) {
+            return;
+        }
         const bool success = geographic_msgs_msg_GeoPoseStamped_serialize_topic(&ub, &geo_pose_topic);
+        count_topic(to_underlying(TopicIndex::GEOPOSE_PUB), success);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
             // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
@@ -1608,8 +1772,11 @@ void AP_DDS_Client::write_clock_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = rosgraph_msgs_msg_Clock_size_of_topic(&clock_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::CLOCK_PUB)].dw_id, &ub, topic_size);
+        if (!prepare_topic(to_underlying(TopicIndex::CLOCK_PUB), ub, topic_size)) {
+            return;
+        }
         const bool success = rosgraph_msgs_msg_Clock_serialize_topic(&ub, &clock_topic);
+        count_topic(to_underlying(TopicIndex::CLOCK_PUB), success);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
             // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
@@ -1625,8 +1792,11 @@ void AP_DDS_Client::write_gps_global_origin_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = geographic_msgs_msg_GeoPointStamped_size_of_topic(&gps_global_origin_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::GPS_GLOBAL_ORIGIN_PUB)].dw_id, &ub, topic_size);
+        if (!prepare_topic(to_underlying(TopicIndex::GPS_GLOBAL_ORIGIN_PUB), ub, topic_size)) {
+            return;
+        }
         const bool success = geographic_msgs_msg_GeoPointStamped_serialize_topic(&ub, &gps_global_origin_topic);
+        count_topic(to_underlying(TopicIndex::GPS_GLOBAL_ORIGIN_PUB), success);
         if (!success) {
             // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
         }
@@ -1641,8 +1811,11 @@ void AP_DDS_Client::write_goal_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = geographic_msgs_msg_GeoPointStamped_size_of_topic(&goal_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::GOAL_PUB)].dw_id, &ub, topic_size);
+        if (!prepare_topic(to_underlying(TopicIndex::GOAL_PUB), ub, topic_size)) {
+            return;
+        }
         const bool success = geographic_msgs_msg_GeoPointStamped_serialize_topic(&ub, &goal_topic);
+        count_topic(to_underlying(TopicIndex::GOAL_PUB), success);
         if (!success) {
             // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
         }
@@ -1657,8 +1830,11 @@ void AP_DDS_Client::write_status_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = ardupilot_msgs_msg_Status_size_of_topic(&status_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::STATUS_PUB)].dw_id, &ub, topic_size);
+        if (!prepare_topic(to_underlying(TopicIndex::STATUS_PUB), ub, topic_size)) {
+            return;
+        }
         const bool success = ardupilot_msgs_msg_Status_serialize_topic(&ub, &status_topic);
+        count_topic(to_underlying(TopicIndex::STATUS_PUB), success);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
             // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
@@ -1667,15 +1843,102 @@ void AP_DDS_Client::write_status_topic()
 }
 #endif // AP_DDS_STATUS_PUB_ENABLED
 
+/*
+  reserve space for a topic sample in the reliable output stream. The
+  stream is full if the agent has not yet acknowledged earlier samples
+ */
+bool AP_DDS_Client::prepare_topic(const uint8_t index, ucdrBuffer &ub, const uint32_t topic_size)
+{
+    topic_start_us = AP_HAL::micros();
+    if (uxr_prepare_output_stream(&session, reliable_out, topics[index].dw_id, &ub, topic_size) == UXR_INVALID_REQUEST_ID) {
+        topic_stats[index].dropped++;
+        return false;
+    }
+    return true;
+}
+
+void AP_DDS_Client::count_topic(const uint8_t index, const bool success)
+{
+    topic_stats[index].serialize_us += AP_HAL::micros() - topic_start_us;
+    if (success) {
+        topic_stats[index].sent++;
+    } else {
+        topic_stats[index].dropped++;
+    }
+}
+
+bool AP_DDS_Client::topic_due(uint64_t &last_ms, const AP_Int16 &rate_hz, const uint64_t now_ms)
+{
+    if (rate_hz <= 0) {
+        return false;
+    }
+    if (now_ms - last_ms < uint32_t(1000 / rate_hz)) {
+        return false;
+    }
+    last_ms = now_ms;
+    return true;
+}
+
+#if AP_DDS_IMU_PUB_ENABLED || AP_DDS_LOCAL_POSE_PUB_ENABLED
+/*
+  return true if a new INS sample is due at rate_hz, for topics
+  published at the sample rate and stamped with the sample time
+ */
+bool AP_DDS_Client::sample_due(uint32_t &next_us, const AP_Int16 &rate_hz)
+{
+    if (rate_hz <= 0) {
+        return false;
+    }
+    const uint32_t sample_us = AP::ins().get_last_update_usec();
+    if (int32_t(sample_us - next_us) < 0) {
+        return false;
+    }
+    const uint32_t interval_us = 1000000UL / rate_hz;
+    next_us += interval_us;
+    if (int32_t(sample_us - next_us) >= 0) {
+        // fallen behind, restart the schedule from this sample
+        next_us = sample_us + interval_us;
+    }
+    return true;
+}
+#endif // AP_DDS_IMU_PUB_ENABLED || AP_DDS_LOCAL_POSE_PUB_ENABLED
+
+bool AP_DDS_Client::topic_changed(const uint32_t crc, uint32_t &last_crc, uint64_t &last_pub_ms, const uint64_t now_ms) const
+{
+    if (option_is_set(Option::PUB_ON_CHANGE) &&
+        crc == last_crc &&
+        now_ms - last_pub_ms < AP_DDS_CHANGE_REFRESH_MS) {
+        return false;
+    }
+    last_crc = crc;
+    last_pub_ms = now_ms;
+    return true;
+}
+
+#if AP_DDS_BATTERY_STATE_PUB_ENABLED || AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
+/*
+  checksum of a stamped message ignoring the time stamp, used to
+  detect a change in content
+ */
+template <typename T>
+static uint32_t content_crc(T &msg)
+{
+    const auto stamp = msg.header.stamp;
+    msg.header.stamp = {};
+    const uint32_t crc = crc_crc32(0, (const uint8_t *)&msg, sizeof(msg));
+    msg.header.stamp = stamp;
+    return crc;
+}
+#endif // AP_DDS_BATTERY_STATE_PUB_ENABLED || AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
+
 void AP_DDS_Client::update()
 {
     WITH_SEMAPHORE(csem);
     const auto cur_time_ms = AP_HAL::millis64();
 
 #if AP_DDS_TIME_PUB_ENABLED
-    if (cur_time_ms - last_time_time_ms > DELAY_TIME_TOPIC_MS) {
+    if (topic_due(last_time_time_ms, pub_rate.time, cur_time_ms)) {
         update_topic(time_topic);
-        last_time_time_ms = cur_time_ms;
         write_time_topic();
     }
 #endif // AP_DDS_TIME_PUB_ENABLED
@@ -1687,84 +1950,106 @@ void AP_DDS_Client::update()
     }
 #endif // AP_DDS_NAVSATFIX_PUB_ENABLED
 #if AP_DDS_BATTERY_STATE_PUB_ENABLED
-    if (cur_time_ms - last_battery_state_time_ms > DELAY_BATTERY_STATE_TOPIC_MS) {
+    if (topic_due(last_battery_state_time_ms, pub_rate.battery_state, cur_time_ms)) {
         for (uint8_t battery_instance = 0; battery_instance < AP_BATT_MONITOR_MAX_INSTANCES; battery_instance++) {
             update_topic(battery_state_topic, battery_instance);
-            if (battery_state_topic.present) {
+            if (battery_state_topic.present &&
+                topic_changed(content_crc(battery_state_topic),
+                              last_battery_state_crc[battery_instance],
+                              last_battery_state_pub_ms[battery_instance],
+                              cur_time_ms)) {
                 write_battery_state_topic();
             }
         }
-        last_battery_state_time_ms = cur_time_ms;
     }
 #endif // AP_DDS_BATTERY_STATE_PUB_ENABLED
 #if AP_DDS_LOCAL_POSE_PUB_ENABLED
-    if (cur_time_ms - last_local_pose_time_ms > DELAY_LOCAL_POSE_TOPIC_MS) {
-        update_topic(local_pose_topic);
-        last_local_pose_time_ms = cur_time_ms;
+    if (sample_due(next_local_pose_sample_us, pub_rate.local_pose)) {
         write_local_pose_topic();
     }
 #endif // AP_DDS_LOCAL_POSE_PUB_ENABLED
 #if AP_DDS_LOCAL_VEL_PUB_ENABLED
-    if (cur_time_ms - last_local_velocity_time_ms > DELAY_LOCAL_VELOCITY_TOPIC_MS) {
+    if (topic_due(last_local_velocity_time_ms, pub_rate.local_velocity, cur_time_ms)) {
         update_topic(tx_local_velocity_topic);
-        last_local_velocity_time_ms = cur_time_ms;
         write_tx_local_velocity_topic();
     }
 #endif // AP_DDS_LOCAL_VEL_PUB_ENABLED
 #if AP_DDS_AIRSPEED_PUB_ENABLED
-    if (cur_time_ms - last_airspeed_time_ms > DELAY_AIRSPEED_TOPIC_MS) {
-        last_airspeed_time_ms = cur_time_ms;
+    if (topic_due(last_airspeed_time_ms, pub_rate.airspeed, cur_time_ms)) {
         if (update_topic(tx_local_airspeed_topic)) {
             write_tx_local_airspeed_topic();
         }
     }
 #endif // AP_DDS_AIRSPEED_PUB_ENABLED
 #if AP_DDS_IMU_PUB_ENABLED
-    if (cur_time_ms - last_imu_time_ms > DELAY_IMU_TOPIC_MS) {
-        update_topic(imu_topic);
-        last_imu_time_ms = cur_time_ms;
+    if (sample_due(next_imu_sample_us, pub_rate.imu)) {
         write_imu_topic();
     }
 #endif // AP_DDS_IMU_PUB_ENABLED
 #if AP_DDS_GEOPOSE_PUB_ENABLED
-    if (cur_time_ms - last_geo_pose_time_ms > DELAY_GEO_POSE_TOPIC_MS) {
+    if (topic_due(last_geo_pose_time_ms, pub_rate.geo_pose, cur_time_ms)) {
         update_topic(geo_pose_topic);
-        last_geo_pose_time_ms = cur_time_ms;
         write_geo_pose_topic();
     }
 #endif // AP_DDS_GEOPOSE_PUB_ENABLED
 #if AP_DDS_CLOCK_PUB_ENABLED
-    if (cur_time_ms - last_clock_time_ms > DELAY_CLOCK_TOPIC_MS) {
+    if (topic_due(last_clock_time_ms, pub_rate.clock, cur_time_ms)) {
         update_topic(clock_topic);
-        last_clock_time_ms = cur_time_ms;
         write_clock_topic();
     }
 #endif // AP_DDS_CLOCK_PUB_ENABLED
 #if AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
-    if (cur_time_ms - last_gps_global_origin_time_ms > DELAY_GPS_GLOBAL_ORIGIN_TOPIC_MS) {
+    if (topic_due(last_gps_global_origin_time_ms, pub_rate.gps_global_origin, cur_time_ms)) {
         update_topic(gps_global_origin_topic);
-        last_gps_global_origin_time_ms = cur_time_ms;
-        write_gps_global_origin_topic();
+        if (topic_changed(content_crc(gps_global_origin_topic),
+                          last_gps_global_origin_crc,
+                          last_gps_global_origin_pub_ms,
+                          cur_time_ms)) {
+            write_gps_global_origin_topic();
+        }
     }
 #endif // AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
 #if AP_DDS_GOAL_PUB_ENABLED
-    if (cur_time_ms - last_goal_time_ms > DELAY_GOAL_TOPIC_MS) {
+    if (topic_due(last_goal_time_ms, pub_rate.goal, cur_time_ms)) {
         if (update_topic_goal(goal_topic)) {
             write_goal_topic();
         }
-        last_goal_time_ms = cur_time_ms;
     }
 #endif // AP_DDS_GOAL_PUB_ENABLED
 #if AP_DDS_STATUS_PUB_ENABLED
-    if (cur_time_ms - last_status_check_time_ms > DELAY_STATUS_TOPIC_MS) {
+    if (topic_due(last_status_check_time_ms, pub_rate.status, cur_time_ms)) {
         if (update_topic(status_topic)) {
             write_status_topic();
         }
-        last_status_check_time_ms = cur_time_ms;
     }
 #endif // AP_DDS_STATUS_PUB_ENABLED
 
-    status_ok = uxr_run_session_time(&session, 1);
+    // samples written above accumulate in the output stream until
+    // the session is run, so batch them into fewer transport writes
+    if (cur_time_ms - last_flush_ms >= uint32_t(MAX(batch_ms.get(), 0))) {
+        last_flush_ms = cur_time_ms;
+        status_ok = uxr_run_session_time(&session, 1);
+    }
+}
+
+/*
+  display per topic statistics
+ */
+void AP_DDS_Client::topics_info(ExpandingString &str)
+{
+    WITH_SEMAPHORE(csem);
+    str.printf("DDS connected=%u batch_ms=%d\n", unsigned(connected), int(batch_ms.get()));
+    for (uint8_t i = 0; i < ARRAY_SIZE(topics); i++) {
+        if (topics[i].topic_rw != Topic_rw::DataWriter) {
+            continue;
+        }
+        const auto &stats = topic_stats[i];
+        str.printf("%-36s sent=%lu dropped=%lu us/msg=%.2f\n",
+                   topics[i].topic_name,
+                   (unsigned long)stats.sent,
+                   (unsigned long)stats.dropped,
+                   stats.sent > 0 ? double(stats.serialize_us) / stats.sent : 0.0);
+    }
 }
 
 #if CONFIG_HAL_BOARD == HAL_BOARD_CHIBIOS
@@ -22,6 +22,7 @@
 #endif // AP_DDS_NEEDS_TRANSFORMS
 #if AP_DDS_BATTERY_STATE_PUB_ENABLED
 #include "sensor_msgs/msg/BatteryState.h"
+#include <AP_BattMonitor/AP_BattMonitor.h>
 #endif // AP_DDS_BATTERY_STATE_PUB_ENABLED
 #if AP_DDS_IMU_PUB_ENABLED
 #include "sensor_msgs/msg/Imu.h"
@@ -66,6 +67,7 @@
 #include "fcntl.h"
 
 #include <AP_Param/AP_Param.h>
+#include <AP_Math/AP_Math.h>
 
 #define DDS_MTU             512
 #define DDS_STREAM_HISTORY  8
@@ -113,6 +115,9 @@ private:
     //! @brief Serialize the current gps global origin and publish to the IO stream(s)
     void write_gps_global_origin_topic();
     static void update_topic(geographic_msgs_msg_GeoPointStamped& msg);
+    // content checksum and time of the last published origin
+    uint32_t last_gps_global_origin_crc;
+    uint64_t last_gps_global_origin_pub_ms;
 # endif // AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
 
 #if AP_DDS_GOAL_PUB_ENABLED
@@ -135,12 +140,14 @@ private:
 #endif // AP_DDS_GEOPOSE_PUB_ENABLED
 
 #if AP_DDS_LOCAL_POSE_PUB_ENABLED
-    geometry_msgs_msg_PoseStamped local_pose_topic;
-    // The last ms timestamp AP_DDS wrote a Local Pose message
-    uint64_t last_local_pose_time_ms;
-    //! @brief Serialize the current local_pose and publish to the IO stream(s)
+    // serialized size of a Local Pose message, computed once
+    uint32_t local_pose_topic_size;
+    // INS sample time the next Local Pose message is due
+    uint32_t next_local_pose_sample_us;
+    // last known ENU position
+    Vector3f local_pose_position;
+    //! @brief Serialize the local_pose directly into the IO stream(s)
     void write_local_pose_topic();
-    static void update_topic(geometry_msgs_msg_PoseStamped& msg);
 #endif // AP_DDS_LOCAL_POSE_PUB_ENABLED
 
 #if AP_DDS_LOCAL_VEL_PUB_ENABLED
@@ -168,6 +175,9 @@ private:
     //! @brief Serialize the current nav_sat_fix state and publish it to the IO stream(s)
     void write_battery_state_topic();
     static void update_topic(sensor_msgs_msg_BatteryState& msg, const uint8_t instance);
+    // content checksum and time of the last published state for each battery
+    uint32_t last_battery_state_crc[AP_BATT_MONITOR_MAX_INSTANCES];
+    uint64_t last_battery_state_pub_ms[AP_BATT_MONITOR_MAX_INSTANCES];
 #endif // AP_DDS_BATTERY_STATE_PUB_ENABLED
 
 #if AP_DDS_NAVSATFIX_PUB_ENABLED
@@ -180,11 +190,11 @@ private:
 #endif // AP_DDS_NAVSATFIX_PUB_ENABLED
 
 #if AP_DDS_IMU_PUB_ENABLED
-    sensor_msgs_msg_Imu imu_topic;
-    // The last ms timestamp AP_DDS wrote an IMU message
-    uint64_t last_imu_time_ms;
-    static void update_topic(sensor_msgs_msg_Imu& msg);
-    //! @brief Serialize the current IMU data and publish to the IO stream(s)
+    // serialized size of an IMU message, computed once
+    uint32_t imu_topic_size;
+    // INS sample time the next IMU message is due
+    uint32_t next_imu_sample_us;
+    //! @brief Serialize the latest IMU sample directly into the IO stream(s)
     void write_imu_topic();
 #endif // AP_DDS_IMU_PUB_ENABLED
 
@@ -234,6 +244,84 @@ private:
 #endif // AP_DDS_DYNAMIC_TF_SUB_ENABLED
     HAL_Semaphore csem;
 
+    // publish rates in Hz, 0 disables the topic
+    struct {
+#if AP_DDS_TIME_PUB_ENABLED
+        AP_Int16 time;
+#endif
+#if AP_DDS_BATTERY_STATE_PUB_ENABLED
+        AP_Int16 battery_state;
+#endif
+#if AP_DDS_IMU_PUB_ENABLED
+        AP_Int16 imu;
+#endif
+#if AP_DDS_LOCAL_POSE_PUB_ENABLED
+        AP_Int16 local_pose;
+#endif
+#if AP_DDS_LOCAL_VEL_PUB_ENABLED
+        AP_Int16 local_velocity;
+#endif
+#if AP_DDS_AIRSPEED_PUB_ENABLED
+        AP_Int16 airspeed;
+#endif
+#if AP_DDS_GEOPOSE_PUB_ENABLED
+        AP_Int16 geo_pose;
+#endif
+#if AP_DDS_CLOCK_PUB_ENABLED
+        AP_Int16 clock;
+#endif
+#if AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
+        AP_Int16 gps_global_origin;
+#endif
+#if AP_DDS_GOAL_PUB_ENABLED
+        AP_Int16 goal;
+#endif
+#if AP_DDS_STATUS_PUB_ENABLED
+        AP_Int16 status;
+#endif
+    } pub_rate;
+
+    // time to accumulate samples before flushing the output stream
+    AP_Int8 batch_ms;
+    uint64_t last_flush_ms;
+
+    AP_Int32 options;
+    enum class Option : uint32_t {
+        PUB_ON_CHANGE = (1U<<0),
+    };
+    bool option_is_set(Option option) const {
+        return (uint32_t(options.get()) & uint32_t(option)) != 0;
+    }
+
+    //! @brief Return true and update last_ms if a topic is due at rate_hz
+    static bool topic_due(uint64_t &last_ms, const AP_Int16 &rate_hz, const uint64_t now_ms);
+
+    //! @brief Return true if a new INS sample is due at rate_hz
+    static bool sample_due(uint32_t &next_us, const AP_Int16 &rate_hz);
+
+    //! @brief Return true if a slow topic should be published, taking
+    //         the publish on change option into account
+    bool topic_changed(const uint32_t crc, uint32_t &last_crc, uint64_t &last_pub_ms, const uint64_t now_ms) const;
+
+    // per topic statistics
+    struct TopicStats {
+        uint32_t sent;
+        uint32_t dropped;
+        // total time spent serializing samples
+        uint32_t serialize_us;
+    };
+    static TopicStats topic_stats[];
+    uint32_t topic_start_us;
+
+    //! @brief Reserve space in the output stream for a topic sample
+    //! @return True if the sample can be serialized into ub
+    bool prepare_topic(const uint8_t index, ucdrBuffer &ub, const uint32_t topic_size);
+
+    //! @brief Record the result of serializing a topic sample
+    void count_topic(const uint8_t index, const bool success);
+
+    static AP_DDS_Client *_singleton;
+
 #if AP_DDS_PARAMETER_SERVER_ENABLED
     static rcl_interfaces_srv_SetParameters_Request set_parameter_request;
     static rcl_interfaces_srv_SetParameters_Response set_parameter_response;
@@ -298,8 +386,13 @@ private:
 
 
 public:
+    AP_DDS_Client();
     ~AP_DDS_Client();
 
+    static AP_DDS_Client *get_singleton() {
+        return _singleton;
+    }
+
     bool start(void);
     void main_loop(void);
 
@@ -319,6 +412,9 @@ public:
     //! @brief Update the internally stored DDS messages with latest data
     void update();
 
+    //! @brief Display per topic statistics
+    void topics_info(class ExpandingString &str);
+
     //! @brief GCS message prefix
     static constexpr const char* msg_prefix = "DDS:";
 
@@ -153,6 +153,12 @@
 #define AP_DDS_ARM_CHECK_SERVER_ENABLED 1
 #endif
 
+// with the publish on change option, the longest time a slow topic
+// goes without being republished
+#ifndef AP_DDS_CHANGE_REFRESH_MS
+#define AP_DDS_CHANGE_REFRESH_MS 10000
+#endif
+
 // Whether to include Twist support
 #define AP_DDS_NEEDS_TWIST AP_DDS_VEL_CTRL_ENABLED || AP_DDS_LOCAL_VEL_PUB_ENABLED
 
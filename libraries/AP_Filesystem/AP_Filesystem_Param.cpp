@@ -68,6 +68,15 @@ int AP_Filesystem_Param::open(const char *fname, int flags, bool allow_absolute_
     r.read_size = 0;
     r.file_size = 0;
     r.writebuf = nullptr;
+    r.ext_header = false;
+    r.compact = false;
+    r.delta = false;
+    r.num_changed = 0;
+    r.changed = nullptr;
+    r.num_params = 0;
+    r.generation = AP_Param::get_generation();
+    bool have_since = false;
+    uint32_t since = 0;
     if (!read_only) {
         // setup for upload
         r.writebuf = NEW_NOTHROW ExpandingString();
@@ -80,6 +89,10 @@ int AP_Filesystem_Param::open(const char *fname, int flags, bool allow_absolute_
 
     /*
       allow for URI style arguments param.pck?start=N&count=C
+
+      since=G gives a delta download of the parameters changed since
+      parameter generation G, and compact=1 enables compact value
+      encoding. Both use the extended header
      */
     const char *c = strchr(fname, '?');
     while (c && *c) {
@@ -116,12 +129,54 @@ int AP_Filesystem_Param::open(const char *fname, int flags, bool allow_absolute_
             continue;
         }
 #endif
+#if AP_PARAM_CHANGE_HISTORY_LEN > 0
+        if (strncmp(c, "since=", 6) == 0) {
+            since = strtoul(c+6, nullptr, 10);
+            have_since = true;
+            r.ext_header = true;
+            c += 6;
+            c = strchr(c, '&');
+            continue;
+        }
+#endif
+        if (strncmp(c, "compact=", 8) == 0) {
+            uint32_t v = strtoul(c+8, nullptr, 10);
+            if (v > 1) {
+                goto failed;
+            }
+            r.compact = v == 1;
+            r.ext_header = true;
+            c += 8;
+            c = strchr(c, '&');
+            continue;
+        }
+    }
+
+    if (r.ext_header && !read_only) {
+        // upload only uses the basic header
+        goto failed;
+    }
+    if (have_since) {
+        if (r.start != 0 || r.count != 0) {
+            // delta download is always of the whole parameter set
+            goto failed;
+        }
+        if (!setup_delta(r, since)) {
+            delete [] r.cursors;
+            r.cursors = nullptr;
+            r.open = false;
+            errno = ENOMEM;
+            return -1;
+        }
     }
 
     return idx;
 
 failed:
     delete [] r.cursors;
+    r.cursors = nullptr;
+    delete [] r.changed;
+    r.changed = nullptr;
     r.open = false;
     errno = EINVAL;
     return -1;
@@ -144,9 +199,62 @@ int AP_Filesystem_Param::close(int fd)
     r.cursors = nullptr;
     delete r.writebuf;
     r.writebuf = nullptr;
+    delete [] r.changed;
+    r.changed = nullptr;
     return ret;
 }
 
+/*
+  setup for a delta download of the parameters changed since a
+  generation. If the change history doesn't cover the request then
+  a full download is given, which the client can tell from the
+  flags in the extended header
+ */
+bool AP_Filesystem_Param::setup_delta(struct rfile &r, uint32_t since)
+{
+#if AP_PARAM_CHANGE_HISTORY_LEN > 0
+    r.changed = NEW_NOTHROW const AP_Param *[max_delta_params];
+    if (r.changed == nullptr) {
+        return false;
+    }
+    if (!AP_Param::changed_since(since, r.changed, r.num_changed, max_delta_params)) {
+        // full download needed
+        delete [] r.changed;
+        r.changed = nullptr;
+        r.num_changed = 0;
+        return true;
+    }
+    r.delta = true;
+
+    // count the changed parameters that are currently visible
+    AP_Param::ParamToken token {};
+    for (AP_Param *ap = AP_Param::first(&token, nullptr);
+         ap != nullptr && r.num_params < r.num_changed;
+         ap = AP_Param::next_scalar(&token, nullptr)) {
+        if (param_selected(r, ap)) {
+            r.num_params++;
+        }
+    }
+#endif
+    return true;
+}
+
+/*
+  return true if a parameter is included in the download
+ */
+bool AP_Filesystem_Param::param_selected(const struct rfile &r, const AP_Param *ap) const
+{
+    if (!r.delta) {
+        return true;
+    }
+    for (uint8_t i=0; i<r.num_changed; i++) {
+        if (r.changed[i] == ap) {
+            return true;
+        }
+    }
+    return false;
+}
+
 /*
   packed format:
     file header:
@@ -154,15 +262,29 @@ int AP_Filesystem_Param::close(int fd)
       uint16_t num_params
       uint16_t total_params
 
+    extended file header, when since= or compact= is given:
+      uint16_t magic = 0x671d
+      uint16_t num_params
+      uint16_t total_params
+      uint8_t flags         // bit 0: default values, bit 1: delta, bit 2: compact
+      uint8_t reserved
+      uint32_t generation   // parameter generation of this download
+
     per-parameter:
 
     uint8_t type:4;         // AP_Param type NONE=0, INT8=1, INT16=2, INT32=3, FLOAT=4
     uint8_t flags:4;        // bit 0: includes default value for this param
+                            // bit 1: value is zero, no data
+                            // bit 2: value is an integer held in one byte
     uint8_t common_len:4;   // number of name bytes in common with previous entry, 0..15
     uint8_t name_len:4;     // non-common length of param name -1 (0..15)
     uint8_t name[name_len]; // name
     uint8_t data[];         // value, length given by variable type, data length doubled if default is included
 
+    A delta download only contains the parameters changed since the
+    requested generation. If the flags of the extended header do not
+    have the delta bit set then the download is of all parameters.
+
     Any leading zero bytes after the header should be discarded as pad
     bytes. Pad bytes are used to ensure that a parameter data[] field
     does not cross a read packet boundary
@@ -191,8 +313,11 @@ uint8_t AP_Filesystem_Param::pack_param(const struct rfile &r, struct cursor &c,
         c.idx++;
         ap = AP_Param::next_scalar(&c.token, &ptype, &default_val);
     }
+    while (ap != nullptr && !param_selected(r, ap)) {
+        ap = AP_Param::next_scalar(&c.token, &ptype, &default_val);
+    }
     if (ap == nullptr || (r.count && c.idx >= r.count)) {
-        if (r.count == 0 && c.idx != AP_Param::count_parameters()) {
+        if (r.count == 0 && !r.delta && c.idx != AP_Param::count_parameters()) {
             // the parameter count is incorrect, invalidate so a
             // repeated param download avoids an error
             AP_Param::invalidate_count();
@@ -221,19 +346,40 @@ uint8_t AP_Filesystem_Param::pack_param(const struct rfile &r, struct cursor &c,
     const bool add_default = false;
 #endif
     const uint8_t type_len = AP_Param::type_size(ptype);
-    uint8_t packed_len = type_len + name_len + 2 + (add_default ? type_len : 0);
-    const uint8_t flags = add_default;
+    uint8_t flags = add_default ? uint8_t(ParamFlags::DEFAULT) : 0;
+
+    /*
+      with compact encoding zero values have no data and other small
+      integer values are held in one byte
+     */
+    uint8_t data_len = type_len;
+    int8_t int8_value = 0;
+    if (r.compact && !add_default) {
+        const float v = ap->cast_to_float(ptype);
+        const uint8_t zero[4] {};
+        if (memcmp(ap, zero, type_len) == 0) {
+            flags |= uint8_t(ParamFlags::ZERO);
+            data_len = 0;
+        } else if (ptype != AP_PARAM_INT8 &&
+                   v >= INT8_MIN && v <= INT8_MAX &&
+                   is_equal(v, float(int8_t(v)))) {
+            flags |= uint8_t(ParamFlags::INT8_VALUE);
+            int8_value = int8_t(v);
+            data_len = 1;
+        }
+    }
+    uint8_t packed_len = data_len + name_len + 2 + (add_default ? type_len : 0);
 
     /*
       see if we need to add padding to ensure that a data field never
       crosses a block boundary. This ensures that re-reading a block
       won't get a corrupt value for a parameter
      */
-    if (type_len > 1) {
-        const uint32_t ofs = c.token_ofs + sizeof(struct header) + packed_len;
+    if (data_len > 1) {
+        const uint32_t ofs = c.token_ofs + header_size(r) + packed_len;
         const uint32_t ofs_mod = ofs % r.read_size;
-        if (ofs_mod > 0 && ofs_mod < type_len) {
-            const uint8_t pad = type_len - ofs_mod;
+        if (ofs_mod > 0 && ofs_mod < data_len) {
+            const uint8_t pad = data_len - ofs_mod;
             memset(buf, 0, pad);
             buf += pad;
             packed_len += pad;
@@ -243,7 +389,11 @@ uint8_t AP_Filesystem_Param::pack_param(const struct rfile &r, struct cursor &c,
     buf[0] = uint8_t(ptype) | (flags<<4);
     buf[1] = common_len | ((name_len-1)<<4);
     memcpy(&buf[2], pname, name_len);
-    memcpy(&buf[2+name_len], ap, type_len);
+    if (data_len == 1 && type_len != 1) {
+        buf[2+name_len] = uint8_t(int8_value);
+    } else {
+        memcpy(&buf[2+name_len], ap, data_len);
+    }
 #if AP_PARAM_DEFAULTS_ENABLED
     if (add_default) {
         switch (ptype) {
@@ -357,8 +507,9 @@ int32_t AP_Filesystem_Param::read(int fd, void *buf, uint32_t count)
         }
     }
 
-    if (r.file_ofs < sizeof(struct header)) {
-        struct header hdr;
+    const uint8_t hdr_size = header_size(r);
+    if (r.file_ofs < hdr_size) {
+        struct header_ext hdr {};
         hdr.total_params = AP_Param::count_parameters();
         if (hdr.total_params <= r.start) {
             errno = EINVAL;
@@ -368,10 +519,21 @@ int32_t AP_Filesystem_Param::read(int fd, void *buf, uint32_t count)
         if (r.count > 0 && hdr.num_params > r.count) {
             hdr.num_params = r.count;
         }
-        uint8_t n = MIN(sizeof(hdr) - r.file_ofs, count);
-        if (r.with_defaults) {
+        if (r.delta) {
+            hdr.num_params = r.num_params;
+        }
+        if (r.ext_header) {
+            hdr.magic = pmagic_ext;
+            hdr.flags = (r.with_defaults ? uint8_t(ExtFlags::WITH_DEFAULTS) : 0) |
+                        (r.delta ? uint8_t(ExtFlags::DELTA) : 0) |
+                        (r.compact ? uint8_t(ExtFlags::COMPACT) : 0);
+            hdr.generation = r.generation;
+        } else if (r.with_defaults) {
             hdr.magic = pmagic_with_default;
+        } else {
+            hdr.magic = pmagic;
         }
+        uint8_t n = MIN(hdr_size - r.file_ofs, count);
         const uint8_t *b = (const uint8_t *)&hdr;
         memcpy(buf, &b[r.file_ofs], n);
         count -= n;
@@ -383,7 +545,7 @@ int32_t AP_Filesystem_Param::read(int fd, void *buf, uint32_t count)
         }
     }
 
-    uint32_t data_ofs = r.file_ofs - sizeof(struct header);
+    uint32_t data_ofs = r.file_ofs - hdr_size;
     uint8_t best_i = 0;
     uint32_t best_ofs = r.cursors[0].token_ofs;
     size_t total = 0;
@@ -49,6 +49,10 @@ private:
     // Support both protocol versions
     static constexpr uint16_t pmagic = 0x671b;
     static constexpr uint16_t pmagic_with_default = 0x671c;
+    static constexpr uint16_t pmagic_ext = 0x671d;
+
+    // maximum number of changed parameters in a delta download
+    static constexpr uint8_t max_delta_params = 64;
 
     // header at front of the file
     struct header {
@@ -57,6 +61,28 @@ private:
         uint16_t total_params; // for upload this is total file length
     };
 
+    // extended header, used when since= or compact= is given
+    enum class ExtFlags : uint8_t {
+        WITH_DEFAULTS = (1U<<0),
+        DELTA = (1U<<1),
+        COMPACT = (1U<<2),
+    };
+    struct header_ext {
+        uint16_t magic = pmagic_ext;
+        uint16_t num_params;
+        uint16_t total_params;
+        uint8_t flags;
+        uint8_t reserved;
+        uint32_t generation;
+    };
+
+    // per-parameter flags
+    enum class ParamFlags : uint8_t {
+        DEFAULT = (1U<<0),
+        ZERO = (1U<<1),
+        INT8_VALUE = (1U<<2),
+    };
+
     struct cursor {
         AP_Param::ParamToken token;
         uint32_t token_ofs;
@@ -69,6 +95,13 @@ private:
     struct rfile {
         bool open;
         bool with_defaults;
+        bool ext_header;
+        bool compact;
+        bool delta;
+        uint8_t num_changed;
+        const AP_Param **changed; // for delta download
+        uint16_t num_params;
+        uint32_t generation;
         uint16_t read_size;
         uint16_t start;
         uint16_t count;
@@ -79,6 +112,11 @@ private:
     } file[max_open_file];
 
     bool token_seek(const struct rfile &r, const uint32_t data_ofs, struct cursor &c);
+    bool param_selected(const struct rfile &r, const AP_Param *ap) const;
+    uint8_t header_size(const struct rfile &r) const {
+        return r.ext_header ? sizeof(struct header_ext) : sizeof(struct header);
+    }
+    bool setup_delta(struct rfile &r, uint32_t since);
     uint8_t pack_param(const struct rfile &r, struct cursor &c, uint8_t *buf);
     bool check_file_name(const char *fname);
 
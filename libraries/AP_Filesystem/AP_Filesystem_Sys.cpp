@@ -26,6 +26,18 @@
 #include <AP_CANManager/AP_CANManager.h>
 #include <AP_Scheduler/AP_Scheduler.h>
 #include <AP_Common/ExpandingString.h>
+#include <AP_InertialSensor/AP_InertialSensor.h>
+#include <AP_InertialSensor/AP_InertialSensor_rate_config.h>
+#include <GCS_MAVLink/GCS.h>
+#include <AP_Networking/AP_Networking.h>
+#include <AP_DDS/AP_DDS_Client.h>
+#include <StorageManager/StorageManager.h>
+#include <AP_GPS/AP_GPS.h>
+#include <AP_Vehicle/AP_Vehicle_Type.h>
+#include <AC_WPNav/AC_WPNav_config.h>
+#if AC_WPNAV_PLANNER_ENABLED && APM_BUILD_COPTER_OR_HELI
+#include <AC_WPNav/AC_WPNav_Planner.h>
+#endif
 
 extern const AP_HAL::HAL& hal;
 
@@ -40,6 +52,24 @@ static const SysFileList sysfs_file_list[] = {
     {"memory.txt"},
     {"uarts.txt"},
     {"timers.txt"},
+#if AP_INERTIALSENSOR_FAST_SAMPLE_WINDOW_ENABLED
+    {"rate_latency.txt"},
+#endif
+#if HAL_GCS_ENABLED
+    {"routes.txt"},
+#endif
+#if AP_MAVLINK_BANDWIDTH_BUDGET_ENABLED
+    {"mavlink_rates.txt"},
+#endif
+#if AP_MAVLINK_BATCH_WRITES_ENABLED
+    {"mavlink_writes.txt"},
+#endif
+#if AP_NETWORKING_REGISTER_PORT_ENABLED
+    {"net_ports.txt"},
+#endif
+#if AP_DDS_ENABLED
+    {"dds_topics.txt"},
+#endif
 #if HAL_MAX_CAN_PROTOCOL_DRIVERS
     {"can_log.txt"},
 #endif
@@ -51,6 +81,15 @@ static const SysFileList sysfs_file_list[] = {
     {"persistent.parm"},
 #endif
     {"crash_dump.bin"},
+#if AP_STORAGE_WRITEBACK_ENABLED
+    {"storage.txt"},
+#endif
+#if AP_GPS_ENABLED && AP_GPS_RTCM_MUX_ENABLED
+    {"gps_rtcm.txt"},
+#endif
+#if AC_WPNAV_PLANNER_ENABLED && APM_BUILD_COPTER_OR_HELI
+    {"mission_plan.txt"},
+#endif
     {"storage.bin"},
 #if AP_FILESYSTEM_SYS_FLASH_ENABLED
     {"flash.bin"},
@@ -120,6 +159,39 @@ int AP_Filesystem_Sys::open(const char *fname, int flags, bool allow_absolute_pa
     if (strcmp(fname, "timers.txt") == 0) {
         hal.util->timer_info(*r.str);
     }
+#if AP_INERTIALSENSOR_FAST_SAMPLE_WINDOW_ENABLED
+    if (strcmp(fname, "rate_latency.txt") == 0) {
+        AP::ins().fast_rate_latency_info(*r.str);
+    }
+#endif
+#if HAL_GCS_ENABLED
+    if (strcmp(fname, "routes.txt") == 0) {
+        GCS_MAVLINK::routes_info(*r.str);
+    }
+#endif
+#if AP_MAVLINK_BANDWIDTH_BUDGET_ENABLED
+    if (strcmp(fname, "mavlink_rates.txt") == 0) {
+        GCS_MAVLINK::rates_info(*r.str);
+    }
+#endif
+#if AP_MAVLINK_BATCH_WRITES_ENABLED
+    if (strcmp(fname, "mavlink_writes.txt") == 0) {
+        GCS_MAVLINK::batch_info(*r.str);
+    }
+#endif
+#if AP_NETWORKING_REGISTER_PORT_ENABLED
+    if (strcmp(fname, "net_ports.txt") == 0) {
+        AP::network().ports_info(*r.str);
+    }
+#endif
+#if AP_DDS_ENABLED
+    if (strcmp(fname, "dds_topics.txt") == 0) {
+        AP_DDS_Client *dds = AP_DDS_Client::get_singleton();
+        if (dds != nullptr) {
+            dds->topics_info(*r.str);
+        }
+    }
+#endif
 #if HAL_CANMANAGER_ENABLED
     if (strcmp(fname, "can_log.txt") == 0) {
         AP::can().log_retrieve(*r.str);
@@ -141,6 +213,24 @@ int AP_Filesystem_Sys::open(const char *fname, int flags, bool allow_absolute_pa
     if (strcmp(fname, "persistent.parm") == 0) {
         hal.util->load_persistent_params(*r.str);
     }
+#if AP_STORAGE_WRITEBACK_ENABLED
+    if (strcmp(fname, "storage.txt") == 0) {
+        StorageManager::writeback_info(*r.str);
+    }
+#endif
+#if AP_GPS_ENABLED && AP_GPS_RTCM_MUX_ENABLED
+    if (strcmp(fname, "gps_rtcm.txt") == 0) {
+        AP::gps().rtcm_mux_info(*r.str);
+    }
+#endif
+#if AC_WPNAV_PLANNER_ENABLED && APM_BUILD_COPTER_OR_HELI
+    if (strcmp(fname, "mission_plan.txt") == 0) {
+        AC_WPNav_Planner *planner = AP::wpnav_planner();
+        if (planner != nullptr) {
+            planner->plan_info(*r.str);
+        }
+    }
+#endif
 #if AP_CRASHDUMP_ENABLED
     if (strcmp(fname, "crash_dump.bin") == 0) {
         r.str->set_buffer((char*)hal.util->last_crash_dump_ptr(), hal.util->last_crash_dump_size(), hal.util->last_crash_dump_size());
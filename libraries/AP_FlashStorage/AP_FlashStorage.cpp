@@ -109,6 +109,7 @@ bool AP_FlashStorage::init(void)
     // clear any write error
     write_error = false;
     reserved_space = 0;
+    compact_pending = false;
     
     // if the first sector is full then write out all data so we can erase it
     if (states[first_sector] == SECTOR_STATE_FULL) {
@@ -258,17 +259,82 @@ bool AP_FlashStorage::write(uint16_t offset, uint16_t length)
     return true;
 }
 
+/*
+  do one step of background compaction. After a sector switch the
+  other sector is full and init() would have to replay both and then
+  write and erase before it could return. Instead we re-write the
+  image into the current sector one chunk per call, then erase the
+  full sector once erasing is allowed. That leaves a single sector to
+  replay on boot, and a free sector so the next switch is just a
+  header write rather than a full copy and erase
+ */
+bool AP_FlashStorage::compact(void)
+{
+    if (!compact_pending || write_error) {
+        return false;
+    }
+
+    while (compact_offset < storage_size) {
+        // local variable needed to overcome problem with MIN() macro and -O0
+        const uint8_t max_write_local = max_write;
+        const uint16_t ofs = compact_offset;
+        const uint8_t n = MIN(max_write_local, storage_size-ofs);
+        // advance before the write, as a write which fills the
+        // sector can switch sectors and restart compaction
+        compact_offset += n;
+        if (all_zero(ofs, n)) {
+            continue;
+        }
+        if (!write(ofs, n)) {
+            if (compact_offset == ofs + n) {
+                // try this chunk again on the next call
+                compact_offset = ofs;
+            }
+            return false;
+        }
+        return true;
+    }
+
+    // the current sector now holds the whole image
+    if (!flash_erase_ok()) {
+        return true;
+    }
+    debug("compact: erasing sector %u\n", current_sector ^ 1);
+    if (!erase_sector(current_sector ^ 1, true)) {
+        return false;
+    }
+    compact_pending = false;
+    reserved_space = 0;
+    return false;
+}
+
 /*
   load all data from a flash sector into mem_buffer
  */
 bool AP_FlashStorage::load_sector(uint8_t sector)
 {
+    // the sector is read in chunks which cover a number of blocks,
+    // rather than with separate reads for each header and block
+    uint8_t buf[256];
+    static_assert(sizeof(buf) >= max_block_read, "load buffer too small");
+    uint32_t buf_ofs = 0;
+    uint16_t buf_len = 0;
+    auto buffer_from = [&](uint32_t from, uint16_t len) -> bool {
+        if (from >= buf_ofs && from + len <= buf_ofs + buf_len) {
+            return true;
+        }
+        buf_ofs = from;
+        buf_len = MIN(uint32_t(sizeof(buf)), flash_sector_size - from);
+        return flash_read(sector, buf_ofs, buf, buf_len);
+    };
+
     uint32_t ofs = sizeof(sector_header);
     while (ofs < flash_sector_size - sizeof(struct block_header)) {
-        struct block_header header;
-        if (!flash_read(sector, ofs, (uint8_t *)&header, sizeof(header))) {
+        if (!buffer_from(ofs, sizeof(struct block_header))) {
             return false;
         }
+        struct block_header header;
+        memcpy(&header, &buf[ofs - buf_ofs], sizeof(header));
         enum BlockState state = (enum BlockState)header.state;
 
         switch (state) {
@@ -299,7 +365,13 @@ bool AP_FlashStorage::load_sector(uint8_t sector)
                 // the data is invalid (out of range)
                 return false;
             }
-            if (!flash_read(sector, ofs+sizeof(header), &mem_buffer[block_ofs], block_nbytes)) {
+            if (!buffer_from(ofs, sizeof(header) + block_nbytes)) {
+                return false;
+            }
+            if (ofs + sizeof(header) + block_nbytes <= buf_ofs + buf_len) {
+                memcpy(&mem_buffer[block_ofs], &buf[ofs + sizeof(header) - buf_ofs], block_nbytes);
+            } else if (!flash_read(sector, ofs+sizeof(header), &mem_buffer[block_ofs], block_nbytes)) {
+                // block runs off the end of the sector
                 return false;
             }
             //debug("read at %u for %u\n", block_ofs, block_nbytes);
@@ -344,6 +416,7 @@ bool AP_FlashStorage::erase_sector(uint8_t sector, bool mark_available)
 bool AP_FlashStorage::erase_all(void)
 {
     write_error = false;
+    compact_pending = false;
 
     current_sector = 0;
     write_offset = sizeof(struct sector_header);
@@ -443,6 +516,10 @@ bool AP_FlashStorage::switch_sectors(void)
     reserved_space = reserve_size;
     
     write_offset = sizeof(header);
+
+    // the other sector can be freed by compacting into this one
+    compact_pending = true;
+    compact_offset = 0;
     return true;    
 }
 
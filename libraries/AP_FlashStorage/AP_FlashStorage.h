@@ -19,8 +19,13 @@
   backend for any HAL. The basic methodology is to use a log based
   storage system over two flash sectors. Key design elements:
 
-  - erase of sectors only called on init, as erase will lock the flash
-    and prevent code execution
+  - erase of sectors only called on init, or when the caller says
+    erasing is OK, as erase will lock the flash and prevent code
+    execution
+
+  - after a sector switch the caller can compact in the background,
+    re-writing the image into the new sector a chunk at a time and
+    then erasing the old one, so init() normally replays one sector
 
   - write using log based system
 
@@ -130,6 +135,10 @@ public:
     // write some data to storage from mem_buffer
     bool write(uint16_t offset, uint16_t length) WARN_IF_UNUSED;
 
+    // do one step of background compaction, returning true if there
+    // is more to do. Should be called when there is nothing to write
+    bool compact(void);
+
     // fixed storage size
     static const uint16_t storage_size = HAL_STORAGE_SIZE;
     
@@ -146,6 +155,11 @@ private:
     uint32_t reserved_space;
     bool write_error;
 
+    // the other sector is full and the image is being re-written
+    // into the current sector from compact_offset
+    bool compact_pending;
+    uint16_t compact_offset;
+
     // 24 bit signature
 #if AP_FLASHSTORAGE_TYPE == AP_FLASHSTORAGE_TYPE_F4
     static const uint32_t signature = 0x51685B;
@@ -214,6 +228,9 @@ private:
         uint16_t num_blocks_minus_one:3;
     };
 
+    // largest block, including header, that load_sector() can meet
+    static const uint16_t max_block_read = sizeof(block_header) + 8*block_size;
+
     // amount of space needed to write full storage
     static const uint32_t reserve_size = (storage_size / max_write) * (sizeof(block_header) + max_write) + max_write;
         
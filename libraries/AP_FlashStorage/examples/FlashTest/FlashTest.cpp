@@ -40,7 +40,18 @@ private:
     // write to storage and mem_mirror
     void write(uint16_t offset, const uint8_t *data, uint16_t length);
 
+    // do a random write of up to 31 bytes
+    void random_write(void);
+
+    // time init() against the number of writes since erase
+    void boot_benchmark(bool compact);
+
     bool erase_ok;
+
+    // flash access counts for the benchmark
+    uint32_t read_count;
+    uint32_t read_bytes;
+    uint32_t erase_count;
 };
 
 bool FlashTest::flash_write(uint8_t sector, uint32_t offset, const uint8_t *data, uint16_t length)
@@ -99,6 +110,8 @@ bool FlashTest::flash_read(uint8_t sector, uint32_t offset, uint8_t *data, uint1
                       (unsigned)length);
     }
     memcpy(data, &flash[sector][offset], length);
+    read_count++;
+    read_bytes += length;
     return true;
 }
 
@@ -108,6 +121,7 @@ bool FlashTest::flash_erase(uint8_t sector)
         AP_HAL::panic("FATAL: erase sector %u", (unsigned)sector);
     }
     memset(&flash[sector][0], 0xFF, flash_sector_size);
+    erase_count++;
     return true;
 }
 
@@ -127,6 +141,68 @@ void FlashTest::write(uint16_t offset, const uint8_t *data, uint16_t length)
     }
 }
 
+void FlashTest::random_write(void)
+{
+    uint16_t ofs = get_random16() % sizeof(mem_buffer);
+    uint16_t length = get_random16() & 0x1F;
+    length = MIN(length, sizeof(mem_buffer) - ofs);
+    uint8_t data[length];
+    for (uint8_t j=0; j<length; j++) {
+        data[j] = get_random16() & 0xFF;
+    }
+    write(ofs, data, length);
+}
+
+/*
+  time init() after increasing numbers of writes from an erased
+  flash. Erasing is allowed on one write in 1000. With compact set
+  the background compaction is run after every write, as the HAL does
+  when it has nothing to write
+ */
+void FlashTest::boot_benchmark(bool compact)
+{
+    const uint32_t write_counts[] { 100, 1000, 10000, 100000, 1000000 };
+
+    for (const uint32_t count : write_counts) {
+        flash_erase(0);
+        flash_erase(1);
+        memset(mem_buffer, 0, sizeof(mem_buffer));
+        memset(mem_mirror, 0, sizeof(mem_mirror));
+        if (!storage.init()) {
+            AP_HAL::panic("Failed benchmark init()");
+        }
+
+        for (uint32_t i=0; i<count; i++) {
+            erase_ok = (i % 1000 == 0);
+            random_write();
+            if (compact) {
+                storage.compact();
+            }
+        }
+        erase_ok = true;
+
+        memset(mem_buffer, 0, sizeof(mem_buffer));
+        read_count = 0;
+        read_bytes = 0;
+        erase_count = 0;
+        const uint32_t start_us = AP_HAL::micros();
+        if (!storage.init()) {
+            AP_HAL::panic("Failed benchmark re-init()");
+        }
+        const uint32_t init_us = AP_HAL::micros() - start_us;
+        if (memcmp(mem_buffer, mem_mirror, sizeof(mem_buffer)) != 0) {
+            AP_HAL::panic("FATAL: benchmark data mis-match after %u writes", unsigned(count));
+        }
+        hal.console->printf("compact=%u writes=%7u init=%6uus reads=%6u read_bytes=%7u erases=%u\n",
+                            unsigned(compact),
+                            unsigned(count),
+                            unsigned(init_us),
+                            unsigned(read_count),
+                            unsigned(read_bytes),
+                            unsigned(erase_count));
+    }
+}
+
 /*
  * test flash storage
  */
@@ -148,16 +224,8 @@ void FlashTest::loop(void)
 
     // fill with 10k random writes
     for (uint32_t i=0; i<5000000; i++) {
-        uint16_t ofs = get_random16() % sizeof(mem_buffer);
-        uint16_t length = get_random16() & 0x1F;
-        length = MIN(length, sizeof(mem_buffer) - ofs);
-        uint8_t data[length];
-        for (uint8_t j=0; j<length; j++) {
-            data[j] = get_random16() & 0xFF;
-        }
-
         erase_ok = (i % 1000 == 0);
-        write(ofs, data, length);
+        random_write();
 
         if (erase_ok) {
             if (memcmp(mem_buffer, mem_mirror, sizeof(mem_buffer)) != 0) {
@@ -185,6 +253,11 @@ void FlashTest::loop(void)
     if (memcmp(mem_buffer, mem_mirror, sizeof(mem_buffer)) != 0) {
         AP_HAL::panic("FATAL: data mis-match");
     }
+
+    printf("boot benchmark\n");
+    boot_benchmark(false);
+    boot_benchmark(true);
+
     while (true) {
         hal.console->printf("TEST PASSED");
         hal.scheduler->delay(20000);
@@ -239,7 +239,7 @@ const AP_Param::GroupInfo AP_GPS::var_info[] = {
     // @Param: _DRV_OPTIONS
     // @DisplayName: driver options
     // @Description: Additional backend specific options
-    // @Bitmask: 0:Use UART2 for moving baseline on ublox,1:Use base station for GPS yaw on SBF,2:Use baudrate 115200,3:Use dedicated CAN port b/w GPSes for moving baseline,4:Use ellipsoid height instead of AMSL, 5:Override GPS satellite health of L5 band from L1 health, 6:Enable RTCM full parse even for a single channel, 7:Disable automatic full RTCM parsing when RTCM seen on more than one channel
+    // @Bitmask: 0:Use UART2 for moving baseline on ublox,1:Use base station for GPS yaw on SBF,2:Use baudrate 115200,3:Use dedicated CAN port b/w GPSes for moving baseline,4:Use ellipsoid height instead of AMSL, 5:Override GPS satellite health of L5 band from L1 health, 6:Enable RTCM full parse even for a single channel, 7:Disable automatic full RTCM parsing when RTCM seen on more than one channel, 8:Deduplicate filter and pace injected RTCM per GPS
     // @User: Advanced
     AP_GROUPINFO("_DRV_OPTIONS", 22, AP_GPS, _driver_options, 0),
 
@@ -748,72 +748,81 @@ AP_GPS_Backend *AP_GPS::_detect_instance(const uint8_t instance)
         return nullptr;
     }
 
+    // read in blocks to avoid taking the port lock for every byte
+    uint8_t buf[64];
     uint16_t bytecount = MIN(8192U, port->available());
 
-    while (bytecount-- > 0) {
-        const uint8_t data = port->read();
-        (void)data;  // if all backends are compiled out then "data" is unused
+    while (bytecount > 0) {
+        const ssize_t nread = port->read(buf, MIN(bytecount, sizeof(buf)));
+        if (nread <= 0) {
+            break;
+        }
+        bytecount -= nread;
+        for (ssize_t i = 0; i < nread; i++) {
+            const uint8_t data = buf[i];
+            (void)data;  // if all backends are compiled out then "data" is unused
 
 #if AP_GPS_UBLOX_ENABLED
-        if ((type == GPS_TYPE_AUTO ||
-             type == GPS_TYPE_UBLOX) &&
-            ((!_auto_config && _baudrates[dstate->current_baud] >= 38400) ||
-             (_baudrates[dstate->current_baud] >= 115200 && option_set(DriverOptions::UBX_Use115200)) ||
-             _baudrates[dstate->current_baud] == 230400) &&
-            AP_GPS_UBLOX::_detect(dstate->ublox_detect_state, data)) {
-            return NEW_NOTHROW AP_GPS_UBLOX(*this, params[instance], state[instance], port, GPS_ROLE_NORMAL);
-        }
+            if ((type == GPS_TYPE_AUTO ||
+                 type == GPS_TYPE_UBLOX) &&
+                ((!_auto_config && _baudrates[dstate->current_baud] >= 38400) ||
+                 (_baudrates[dstate->current_baud] >= 115200 && option_set(DriverOptions::UBX_Use115200)) ||
+                 _baudrates[dstate->current_baud] == 230400) &&
+                AP_GPS_UBLOX::_detect(dstate->ublox_detect_state, data)) {
+                return NEW_NOTHROW AP_GPS_UBLOX(*this, params[instance], state[instance], port, GPS_ROLE_NORMAL);
+            }
 
-        const uint32_t ublox_mb_required_baud = option_set(DriverOptions::UBX_MBUseUart2)?230400:460800;
-        if ((type == GPS_TYPE_UBLOX_RTK_BASE ||
-             type == GPS_TYPE_UBLOX_RTK_ROVER) &&
-            _baudrates[dstate->current_baud] == ublox_mb_required_baud &&
-            AP_GPS_UBLOX::_detect(dstate->ublox_detect_state, data)) {
-            GPS_Role role;
-            if (type == GPS_TYPE_UBLOX_RTK_BASE) {
-                role = GPS_ROLE_MB_BASE;
-            } else {
-                role = GPS_ROLE_MB_ROVER;
+            const uint32_t ublox_mb_required_baud = option_set(DriverOptions::UBX_MBUseUart2)?230400:460800;
+            if ((type == GPS_TYPE_UBLOX_RTK_BASE ||
+                 type == GPS_TYPE_UBLOX_RTK_ROVER) &&
+                _baudrates[dstate->current_baud] == ublox_mb_required_baud &&
+                AP_GPS_UBLOX::_detect(dstate->ublox_detect_state, data)) {
+                GPS_Role role;
+                if (type == GPS_TYPE_UBLOX_RTK_BASE) {
+                    role = GPS_ROLE_MB_BASE;
+                } else {
+                    role = GPS_ROLE_MB_ROVER;
+                }
+                return NEW_NOTHROW AP_GPS_UBLOX(*this, params[instance], state[instance], port, role);
             }
-            return NEW_NOTHROW AP_GPS_UBLOX(*this, params[instance], state[instance], port, role);
-        }
 #endif  // AP_GPS_UBLOX_ENABLED
 #if AP_GPS_SBP2_ENABLED
-        if ((type == GPS_TYPE_AUTO || type == GPS_TYPE_SBP) &&
-                 AP_GPS_SBP2::_detect(dstate->sbp2_detect_state, data)) {
-            return NEW_NOTHROW AP_GPS_SBP2(*this, params[instance], state[instance], port);
-        }
+            if ((type == GPS_TYPE_AUTO || type == GPS_TYPE_SBP) &&
+                     AP_GPS_SBP2::_detect(dstate->sbp2_detect_state, data)) {
+                return NEW_NOTHROW AP_GPS_SBP2(*this, params[instance], state[instance], port);
+            }
 #endif //AP_GPS_SBP2_ENABLED
 #if AP_GPS_SBP_ENABLED
-        if ((type == GPS_TYPE_AUTO || type == GPS_TYPE_SBP) &&
-                 AP_GPS_SBP::_detect(dstate->sbp_detect_state, data)) {
-            return NEW_NOTHROW AP_GPS_SBP(*this, params[instance], state[instance], port);
-        }
+            if ((type == GPS_TYPE_AUTO || type == GPS_TYPE_SBP) &&
+                     AP_GPS_SBP::_detect(dstate->sbp_detect_state, data)) {
+                return NEW_NOTHROW AP_GPS_SBP(*this, params[instance], state[instance], port);
+            }
 #endif //AP_GPS_SBP_ENABLED
 #if AP_GPS_SIRF_ENABLED
-        if ((type == GPS_TYPE_AUTO || type == GPS_TYPE_SIRF) &&
-                 AP_GPS_SIRF::_detect(dstate->sirf_detect_state, data)) {
-            return NEW_NOTHROW AP_GPS_SIRF(*this, params[instance], state[instance], port);
-        }
+            if ((type == GPS_TYPE_AUTO || type == GPS_TYPE_SIRF) &&
+                     AP_GPS_SIRF::_detect(dstate->sirf_detect_state, data)) {
+                return NEW_NOTHROW AP_GPS_SIRF(*this, params[instance], state[instance], port);
+            }
 #endif
 #if AP_GPS_ERB_ENABLED
-        if ((type == GPS_TYPE_AUTO || type == GPS_TYPE_ERB) &&
-                 AP_GPS_ERB::_detect(dstate->erb_detect_state, data)) {
-            return NEW_NOTHROW AP_GPS_ERB(*this, params[instance], state[instance], port);
-        }
+            if ((type == GPS_TYPE_AUTO || type == GPS_TYPE_ERB) &&
+                     AP_GPS_ERB::_detect(dstate->erb_detect_state, data)) {
+                return NEW_NOTHROW AP_GPS_ERB(*this, params[instance], state[instance], port);
+            }
 #endif // AP_GPS_ERB_ENABLED
 #if AP_GPS_NMEA_ENABLED
-        if ((type == GPS_TYPE_NMEA ||
-                    type == GPS_TYPE_HEMI ||
+            if ((type == GPS_TYPE_NMEA ||
+                        type == GPS_TYPE_HEMI ||
 #if AP_GPS_NMEA_UNICORE_ENABLED
-                    type == GPS_TYPE_UNICORE_NMEA ||
-                    type == GPS_TYPE_UNICORE_MOVINGBASE_NMEA ||
+                        type == GPS_TYPE_UNICORE_NMEA ||
+                        type == GPS_TYPE_UNICORE_MOVINGBASE_NMEA ||
 #endif
-                    type == GPS_TYPE_ALLYSTAR) &&
-                   AP_GPS_NMEA::_detect(dstate->nmea_detect_state, data)) {
-            return NEW_NOTHROW AP_GPS_NMEA(*this, params[instance], state[instance], port);
-        }
+                        type == GPS_TYPE_ALLYSTAR) &&
+                       AP_GPS_NMEA::_detect(dstate->nmea_detect_state, data)) {
+                return NEW_NOTHROW AP_GPS_NMEA(*this, params[instance], state[instance], port);
+            }
 #endif //AP_GPS_NMEA_ENABLED
+        }
     }
 
     return nullptr;
@@ -1057,6 +1066,10 @@ void AP_GPS::update(void)
         update_instance(i);
     }
 
+#if AP_GPS_RTCM_MUX_ENABLED
+    rtcm_mux_update();
+#endif
+
     // calculate number of instances
     for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
         if (drivers[i] != nullptr) {
@@ -1596,6 +1609,9 @@ void AP_GPS::handle_gps_rtcm_data(mavlink_channel_t chan, const mavlink_message_
         const uint16_t mask = (1U << unsigned(chan));
         rtcm.seen_mav_channels |= mask;
         if (option_set(DriverOptions::AlwaysRTCMDecode) ||
+#if AP_GPS_RTCM_MUX_ENABLED
+            option_set(DriverOptions::RTCMMux) ||
+#endif
             (rtcm.seen_mav_channels & ~mask) != 0) {
             /*
               we are seeing RTCM on multiple mavlink channels. We will run
@@ -1637,17 +1653,45 @@ bool AP_GPS::parse_rtcm_injection(mavlink_channel_t chan, const mavlink_gps_rtcm
             const uint8_t *buf = nullptr;
             uint16_t len = rtcm.parsers[chan]->get_len(buf);
 
+#if AP_GPS_RTCM_MUX_ENABLED
+            const bool use_mux = option_set(DriverOptions::RTCMMux);
+#else
+            const bool use_mux = false;
+#endif
+#if HAL_LOGGING_ENABLED
+            const bool logging = AP::logger().logging_started();
+#else
+            const bool logging = false;
+#endif
+
             // see if we have already sent it. This prevents
-            // duplicates from multiple sources
-            const uint32_t crc = crc_crc32(0, buf, len);
+            // duplicates from multiple sources. The mux drops
+            // duplicates using the frame's own CRC24, so only needs
+            // this for the log
+            uint32_t crc = 0;
+            if (!use_mux || logging) {
+                crc = crc_crc32(0, buf, len);
+            }
 
 #if HAL_LOGGING_ENABLED
-            AP::logger().WriteStreaming("RTCM", "TimeUS,Chan,RTCMId,Len,CRC", "s#---", "F----", "QBHHI",
-                                        AP_HAL::micros64(),
-                                        uint8_t(chan),
-                                        rtcm.parsers[chan]->get_id(),
-                                        len,
-                                        crc);
+            if (logging) {
+                AP::logger().WriteStreaming("RTCM", "TimeUS,Chan,RTCMId,Len,CRC", "s#---", "F----", "QBHHI",
+                                            AP_HAL::micros64(),
+                                            uint8_t(chan),
+                                            rtcm.parsers[chan]->get_id(),
+                                            len,
+                                            crc);
+            }
+#endif
+
+#if AP_GPS_RTCM_MUX_ENABLED
+            if (use_mux) {
+                if (buf != nullptr && len > 0) {
+                    rtcm_mux_frame(buf, len, rtcm.parsers[chan]->get_id());
+                }
+                rtcm.parsers[chan]->reset();
+                continue;
+            }
 #endif
             
             bool already_seen = false;
@@ -47,6 +47,8 @@
 
 class AP_GPS_Backend;
 class RTCM3_Parser;
+class ByteBuffer;
+class ExpandingString;
 
 /// @class AP_GPS
 /// GPS driver main class
@@ -140,6 +142,9 @@ public:
 #if GPS_MOVING_BASELINE
         MovingBase mb_params;
 #endif // GPS_MOVING_BASELINE
+#if AP_GPS_RTCM_MUX_ENABLED
+        AP_Int16 rtcm_filter;   // bitmask of RtcmGroup not to inject
+#endif
 
         static const struct AP_Param::GroupInfo var_info[];
     };
@@ -631,13 +636,36 @@ protected:
         GPSL5HealthOverride = (1U << 5),
         AlwaysRTCMDecode = (1U << 6),
         DisableRTCMDecode = (1U << 7),
+        RTCMMux = (1U << 8),
     };
 
     // check if an option is set
     bool option_set(const DriverOptions option) const {
-        return (uint8_t(_driver_options.get()) & uint8_t(option)) != 0;
+        return (uint16_t(_driver_options.get()) & uint16_t(option)) != 0;
     }
 
+#if AP_GPS_RTCM_MUX_ENABLED
+public:
+    // groups of RTCM3 messages for the per-GPS RTCM_FILT parameter
+    enum class RtcmGroup : uint8_t {
+        Station = 0,        // 1005, 1006, 1032
+        Descriptor = 1,     // 1007, 1008, 1033
+        Ephemeris = 2,      // 1019, 1020, 1041-1046
+        MSM_GPS = 3,        // 1071-1077
+        MSM_GLONASS = 4,    // 1081-1087, 1230
+        MSM_Galileo = 5,    // 1091-1097
+        MSM_QZSS = 6,       // 1111-1117
+        MSM_BeiDou = 7,     // 1121-1127
+        Legacy = 8,         // 1001-1004, 1009-1012
+        Proprietary = 9,    // 4001-4095
+        Other = 10,
+    };
+    static RtcmGroup rtcm_group(uint16_t msg_id);
+
+    // RTCM injection statistics for @SYS/gps_rtcm.txt
+    void rtcm_mux_info(ExpandingString &str);
+#endif
+
 private:
     static AP_GPS *_singleton;
     HAL_Semaphore rsem;
@@ -808,6 +836,40 @@ private:
     bool parse_rtcm_injection(mavlink_channel_t chan, const mavlink_gps_rtcm_data_t &pkt);
 #endif
 
+#if AP_GPS_RTCM_MUX_ENABLED
+    /*
+      RTCM injection multiplexer, enabled with the RTCMMux option in
+      GPS_DRV_OPTIONS. Whole frames from the per-channel decoders are
+      deduplicated once, filtered per GPS by message group and queued
+      per GPS, then written out only as the GPS port has room for a
+      whole frame. Allocated on first use
+    */
+    struct RtcmMux {
+        struct {
+            uint32_t key;               // CRC24 of the frame and message id
+        } sent[32];
+        uint8_t sent_idx;
+        uint32_t bytes_in;
+        uint32_t bytes_duplicate;
+        struct Instance {
+            ByteBuffer *queue;
+            uint32_t bytes_sent;
+            uint32_t bytes_filtered;
+            uint32_t bytes_dropped;
+            float latency_avg_ms;
+            uint32_t latency_max_ms;
+            uint32_t max_space;         // most inject space seen on the port
+        } instance[GPS_MAX_RECEIVERS];
+    } *rtcm_mux;
+    // header ahead of each frame in a queue
+    struct PACKED RtcmMuxHeader {
+        uint16_t len;
+        uint32_t queued_ms;
+    };
+    void rtcm_mux_frame(const uint8_t *buf, uint16_t len, uint16_t msg_id);
+    void rtcm_mux_update(void);
+#endif
+
     void convert_parameters();
 };
 
@@ -106,13 +106,15 @@ AP_GPS_GSOF::read(void)
         }
     }
 
-    while (port->available() > 0) {
-        const uint8_t temp = port->read();
-#if AP_GPS_DEBUG_LOGGING_ENABLED
-        log_data(&temp, 1);
-#endif
+    return read_port(port->available());
+}
+
+uint16_t
+AP_GPS_GSOF::parse_block(const uint8_t *bytes, uint16_t len, bool &fix_parsed)
+{
+    for (uint16_t i = 0; i < len; i++) {
         AP_GSOF::MsgTypes parsed;
-        const int parse_status = parse(temp, parsed);
+        const int parse_status = parse(bytes[i], parsed);
         if(parse_status == PARSED_GSOF_DATA) {
             if (parsed.get(AP_GSOF::POS_TIME) &&
                 parsed.get(AP_GSOF::POS) && 
@@ -122,12 +124,13 @@ AP_GPS_GSOF::read(void)
             )
             {
                 pack_state_data();
-                return true;
+                // stop at the fix, leaving the rest for the next read
+                fix_parsed = true;
+                return i + 1;
             }
         }          
     }
-
-    return false;
+    return len;
 }
 
 void
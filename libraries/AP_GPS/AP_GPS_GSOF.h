@@ -70,6 +70,8 @@ private:
 
     void pack_state_data();
 
+    uint16_t parse_block(const uint8_t *bytes, uint16_t len, bool &parsed) override;
+
     uint8_t packetcount;
     uint32_t gsofmsg_time;
     uint8_t gsofmsgreq_index;
@@ -58,22 +58,21 @@ extern const AP_HAL::HAL& hal;
 
 bool AP_GPS_NMEA::read(void)
 {
-    int16_t numc;
-    bool parsed = false;
-
     send_config();
 
-    numc = port->available();
-    while (numc--) {
-        char c = port->read();
-#if AP_GPS_DEBUG_LOGGING_ENABLED
-        log_data((const uint8_t *)&c, 1);
-#endif
-        if (_decode(c)) {
+    return read_port(port->available());
+}
+
+uint16_t AP_GPS_NMEA::parse_block(const uint8_t *bytes, uint16_t len, bool &parsed)
+{
+    for (uint16_t i=0; i<len; i++) {
+        // sentence timestamps allow for the rest of the block
+        unparsed_bytes = len - (i+1);
+        if (_decode(bytes[i])) {
             parsed = true;
         }
     }
-    return parsed;
+    return len;
 }
 
 /*
@@ -100,6 +100,8 @@ private:
     ///
     bool                        _decode(char c);
 
+    uint16_t parse_block(const uint8_t *bytes, uint16_t len, bool &parsed) override;
+
     /// Parses the @p as a NMEA-style decimal number with
     /// up to 3 decimal digits.
     ///
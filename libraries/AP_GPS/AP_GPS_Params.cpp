@@ -113,6 +113,15 @@ const AP_Param::GroupInfo AP_GPS::Params::var_info[] = {
     AP_GROUPINFO("CAN_OVRIDE", 9, AP_GPS::Params, override_node_id, 0),
 #endif
 
+#if AP_GPS_RTCM_MUX_ENABLED
+    // @Param: RTCM_FILT
+    // @DisplayName: RTCM injection filter
+    // @Description: Groups of RTCM3 messages which are not injected into this GPS. Only used when the RTCM multiplexer is enabled in GPS_DRV_OPTIONS. Use this to avoid sending corrections for constellations the receiver does not track, which saves bandwidth on the GPS port
+    // @Bitmask: 0:Station position,1:Antenna descriptors,2:Ephemeris,3:GPS MSM,4:GLONASS MSM,5:Galileo MSM,6:QZSS MSM,7:BeiDou MSM,8:Legacy observables,9:Proprietary,10:Other
+    // @User: Advanced
+    AP_GROUPINFO("RTCM_FILT", 10, AP_GPS::Params, rtcm_filter, 0),
+#endif
+
     AP_GROUPEND
 };
 
@@ -0,0 +1,267 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  RTCM injection multiplexer
+
+  Frames arrive already reassembled by the per-channel RTCM3 decoders,
+  so each is looked at once no matter how many GPSes it goes to. A
+  frame seen before on another link (or repeated by the same link) is
+  dropped using its own CRC24 and message id, so the CRC32 used to
+  drop duplicates without the mux is only computed for the RTCM log
+  message. Each GPS then gets the frame only if its message group is
+  not masked out in GPSx_RTCM_FILT, through a small per-GPS queue
+  which is drained from update() whole frames at a time, and only
+  when the port has room for the whole frame. A frame is never split
+  by a full UART, and frames which can't get out in time are dropped
+  rather than delaying the newer ones behind them.
+ */
+
+#include "AP_GPS_config.h"
+
+#if AP_GPS_ENABLED && AP_GPS_RTCM_MUX_ENABLED
+
+#include "AP_GPS.h"
+#include "GPS_Backend.h"
+#include <AP_Common/ExpandingString.h>
+
+extern const AP_HAL::HAL& hal;
+
+// bytes queued per GPS, must hold at least one maximum length frame
+#ifndef AP_GPS_RTCM_MUX_QUEUE_SIZE
+#define AP_GPS_RTCM_MUX_QUEUE_SIZE 2048
+#endif
+
+// frames waiting longer than this are dropped
+#ifndef AP_GPS_RTCM_MUX_MAX_AGE_MS
+#define AP_GPS_RTCM_MUX_MAX_AGE_MS 2000
+#endif
+
+/*
+  map an RTCM3 message id to the group used by GPSx_RTCM_FILT
+ */
+AP_GPS::RtcmGroup AP_GPS::rtcm_group(uint16_t msg_id)
+{
+    switch (msg_id) {
+    case 1005:
+    case 1006:
+    case 1032:
+        return RtcmGroup::Station;
+    case 1007:
+    case 1008:
+    case 1033:
+        return RtcmGroup::Descriptor;
+    case 1019:
+    case 1020:
+    case 1041 ... 1046:
+        return RtcmGroup::Ephemeris;
+    case 1071 ... 1077:
+        return RtcmGroup::MSM_GPS;
+    case 1081 ... 1087:
+    case 1230:
+        return RtcmGroup::MSM_GLONASS;
+    case 1091 ... 1097:
+        return RtcmGroup::MSM_Galileo;
+    case 1111 ... 1117:
+        return RtcmGroup::MSM_QZSS;
+    case 1121 ... 1127:
+        return RtcmGroup::MSM_BeiDou;
+    case 1001 ... 1004:
+    case 1009 ... 1012:
+        return RtcmGroup::Legacy;
+    case 4001 ... 4095:
+        return RtcmGroup::Proprietary;
+    default:
+        return RtcmGroup::Other;
+    }
+}
+
+/*
+  take a complete RTCM3 frame from a MAVLink channel, and queue it
+  for each GPS it should go to
+ */
+void AP_GPS::rtcm_mux_frame(const uint8_t *buf, uint16_t len, uint16_t msg_id)
+{
+    // preamble, length and CRC24 at the least
+    if (len < 6) {
+        return;
+    }
+
+    WITH_SEMAPHORE(rsem);
+
+    if (rtcm_mux == nullptr) {
+        rtcm_mux = NEW_NOTHROW RtcmMux;
+        if (rtcm_mux == nullptr) {
+            inject_data(buf, len);
+            return;
+        }
+    }
+    rtcm_mux->bytes_in += len;
+
+    // the frame ends in a CRC24 over the whole frame, so together
+    // with the message id it identifies the frame well enough
+    const uint32_t key = (uint32_t(buf[len-3]) << 16 |
+                          uint32_t(buf[len-2]) << 8 |
+                          uint32_t(buf[len-1])) |
+                         (uint32_t(msg_id & 0xFF) << 24);
+    for (const auto &sent : rtcm_mux->sent) {
+        if (sent.key == key) {
+            rtcm_mux->bytes_duplicate += len;
+            return;
+        }
+    }
+    rtcm_mux->sent[rtcm_mux->sent_idx].key = key;
+    rtcm_mux->sent_idx = (rtcm_mux->sent_idx+1) % ARRAY_SIZE(rtcm_mux->sent);
+
+    const RtcmMuxHeader hdr { len, AP_HAL::millis() };
+    const uint16_t group_mask = 1U << uint8_t(rtcm_group(msg_id));
+
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        if (_inject_to == GPS_RTK_INJECT_TO_ALL) {
+            if (is_rtk_rover(i)) {
+                // we don't externally inject to moving baseline rover
+                continue;
+            }
+        } else if (i != _inject_to) {
+            continue;
+        }
+        if (drivers[i] == nullptr) {
+            continue;
+        }
+        auto &inst = rtcm_mux->instance[i];
+        if ((uint16_t(params[i].rtcm_filter.get()) & group_mask) != 0) {
+            inst.bytes_filtered += len;
+            continue;
+        }
+        if (inst.queue == nullptr) {
+            inst.queue = NEW_NOTHROW ByteBuffer(AP_GPS_RTCM_MUX_QUEUE_SIZE);
+            if (inst.queue == nullptr || inst.queue->get_size() == 0) {
+                delete inst.queue;
+                inst.queue = nullptr;
+                inject_data(i, buf, len);
+                continue;
+            }
+        }
+        ByteBuffer &queue = *inst.queue;
+        // make room by dropping the oldest frames, newer corrections
+        // are worth more to the GPS
+        while (queue.space() < sizeof(hdr) + len) {
+            RtcmMuxHeader old;
+            if (queue.peekbytes((uint8_t*)&old, sizeof(old)) != sizeof(old)) {
+                queue.clear();
+                break;
+            }
+            queue.advance(sizeof(old) + old.len);
+            inst.bytes_dropped += old.len;
+        }
+        queue.write((const uint8_t *)&hdr, sizeof(hdr));
+        queue.write(buf, len);
+    }
+}
+
+/*
+  write queued frames to each GPS as its port has room for them,
+  called with rsem held
+ */
+void AP_GPS::rtcm_mux_update(void)
+{
+    if (rtcm_mux == nullptr) {
+        return;
+    }
+    const uint32_t now_ms = AP_HAL::millis();
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        auto &inst = rtcm_mux->instance[i];
+        if (inst.queue == nullptr) {
+            continue;
+        }
+        ByteBuffer &queue = *inst.queue;
+        RtcmMuxHeader hdr;
+        while (queue.peekbytes((uint8_t*)&hdr, sizeof(hdr)) == sizeof(hdr)) {
+            if (queue.available() < sizeof(hdr) + hdr.len) {
+                // can't happen as frames are written whole
+                queue.clear();
+                break;
+            }
+            const uint32_t age_ms = now_ms - hdr.queued_ms;
+            if (drivers[i] == nullptr || age_ms > AP_GPS_RTCM_MUX_MAX_AGE_MS) {
+                queue.advance(sizeof(hdr) + hdr.len);
+                inst.bytes_dropped += hdr.len;
+                continue;
+            }
+            const uint32_t space = drivers[i]->get_inject_space();
+            inst.max_space = MAX(inst.max_space, space);
+            if (space < hdr.len) {
+                if (hdr.len <= inst.max_space) {
+                    // wait for the port to drain
+                    break;
+                }
+                // the port has never had room for a frame this big,
+                // don't hold up the frames behind it
+                queue.advance(sizeof(hdr) + hdr.len);
+                inst.bytes_dropped += hdr.len;
+                continue;
+            }
+            queue.advance(sizeof(hdr));
+            // the frame may wrap around the end of the queue
+            uint16_t remaining = hdr.len;
+            while (remaining > 0) {
+                uint32_t n;
+                const uint8_t *ptr = queue.readptr(n);
+                if (ptr == nullptr || n == 0) {
+                    break;
+                }
+                n = MIN(n, uint32_t(remaining));
+                drivers[i]->inject_data(ptr, n);
+                queue.advance(n);
+                remaining -= n;
+            }
+            if (inst.bytes_sent == 0) {
+                inst.latency_avg_ms = age_ms;
+            } else {
+                inst.latency_avg_ms = 0.9f * inst.latency_avg_ms + 0.1f * age_ms;
+            }
+            inst.bytes_sent += hdr.len;
+            inst.latency_max_ms = MAX(inst.latency_max_ms, age_ms);
+        }
+    }
+}
+
+void AP_GPS::rtcm_mux_info(ExpandingString &str)
+{
+    WITH_SEMAPHORE(rsem);
+    if (rtcm_mux == nullptr) {
+        str.printf("RTCM mux %s\n", option_set(DriverOptions::RTCMMux) ? "idle" : "disabled");
+        return;
+    }
+    str.printf("in=%u duplicate=%u\n",
+               unsigned(rtcm_mux->bytes_in),
+               unsigned(rtcm_mux->bytes_duplicate));
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        const auto &inst = rtcm_mux->instance[i];
+        if (inst.queue == nullptr && inst.bytes_filtered == 0) {
+            continue;
+        }
+        str.printf("GPS%u sent=%u filtered=%u dropped=%u queued=%u latency avg=%.1fms max=%ums\n",
+                   unsigned(i+1),
+                   unsigned(inst.bytes_sent),
+                   unsigned(inst.bytes_filtered),
+                   unsigned(inst.bytes_dropped),
+                   unsigned(inst.queue != nullptr ? inst.queue->available() : 0),
+                   inst.latency_avg_ms,
+                   unsigned(inst.latency_max_ms));
+    }
+}
+
+#endif  // AP_GPS_ENABLED && AP_GPS_RTCM_MUX_ENABLED
@@ -87,15 +87,7 @@ AP_GPS_SBF::~AP_GPS_SBF (void) {
 bool
 AP_GPS_SBF::read(void)
 {
-    bool ret = false;
-    uint32_t available_bytes = port->available();
-    for (uint32_t i = 0; i < available_bytes; i++) {
-        uint8_t temp = port->read();
-#if AP_GPS_DEBUG_LOGGING_ENABLED
-        log_data(&temp, 1);
-#endif
-        ret |= parse(temp);
-    }
+    bool ret = read_port(port->available());
 
     const uint32_t now = AP_HAL::millis();
     if (gps._auto_config != AP_GPS::GPS_AUTO_CONFIG_DISABLE) {
@@ -236,6 +228,15 @@ bool AP_GPS_SBF::logging_healthy(void) const
     }
 }
 
+uint16_t
+AP_GPS_SBF::parse_block(const uint8_t *bytes, uint16_t len, bool &parsed)
+{
+    for (uint16_t i = 0; i < len; i++) {
+        parsed |= parse(bytes[i]);
+    }
+    return len;
+}
+
 bool
 AP_GPS_SBF::parse(uint8_t temp)
 {
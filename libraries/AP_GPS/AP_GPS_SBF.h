@@ -63,6 +63,7 @@ public:
 private:
 
     bool parse(uint8_t temp);
+    uint16_t parse_block(const uint8_t *bytes, uint16_t len, bool &parsed) override;
     bool process_message();
 
     static const uint8_t SBF_PREAMBLE1 = '$';
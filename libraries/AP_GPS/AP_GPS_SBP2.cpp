@@ -101,13 +101,15 @@ AP_GPS_SBP2::inject_data(const uint8_t *data, uint16_t len)
 void
 AP_GPS_SBP2::_sbp_process()
 {
-    uint32_t nleft = port->available(); 
-    while (nleft > 0) {
-        nleft--;
-        uint8_t temp = port->read();
-#if AP_GPS_DEBUG_LOGGING_ENABLED
-        log_data(&temp, 1);
-#endif
+    // messages are picked up from the parsed state by _attempt_state_update()
+    (void)read_port(port->available());
+}
+
+uint16_t
+AP_GPS_SBP2::parse_block(const uint8_t *bytes, uint16_t len, bool &parsed)
+{
+    for (uint16_t i = 0; i < len; i++) {
+        const uint8_t temp = bytes[i];
         uint16_t crc;
 
         //This switch reads one character at a time,
@@ -177,6 +179,7 @@ AP_GPS_SBP2::_sbp_process()
                 break;
             }
     }
+    return len;
 }
 
 
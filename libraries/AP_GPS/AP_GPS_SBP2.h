@@ -166,6 +166,7 @@ private:
     }; // 12 bytes
 
     void _sbp_process();
+    uint16_t parse_block(const uint8_t *bytes, uint16_t len, bool &parsed) override;
     void _sbp_process_message();
     bool _attempt_state_update();
 
@@ -648,7 +648,6 @@ AP_GPS_UBLOX::_request_port(void)
 bool
 AP_GPS_UBLOX::read(void)
 {
-    bool parsed = false;
     uint32_t millis_now = AP_HAL::millis();
 
     // walk through the gps configuration at 1 message per second
@@ -684,17 +683,14 @@ AP_GPS_UBLOX::read(void)
         }
     }
 
-    const uint16_t numc = MIN(port->available(), 8192U);
-    for (uint16_t i = 0; i < numc; i++) {        // Process bytes received
+    return read_port(MIN(port->available(), 8192U));
+}
 
-        // read the next byte
-        uint8_t data;
-        if (!port->read(data)) {
-            break;
-        }
-#if AP_GPS_DEBUG_LOGGING_ENABLED
-        log_data(&data, 1);
-#endif
+uint16_t
+AP_GPS_UBLOX::parse_block(const uint8_t *bytes, uint16_t len, bool &parsed)
+{
+    for (uint16_t i = 0; i < len; i++) {        // Process bytes received
+        const uint8_t data = bytes[i];
 
 #if GPS_MOVING_BASELINE
         if (rtcm3_parser) {
@@ -705,7 +701,7 @@ AP_GPS_UBLOX::read(void)
                 // chance to send the RTCMv3 packet to another (rover)
                 // GPS
                 _step = 0;
-                break;
+                return i + 1;
             }
         }
 #endif
@@ -818,7 +814,7 @@ AP_GPS_UBLOX::read(void)
             break;
         }
     }
-    return parsed;
+    return len;
 }
 
 // Private Methods /////////////////////////////////////////////////////////////
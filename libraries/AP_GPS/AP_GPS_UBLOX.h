@@ -172,6 +172,8 @@ public:
     bool is_healthy(void) const override;
     
 private:
+    uint16_t parse_block(const uint8_t *bytes, uint16_t len, bool &parsed) override;
+
     // u-blox UBX protocol essentials
     struct PACKED ubx_header {
         uint8_t preamble1;
@@ -101,6 +101,10 @@
   #define AP_GPS_RTCM_DECODE_ENABLED HAL_PROGRAM_SIZE_LIMIT_KB > 1024
 #endif
 
+#ifndef AP_GPS_RTCM_MUX_ENABLED
+  #define AP_GPS_RTCM_MUX_ENABLED AP_GPS_RTCM_DECODE_ENABLED
+#endif
+
 #ifndef HAL_GPS_COM_PORT_DEFAULT
 #define HAL_GPS_COM_PORT_DEFAULT 1
 #endif
@@ -130,6 +130,17 @@ AP_GPS_Backend::inject_data(const uint8_t *data, uint16_t len)
     }
 }
 
+uint32_t AP_GPS_Backend::get_inject_space(void) const
+{
+    if (port == nullptr) {
+        // the backend buffers injected data itself
+        return UINT32_MAX;
+    }
+    // inject_data() needs strictly more space than it writes
+    const uint32_t space = port->txspace();
+    return space > 0 ? space - 1 : 0;
+}
+
 void AP_GPS_Backend::_detection_message(char *buffer, const uint8_t buflen) const
 {
     const uint8_t instance = state.instance;
@@ -223,11 +234,46 @@ void AP_GPS_Backend::send_mavlink_gps_rtk(mavlink_channel_t chan)
 void AP_GPS_Backend::set_uart_timestamp(uint16_t nbytes)
 {
     if (port) {
-        state.last_corrected_gps_time_us = port->receive_time_constraint_us(nbytes);
+        state.last_corrected_gps_time_us = port->receive_time_constraint_us(nbytes + unparsed_bytes);
         state.corrected_timestamp_updated = true;
     }
 }
 
+/*
+  read from the port in blocks rather than a byte at a time, so the
+  UART lock is taken once per block
+ */
+bool AP_GPS_Backend::read_port(uint32_t max_bytes)
+{
+    bool parsed = false;
+    while (true) {
+        if (_read_buf_ofs >= _read_buf_len) {
+            if (max_bytes == 0) {
+                break;
+            }
+            const ssize_t n = port->read(_read_buf, MIN(max_bytes, sizeof(_read_buf)));
+            if (n <= 0) {
+                break;
+            }
+#if AP_GPS_DEBUG_LOGGING_ENABLED
+            log_data(_read_buf, n);
+#endif
+            max_bytes -= n;
+            _read_buf_ofs = 0;
+            _read_buf_len = n;
+        }
+        const uint16_t len = _read_buf_len - _read_buf_ofs;
+        unparsed_bytes = len;
+        const uint16_t used = MIN(parse_block(&_read_buf[_read_buf_ofs], len, parsed), len);
+        unparsed_bytes = 0;
+        _read_buf_ofs += used;
+        if (used < len) {
+            // the driver wants to stop here
+            break;
+        }
+    }
+    return parsed;
+}
 
 void AP_GPS_Backend::check_new_itow(uint32_t itow, uint32_t msg_length)
 {
@@ -42,6 +42,11 @@
 #define AP_GPS_MB_MAX_LAG 0.25f
 #endif
 
+// size of the blocks read from the port by read_port()
+#ifndef AP_GPS_READ_BLOCK_SIZE
+#define AP_GPS_READ_BLOCK_SIZE 128
+#endif
+
 #if AP_GPS_DEBUG_LOGGING_ENABLED
 #include <AP_HAL/utility/RingBuffer.h>
 #endif
@@ -68,6 +73,9 @@ public:
 
     virtual void inject_data(const uint8_t *data, uint16_t len);
 
+    // largest block inject_data() will accept now without dropping it
+    virtual uint32_t get_inject_space(void) const;
+
 #if HAL_GCS_ENABLED
     //MAVLink methods
     virtual bool supports_mavlink_gps_rtk_message() const { return false; }
@@ -156,6 +164,26 @@ protected:
 
     void check_new_itow(uint32_t itow, uint32_t msg_length);
 
+    /*
+      read up to max_bytes from the port in blocks, passing them to
+      parse_block(). Returns true if parse_block() parsed a fix
+     */
+    bool read_port(uint32_t max_bytes);
+
+    /*
+      parse a block of bytes read from the port by read_port(),
+      returning the number of bytes used. A driver can return less
+      than len to stop parsing, and the bytes not used are passed to
+      it again on the next read_port(). parsed should be set to true
+      when a fix has been parsed
+     */
+    virtual uint16_t parse_block(const uint8_t *bytes, uint16_t len, bool &parsed) { return len; }
+
+    // bytes which have been read from the port but not yet parsed,
+    // allowed for by set_uart_timestamp(). Drivers using
+    // set_uart_timestamp() from parse_block() keep this up to date
+    uint16_t unparsed_bytes;
+
 #if GPS_MOVING_BASELINE
     bool calculate_moving_base_yaw(const float reported_heading_deg, const float reported_distance, const float reported_D);
     bool calculate_moving_base_yaw(AP_GPS::GPS_State &interim_state, const float reported_heading_deg, const float reported_distance, const float reported_D);
@@ -185,6 +213,11 @@ private:
     uint32_t _last_rate_ms;
     uint16_t _rate_counter;
 
+    // block read from the port by read_port()
+    uint8_t _read_buf[AP_GPS_READ_BLOCK_SIZE];
+    uint16_t _read_buf_ofs;
+    uint16_t _read_buf_len;
+
 #if AP_GPS_DEBUG_LOGGING_ENABLED
     // support raw GPS logging
     static struct loginfo {
@@ -0,0 +1,176 @@
+/*
+  replay GPS byte streams through the serial GPS parsers, reporting
+  the throughput of each in bytes per second
+ */
+#include <AP_gbenchmark.h>
+
+#include <AP_GPS/AP_GPS.h>
+#include <AP_GPS/AP_GPS_NMEA.h>
+#include <AP_GPS/AP_GPS_SBP2.h>
+#include <AP_GPS/AP_GPS_UBLOX.h>
+#include <AP_HAL/UARTDriver.h>
+#include <AP_HAL/utility/sparse-endian.h>
+#include <AP_Math/crc.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// size of each replayed stream
+static const uint32_t stream_size = 64*1024;
+
+/*
+  UART which returns a recorded stream and discards writes
+ */
+class ReplayUart : public AP_HAL::UARTDriver {
+public:
+    void set_stream(const uint8_t *_data, uint32_t _len) {
+        data = _data;
+        len = _len;
+        ofs = 0;
+    }
+
+    bool is_initialized() override { return true; }
+    bool tx_pending() override { return false; }
+    uint32_t txspace() override { return 4096; }
+    uint32_t get_baud_rate() const override { return 460800; }
+
+protected:
+    uint32_t _available() override { return len - ofs; }
+    void _begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace) override {}
+    void _end() override {}
+    void _flush() override {}
+    size_t _write(const uint8_t *buffer, size_t size) override { return size; }
+    ssize_t _read(uint8_t *buf, uint16_t count) override {
+        const uint32_t n = MIN(uint32_t(count), len - ofs);
+        memcpy(buf, &data[ofs], n);
+        ofs += n;
+        return n;
+    }
+    bool _discard_input() override { ofs = len; return true; }
+
+private:
+    const uint8_t *data;
+    uint32_t len;
+    uint32_t ofs;
+};
+
+static AP_GPS gps;
+static AP_GPS::Params gps_params;
+static AP_GPS::GPS_State gps_state;
+static ReplayUart uart;
+
+// repeat a set of messages to fill a stream
+static void fill_stream(uint8_t *stream, const uint8_t *msgs, uint32_t msgs_len)
+{
+    for (uint32_t ofs = 0; ofs < stream_size; ofs += msgs_len) {
+        memcpy(&stream[ofs], msgs, MIN(msgs_len, stream_size - ofs));
+    }
+}
+
+// add a NMEA sentence, adding the checksum
+static uint32_t add_nmea(uint8_t *buf, const char *body)
+{
+    uint8_t sum = 0;
+    for (const char *p = body; *p; p++) {
+        sum ^= uint8_t(*p);
+    }
+    return sprintf((char *)buf, "$%s*%02X\r\n", body, unsigned(sum));
+}
+
+// add a UBX message with a zero payload of the given length
+static uint32_t add_ubx(uint8_t *buf, uint8_t msg_class, uint8_t msg_id, uint16_t payload_len)
+{
+    buf[0] = 0xB5;
+    buf[1] = 0x62;
+    buf[2] = msg_class;
+    buf[3] = msg_id;
+    buf[4] = payload_len & 0xFF;
+    buf[5] = payload_len >> 8;
+    memset(&buf[6], 0, payload_len);
+    uint8_t ck_a = 0, ck_b = 0;
+    for (uint16_t i = 2; i < 6 + payload_len; i++) {
+        ck_b += (ck_a += buf[i]);
+    }
+    buf[6+payload_len] = ck_a;
+    buf[7+payload_len] = ck_b;
+    return 8 + payload_len;
+}
+
+// add a SBP message with a zero payload of the given length
+static uint32_t add_sbp(uint8_t *buf, uint16_t msg_type, uint8_t payload_len)
+{
+    buf[0] = 0x55;
+    put_le16_ptr(&buf[1], msg_type);
+    put_le16_ptr(&buf[3], 0x1234);
+    buf[5] = payload_len;
+    memset(&buf[6], 0, payload_len);
+    const uint16_t crc = crc16_ccitt(&buf[1], 5 + payload_len, 0);
+    put_le16_ptr(&buf[6+payload_len], crc);
+    return 8 + payload_len;
+}
+
+static void replay(benchmark::State &state, AP_GPS_Backend &driver, const uint8_t *stream)
+{
+    while (state.KeepRunning()) {
+        uart.set_stream(stream, stream_size);
+        while (uart.available() > 0) {
+            driver.read();
+        }
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * stream_size);
+}
+
+#if AP_GPS_NMEA_ENABLED
+static void BM_GPS_NMEA(benchmark::State &state)
+{
+    static uint8_t stream[stream_size];
+    uint8_t msgs[512];
+    uint32_t len = 0;
+    len += add_nmea(&msgs[len], "GPGGA,123519.00,4807.0381,N,01131.0001,E,4,12,0.9,545.4,M,46.9,M,1.0,0000");
+    len += add_nmea(&msgs[len], "GPRMC,123519.00,A,4807.0381,N,01131.0001,E,0.022,84.4,230394,003.1,W,D");
+    len += add_nmea(&msgs[len], "GPVTG,84.4,T,87.5,M,0.022,N,0.041,K,D");
+    fill_stream(stream, msgs, len);
+
+    AP_GPS_NMEA driver(gps, gps_params, gps_state, &uart);
+    replay(state, driver, stream);
+}
+BENCHMARK(BM_GPS_NMEA);
+#endif  // AP_GPS_NMEA_ENABLED
+
+#if AP_GPS_UBLOX_ENABLED
+static void BM_GPS_UBLOX(benchmark::State &state)
+{
+    static uint8_t stream[stream_size];
+    uint8_t msgs[512];
+    uint32_t len = 0;
+    // NAV-PVT, NAV-DOP and NAV-RELPOSNED as streamed by an RTK rover
+    len += add_ubx(&msgs[len], 0x01, 0x07, 92);
+    len += add_ubx(&msgs[len], 0x01, 0x04, 18);
+    len += add_ubx(&msgs[len], 0x01, 0x3C, 64);
+    fill_stream(stream, msgs, len);
+
+    AP_GPS_UBLOX driver(gps, gps_params, gps_state, &uart, AP_GPS::GPS_ROLE_NORMAL);
+    replay(state, driver, stream);
+}
+BENCHMARK(BM_GPS_UBLOX);
+#endif  // AP_GPS_UBLOX_ENABLED
+
+#if AP_GPS_SBP2_ENABLED
+static void BM_GPS_SBP2(benchmark::State &state)
+{
+    static uint8_t stream[stream_size];
+    uint8_t msgs[512];
+    uint32_t len = 0;
+    // GPS_TIME, POS_LLH, VEL_NED and DOPS
+    len += add_sbp(&msgs[len], 0x0102, 11);
+    len += add_sbp(&msgs[len], 0x020A, 34);
+    len += add_sbp(&msgs[len], 0x020E, 22);
+    len += add_sbp(&msgs[len], 0x0208, 15);
+    fill_stream(stream, msgs, len);
+
+    AP_GPS_SBP2 driver(gps, gps_params, gps_state, &uart);
+    replay(state, driver, stream);
+}
+BENCHMARK(BM_GPS_SBP2);
+#endif  // AP_GPS_SBP2_ENABLED
+
+BENCHMARK_MAIN();
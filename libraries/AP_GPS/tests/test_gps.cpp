@@ -17,6 +17,7 @@
 #include <AP_gtest.h>
 
 #include <AP_GPS/AP_GPS_NMEA.h>
+#include <AP_GPS/AP_GPS.h>
 
 const AP_HAL::HAL &hal = AP_HAL::get_HAL();
 
@@ -62,4 +63,27 @@ TEST(AP_GPS_NMEA, parse_decimal_100)
     ASSERT_EQ(-100, test.parse_decimal_100("-1"));
 }
 
+#if AP_GPS_RTCM_MUX_ENABLED
+TEST(AP_GPS, rtcm_group)
+{
+    ASSERT_EQ(AP_GPS::RtcmGroup::Station, AP_GPS::rtcm_group(1005));
+    ASSERT_EQ(AP_GPS::RtcmGroup::Station, AP_GPS::rtcm_group(1006));
+    ASSERT_EQ(AP_GPS::RtcmGroup::Descriptor, AP_GPS::rtcm_group(1033));
+    ASSERT_EQ(AP_GPS::RtcmGroup::Ephemeris, AP_GPS::rtcm_group(1019));
+    ASSERT_EQ(AP_GPS::RtcmGroup::Ephemeris, AP_GPS::rtcm_group(1046));
+    ASSERT_EQ(AP_GPS::RtcmGroup::MSM_GPS, AP_GPS::rtcm_group(1074));
+    ASSERT_EQ(AP_GPS::RtcmGroup::MSM_GPS, AP_GPS::rtcm_group(1077));
+    ASSERT_EQ(AP_GPS::RtcmGroup::MSM_GLONASS, AP_GPS::rtcm_group(1084));
+    ASSERT_EQ(AP_GPS::RtcmGroup::MSM_GLONASS, AP_GPS::rtcm_group(1230));
+    ASSERT_EQ(AP_GPS::RtcmGroup::MSM_Galileo, AP_GPS::rtcm_group(1094));
+    ASSERT_EQ(AP_GPS::RtcmGroup::MSM_QZSS, AP_GPS::rtcm_group(1117));
+    ASSERT_EQ(AP_GPS::RtcmGroup::MSM_BeiDou, AP_GPS::rtcm_group(1124));
+    ASSERT_EQ(AP_GPS::RtcmGroup::Legacy, AP_GPS::rtcm_group(1004));
+    ASSERT_EQ(AP_GPS::RtcmGroup::Legacy, AP_GPS::rtcm_group(1012));
+    ASSERT_EQ(AP_GPS::RtcmGroup::Proprietary, AP_GPS::rtcm_group(4072));
+    ASSERT_EQ(AP_GPS::RtcmGroup::Other, AP_GPS::rtcm_group(1013));
+    ASSERT_EQ(AP_GPS::RtcmGroup::Other, AP_GPS::rtcm_group(1101));
+}
+#endif
+
 AP_GTEST_MAIN()
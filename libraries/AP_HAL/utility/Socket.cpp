@@ -195,6 +195,18 @@ fail_multi:
   connect the socket with a timeout
  */
 bool SOCKET_CLASS_NAME::connect_timeout(const char *address, uint16_t port, uint32_t timeout_ms)
+{
+    if (!connect_start(address, port)) {
+        return false;
+    }
+    connect_finish(timeout_ms);
+    return connected;
+}
+
+/*
+  start a non-blocking connect
+ */
+bool SOCKET_CLASS_NAME::connect_start(const char *address, uint16_t port)
 {
     if (fd == -1) {
         return false;
@@ -204,25 +216,35 @@ bool SOCKET_CLASS_NAME::connect_timeout(const char *address, uint16_t port, uint
 
     set_blocking(false);
 
+    connected = false;
     int ret = CALL_PREFIX(connect)(fd, (struct sockaddr *)&sockaddr, sizeof(sockaddr));
     if (ret == 0) {
         // instant connect?
+        connected = true;
         return true;
     }
-    if (errno != EINPROGRESS) {
-        return false;
+    return errno == EINPROGRESS;
+}
+
+/*
+  wait for a connect started with connect_start(). Returns false if
+  the connect is still in progress after timeout_ms
+ */
+bool SOCKET_CLASS_NAME::connect_finish(uint32_t timeout_ms)
+{
+    if (connected) {
+        return true;
     }
-    bool pollret = pollout(timeout_ms);
-    if (!pollret) {
+    if (!pollout(timeout_ms)) {
         return false;
     }
     int sock_error = 0;
     socklen_t len = sizeof(sock_error);
     if (CALL_PREFIX(getsockopt)(fd, SOL_SOCKET, SO_ERROR, (void*)&sock_error, &len) != 0) {
-        return false;
+        sock_error = errno;
     }
     connected = sock_error == 0;
-    return connected;
+    return true;
 }
 
 /*
@@ -459,6 +481,52 @@ bool SOCKET_CLASS_NAME::pollin(uint32_t timeout_ms)
 }
 
 
+/*
+  wait for pending input on any of a set of sockets
+ */
+uint8_t SOCKET_CLASS_NAME::pollin_multi(SOCKET_CLASS_NAME *const socks[], bool ready[], uint8_t n, uint32_t timeout_us)
+{
+    fd_set fds;
+    struct timeval tv;
+    int max_fd = -1;
+
+    FD_ZERO(&fds);
+    for (uint8_t i=0; i<n; i++) {
+        ready[i] = false;
+        if (socks[i] == nullptr) {
+            continue;
+        }
+        const int fin = socks[i]->get_read_fd();
+        if (fin == -1) {
+            continue;
+        }
+        FD_SET(fin, &fds);
+        if (fin > max_fd) {
+            max_fd = fin;
+        }
+    }
+    if (max_fd == -1) {
+        return 0;
+    }
+
+    tv.tv_sec = timeout_us / 1000000UL;
+    tv.tv_usec = timeout_us % 1000000UL;
+
+    if (CALL_PREFIX(select)(max_fd+1, &fds, nullptr, nullptr, &tv) <= 0) {
+        return 0;
+    }
+    uint8_t count = 0;
+    for (uint8_t i=0; i<n; i++) {
+        if (socks[i] != nullptr &&
+            socks[i]->get_read_fd() != -1 &&
+            FD_ISSET(socks[i]->get_read_fd(), &fds)) {
+            ready[i] = true;
+            count++;
+        }
+    }
+    return count;
+}
+
 /*
   return true if there is room for output data
  */
@@ -35,6 +35,13 @@ public:
 
     bool connect(const char *address, uint16_t port);
     bool connect_timeout(const char *address, uint16_t port, uint32_t timeout_ms);
+
+    // non-blocking connect. connect_start() returns false if the
+    // connect failed. connect_finish() returns false if the connect
+    // is still in progress after timeout_ms, otherwise is_connected()
+    // gives the result
+    bool connect_start(const char *address, uint16_t port);
+    bool connect_finish(uint32_t timeout_ms);
     bool bind(const char *address, uint16_t port);
     bool reuseaddress() const;
     bool set_blocking(bool blocking) const;
@@ -61,6 +68,11 @@ public:
     // return true if there is room for output data
     bool pollout(uint32_t timeout_ms);
 
+    // wait for pending input on any of a set of sockets, setting
+    // ready[i] for each socket with input. nullptr entries are
+    // ignored. Returns the number of sockets with pending input
+    static uint8_t pollin_multi(SOCKET_CLASS_NAME *const socks[], bool ready[], uint8_t n, uint32_t timeout_us);
+
     // start listening for new tcp connections
     bool listen(uint16_t backlog) const;
 
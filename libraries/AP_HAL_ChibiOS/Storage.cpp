@@ -251,6 +251,13 @@ void Storage::_timer_tick(void)
     }
     if (_dirty_mask.empty()) {
         _last_empty_ms = AP_HAL::millis();
+#ifdef STORAGE_FLASH_PAGE
+        if (_initialisedType == StorageBackend::Flash) {
+            // nothing to write, so use the time to compact flash
+            EXPECT_DELAY_MS(1);
+            _flash.compact();
+        }
+#endif
         return;
     }
 
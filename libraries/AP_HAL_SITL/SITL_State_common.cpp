@@ -253,7 +253,7 @@ SITL::SerialDevice *SITL_State_Common::create_serial_sim(const char *name, const
         if (ais != nullptr) {
             AP_HAL::panic("Only one AIS at a time");
         }
-        ais = NEW_NOTHROW SITL::AIS();
+        ais = NEW_NOTHROW SITL::AIS(arg);
         return ais;
 #endif
     } else if (strncmp(name, "gps", 3) == 0) {
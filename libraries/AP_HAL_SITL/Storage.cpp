@@ -167,6 +167,12 @@ void Storage::_timer_tick(void)
     }
     if (_dirty_mask.empty()) {
         _last_empty_ms = AP_HAL::millis();
+#if STORAGE_USE_FLASH
+        if (_initialisedType == StorageBackend::Flash) {
+            // nothing to write, so use the time to compact flash
+            _flash.compact();
+        }
+#endif
         return;
     }
 
@@ -684,6 +684,16 @@ const AP_Param::GroupInfo AP_InertialSensor::var_info[] = {
     // @User: Advanced
     AP_GROUPINFO("_RAW_LOG_OPT", 56, AP_InertialSensor, raw_logging_options, 0),
 
+#if AP_INERTIALSENSOR_FILTER_THREAD_ENABLED
+    // @Param: _FILT_CPU
+    // @DisplayName: Gyro filter thread CPU
+    // @Description: When set to zero or more the gyro notch and low pass filters are run on a dedicated high priority thread pinned to this CPU core, rather than on the sensor bus threads. This reduces main loop jitter and allows higher gyro rates on multi-core boards. -1 disables the filter thread
+    // @Range: -1 7
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("_FILT_CPU", 57, AP_InertialSensor, _filter_thread_cpu, -1),
+#endif
+
     /*
       NOTE: parameter indexes have gaps above. When adding new
       parameters check for conflicts carefully
@@ -950,6 +960,11 @@ AP_InertialSensor::init(uint16_t loop_rate)
         _start_backends();
     }
 
+#if AP_INERTIALSENSOR_FILTER_THREAD_ENABLED
+    // the filter thread must be running before gyro calibration
+    start_filter_thread();
+#endif
+
     // calibrate gyros unless gyro calibration has been disabled
     if (gyro_calibration_timing() != GYRO_CAL_NEVER && _gyro_count > 0) {
         init_gyro();
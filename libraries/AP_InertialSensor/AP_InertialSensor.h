@@ -811,18 +811,39 @@ private:
     bool fast_rate_buffer_enabled;
 
 public:
+    // stages of the gyro to motor output pipeline used for latency
+    // measurement of the fast rate thread
+    enum class FastRateStage : uint8_t {
+        FILTER = 0, // raw sample to filtered sample pushed to the buffer
+        QUEUE,      // pushed to the buffer to read by the rate thread
+        RATE,       // attitude rate controller
+        MOTORS,     // motor mixer output
+        PUSH,       // RCOutput push
+        TOTAL,      // raw sample to RCOutput push
+        NUM_STAGES
+    };
+
     // enable the fast rate buffer and start pushing samples to it
     void enable_fast_rate_buffer();
     // disable the fast rate buffer and stop pushing samples to it
     void disable_fast_rate_buffer();
     // get the next available gyro sample from the fast rate buffer
     bool get_next_gyro_sample(Vector3f& gyro);
+    // get the next available gyro sample and start tracking its latency
+    // through the rate controller to the motor outputs
+    bool get_next_gyro_sample_timed(Vector3f& gyro);
+    // record that a stage of the fast rate pipeline has completed
+    void fast_rate_stage_done(FastRateStage stage);
+    // return average and max latency per stage since the last call
+    bool get_fast_rate_latency(uint16_t avg_us[], uint16_t max_us[]);
+    // display fast rate latency histograms for @SYS/rate_latency.txt
+    void fast_rate_latency_info(ExpandingString &str);
     // get the number of available gyro samples in the fast rate buffer
     uint32_t get_num_gyro_samples();
     // set the rate at which samples are collected, unused samples are dropped
     void set_rate_decimation(uint8_t rdec);
     // push a new gyro sample into the fast rate buffer
-    bool push_next_gyro_sample(const Vector3f& gyro);
+    bool push_next_gyro_sample(const Vector3f& gyro, uint32_t sample_us);
     // run the filter parmeter update code.
     void update_backend_filters();
     // are rate loop samples enabled for this instance?
@@ -830,6 +851,34 @@ public:
     // is dynamic fifo enabled for this instance
     bool is_dynamic_fifo_enabled(uint8_t instance) const;
     // endif AP_INERTIALSENSOR_FAST_SAMPLE_WINDOW_ENABLED
+
+#if AP_INERTIALSENSOR_FILTER_THREAD_ENABLED
+    // queue a raw gyro sample for the filter thread, returns false if
+    // the filter thread is not running and the caller should filter
+    bool push_filter_thread_sample(AP_InertialSensor_Backend *backend, uint8_t instance, const Vector3f &gyro, uint64_t sample_us);
+
+private:
+    // raw gyro sample queued for the filter thread
+    struct FilterSample {
+        Vector3f gyro;
+        uint64_t sample_us;
+    };
+
+    // start the filter thread if enabled
+    void start_filter_thread();
+    void free_filter_queues();
+    void filter_thread();
+
+    // CPU core to pin the filter thread to, -1 disables the filter thread
+    AP_Int8 _filter_thread_cpu;
+
+    // one queue per gyro so each has a single producer bus thread
+    // and the filter thread as the single consumer
+    ObjectBuffer<FilterSample> *_filter_queue[INS_MAX_INSTANCES];
+    AP_InertialSensor_Backend *_filter_backend[INS_MAX_INSTANCES];
+    HAL_BinarySemaphore _filter_notify;
+    bool _filter_thread_running;
+#endif
 };
 
 namespace AP {
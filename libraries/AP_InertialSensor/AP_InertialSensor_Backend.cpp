@@ -216,7 +216,7 @@ void AP_InertialSensor_Backend::save_gyro_window(const uint8_t instance, const V
 /*
   apply harmonic notch and low pass gyro filters
  */
-void AP_InertialSensor_Backend::apply_gyro_filters(const uint8_t instance, const Vector3f &gyro)
+void AP_InertialSensor_Backend::apply_gyro_filters(const uint8_t instance, const Vector3f &gyro, uint64_t sample_us)
 {
     uint8_t filter_phase = 0;
     save_gyro_window(instance, gyro, filter_phase++);
@@ -266,7 +266,7 @@ void AP_InertialSensor_Backend::apply_gyro_filters(const uint8_t instance, const
 
 #if AP_INERTIALSENSOR_FAST_SAMPLE_WINDOW_ENABLED
     if (_imu.is_rate_loop_gyro_enabled(instance)) {
-        if (_imu.push_next_gyro_sample(gyro_filtered)) {
+        if (_imu.push_next_gyro_sample(gyro_filtered, uint32_t(sample_us))) {
             // if we used the value, record it for publication to the front-end
             _imu._gyro_filtered[instance] = gyro_filtered;
         }
@@ -337,6 +337,7 @@ void AP_InertialSensor_Backend::_notify_new_gyro_raw_sample(uint8_t instance,
     delta_coning = delta_coning % delta_angle;
     delta_coning *= 0.5f;
 
+    bool filter_queued = false;
     {
         WITH_SEMAPHORE(_sem);
         uint64_t now = AP_HAL::micros64();
@@ -360,14 +361,23 @@ void AP_InertialSensor_Backend::_notify_new_gyro_raw_sample(uint8_t instance,
         _imu._last_delta_angle[instance] = delta_angle;
         _imu._last_raw_gyro[instance] = gyro;
 
-        // apply gyro filters and sample for FFT
-        apply_gyro_filters(instance, gyro);
+#if AP_INERTIALSENSOR_FILTER_THREAD_ENABLED
+        // the filter thread applies the filters, flags new data and
+        // logs the sample once it is filtered
+        filter_queued = _imu.push_filter_thread_sample(this, instance, gyro, sample_us);
+#endif
+        if (!filter_queued) {
+            // apply gyro filters and sample for FFT
+            apply_gyro_filters(instance, gyro, sample_us);
 
-        _imu._new_gyro_data[instance] = true;
+            _imu._new_gyro_data[instance] = true;
+        }
     }
 
-    // 5us
-    log_gyro_raw(instance, sample_us, gyro, _imu._gyro_filtered[instance]);
+    if (!filter_queued) {
+        // 5us
+        log_gyro_raw(instance, sample_us, gyro, _imu._gyro_filtered[instance]);
+    }
     update_primary();
 }
 
@@ -426,6 +436,7 @@ void AP_InertialSensor_Backend::_notify_new_delta_angle(uint8_t instance, const
     delta_coning = delta_coning % delta_angle;
     delta_coning *= 0.5f;
 
+    bool filter_queued = false;
     {
         WITH_SEMAPHORE(_sem);
         uint64_t now = AP_HAL::micros64();
@@ -449,13 +460,22 @@ void AP_InertialSensor_Backend::_notify_new_delta_angle(uint8_t instance, const
         _imu._last_delta_angle[instance] = delta_angle;
         _imu._last_raw_gyro[instance] = gyro;
 
-        // apply gyro filters and sample for FFT
-        apply_gyro_filters(instance, gyro);
+#if AP_INERTIALSENSOR_FILTER_THREAD_ENABLED
+        // the filter thread applies the filters, flags new data and
+        // logs the sample once it is filtered
+        filter_queued = _imu.push_filter_thread_sample(this, instance, gyro, sample_us);
+#endif
+        if (!filter_queued) {
+            // apply gyro filters and sample for FFT
+            apply_gyro_filters(instance, gyro, sample_us);
 
-        _imu._new_gyro_data[instance] = true;
+            _imu._new_gyro_data[instance] = true;
+        }
     }
 
-    log_gyro_raw(instance, sample_us, gyro, _imu._gyro_filtered[instance]);
+    if (!filter_queued) {
+        log_gyro_raw(instance, sample_us, gyro, _imu._gyro_filtered[instance]);
+    }
     update_primary();
 }
 
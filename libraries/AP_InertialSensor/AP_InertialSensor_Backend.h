@@ -154,6 +154,11 @@ public:
         DEVTYPE_INS_IIM42653 = 0x3D,
     };
 
+#if AP_INERTIALSENSOR_FILTER_THREAD_ENABLED
+    // apply gyro filters to a sample queued for the filter thread
+    void filter_queued_gyro(uint8_t instance, const Vector3f &gyro, uint64_t sample_us);
+#endif
+
 protected:
     // access to frontend
     AP_InertialSensor &_imu;
@@ -177,7 +182,7 @@ protected:
     void _publish_gyro(uint8_t instance, const Vector3f &gyro) __RAMFUNC__; /* front end */
 
     // apply notch and lowpass gyro filters and sample for FFT
-    void apply_gyro_filters(const uint8_t instance, const Vector3f &gyro);
+    void apply_gyro_filters(const uint8_t instance, const Vector3f &gyro, uint64_t sample_us);
     void save_gyro_window(const uint8_t instance, const Vector3f &gyro, uint8_t phase);
 
     // this should be called every time a new gyro raw sample is
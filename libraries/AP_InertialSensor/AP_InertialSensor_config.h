@@ -81,3 +81,9 @@
 #ifndef AP_INERTIALSENSOR_RST_ENABLED
 #define AP_INERTIALSENSOR_RST_ENABLED 0
 #endif // AP_INERTIALSENSOR_RST_ENABLED
+
+// run gyro filtering on a dedicated thread, fed from the sensor bus
+// threads through lock-free queues
+#ifndef AP_INERTIALSENSOR_FILTER_THREAD_ENABLED
+#define AP_INERTIALSENSOR_FILTER_THREAD_ENABLED (AP_INERTIALSENSOR_ENABLED && CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
@@ -99,8 +99,57 @@ bool AP_InertialSensor::get_next_gyro_sample(Vector3f& gyro)
     return fast_rate_buffer->get_next_gyro_sample(gyro);
 }
 
+// get the next available gyro sample and start tracking its latency
+bool AP_InertialSensor::get_next_gyro_sample_timed(Vector3f& gyro)
+{
+    if (!fast_rate_buffer_enabled || fast_rate_buffer == nullptr) {
+        return false;
+    }
+
+    uint32_t sample_us, push_us;
+    if (!fast_rate_buffer->get_next_gyro_sample(gyro, sample_us, push_us)) {
+        return false;
+    }
+    fast_rate_buffer->latency_begin(sample_us, push_us);
+    return true;
+}
+
+// record that a stage of the fast rate pipeline has completed
+void AP_InertialSensor::fast_rate_stage_done(FastRateStage stage)
+{
+    if (!fast_rate_buffer_enabled || fast_rate_buffer == nullptr) {
+        return;
+    }
+    fast_rate_buffer->latency_stage_done(stage);
+}
+
+// return average and max latency per stage since the last call
+bool AP_InertialSensor::get_fast_rate_latency(uint16_t avg_us[], uint16_t max_us[])
+{
+    if (!fast_rate_buffer_enabled || fast_rate_buffer == nullptr) {
+        return false;
+    }
+    fast_rate_buffer->latency_get_and_reset(avg_us, max_us);
+    return true;
+}
+
+// display fast rate latency histograms for @SYS/rate_latency.txt
+void AP_InertialSensor::fast_rate_latency_info(ExpandingString &str)
+{
+    if (fast_rate_buffer == nullptr) {
+        str.printf("Rate thread not active\n");
+        return;
+    }
+    fast_rate_buffer->latency_info(str);
+}
 
 bool FastRateBuffer::get_next_gyro_sample(Vector3f& gyro)
+{
+    uint32_t sample_us, push_us;
+    return get_next_gyro_sample(gyro, sample_us, push_us);
+}
+
+bool FastRateBuffer::get_next_gyro_sample(Vector3f& gyro, uint32_t& sample_us, uint32_t& push_us)
 {
     if (!use_rate_loop_gyro_samples()) {
         return false;
@@ -112,15 +161,109 @@ bool FastRateBuffer::get_next_gyro_sample(Vector3f& gyro)
 
     WITH_SEMAPHORE(_mutex);
 
-    return _rate_loop_gyro_window.pop(gyro);
+    GyroSample sample;
+    if (!_rate_loop_gyro_window.pop(sample)) {
+        return false;
+    }
+    gyro = sample.gyro;
+    sample_us = sample.sample_us;
+    push_us = sample.push_us;
+    return true;
 }
 
 void FastRateBuffer::reset()
 {
     _rate_loop_gyro_window.clear();
+    _latency_active = false;
+}
+
+/*
+  start tracking a sample that has just been read by the rate
+  thread. The filter and queue stages are already complete
+ */
+void FastRateBuffer::latency_begin(uint32_t sample_us, uint32_t push_us)
+{
+    const uint32_t now_us = AP_HAL::micros();
+    _latency[uint8_t(AP_InertialSensor::FastRateStage::FILTER)].update(push_us - sample_us);
+    _latency[uint8_t(AP_InertialSensor::FastRateStage::QUEUE)].update(now_us - push_us);
+    _latency_sample_us = sample_us;
+    _latency_stage_us = now_us;
+    _latency_active = true;
+}
+
+// record the end of a pipeline stage for the sample being tracked
+void FastRateBuffer::latency_stage_done(AP_InertialSensor::FastRateStage stage)
+{
+    if (!_latency_active) {
+        return;
+    }
+    const uint32_t now_us = AP_HAL::micros();
+    _latency[uint8_t(stage)].update(now_us - _latency_stage_us);
+    _latency_stage_us = now_us;
+    if (stage == AP_InertialSensor::FastRateStage::PUSH) {
+        // the sample has reached the outputs
+        _latency[uint8_t(AP_InertialSensor::FastRateStage::TOTAL)].update(now_us - _latency_sample_us);
+        _latency_active = false;
+    }
+}
+
+void FastRateBuffer::StageLatency::update(uint32_t latency_us)
+{
+    if (count == UINT16_MAX) {
+        sum_us /= 2;
+        count /= 2;
+    }
+    sum_us += latency_us;
+    max_us = uint16_t(MAX(uint32_t(max_us), MIN(latency_us, uint32_t(UINT16_MAX))));
+    count++;
+
+    uint8_t b = 0;
+    if (latency_us > 1) {
+        b = MIN(uint8_t(31 - __builtin_clz(latency_us)), uint8_t(LATENCY_BUCKETS-1));
+    }
+    if (bucket[b] == UINT16_MAX) {
+        // halve all counts so the shape of the distribution is kept
+        for (uint8_t i=0; i<LATENCY_BUCKETS; i++) {
+            bucket[i] /= 2;
+        }
+    }
+    bucket[b]++;
+}
+
+// return average and max latency per stage since the last call
+void FastRateBuffer::latency_get_and_reset(uint16_t avg_us[], uint16_t max_us[])
+{
+    for (uint8_t i=0; i<ARRAY_SIZE(_latency); i++) {
+        StageLatency &l = _latency[i];
+        avg_us[i] = l.count > 0 ? MIN(l.sum_us / l.count, UINT16_MAX) : 0;
+        max_us[i] = l.max_us;
+        l.sum_us = 0;
+        l.max_us = 0;
+        l.count = 0;
+    }
+}
+
+// display latency histograms, bucket n is [2^n, 2^(n+1)) microseconds
+void FastRateBuffer::latency_info(ExpandingString &str) const
+{
+    static const char *stage_names[] { "FILTER", "QUEUE", "RATE", "MOTORS", "PUSH", "TOTAL" };
+    static_assert(ARRAY_SIZE(stage_names) == ARRAY_SIZE(_latency), "stage_names must match FastRateStage");
+
+    str.printf("%-8s", "STAGE");
+    for (uint8_t b=0; b<LATENCY_BUCKETS; b++) {
+        str.printf(" %5u", unsigned(1U<<b));
+    }
+    str.printf("\n");
+    for (uint8_t i=0; i<ARRAY_SIZE(_latency); i++) {
+        str.printf("%-8s", stage_names[i]);
+        for (uint8_t b=0; b<LATENCY_BUCKETS; b++) {
+            str.printf(" %5u", unsigned(_latency[i].bucket[b]));
+        }
+        str.printf("\n");
+    }
 }
 
-bool AP_InertialSensor::push_next_gyro_sample(const Vector3f& gyro)
+bool AP_InertialSensor::push_next_gyro_sample(const Vector3f& gyro, uint32_t sample_us)
 {
     if (!fast_rate_buffer_enabled || fast_rate_buffer == nullptr) {
         return false;
@@ -134,7 +277,12 @@ bool AP_InertialSensor::push_next_gyro_sample(const Vector3f& gyro)
     */
     WITH_SEMAPHORE(fast_rate_buffer->_mutex);
 
-    if (!fast_rate_buffer->_rate_loop_gyro_window.push(gyro)) {
+    const FastRateBuffer::GyroSample sample {
+        gyro : gyro,
+        sample_us : sample_us,
+        push_us : AP_HAL::micros(),
+    };
+    if (!fast_rate_buffer->_rate_loop_gyro_window.push(sample)) {
         debug("dropped rate loop sample");
     }
     fast_rate_buffer->rate_decimation_count = 0;
@@ -24,12 +24,14 @@
 #include <AP_HAL/utility/RingBuffer.h>
 #include <AP_Math/AP_Math.h>
 #include <AP_HAL/Semaphores.h>
+#include <AP_Common/ExpandingString.h>
 
 class FastRateBuffer
 {
     friend class AP_InertialSensor;
 public:
     bool get_next_gyro_sample(Vector3f& gyro);
+    bool get_next_gyro_sample(Vector3f& gyro, uint32_t& sample_us, uint32_t& push_us);
     uint32_t get_num_gyro_samples() { return _rate_loop_gyro_window.available(); }
     void set_rate_decimation(uint8_t rdec) { rate_decimation = rdec; }
     // whether or not to push the current gyro sample
@@ -37,12 +39,48 @@ public:
     bool gyro_samples_available() { return  _rate_loop_gyro_window.available() > 0; }
     void reset();
 
+    // start tracking pipeline latency for a sample read by the rate thread
+    void latency_begin(uint32_t sample_us, uint32_t push_us);
+    // record the end of a pipeline stage for the sample being tracked
+    void latency_stage_done(AP_InertialSensor::FastRateStage stage);
+    // return average and max latency per stage since the last call
+    void latency_get_and_reset(uint16_t avg_us[], uint16_t max_us[]);
+    // display latency histograms for @SYS/rate_latency.txt
+    void latency_info(ExpandingString &str) const;
+
 private:
+    // gyro sample along with when it was taken and when filtering finished
+    struct GyroSample {
+        Vector3f gyro;
+        uint32_t sample_us;
+        uint32_t push_us;
+    };
+
+    // number of log2 buckets in the latency histograms. Bucket n
+    // counts latencies in [2^n, 2^(n+1)) microseconds
+    static const uint8_t LATENCY_BUCKETS = 13;
+
+    struct StageLatency {
+        // since the last latency_get_and_reset()
+        uint32_t sum_us;
+        uint16_t max_us;
+        uint16_t count;
+        // since boot, halved on overflow
+        uint16_t bucket[LATENCY_BUCKETS];
+
+        void update(uint32_t latency_us);
+    } _latency[uint8_t(AP_InertialSensor::FastRateStage::NUM_STAGES)];
+
+    // sample being tracked through the pipeline
+    uint32_t _latency_sample_us;
+    uint32_t _latency_stage_us;
+    bool _latency_active;
+
     /*
       binary semaphore for rate loop to use to start a rate loop when
       we hav finished filtering the primary IMU
      */
-    ObjectBuffer<Vector3f> _rate_loop_gyro_window{AP_INERTIAL_SENSOR_RATE_LOOP_BUFFER_SIZE};
+    ObjectBuffer<GyroSample> _rate_loop_gyro_window{AP_INERTIAL_SENSOR_RATE_LOOP_BUFFER_SIZE};
     uint8_t rate_decimation; // 0 means off
     uint8_t rate_decimation_count;
     HAL_BinarySemaphore _notifier;
@@ -0,0 +1,151 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*
+  dedicated gyro filter thread
+
+  Normally the harmonic notch and low pass gyro filters are run on the
+  sensor bus thread as part of _notify_new_gyro_raw_sample(). On
+  multi-core Linux boards this thread lets the bus threads do nothing
+  but read the sensor FIFOs, with the filters run on a high priority
+  thread pinned to its own core. Raw samples are passed through one
+  lock-free queue per gyro, so each queue has a single producer.
+ */
+
+#include "AP_InertialSensor.h"
+#include "AP_InertialSensor_Backend.h"
+
+#if AP_INERTIALSENSOR_FILTER_THREAD_ENABLED
+
+#include <AP_Scheduler/AP_Scheduler.h>
+#include <pthread.h>
+#include <sched.h>
+
+// number of raw samples that can be queued for each gyro
+#ifndef AP_INERTIALSENSOR_FILTER_QUEUE_LENGTH
+#define AP_INERTIALSENSOR_FILTER_QUEUE_LENGTH 32
+#endif
+
+extern const AP_HAL::HAL& hal;
+
+// start the filter thread if enabled
+void AP_InertialSensor::start_filter_thread()
+{
+    if (_filter_thread_cpu < 0 || _filter_thread_running) {
+        return;
+    }
+    for (uint8_t i=0; i<_gyro_count; i++) {
+        _filter_queue[i] = NEW_NOTHROW ObjectBuffer<FilterSample>(AP_INERTIALSENSOR_FILTER_QUEUE_LENGTH);
+        if (_filter_queue[i] == nullptr || _filter_queue[i]->get_size() == 0) {
+            DEV_PRINTF("INS: failed to allocate filter queue\n");
+            free_filter_queues();
+            return;
+        }
+    }
+    if (!hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&AP_InertialSensor::filter_thread, void),
+                                      "ins_filter", 2048, AP_HAL::Scheduler::PRIORITY_SPI, 1)) {
+        DEV_PRINTF("INS: failed to start filter thread\n");
+        free_filter_queues();
+    }
+}
+
+/*
+  free the filter queues when the filter thread can't be started. The
+  thread is not running so the gyros are filtered inline
+ */
+void AP_InertialSensor::free_filter_queues()
+{
+    for (uint8_t i=0; i<INS_MAX_INSTANCES; i++) {
+        delete _filter_queue[i];
+        _filter_queue[i] = nullptr;
+    }
+}
+
+/*
+  queue a raw gyro sample for the filter thread. Called from the
+  sensor bus thread with the backend semaphore held
+ */
+bool AP_InertialSensor::push_filter_thread_sample(AP_InertialSensor_Backend *backend, uint8_t instance, const Vector3f &gyro, uint64_t sample_us)
+{
+    if (!_filter_thread_running || instance >= INS_MAX_INSTANCES || _filter_queue[instance] == nullptr) {
+        return false;
+    }
+    _filter_backend[instance] = backend;
+    const FilterSample sample {
+        gyro : gyro,
+        sample_us : sample_us,
+    };
+    if (!_filter_queue[instance]->push(sample)) {
+        // the filter thread is not keeping up
+        AP_Scheduler *scheduler = AP_Scheduler::get_singleton();
+        if (scheduler != nullptr) {
+            scheduler->perf_info.offload_dropped();
+        }
+    }
+    _filter_notify.signal();
+    return true;
+}
+
+void AP_InertialSensor::filter_thread()
+{
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(_filter_thread_cpu.get(), &cpu_set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0) {
+        DEV_PRINTF("INS: failed to pin filter thread to CPU %d\n", int(_filter_thread_cpu.get()));
+    }
+
+    _filter_thread_running = true;
+
+    AP_Scheduler *scheduler = AP_Scheduler::get_singleton();
+
+    while (true) {
+        _filter_notify.wait_blocking();
+
+        for (uint8_t i=0; i<INS_MAX_INSTANCES; i++) {
+            if (_filter_queue[i] == nullptr || _filter_backend[i] == nullptr) {
+                continue;
+            }
+            FilterSample sample;
+            while (_filter_queue[i]->pop(sample)) {
+                const uint32_t start_us = AP_HAL::micros();
+                _filter_backend[i]->filter_queued_gyro(i, sample.gyro, sample.sample_us);
+                if (scheduler != nullptr) {
+                    scheduler->perf_info.update_offload_time(AP_HAL::micros() - start_us);
+                }
+            }
+        }
+    }
+}
+
+// apply gyro filters to a sample queued for the filter thread
+void AP_InertialSensor_Backend::filter_queued_gyro(uint8_t instance, const Vector3f &gyro, uint64_t sample_us)
+{
+    Vector3f gyro_filtered;
+    {
+        WITH_SEMAPHORE(_sem);
+
+        // apply gyro filters and sample for FFT
+        apply_gyro_filters(instance, gyro, sample_us);
+
+        _imu._new_gyro_data[instance] = true;
+        gyro_filtered = _imu._gyro_filtered[instance];
+    }
+
+    // logged here rather than by the bus thread so the filtered value
+    // is the one for this sample
+    log_gyro_raw(instance, sample_us, gyro, gyro_filtered);
+}
+
+#endif  // AP_INERTIALSENSOR_FILTER_THREAD_ENABLED
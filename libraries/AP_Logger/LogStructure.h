@@ -546,6 +546,19 @@ struct PACKED log_Performance {
     uint64_t rtc;
 };
 
+struct PACKED log_SchedTrace {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint32_t tick;
+    uint32_t loop_start_us;
+    uint16_t loop_time_us;
+    uint16_t run_time_us;
+    uint16_t sched_overhead_us;
+    uint8_t tasks_run;
+    uint8_t longest_task;
+    uint16_t longest_task_us;
+};
+
 struct PACKED log_SRTL {
     LOG_PACKET_HEADER;
     uint64_t time_us;
@@ -880,6 +893,18 @@ struct PACKED log_VER {
 // @Field: Ex: number of microseconds being added to each loop to address scheduler overruns
 // @Field: R: RTC time, time since Unix epoch
 
+// @LoggerMessage: SCHT
+// @Description: Scheduler tick trace, written from a ring buffer of recent ticks when a long loop is detected
+// @Field: TimeUS: Time since system startup
+// @Field: Tick: Scheduler tick number
+// @Field: LStart: Loop start time in microseconds
+// @Field: LoopT: Time since the start of the previous loop
+// @Field: RunT: Time spent running scheduler tasks
+// @Field: Ovh: Time spent in the scheduler outside of tasks
+// @Field: NRun: Number of tasks run in this tick
+// @Field: LTsk: Index of the longest running task in this tick
+// @Field: LTskT: Run time of the longest running task in this tick
+
 // @LoggerMessage: POWR
 // @Description: System power information
 // @Field: TimeUS: Time since system startup
@@ -1192,6 +1217,8 @@ LOG_STRUCTURE_FROM_MOUNT \
     LOG_STRUCTURE_FROM_PROXIMITY                                    \
     { LOG_PERFORMANCE_MSG, sizeof(log_Performance),                     \
       "PM",  "QHHHIIHHIIIIIIQ", "TimeUS,LR,NLon,NL,MaxT,Mem,Load,ErrL,InE,ErC,SPIC,I2CC,I2CI,Ex,R", "sz---b%------ss", "F----0A------FF" }, \
+    { LOG_SCHED_TRACE_MSG, sizeof(log_SchedTrace),                      \
+      "SCHT", "QIIHHHBBH", "TimeUS,Tick,LStart,LoopT,RunT,Ovh,NRun,LTsk,LTskT", "s-ssss--s", "F-FFFF--F" }, \
     { LOG_SRTL_MSG, sizeof(log_SRTL), \
       "SRTL", "QBHHBfff", "TimeUS,Active,NumPts,MaxPts,Action,N,E,D", "s----mmm", "F----000" }, \
 LOG_STRUCTURE_FROM_AVOIDANCE \
@@ -1346,6 +1373,7 @@ enum LogMessages : uint8_t {
     LOG_RCOUT3_MSG,
     LOG_IDS_FROM_FENCE,
     LOG_IDS_FROM_HAL,
+    LOG_SCHED_TRACE_MSG,
 
     _LOG_LAST_MSG_
 };
@@ -51,6 +51,7 @@ void SCurve::init()
     vel_max = 0.0f;
     time = 0.0f;
     num_segs = SEG_INIT;
+    seg_cursor = SEG_INIT;
     add_segment(num_segs, 0.0f, SegmentType::CONSTANT_JERK, 0.0f, 0.0f, 0.0f, 0.0f);
     track.zero();
     delta_unit.zero();
@@ -643,15 +644,20 @@ void SCurve::get_jerk_accel_vel_pos_at_time(float time_now, float &Jt_out, float
     }
 
     SegmentType Jtype;
-    uint8_t pnt = num_segs;
     float Jm, tj, T0, A0, V0, P0;
 
-    // find active segment at time_now
-    for (uint8_t i = 0; i < num_segs; i++) {
-        if (time_now < segment[num_segs - 1 - i].end_time) {
-            pnt = num_segs - 1 - i;
-        }
+    // find active segment at time_now, the first segment ending after
+    // time_now. Segment end times never decrease and time normally only
+    // moves forward a little between calls, so start from the segment
+    // found last time rather than searching the whole table
+    uint8_t pnt = MIN(seg_cursor, num_segs);
+    while (pnt > 0 && time_now < segment[pnt - 1].end_time) {
+        pnt--;
+    }
+    while (pnt < num_segs && !(time_now < segment[pnt].end_time)) {
+        pnt++;
     }
+    seg_cursor = pnt;
     if (pnt == 0) {
         Jtype = SegmentType::CONSTANT_JERK;
         Jm = 0.0f;
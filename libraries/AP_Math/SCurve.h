@@ -210,6 +210,7 @@ private:
     const static uint8_t segments_max = 23; // maximum number of time segments
 
     uint8_t num_segs;       // number of time segments being used
+    mutable uint8_t seg_cursor; // segment found by the last time lookup, only a hint
     struct {
         float jerk_ref;     // jerk reference value for time segment (the jerk at the beginning, middle or end depending upon the segment type)
         SegmentType seg_type;   // segment type (jerk is constant, increasing or decreasing)
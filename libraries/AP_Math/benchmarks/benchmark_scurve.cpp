@@ -0,0 +1,57 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/SCurve.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  per-tick cost of following a 3-leg corner at 400Hz, stepping the
+  legs the way AC_WPNav does when passing through a fast waypoint
+ */
+static void BM_SCurveCorner(benchmark::State& state)
+{
+    const Vector3f wp[] {
+        Vector3f(0.0f, 0.0f, 0.0f),
+        Vector3f(100.0f, 0.0f, 10.0f),
+        Vector3f(100.0f, 100.0f, 10.0f),
+        Vector3f(0.0f, 100.0f, 0.0f),
+    };
+    const uint8_t num_wp = ARRAY_SIZE(wp);
+    const float dt = 0.0025f;
+
+    SCurve prev_leg, this_leg, next_leg;
+    uint8_t leg = 0;
+
+    while (state.KeepRunning()) {
+        if (leg == 0) {
+            prev_leg.init();
+            this_leg.calculate_track(wp[0], wp[1], 10.0f, 2.5f, 1.5f, 2.5f, 1.0f, 50.0f, 5.0f);
+            next_leg.calculate_track(wp[1], wp[2], 10.0f, 2.5f, 1.5f, 2.5f, 1.0f, 50.0f, 5.0f);
+            leg = 1;
+        }
+        Vector3f target_pos = wp[leg-1];
+        Vector3f target_vel, target_accel;
+        const bool finished = this_leg.advance_target_along_track(prev_leg, next_leg, 2.0f, 5.0f, true, dt, target_pos, target_vel, target_accel);
+        gbenchmark_escape(&target_pos);
+        gbenchmark_escape(&target_vel);
+        gbenchmark_escape(&target_accel);
+        if (finished) {
+            prev_leg = this_leg;
+            this_leg = next_leg;
+            leg++;
+            if (leg + 1 < num_wp) {
+                next_leg.calculate_track(wp[leg], wp[leg+1], 10.0f, 2.5f, 1.5f, 2.5f, 1.0f, 50.0f, 5.0f);
+            } else if (leg < num_wp) {
+                next_leg.init();
+            } else {
+                // start the corner again
+                leg = 0;
+            }
+        }
+    }
+}
+
+BENCHMARK(BM_SCurveCorner);
+
+BENCHMARK_MAIN();
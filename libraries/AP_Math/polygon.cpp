@@ -27,6 +27,46 @@
  */
 
 
+/*
+ *  Polygon_edge_crossing(): test if the polygon edge from A to B is
+ *  crossed by the ray Polygon_outside() casts from P, so that callers
+ *  which only look at some of the edges get the same result
+ */
+template <typename T>
+bool Polygon_edge_crossing(const Vector2<T> &P, const Vector2<T> &A, const Vector2<T> &B)
+{
+    if ((A.y > P.y) == (B.y > P.y)) {
+        return false;
+    }
+    const T dx1 = P.x - A.x;
+    const T dx2 = B.x - A.x;
+    const T dy1 = P.y - A.y;
+    const T dy2 = B.y - A.y;
+    const int8_t dx1s = (dx1 < 0) ? -1 : 1;
+    const int8_t dx2s = (dx2 < 0) ? -1 : 1;
+    const int8_t dy1s = (dy1 < 0) ? -1 : 1;
+    const int8_t dy2s = (dy2 < 0) ? -1 : 1;
+    const int8_t m1 = dx1s * dy2s;
+    const int8_t m2 = dx2s * dy1s;
+    // we avoid the 64 bit multiplies if we can based on sign checks.
+    if (dy2 < 0) {
+        if (m1 != m2) {
+            return m1 > m2;
+        }
+        if (std::is_floating_point<T>::value) {
+            return dx1 * dy2 > dx2 * dy1;
+        }
+        return dx1 * (int64_t)dy2 > dx2 * (int64_t)dy1;
+    }
+    if (m1 != m2) {
+        return m1 < m2;
+    }
+    if (std::is_floating_point<T>::value) {
+        return dx1 * dy2 < dx2 * dy1;
+    }
+    return dx1 * (int64_t)dy2 < dx2 * (int64_t)dy1;
+}
+
 /*
  *  Polygon_outside(): test for a point in a polygon
  *     Input:   P = a point,
@@ -55,52 +95,8 @@ bool Polygon_outside(const Vector2<T> &P, const Vector2<T> *V, unsigned n)
         if (j >= n) {
             j = 0;
         }
-        if ((V[i].y > P.y) == (V[j].y > P.y)) {
-            continue;
-        }
-        const T dx1 = P.x - V[i].x;
-        const T dx2 = V[j].x - V[i].x;
-        const T dy1 = P.y - V[i].y;
-        const T dy2 = V[j].y - V[i].y;
-        const int8_t dx1s = (dx1 < 0) ? -1 : 1;
-        const int8_t dx2s = (dx2 < 0) ? -1 : 1;
-        const int8_t dy1s = (dy1 < 0) ? -1 : 1;
-        const int8_t dy2s = (dy2 < 0) ? -1 : 1;
-        const int8_t m1 = dx1s * dy2s;
-        const int8_t m2 = dx2s * dy1s;
-        // we avoid the 64 bit multiplies if we can based on sign checks.
-        if (dy2 < 0) {
-            if (m1 > m2) {
-                outside = !outside;
-            } else if (m1 < m2) {
-                continue;
-            } else {
-                if (std::is_floating_point<T>::value) {
-                    if ( dx1 * dy2 > dx2 * dy1 ) {
-                        outside = !outside;
-                    }
-                } else {
-                    if ( dx1 * (int64_t)dy2 > dx2 * (int64_t)dy1 ) {
-                        outside = !outside;
-                    }
-                }
-            }
-        } else {
-            if (m1 < m2) {
-                outside = !outside;
-            } else if (m1 > m2) {
-                continue;
-            } else {
-                if (std::is_floating_point<T>::value) {
-                    if ( dx1 * dy2 < dx2 * dy1 ) {
-                        outside = !outside;
-                    }
-                } else {
-                    if ( dx1 * (int64_t)dy2 < dx2 * (int64_t)dy1 ) {
-                        outside = !outside;
-                    }
-                }
-            }
+        if (Polygon_edge_crossing(P, V[i], V[j])) {
+            outside = !outside;
         }
     }
     return outside;
@@ -121,8 +117,10 @@ bool Polygon_complete(const Vector2<T> *V, unsigned n)
 
 // Necessary to avoid linker errors
 template bool Polygon_outside<int32_t>(const Vector2l &P, const Vector2l *V, unsigned n);
+template bool Polygon_edge_crossing<int32_t>(const Vector2l &P, const Vector2l &A, const Vector2l &B);
 template bool Polygon_complete<int32_t>(const Vector2l *V, unsigned n);
 template bool Polygon_outside<float>(const Vector2f &P, const Vector2f *V, unsigned n);
+template bool Polygon_edge_crossing<float>(const Vector2f &P, const Vector2f &A, const Vector2f &B);
 template bool Polygon_complete<float>(const Vector2f *V, unsigned n);
 
 /*
@@ -17,6 +17,32 @@ TEST(LinesScurve, test_calculate_path)
     EXPECT_FLOAT_EQ(t6_out, 0.25000018);
 }
 
+TEST(LinesScurve, test_advance_to_destination)
+{
+    // follow a straight leg to the end, checking the target moves
+    // forward smoothly and stops at the destination
+    const Vector3f origin(0.0f, 0.0f, 0.0f);
+    const Vector3f destination(50.0f, 20.0f, 5.0f);
+    SCurve prev_leg, leg, next_leg;
+    leg.calculate_track(origin, destination, 10.0f, 2.5f, 1.5f, 2.5f, 1.0f, 50.0f, 5.0f);
+
+    float last_dist = 0.0f;
+    bool finished = false;
+    Vector3f target_pos, target_vel, target_accel;
+    for (uint32_t i = 0; i < 400 * 60 && !finished; i++) {
+        target_pos = origin;
+        target_vel.zero();
+        target_accel.zero();
+        finished = leg.advance_target_along_track(prev_leg, next_leg, 2.0f, 5.0f, false, 0.0025f, target_pos, target_vel, target_accel);
+        const float dist = (target_pos - origin).length();
+        EXPECT_GE(dist, last_dist - 0.001f);
+        EXPECT_LT(dist - last_dist, 10.0f * 0.0025f * 1.01f);
+        last_dist = dist;
+    }
+    EXPECT_TRUE(finished);
+    EXPECT_NEAR((target_pos - destination).length(), 0.0f, 0.01f);
+    EXPECT_NEAR(target_vel.length(), 0.0f, 0.01f);
+}
 
 AP_GTEST_MAIN()
 int hal = 0; //weirdly the build will fail without this
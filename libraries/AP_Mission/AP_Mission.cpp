@@ -46,6 +46,17 @@ const AP_Param::GroupInfo AP_Mission::var_info[] = {
     // @User: Advanced
     AP_GROUPINFO("OPTIONS",  2, AP_Mission, _options, AP_MISSION_OPTIONS_DEFAULT),
 
+#if AP_MISSION_CACHE_ENABLED
+    // @Param: CACHE
+    // @DisplayName: Mission command cache size
+    // @Description: Number of decoded mission commands to keep in RAM. Cached commands are not decoded from storage again each time they are read, and the search for the next navigation command skips over cached DO commands. Each cached command uses RAM for a full decoded command. 0 disables the cache.
+    // @Range: 0 1000
+    // @Increment: 1
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("CACHE",  3, AP_Mission, _cache_size, AP_MISSION_CACHE_DEFAULT),
+#endif
+
     AP_GROUPEND
 };
 
@@ -88,6 +99,10 @@ void AP_Mission::init()
     }
 
 
+#if AP_MISSION_CACHE_ENABLED
+    cache_init();
+#endif
+
     // check_eeprom_version - checks version of missions stored in eeprom matches this library
     // command list will be cleared if they do not match
     check_eeprom_version();
@@ -302,6 +317,10 @@ void AP_Mission::truncate(uint16_t index)
     if ((unsigned)_cmd_total > index) {
         _cmd_total.set_and_save(index);
         _last_change_time_ms = AP_HAL::millis();
+#if AP_MISSION_CACHE_ENABLED
+        WITH_SEMAPHORE(_rsem);
+        _next_nav_index_valid = false;
+#endif
     }
 }
 
@@ -553,6 +572,14 @@ bool AP_Mission::get_next_nav_cmd(uint16_t start_index, Mission_Command& cmd)
 {
     // search until the end of the mission command list
     for (uint16_t cmd_index = start_index; cmd_index < (unsigned)_cmd_total; cmd_index++) {
+#if AP_MISSION_CACHE_ENABLED
+        // DO commands would be returned and rejected one at a time
+        // below, so skip straight over them
+        cmd_index = next_nav_or_jump_index(cmd_index);
+        if (cmd_index >= (unsigned)_cmd_total) {
+            break;
+        }
+#endif
         // get next command
         if (!get_next_cmd(cmd_index, cmd, false)) {
             // no more commands so return failure
@@ -832,6 +859,13 @@ bool AP_Mission::read_cmd_from_storage(uint16_t index, Mission_Command& cmd) con
         return false;
     }
 
+#if AP_MISSION_CACHE_ENABLED
+    if (index < _cache_count && _cache[index].index == index) {
+        cmd = _cache[index];
+        return true;
+    }
+#endif
+
     // ensure all bytes of cmd are zeroed
     cmd = {};
 
@@ -890,6 +924,12 @@ bool AP_Mission::read_cmd_from_storage(uint16_t index, Mission_Command& cmd) con
     // set command's index to it's position in eeprom
     cmd.index = index;
 
+#if AP_MISSION_CACHE_ENABLED
+    if (index < _cache_count) {
+        _cache[index] = cmd;
+    }
+#endif
+
     // return success
     return true;
 }
@@ -978,6 +1018,10 @@ bool AP_Mission::write_cmd_to_storage(uint16_t index, const Mission_Command& cmd
         _storage.write_block(pos_in_storage+5, packed.bytes, 10);
     }
 
+#if AP_MISSION_CACHE_ENABLED
+    cache_invalidate(index);
+#endif
+
     // remember when the mission last changed
     if (index != 0) {
         // Update of home location is not a true change
@@ -1003,6 +1047,73 @@ void AP_Mission::write_home_to_storage()
     }
 }
 
+#if AP_MISSION_CACHE_ENABLED
+/// cache_init - allocate the decoded command cache and next navigation command index
+void AP_Mission::cache_init()
+{
+    if (_cache != nullptr) {
+        // already allocated by an earlier init(), writes keep it valid
+        return;
+    }
+    const uint16_t count = MIN(uint16_t(MAX(_cache_size.get(), 0)), _commands_max);
+    if (count == 0) {
+        return;
+    }
+    _cache = NEW_NOTHROW Mission_Command[count];
+    _next_nav_index = NEW_NOTHROW uint16_t[count];
+    if (_cache == nullptr || _next_nav_index == nullptr) {
+        delete[] _cache;
+        delete[] _next_nav_index;
+        _cache = nullptr;
+        _next_nav_index = nullptr;
+        GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "Mission: cache allocation failed");
+        return;
+    }
+    for (uint16_t i=0; i<count; i++) {
+        _cache[i].index = AP_MISSION_CMD_INDEX_NONE;
+    }
+    _cache_count = count;
+}
+
+/// cache_invalidate - forget the cached copy of a command after it is written
+void AP_Mission::cache_invalidate(uint16_t index)
+{
+    WITH_SEMAPHORE(_rsem);
+    if (index < _cache_count) {
+        _cache[index].index = AP_MISSION_CMD_INDEX_NONE;
+    }
+    _next_nav_index_valid = false;
+}
+
+/// next_nav_or_jump_index - returns the first index at or after index holding a navigation or jump command
+///     indexes past the cached commands are returned unchanged
+uint16_t AP_Mission::next_nav_or_jump_index(uint16_t index)
+{
+    WITH_SEMAPHORE(_rsem);
+
+    if (!_next_nav_index_valid) {
+        _next_nav_index_count = MIN(_cache_count, uint16_t(_cmd_total));
+        uint16_t next = _next_nav_index_count;
+        for (int32_t i=_next_nav_index_count-1; i>=0; i--) {
+            Mission_Command tmp;
+            // home at index 0 is always a navigation command, and
+            // unreadable commands are left for get_next_cmd to reject
+            if (i == 0 || !read_cmd_from_storage(i, tmp) || is_nav_cmd(tmp) ||
+                tmp.id == MAV_CMD_DO_JUMP || tmp.id == MAV_CMD_DO_JUMP_TAG) {
+                next = i;
+            }
+            _next_nav_index[i] = next;
+        }
+        _next_nav_index_valid = true;
+    }
+
+    if (index >= _next_nav_index_count) {
+        return index;
+    }
+    return _next_nav_index[index];
+}
+#endif  // AP_MISSION_CACHE_ENABLED
+
 MAV_MISSION_RESULT AP_Mission::sanity_check_params(const mavlink_mission_item_int_t& packet)
 {
     uint8_t nan_mask;
@@ -2925,6 +3036,14 @@ const char *AP_Mission::Mission_Command::type() const
  */
 uint16_t AP_Mission::get_command_id(uint16_t index) const
 {
+#if AP_MISSION_CACHE_ENABLED
+    {
+        WITH_SEMAPHORE(_rsem);
+        if (index < _cache_count && _cache[index].index == index) {
+            return _cache[index].id;
+        }
+    }
+#endif
     const uint16_t pos_in_storage = 4 + (index * AP_MISSION_EEPROM_COMMAND_SIZE);
     uint8_t b[3] {};
     if (!_storage.read_block(b, pos_in_storage, sizeof(b))) {
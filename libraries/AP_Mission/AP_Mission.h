@@ -898,6 +898,9 @@ private:
     AP_Int16                _cmd_total;  // total number of commands in the mission
     AP_Int16                _options;    // bitmask options for missions, currently for mission clearing on reboot but can be expanded as required
     AP_Int8                 _restart;   // controls mission starting point when entering Auto mode (either restart from beginning of mission or resume from last command run)
+#if AP_MISSION_CACHE_ENABLED
+    AP_Int16                _cache_size;    // number of decoded commands to keep in RAM
+#endif
 
     // internal variables
     bool                    _force_resume;  // when set true it forces mission to resume irrespective of MIS_RESTART param.
@@ -930,6 +933,23 @@ private:
     // fast call to get command ID of a mission index
     uint16_t get_command_id(uint16_t index) const;
 
+#if AP_MISSION_CACHE_ENABLED
+    // decoded commands, indexed by mission index. An entry is valid
+    // when its index field matches its position in the cache
+    mutable Mission_Command *_cache;
+    uint16_t _cache_count;
+    // for each cached position, the index of the next navigation or
+    // jump command at or after it. Rebuilt after the mission changes
+    uint16_t *_next_nav_index;
+    uint16_t _next_nav_index_count;
+    bool _next_nav_index_valid;
+    void cache_init();
+    void cache_invalidate(uint16_t index);
+    // return the first index at or after index which may hold a
+    // navigation command once jumps are followed
+    uint16_t next_nav_or_jump_index(uint16_t index);
+#endif
+
     // memoisation of contains-relative:
     bool _contains_terrain_alt_items;  // true if the mission has terrain-relative items
     uint32_t _last_contains_relative_calculated_ms;  // will be equal to _last_change_time_ms if _contains_terrain_alt_items is up-to-date
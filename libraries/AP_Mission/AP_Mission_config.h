@@ -7,3 +7,12 @@
 #ifndef AP_MISSION_NAV_PAYLOAD_PLACE_ENABLED
 #define AP_MISSION_NAV_PAYLOAD_PLACE_ENABLED 1
 #endif
+
+// keep decoded mission commands in RAM, sized by MIS_CACHE
+#ifndef AP_MISSION_CACHE_ENABLED
+#define AP_MISSION_CACHE_ENABLED (HAL_PROGRAM_SIZE_LIMIT_KB > 1024)
+#endif
+
+#ifndef AP_MISSION_CACHE_DEFAULT
+#define AP_MISSION_CACHE_DEFAULT 0
+#endif
@@ -51,6 +51,7 @@ private:
     void run_set_current_cmd_while_stopped_test();
     void run_replace_cmd_test();
     void run_max_cmd_test();
+    void run_read_timing_test();
 
     AP_Mission mission{
             FUNCTOR_BIND_MEMBER(&MissionTest::start_cmd, bool, const AP_Mission::Mission_Command &),
@@ -1323,6 +1324,62 @@ void MissionTest::run_max_cmd_test()
     }
 }
 
+// run_read_timing_test - times reading a 700 item mission and searching it for
+//  navigation commands.  Build with -DAP_MISSION_CACHE_DEFAULT=700 to time it
+//  with the decoded command cache enabled
+void MissionTest::run_read_timing_test()
+{
+    const uint16_t num_items = 700;
+    AP_Mission::Mission_Command cmd;
+
+    mission.init();
+    mission.clear();
+    if (mission.num_commands_max() < num_items) {
+        hal.console->printf("storage only holds %u commands\n", (unsigned int)mission.num_commands_max());
+        return;
+    }
+
+    // waypoints, each followed by three "do" commands
+    for (uint16_t i=0; i<num_items; i++) {
+        cmd = {};
+        if (i % 4 == 0) {
+            cmd.id = MAV_CMD_NAV_WAYPOINT;
+            cmd.content.location = Location{
+                12345678 + i,
+                23456789,
+                100,
+                Location::AltFrame::ABOVE_HOME
+            };
+        } else {
+            cmd.id = MAV_CMD_DO_SET_SERVO;
+            cmd.content.servo.channel = 5;
+            cmd.content.servo.pwm = 1500;
+        }
+        if (!mission.add_cmd(cmd)) {
+            hal.console->printf("failed to add command #%u\n", (unsigned int)i);
+            return;
+        }
+    }
+
+    // the second pass is served from the cache when it is enabled
+    for (uint8_t pass=0; pass<2; pass++) {
+        const uint32_t start_us = AP_HAL::micros();
+        for (uint16_t i=0; i<mission.num_commands(); i++) {
+            mission.read_cmd_from_storage(i, cmd);
+        }
+        hal.console->printf("read %u commands: %luus\n",
+                            (unsigned int)mission.num_commands(),
+                            (unsigned long)(AP_HAL::micros() - start_us));
+    }
+
+    const uint32_t start_us = AP_HAL::micros();
+    for (uint16_t i=0; i<mission.num_commands(); i++) {
+        mission.get_next_nav_cmd(i, cmd);
+    }
+    hal.console->printf("next nav command from every index: %luus\n",
+                        (unsigned long)(AP_HAL::micros() - start_us));
+}
+
 // setup
 void MissionTest::setup(void)
 {
@@ -1342,6 +1399,9 @@ void MissionTest::loop(void)
     // uncomment line below to run the mission pause/resume test
     //run_resume_test();
 
+    // uncomment line below to time reading a large mission
+    //run_read_timing_test();
+
     // wait forever
     while(true) {
         hal.scheduler->delay(1000);
@@ -152,6 +152,11 @@ public:
      */
     bool sendfile(SocketAPM *sock, int fd);
 
+#if AP_NETWORKING_REGISTER_PORT_ENABLED
+    // display network port statistics
+    void ports_info(class ExpandingString &str);
+#endif
+
     static const struct AP_Param::GroupInfo var_info[];
 
     enum class OPTION {
@@ -164,6 +169,7 @@ public:
         CAN2_MCAST_BRIDGED=(1U<<4),
 #endif
 #endif
+        PORTS_EVENT_LOOP=(1U<<5),
     };
     bool option_is_set(OPTION option) const {
         return (param.options.get() & int32_t(option)) != 0;
@@ -224,6 +230,7 @@ private:
 #if AP_NETWORKING_REGISTER_PORT_ENABLED
     // class for NET_Pn_* parameters
     class Port : public AP_SerialManager::RegisteredPort {
+        friend class AP_Networking;
     public:
         /* Do not allow copies */
         CLASS_NO_COPY(Port);
@@ -249,16 +256,23 @@ private:
         void tcp_server_init(void);
         void tcp_client_init(void);
 
-        void udp_client_loop(void);
-        void udp_server_loop(void);
-        void tcp_client_loop(void);
-        void tcp_server_loop(void);
+        // thread for a single port
+        void port_loop(void);
+
+        // open the sockets once the network is up
+        bool start(void);
+
+        // one update of a started port, returns true if data was transferred
+        bool update(void);
 
         bool send_receive(void);
 
     private:
         bool init_buffers(const uint32_t size_rx, const uint32_t size_tx);
         void thread_create(AP_HAL::MemberProc);
+        void tcp_server_accept(void);
+        void tcp_client_connect(void);
+        bool tx_waiting(void);
 
         uint32_t txspace() override;
         void _begin(uint32_t b, uint16_t rxS, uint16_t txS) override;
@@ -288,9 +302,22 @@ private:
         bool close_on_recv_error;
         uint32_t last_udp_srv_recv_time_ms;
 
-        // statistics
+        // true if serviced by the shared port thread
+        bool event_loop;
+
+        // non-blocking TCP client connect in the shared port thread
+        bool connecting;
+        uint32_t connect_start_ms;
+
+        // max bytes per recv() or send(), and the buffer for them
+        uint16_t io_chunk = 300;
+        uint8_t *io_buf;
+
+        // statistics. A wakeup is a pass of the port's own thread, or
+        // the shared port thread servicing this port
         uint32_t tx_stats_bytes;
         uint32_t rx_stats_bytes;
+        uint32_t stats_wakeups;
 
         HAL_Semaphore sem;
 
@@ -344,6 +371,11 @@ private:
     bool sendfile_thread_started;
 
     void ports_init(void);
+
+#if AP_NETWORKING_REGISTER_PORT_ENABLED
+    // shared thread for all ports with the PORTS_EVENT_LOOP option
+    void ports_event_loop(void);
+#endif
 };
 
 namespace AP
@@ -13,6 +13,7 @@
 #include <AP_Math/AP_Math.h>
 #include <AP_SerialManager/AP_SerialManager.h>
 #include <AP_HAL/utility/packetise.h>
+#include <AP_Common/ExpandingString.h>
 #include <errno.h>
 
 extern const AP_HAL::HAL& hal;
@@ -29,6 +30,31 @@ extern const AP_HAL::HAL& hal;
 #define AP_NETWORKING_PORT_STACK_SIZE 1024
 #endif
 
+// settings for the shared port thread
+#ifndef AP_NETWORKING_PORT_EVENT_STACK_SIZE
+#define AP_NETWORKING_PORT_EVENT_STACK_SIZE 4096
+#endif
+
+// max bytes per recv() or send() call
+#ifndef AP_NETWORKING_PORT_EVENT_CHUNK
+#define AP_NETWORKING_PORT_EVENT_CHUNK 1024
+#endif
+
+// max updates of one port per wakeup
+#ifndef AP_NETWORKING_PORT_EVENT_BATCH
+#define AP_NETWORKING_PORT_EVENT_BATCH 8
+#endif
+
+// max time to sleep waiting for input
+#ifndef AP_NETWORKING_PORT_EVENT_TIMEOUT_US
+#define AP_NETWORKING_PORT_EVENT_TIMEOUT_US 1000
+#endif
+
+// time to wait for a non-blocking TCP client connect
+#ifndef AP_NETWORKING_PORT_EVENT_CONNECT_MS
+#define AP_NETWORKING_PORT_EVENT_CONNECT_MS 2000
+#endif
+
 const AP_Param::GroupInfo AP_Networking::Port::var_info[] = {
     // @Param: TYPE
     // @DisplayName: Port type
@@ -67,6 +93,7 @@ const AP_Param::GroupInfo AP_Networking::Port::var_info[] = {
  */
 void AP_Networking::ports_init(void)
 {
+    bool need_event_loop = false;
     for (uint8_t i=0; i<ARRAY_SIZE(ports); i++) {
         auto &p = ports[i];
         NetworkPortType ptype = (NetworkPortType)p.type;
@@ -89,8 +116,17 @@ void AP_Networking::ports_init(void)
         }
         if (p.sock != nullptr || p.listen_sock != nullptr) {
             AP::serialmanager().register_port(&p);
+            if (p.event_loop) {
+                need_event_loop = true;
+            }
         }
     }
+
+    if (need_event_loop &&
+        !hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&AP_Networking::ports_event_loop, void),
+                                      "NET_PORTS", AP_NETWORKING_PORT_EVENT_STACK_SIZE, AP_HAL::Scheduler::PRIORITY_UART, 0)) {
+        AP_BoardConfig::allocation_error("Failed to allocate NET_PORTS thread");
+    }
 }
 
 /*
@@ -106,6 +142,22 @@ void AP_Networking::Port::thread_create(AP_HAL::MemberProc proc)
         return;
     }
 
+    const bool use_event_loop = AP::network().option_is_set(OPTION::PORTS_EVENT_LOOP);
+    if (use_event_loop) {
+        io_chunk = AP_NETWORKING_PORT_EVENT_CHUNK;
+    }
+    io_buf = NEW_NOTHROW uint8_t[io_chunk];
+    if (io_buf == nullptr) {
+        AP_BoardConfig::allocation_error("Failed to allocate %s buffers", thread_name);
+        return;
+    }
+
+    if (use_event_loop) {
+        // serviced by the shared port thread
+        event_loop = true;
+        return;
+    }
+
     if (!hal.scheduler->thread_create(proc, thread_name, AP_NETWORKING_PORT_STACK_SIZE, AP_HAL::Scheduler::PRIORITY_UART, 0)) {
         AP_BoardConfig::allocation_error("Failed to allocate %s client thread", thread_name);
     }
@@ -126,7 +178,7 @@ void AP_Networking::Port::udp_client_init(void)
     packetise = (state.protocol == AP_SerialManager::SerialProtocol_MAVLink ||
                  state.protocol == AP_SerialManager::SerialProtocol_MAVLink2);
 
-    thread_create(FUNCTOR_BIND_MEMBER(&AP_Networking::Port::udp_client_loop, void));
+    thread_create(FUNCTOR_BIND_MEMBER(&AP_Networking::Port::port_loop, void));
 }
 
 /*
@@ -144,7 +196,7 @@ void AP_Networking::Port::udp_server_init(void)
     packetise = (state.protocol == AP_SerialManager::SerialProtocol_MAVLink ||
                  state.protocol == AP_SerialManager::SerialProtocol_MAVLink2);
 
-    thread_create(FUNCTOR_BIND_MEMBER(&AP_Networking::Port::udp_server_loop, void));
+    thread_create(FUNCTOR_BIND_MEMBER(&AP_Networking::Port::port_loop, void));
 }
 
 /*
@@ -158,7 +210,7 @@ void AP_Networking::Port::tcp_server_init(void)
     }
     listen_sock->reuseaddress();
 
-    thread_create(FUNCTOR_BIND_MEMBER(&AP_Networking::Port::tcp_server_loop, void));
+    thread_create(FUNCTOR_BIND_MEMBER(&AP_Networking::Port::port_loop, void));
 }
 
 /*
@@ -169,147 +221,299 @@ void AP_Networking::Port::tcp_client_init(void)
     sock = NEW_NOTHROW SocketAPM(false);
     if (sock != nullptr) {
         sock->set_blocking(true);
-        thread_create(FUNCTOR_BIND_MEMBER(&AP_Networking::Port::tcp_client_loop, void));
+        thread_create(FUNCTOR_BIND_MEMBER(&AP_Networking::Port::port_loop, void));
     }
 }
 
 /*
-  update a UDP client
+  thread for a single port
  */
-void AP_Networking::Port::udp_client_loop(void)
+void AP_Networking::Port::port_loop(void)
 {
     AP::network().startup_wait();
 
-    const char *dest = ip.get_str();
-    if (!sock->connect(dest, port.get())) {
-        GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "UDP[%u]: Failed to connect to %s", (unsigned)state.idx, dest);
-        delete sock;
-        sock = nullptr;
+    if (!start()) {
         return;
     }
 
-    GCS_SEND_TEXT(MAV_SEVERITY_INFO, "UDP[%u]: connected to %s:%u", (unsigned)state.idx, dest, unsigned(port.get()));
-
-    connected = true;
-
     bool active = false;
     while (true) {
         if (!active) {
             hal.scheduler->delay_microseconds(100);
         }
-        active = send_receive();
+        stats_wakeups++;
+        active = update();
     }
 }
 
 /*
-  update a UDP server
+  connect or bind the sockets for a port once the network is up.
+  Returns false if the port could not be started
  */
-void AP_Networking::Port::udp_server_loop(void)
+bool AP_Networking::Port::start(void)
 {
-    AP::network().startup_wait();
-
-    const char *addr = ip.get_str();
-    if (!sock->bind(addr, port.get())) {
-        GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "UDP[%u]: Failed to bind to %s:%u", (unsigned)state.idx, addr, unsigned(port.get()));
-        delete sock;
-        sock = nullptr;
-        return;
+    switch ((NetworkPortType)type) {
+    case NetworkPortType::UDP_CLIENT: {
+        const char *dest = ip.get_str();
+        if (!sock->connect(dest, port.get())) {
+            GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "UDP[%u]: Failed to connect to %s", (unsigned)state.idx, dest);
+            delete sock;
+            sock = nullptr;
+            return false;
+        }
+        GCS_SEND_TEXT(MAV_SEVERITY_INFO, "UDP[%u]: connected to %s:%u", (unsigned)state.idx, dest, unsigned(port.get()));
+        connected = true;
+        break;
     }
-    sock->reuseaddress();
 
-    GCS_SEND_TEXT(MAV_SEVERITY_INFO, "UDP[%u]: bound to %s:%u", (unsigned)state.idx, addr, unsigned(port.get()));
+    case NetworkPortType::UDP_SERVER: {
+        const char *addr = ip.get_str();
+        if (!sock->bind(addr, port.get())) {
+            GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "UDP[%u]: Failed to bind to %s:%u", (unsigned)state.idx, addr, unsigned(port.get()));
+            delete sock;
+            sock = nullptr;
+            return false;
+        }
+        sock->reuseaddress();
+        GCS_SEND_TEXT(MAV_SEVERITY_INFO, "UDP[%u]: bound to %s:%u", (unsigned)state.idx, addr, unsigned(port.get()));
+        break;
+    }
 
-    bool active = false;
-    while (true) {
-        if (!active) {
-            hal.scheduler->delay_microseconds(100);
+    case NetworkPortType::TCP_SERVER: {
+        const char *addr = ip.get_str();
+        if (!listen_sock->bind(addr, port.get()) || !listen_sock->listen(1)) {
+            GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "TCP[%u]: Failed to bind to %s:%u", (unsigned)state.idx, addr, unsigned(port.get()));
+            delete listen_sock;
+            listen_sock = nullptr;
+            return false;
         }
-        active = send_receive();
+        GCS_SEND_TEXT(MAV_SEVERITY_INFO, "TCP[%u]: bound to %s:%u", (unsigned)state.idx, addr, unsigned(port.get()));
+        close_on_recv_error = true;
+        break;
     }
+
+    case NetworkPortType::TCP_CLIENT:
+        close_on_recv_error = true;
+        break;
+
+    case NetworkPortType::NONE:
+        return false;
+    }
+    return true;
 }
 
 /*
-  update a TCP server
+  accept a new connection on a TCP server
  */
-void AP_Networking::Port::tcp_server_loop(void)
+void AP_Networking::Port::tcp_server_accept(void)
 {
-    AP::network().startup_wait();
-
-    const char *addr = ip.get_str();
-    if (!listen_sock->bind(addr, port.get()) || !listen_sock->listen(1)) {
-        GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "TCP[%u]: Failed to bind to %s:%u", (unsigned)state.idx, addr, unsigned(port.get()));
-        delete listen_sock;
-        listen_sock = nullptr;
-        return;
+    // the event loop only calls us when a connection is pending
+    sock = listen_sock->accept(event_loop ? 0 : 100);
+    if (sock != nullptr) {
+        sock->set_blocking(false);
+        char buf[IP4_STR_LEN];
+        uint16_t last_port;
+        const char *last_addr = listen_sock->last_recv_address(buf, sizeof(buf), last_port);
+        if (last_addr != nullptr) {
+            GCS_SEND_TEXT(MAV_SEVERITY_INFO, "TCP[%u]: connection from %s:%u", (unsigned)state.idx, last_addr, unsigned(last_port));
+        }
+        connected = true;
+        sock->reuseaddress();
     }
+}
 
-    GCS_SEND_TEXT(MAV_SEVERITY_INFO, "TCP[%u]: bound to %s:%u", (unsigned)state.idx, addr, unsigned(port.get()));
-
-    close_on_recv_error = true;
-
-    bool active = false;
-    while (true) {
-        if (!active) {
-            hal.scheduler->delay_microseconds(100);
+/*
+  (re)connect a TCP client. In the shared port thread the connect is
+  non-blocking and is checked on each update, so a missing server
+  can't stall the other ports
+ */
+void AP_Networking::Port::tcp_client_connect(void)
+{
+    const char *dest = ip.get_str();
+    if (event_loop) {
+        const uint32_t now_ms = AP_HAL::millis();
+        if (sock != nullptr && connecting) {
+            if (!sock->connect_finish(0) &&
+                now_ms - connect_start_ms < AP_NETWORKING_PORT_EVENT_CONNECT_MS) {
+                // still in progress
+                return;
+            }
+            connecting = false;
+            connected = sock->is_connected();
+        } else {
+            // retry at 1Hz
+            if (now_ms - connect_start_ms < 1000) {
+                return;
+            }
+            connect_start_ms = now_ms;
+            if (sock == nullptr) {
+                sock = NEW_NOTHROW SocketAPM(false);
+                if (sock == nullptr) {
+                    return;
+                }
+            }
+            connected = false;
+            if (sock->connect_start(dest, port.get())) {
+                connected = sock->is_connected();
+                connecting = !connected;
+                if (connecting) {
+                    return;
+                }
+            }
         }
+    } else {
         if (sock == nullptr) {
-            sock = listen_sock->accept(100);
-            if (sock != nullptr) {
-                sock->set_blocking(false);
-                char buf[IP4_STR_LEN];
-                uint16_t last_port;
-                const char *last_addr = listen_sock->last_recv_address(buf, sizeof(buf), last_port);
-                if (last_addr != nullptr) {
-                    GCS_SEND_TEXT(MAV_SEVERITY_INFO, "TCP[%u]: connection from %s:%u", (unsigned)state.idx, last_addr, unsigned(last_port));
-                }
-                connected = true;
-                sock->reuseaddress();
+            sock = NEW_NOTHROW SocketAPM(false);
+            if (sock == nullptr) {
+                return;
             }
+            sock->set_blocking(true);
+            connected = false;
         }
-        if (sock != nullptr) {
-            active = send_receive();
+        connected = sock->connect(dest, port.get());
+    }
+    if (connected) {
+        GCS_SEND_TEXT(MAV_SEVERITY_INFO, "TCP[%u]: connected to %s:%u", unsigned(state.idx), dest, unsigned(port.get()));
+        sock->set_blocking(false);
+    } else {
+        delete sock;
+        sock = nullptr;
+        if (!event_loop) {
+            // don't try and connect too fast
+            hal.scheduler->delay(100);
         }
     }
 }
 
 /*
-  update a TCP client
+  one update of a started port. Returns true if any data was
+  transferred
  */
-void AP_Networking::Port::tcp_client_loop(void)
+bool AP_Networking::Port::update(void)
 {
-    AP::network().startup_wait();
+    switch ((NetworkPortType)type) {
+    case NetworkPortType::TCP_SERVER:
+        if (sock == nullptr) {
+            tcp_server_accept();
+        }
+        if (sock == nullptr) {
+            return false;
+        }
+        break;
+    case NetworkPortType::TCP_CLIENT:
+        if (sock == nullptr || !connected) {
+            tcp_client_connect();
+        }
+        if (sock == nullptr || !connected) {
+            return false;
+        }
+        break;
+    case NetworkPortType::UDP_CLIENT:
+    case NetworkPortType::UDP_SERVER:
+        if (sock == nullptr) {
+            return false;
+        }
+        break;
+    case NetworkPortType::NONE:
+        return false;
+    }
+    return send_receive();
+}
 
-    close_on_recv_error = true;
+/*
+  return true if the port has data waiting to be sent
+ */
+bool AP_Networking::Port::tx_waiting(void)
+{
+    if (!connected || sock == nullptr) {
+        return false;
+    }
+    WITH_SEMAPHORE(sem);
+    return writebuffer->available() > 0;
+}
+
+/*
+  shared thread servicing all ports, used with the PORTS_EVENT_LOOP
+  option. The thread sleeps in select() until a socket has input,
+  or for at most AP_NETWORKING_PORT_EVENT_TIMEOUT_US to pick up
+  output data written by the vehicle code
+ */
+void AP_Networking::ports_event_loop(void)
+{
+    startup_wait();
 
+    bool started[ARRAY_SIZE(ports)] {};
+    for (uint8_t i=0; i<ARRAY_SIZE(ports); i++) {
+        auto &p = ports[i];
+        if (p.event_loop) {
+            started[i] = p.start();
+        }
+    }
+
+    // each port can have a connected socket and a listening socket
+    SocketAPM *socks[2*ARRAY_SIZE(ports)];
+    bool ready[2*ARRAY_SIZE(ports)];
     bool active = false;
+
     while (true) {
-        if (!active) {
-            hal.scheduler->delay_microseconds(100);
+        uint8_t nsocks = 0;
+        for (uint8_t i=0; i<ARRAY_SIZE(ports); i++) {
+            auto &p = ports[i];
+            socks[2*i] = started[i] ? p.sock : nullptr;
+            socks[2*i+1] = (started[i] && p.sock == nullptr) ? p.listen_sock : nullptr;
+            nsocks += (socks[2*i] != nullptr) + (socks[2*i+1] != nullptr);
         }
-        if (sock == nullptr) {
-            sock = NEW_NOTHROW SocketAPM(false);
-            if (sock == nullptr) {
+
+        const uint32_t timeout_us = active ? 0 : AP_NETWORKING_PORT_EVENT_TIMEOUT_US;
+        memset(ready, 0, sizeof(ready));
+        if (nsocks == 0) {
+            hal.scheduler->delay_microseconds(AP_NETWORKING_PORT_EVENT_TIMEOUT_US);
+        } else {
+            SocketAPM::pollin_multi(socks, ready, ARRAY_SIZE(socks), timeout_us);
+        }
+
+        active = false;
+        for (uint8_t i=0; i<ARRAY_SIZE(ports); i++) {
+            auto &p = ports[i];
+            if (!started[i]) {
                 continue;
             }
-            sock->set_blocking(true);
-            connected = false;
-        }
-        if (!connected) {
-            const char *dest = ip.get_str();
-            connected = sock->connect(dest, port.get());
-            if (connected) {
-                GCS_SEND_TEXT(MAV_SEVERITY_INFO, "TCP[%u]: connected to %s:%u", unsigned(state.idx), dest, unsigned(port.get()));
-                sock->set_blocking(false);
-            } else {
-                delete sock;
-                sock = nullptr;
-                // don't try and connect too fast
-                hal.scheduler->delay(100);
+            const bool tcp_client_down = (NetworkPortType)p.type == NetworkPortType::TCP_CLIENT &&
+                                         (p.sock == nullptr || !p.connected);
+            if (!ready[2*i] && !ready[2*i+1] && !tcp_client_down && !p.tx_waiting()) {
+                continue;
+            }
+            p.stats_wakeups++;
+            // drain the port in a batch of updates
+            for (uint8_t n=0; n<AP_NETWORKING_PORT_EVENT_BATCH; n++) {
+                if (!p.update()) {
+                    break;
+                }
+                active = true;
             }
         }
-        if (sock != nullptr && connected) {
-            active = send_receive();
+    }
+}
+
+/*
+  display statistics for network ports
+ */
+void AP_Networking::ports_info(ExpandingString &str)
+{
+    str.printf("PORTS mode=%s\n", option_is_set(OPTION::PORTS_EVENT_LOOP) ? "event" : "thread");
+    for (uint8_t i=0; i<ARRAY_SIZE(ports); i++) {
+        const auto &p = ports[i];
+        if ((NetworkPortType)p.type == NetworkPortType::NONE) {
+            continue;
         }
+        const uint32_t bytes = p.rx_stats_bytes + p.tx_stats_bytes;
+        str.printf("NET_P%u type=%u wakeups=%lu rx=%lu tx=%lu bytes/wakeup=%.1f\n",
+                   unsigned(i+1),
+                   unsigned(p.type.get()),
+                   (unsigned long)p.stats_wakeups,
+                   (unsigned long)p.rx_stats_bytes,
+                   (unsigned long)p.tx_stats_bytes,
+                   p.stats_wakeups > 0 ? double(bytes) / p.stats_wakeups : 0.0);
     }
 }
 
@@ -329,9 +533,8 @@ bool AP_Networking::Port::send_receive(void)
         space = readbuffer->space();
     }
     if (space > 0) {
-        const uint32_t n = MIN(300U, space);
-        uint8_t buf[n];
-        const auto ret = sock->recv(buf, n, 0);
+        const uint32_t n = MIN(uint32_t(io_chunk), space);
+        const auto ret = sock->recv(io_buf, n, 0);
         if (close_on_recv_error && ret == 0) {
             GCS_SEND_TEXT(MAV_SEVERITY_INFO, "TCP[%u]: closed connection", unsigned(state.idx));
             delete sock;
@@ -340,7 +543,7 @@ bool AP_Networking::Port::send_receive(void)
         }
         if (ret > 0) {
             WITH_SEMAPHORE(sem);
-            readbuffer->write(buf, ret);
+            readbuffer->write(io_buf, ret);
 
             // Cant track dropped read packets because we only read in what there is space for
             // The socket buffer becomes full and data is lost there
@@ -382,7 +585,7 @@ bool AP_Networking::Port::send_receive(void)
         {
             WITH_SEMAPHORE(sem);
             available = writebuffer->available();
-            available = MIN(300U, available);
+            available = MIN(uint32_t(io_chunk), available);
 #if AP_MAVLINK_PACKETISE_ENABLED
             if (packetise) {
                 available = mavlink_packetise(*writebuffer, available);
@@ -392,11 +595,10 @@ bool AP_Networking::Port::send_receive(void)
                 return active;
             }
         }
-        uint8_t buf[available];
         uint32_t n;
         {
             WITH_SEMAPHORE(sem);
-            n = writebuffer->peekbytes(buf, available);
+            n = writebuffer->peekbytes(io_buf, available);
         }
 
         // nothing to send return
@@ -408,11 +610,11 @@ bool AP_Networking::Port::send_receive(void)
         if (type == NetworkPortType::UDP_SERVER) {
             // UDP Server uses sendto, allowing us to change the destination address port on the fly
             if(last_udp_connect_address != 0 && last_udp_connect_port != 0) {
-                ret = sock->sendto(buf, n, last_udp_connect_address, last_udp_connect_port);
+                ret = sock->sendto(io_buf, n, last_udp_connect_address, last_udp_connect_port);
             }
         } else {
             // TCP Server and Client and UDP Client use send
-            ret = sock->send(buf, n);
+            ret = sock->send(io_buf, n);
         }
 
         if (ret > 0) {
@@ -104,6 +104,22 @@ uint16_t AP_Param::_count_marker;
 uint16_t AP_Param::_count_marker_done;
 HAL_Semaphore AP_Param::_count_sem;
 
+// parameter generation and change history
+uint32_t AP_Param::_generation;
+uint32_t AP_Param::_structure_generation;
+HAL_Semaphore AP_Param::_change_sem;
+#if AP_PARAM_CHANGE_HISTORY_LEN > 0
+const AP_Param *AP_Param::_changes[AP_PARAM_CHANGE_HISTORY_LEN];
+uint8_t AP_Param::_changes_head;
+uint8_t AP_Param::_changes_count;
+#endif
+
+#if AP_PARAM_INDEX_TABLE_ENABLED
+AP_Param::IndexEntry *AP_Param::_index_table;
+uint16_t AP_Param::_index_table_size;
+uint16_t AP_Param::_index_table_count;
+#endif
+
 // storage and naming information about all types that can be saved
 const AP_Param::Info *AP_Param::_var_info;
 
@@ -958,11 +974,23 @@ AP_Param::find(const char *name, enum ap_var_type *ptype, uint16_t *flags)
     return nullptr;
 }
 
-// Find a variable by index. Note that this is quite slow.
+// Find a variable by index. This is constant time when the index
+// table is valid, otherwise it is quite slow.
 //
 AP_Param *
 AP_Param::find_by_index(uint16_t idx, enum ap_var_type *ptype, ParamToken *token)
 {
+#if AP_PARAM_INDEX_TABLE_ENABLED
+    {
+        WITH_SEMAPHORE(_count_sem);
+        // make sure the table is up to date
+        count_parameters();
+        if (_index_table_count != 0 &&
+            _count_marker == _count_marker_done) {
+            return find_by_index_table(idx, ptype, token);
+        }
+    }
+#endif
     AP_Param *ap;
     uint16_t count=0;
     for (ap=AP_Param::first(token, ptype);
@@ -973,6 +1001,25 @@ AP_Param::find_by_index(uint16_t idx, enum ap_var_type *ptype, ParamToken *token
     return ap;    
 }
 
+#if AP_PARAM_INDEX_TABLE_ENABLED
+/*
+  lookup an index in the index table. Must be called with _count_sem
+  held and the table valid
+ */
+AP_Param *AP_Param::find_by_index_table(uint16_t idx, enum ap_var_type *ptype, ParamToken *token)
+{
+    if (idx >= _index_table_count) {
+        return nullptr;
+    }
+    const IndexEntry &e = _index_table[idx];
+    *token = e.token;
+    if (ptype != nullptr) {
+        *ptype = (enum ap_var_type)e.type;
+    }
+    return e.ap;
+}
+#endif
+
 // by-name equivalent of find_by_index()
 AP_Param* AP_Param::find_by_name(const char* name, enum ap_var_type *ptype, ParamToken *token)
 {
@@ -1135,8 +1182,88 @@ void AP_Param::notify() const {
     }
 
     send_parameter(name, (enum ap_var_type)param_header_type, idx);
+
+    note_change((enum ap_var_type)param_header_type, idx);
 }
 
+/*
+  record a change to this parameter for delta parameter downloads
+ */
+void AP_Param::note_change(enum ap_var_type type, uint8_t idx) const
+{
+    WITH_SEMAPHORE(_change_sem);
+    if (type == AP_PARAM_VECTOR3F && idx == 0) {
+        // whole vector
+        for (uint8_t i=0; i<3; i++) {
+            record_change((const AP_Param *)((ptrdiff_t)this + i*sizeof(float)));
+        }
+    } else {
+        record_change(this);
+    }
+}
+
+/*
+  add a change to the history as a new generation. Must be called
+  with _change_sem held
+ */
+void AP_Param::record_change(const AP_Param *ap)
+{
+    _generation++;
+#if AP_PARAM_CHANGE_HISTORY_LEN > 0
+    _changes[_changes_head] = ap;
+    _changes_head = (_changes_head + 1) % AP_PARAM_CHANGE_HISTORY_LEN;
+    if (_changes_count < AP_PARAM_CHANGE_HISTORY_LEN) {
+        _changes_count++;
+    }
+#endif
+}
+
+#if AP_PARAM_CHANGE_HISTORY_LEN > 0
+/*
+  get the parameters changed since a generation
+ */
+bool AP_Param::changed_since(uint32_t generation, const AP_Param **changed, uint8_t &num_changed, uint8_t max_changed)
+{
+    WITH_SEMAPHORE(_change_sem);
+    num_changed = 0;
+    if (generation == _generation) {
+        // nothing has changed
+        return true;
+    }
+    // every generation since the last change to the parameter set is
+    // a change in the history, so the number of changes we need is
+    // the difference in generation
+    const uint32_t num_since = _generation - generation;
+    if (num_since > _generation - _structure_generation) {
+        // from before a change in the parameter set, or from a
+        // previous boot
+        return false;
+    }
+    if (num_since > _changes_count) {
+        // history doesn't go back far enough
+        return false;
+    }
+    for (uint8_t i=0; i<num_since; i++) {
+        const AP_Param *ap = _changes[(_changes_head + AP_PARAM_CHANGE_HISTORY_LEN - 1 - i) % AP_PARAM_CHANGE_HISTORY_LEN];
+        bool found = false;
+        for (uint8_t j=0; j<num_changed; j++) {
+            if (changed[j] == ap) {
+                found = true;
+                break;
+            }
+        }
+        if (found) {
+            continue;
+        }
+        if (num_changed == max_changed) {
+            return false;
+        }
+        changed[num_changed++] = ap;
+    }
+    return true;
+}
+#endif
+
 
 /*
   Save the variable to HAL storage, synchronous version
@@ -1185,6 +1312,8 @@ void AP_Param::save_sync(bool force_save, bool send_to_gcs)
         // clear cached parameter count
         invalidate_count();
     }
+
+    note_change((enum ap_var_type)phdr.type, idx);
     
     char name[AP_MAX_NAME_SIZE+1];
     copy_name_info(info, ginfo, group_nesting, idx, name, sizeof(name), true);
@@ -1546,6 +1675,16 @@ bool AP_Param::load_all()
     if (!registered_save_handler) {
         registered_save_handler = true;
         hal.scheduler->register_io_process(FUNCTOR_BIND((&save_dummy), &AP_Param::save_io_handler, void));
+
+        // start the generation at a random value so a GCS can tell a
+        // reboot from an unchanged parameter set
+        uint32_t gen;
+        if (!hal.util->get_random_vals((uint8_t *)&gen, sizeof(gen))) {
+            gen = AP_HAL::micros() ^ (uint32_t(get_random16()) << 16);
+        }
+        WITH_SEMAPHORE(_change_sem);
+        _generation = gen;
+        _structure_generation = gen;
     }
     
     while (ofs < _storage.size()) {
@@ -1923,6 +2062,21 @@ AP_Param *AP_Param::next_scalar(ParamToken *token, enum ap_var_type *ptype, floa
 }
 
 
+/// Returns the scalar following the one at index idx
+AP_Param *AP_Param::next_scalar_by_index(uint16_t idx, ParamToken *token, enum ap_var_type *ptype)
+{
+#if AP_PARAM_INDEX_TABLE_ENABLED
+    {
+        WITH_SEMAPHORE(_count_sem);
+        if (_index_table_count != 0 &&
+            _count_marker == _count_marker_done) {
+            return find_by_index_table(idx+1, ptype, token);
+        }
+    }
+#endif
+    return next_scalar(token, ptype);
+}
+
 /// cast a variable to a float given its type
 float AP_Param::cast_to_float(enum ap_var_type type) const
 {
@@ -2644,7 +2798,8 @@ void AP_Param::send_parameter(const char *name, enum ap_var_type var_type, uint8
 }
 
 /*
-  return count of all scalar parameters.
+  return count of all scalar parameters. This also rebuilds the index
+  table when enabled.
   Note that this function may be called from the IO thread, so needs
   to be thread safe
  */
@@ -2666,17 +2821,53 @@ uint16_t AP_Param::count_parameters(void)
            limit--) {
         AP_Param  *vp;
         AP_Param::ParamToken token {};
+        enum ap_var_type type;
         uint16_t count = 0;
         uint16_t marker = _count_marker;
 
-        for (vp = AP_Param::first(&token, nullptr);
+#if AP_PARAM_INDEX_TABLE_ENABLED
+        _index_table_count = 0;
+#endif
+        for (vp = AP_Param::first(&token, &type);
              vp != nullptr;
-             vp = AP_Param::next_scalar(&token, nullptr)) {
+             vp = AP_Param::next_scalar(&token, &type)) {
+#if AP_PARAM_INDEX_TABLE_ENABLED
+            if (count < _index_table_size) {
+                _index_table[count] = IndexEntry {
+                    ap : vp,
+                    token : token,
+                    type : uint8_t(type),
+                };
+            }
+#endif
             count++;
         }
         _parameter_count = count;
         _count_marker_done = marker;
+
+#if AP_PARAM_INDEX_TABLE_ENABLED
+        if (count > _index_table_size) {
+            // grow the table with some room for parameters being
+            // enabled, and force another pass to fill it
+            delete[] _index_table;
+            _index_table_size = count + 32;
+            _index_table = NEW_NOTHROW IndexEntry[_index_table_size];
+            if (_index_table == nullptr) {
+                _index_table_size = 0;
+            } else {
+                _count_marker_done = marker - 1;
+            }
+            continue;
+        }
+        _index_table_count = count;
+#endif
+    }
+#if AP_PARAM_INDEX_TABLE_ENABLED
+    if (_count_marker != _count_marker_done) {
+        // table is stale, don't use it for lookups
+        _index_table_count = 0;
     }
+#endif
     return _parameter_count;
 }
 
@@ -2685,10 +2876,16 @@ uint16_t AP_Param::count_parameters(void)
  */
 void AP_Param::invalidate_count(void)
 {
-    // we don't take the semaphore here as we don't want to block. The
-    // not-equal test is strong enough to ensure we get the right
-    // answer
+    // we don't take _count_sem here as we don't want to block on a
+    // count in progress. The not-equal test is strong enough to
+    // ensure we get the right answer
     _count_marker++;
+
+    // the set of parameters may have changed. _change_sem is only
+    // held briefly by the change history
+    WITH_SEMAPHORE(_change_sem);
+    _generation++;
+    _structure_generation = _generation;
 }
 
 /*
@@ -192,6 +192,8 @@ enum ap_var_type {
 ///
 class AP_Param
 {
+    friend class AP_Param_Test;
+
 public:
     // the Info and GroupInfo structures are passed by the main
     // program in setup() to give information on how variables are
@@ -551,6 +553,12 @@ public:
     /// as needed
     static AP_Param *       next_scalar(ParamToken *token, enum ap_var_type *ptype, float *default_val = nullptr);
 
+    /// Returns the scalar following the one at index idx. This is
+    /// equivalent to next_scalar() with the token for idx, but is
+    /// constant time when the index table is valid. idx must be from
+    /// the current get_index_version()
+    static AP_Param *       next_scalar_by_index(uint16_t idx, ParamToken *token, enum ap_var_type *ptype);
+
     /// get the size of a type in bytes
     static uint8_t				type_size(enum ap_var_type type);
 
@@ -575,6 +583,33 @@ public:
     // invalidate parameter count
     static void invalidate_count(void);
 
+    /*
+      the version of the parameter numbering used by find_by_index()
+      and next_scalar_by_index(). It changes whenever the count is
+      invalidated, as the index table may be rebuilt with parameters
+      at different indexes. A client walking the parameters by index
+      must restart if it changes
+     */
+    static uint16_t get_index_version(void) { return _count_marker; }
+
+    /*
+      parameter generation number. This changes whenever a parameter
+      is saved or notified, or the set of parameters changes. It
+      starts at a random value on boot so a GCS can tell a reboot from
+      an unchanged parameter set
+     */
+    static uint32_t get_generation(void) { return _generation; }
+
+#if AP_PARAM_CHANGE_HISTORY_LEN > 0
+    /*
+      get the parameters changed since the given generation. Returns
+      false if the change history does not go back far enough, or the
+      set of parameters has changed, in which case a full download is
+      needed
+     */
+    static bool changed_since(uint32_t generation, const AP_Param **changed, uint8_t &num_changed, uint8_t max_changed);
+#endif
+
     static void set_hide_disabled_groups(bool value) { _hide_disabled_groups = value; }
 
     // set frame type flags. Used to unhide frame specific parameters
@@ -813,6 +848,36 @@ private:
     static uint16_t             _count_marker;
     static uint16_t             _count_marker_done;
     static HAL_Semaphore        _count_sem;
+
+    // parameter generation and change history
+    static uint32_t             _generation;
+    static uint32_t             _structure_generation;
+    static HAL_Semaphore        _change_sem;
+#if AP_PARAM_CHANGE_HISTORY_LEN > 0
+    // one entry per generation, holding the scalar that changed
+    static const AP_Param       *_changes[AP_PARAM_CHANGE_HISTORY_LEN];
+    static uint8_t              _changes_head;
+    static uint8_t              _changes_count;
+#endif
+    // record a change of this parameter. A whole vector is recorded
+    // as a change of each element, as downloads list them separately
+    void note_change(enum ap_var_type type, uint8_t idx) const;
+    static void record_change(const AP_Param *ap);
+
+#if AP_PARAM_INDEX_TABLE_ENABLED
+    // index to parameter table, rebuilt with the parameter count
+    struct IndexEntry {
+        AP_Param *ap;
+        ParamToken token;
+        uint8_t type;
+    };
+    static IndexEntry *         _index_table;
+    static uint16_t             _index_table_size;
+    static uint16_t             _index_table_count;
+
+    // lookup an index in the index table, returns nullptr if the table is not valid
+    static AP_Param *find_by_index_table(uint16_t idx, enum ap_var_type *ptype, ParamToken *token);
+#endif
     static const struct Info *  _var_info;
 
 #if AP_PARAM_DYNAMIC_ENABLED
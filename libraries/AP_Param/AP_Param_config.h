@@ -8,6 +8,18 @@
 #define AP_PARAM_DEFAULTS_FILE_PARSING_ENABLED AP_FILESYSTEM_FILE_READING_ENABLED
 #endif
 
+// table mapping parameter index to token, making PARAM_REQUEST_READ
+// by index and parameter download constant time per parameter
+#ifndef AP_PARAM_INDEX_TABLE_ENABLED
+#define AP_PARAM_INDEX_TABLE_ENABLED (HAL_MEM_CLASS >= HAL_MEM_CLASS_300)
+#endif
+
+// number of recent parameter changes remembered for delta parameter
+// downloads. Zero disables change tracking
+#ifndef AP_PARAM_CHANGE_HISTORY_LEN
+#define AP_PARAM_CHANGE_HISTORY_LEN 64
+#endif
+
 #ifndef FORCE_APJ_DEFAULT_PARAMETERS
 #define FORCE_APJ_DEFAULT_PARAMETERS 0
 #endif
@@ -0,0 +1,316 @@
+#include <AP_gtest.h>
+
+#include <AP_Param/AP_Param.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Filesystem/AP_Filesystem.h>
+#include <AP_Filesystem/AP_Filesystem_Param.h>
+
+#include <map>
+#include <string>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_PARAM_CHANGE_HISTORY_LEN > 0 && AP_FILESYSTEM_PARAM_ENABLED
+
+static AP_Int8 test_int8;
+static AP_Int16 test_int16;
+static AP_Float test_float;
+static AP_Vector3f test_vector;
+
+static const AP_Param::Info var_info[] = {
+    { "TEST_I8",  &test_int8,   {def_value : 0}, 0, 0, AP_PARAM_INT8 },
+    { "TEST_I16", &test_int16,  {def_value : 0}, 0, 1, AP_PARAM_INT16 },
+    { "TEST_FLT", &test_float,  {def_value : 0}, 0, 2, AP_PARAM_FLOAT },
+    { "TEST_VEC", &test_vector, {def_value : 0}, 0, 3, AP_PARAM_VECTOR3F },
+    AP_VAREND
+};
+
+static AP_Param param_loader(var_info);
+
+class AP_Param_Test
+{
+public:
+    // record a change as notify() and save_sync() do
+    static void note_change(const AP_Param &ap, enum ap_var_type type, uint8_t idx=0)
+    {
+        ap.note_change(type, idx);
+    }
+};
+
+// a parsed @PARAM/param.pck download
+struct ParamDownload {
+    uint16_t magic;
+    uint16_t num_params;
+    uint16_t total_params;
+    uint8_t flags;
+    uint32_t generation;
+    std::map<std::string, float> values;
+    std::map<std::string, uint8_t> value_lengths;
+};
+
+/*
+  read and unpack param.pck with the given query string
+ */
+static bool download(const char *query, ParamDownload &d)
+{
+    static AP_Filesystem_Param fs;
+    char fname[40];
+    snprintf(fname, sizeof(fname), "param.pck%s", query);
+    const int fd = fs.open(fname, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    uint8_t data[1024];
+    uint32_t len = 0;
+    int32_t n;
+    while (len + 64 <= sizeof(data) && (n = fs.read(fd, &data[len], 64)) > 0) {
+        len += n;
+    }
+    fs.close(fd);
+
+    if (len < 6) {
+        return false;
+    }
+    memcpy(&d.magic, &data[0], 2);
+    memcpy(&d.num_params, &data[2], 2);
+    memcpy(&d.total_params, &data[4], 2);
+    uint32_t ofs = 6;
+    d.flags = 0;
+    d.generation = 0;
+    if (d.magic == 0x671d) {
+        d.flags = data[6];
+        memcpy(&d.generation, &data[8], 4);
+        ofs = 12;
+    }
+    d.values.clear();
+    d.value_lengths.clear();
+
+    char name[AP_MAX_NAME_SIZE+1] {};
+    while (ofs < len) {
+        if (data[ofs] == 0) {
+            // pad byte
+            ofs++;
+            continue;
+        }
+        const uint8_t ptype = data[ofs] & 0x0F;
+        const uint8_t pflags = data[ofs] >> 4;
+        const uint8_t common_len = data[ofs+1] & 0x0F;
+        const uint8_t name_len = (data[ofs+1] >> 4) + 1;
+        ofs += 2;
+        memcpy(&name[common_len], &data[ofs], name_len);
+        name[common_len+name_len] = 0;
+        ofs += name_len;
+
+        float v = 0;
+        uint8_t data_len = AP_Param::type_size((enum ap_var_type)ptype);
+        if (pflags & 2) {
+            data_len = 0;
+        } else if (pflags & 4) {
+            data_len = 1;
+            v = int8_t(data[ofs]);
+        } else {
+            switch (ptype) {
+            case AP_PARAM_INT8:
+                v = int8_t(data[ofs]);
+                break;
+            case AP_PARAM_INT16: {
+                int16_t v16;
+                memcpy(&v16, &data[ofs], sizeof(v16));
+                v = v16;
+                break;
+            }
+            case AP_PARAM_INT32: {
+                int32_t v32;
+                memcpy(&v32, &data[ofs], sizeof(v32));
+                v = v32;
+                break;
+            }
+            case AP_PARAM_FLOAT:
+                memcpy(&v, &data[ofs], sizeof(v));
+                break;
+            default:
+                return false;
+            }
+        }
+        ofs += data_len;
+        d.values[name] = v;
+        d.value_lengths[name] = data_len;
+    }
+    return true;
+}
+
+static const uint8_t flag_delta = (1U<<1);
+static const uint8_t flag_compact = (1U<<2);
+
+/*
+  saving a whole vector must put each element in a delta download
+ */
+TEST(AP_Param, delta_vector)
+{
+    char query[40];
+    ParamDownload d;
+
+    uint32_t since = AP_Param::get_generation();
+    test_vector.set(Vector3f(1.5f, -2.5f, 3.5f));
+    AP_Param_Test::note_change(test_vector, AP_PARAM_VECTOR3F);
+
+    snprintf(query, sizeof(query), "?since=%u", unsigned(since));
+    ASSERT_TRUE(download(query, d));
+    EXPECT_EQ(d.flags & flag_delta, flag_delta);
+    EXPECT_EQ(d.generation, AP_Param::get_generation());
+    EXPECT_EQ(d.num_params, 3);
+    EXPECT_EQ(d.values.size(), 3U);
+    EXPECT_FLOAT_EQ(d.values["TEST_VEC_X"], 1.5f);
+    EXPECT_FLOAT_EQ(d.values["TEST_VEC_Y"], -2.5f);
+    EXPECT_FLOAT_EQ(d.values["TEST_VEC_Z"], 3.5f);
+
+    // a single element is recorded on its own
+    since = AP_Param::get_generation();
+    const AP_Param *vector_y = (const AP_Param *)((ptrdiff_t)&test_vector + sizeof(float));
+    AP_Param_Test::note_change(*vector_y, AP_PARAM_VECTOR3F, 1);
+
+    snprintf(query, sizeof(query), "?since=%u", unsigned(since));
+    ASSERT_TRUE(download(query, d));
+    EXPECT_EQ(d.flags & flag_delta, flag_delta);
+    EXPECT_EQ(d.num_params, 1);
+    EXPECT_EQ(d.values.size(), 1U);
+    EXPECT_FLOAT_EQ(d.values["TEST_VEC_Y"], -2.5f);
+
+    // nothing changed since the current generation
+    snprintf(query, sizeof(query), "?since=%u", unsigned(AP_Param::get_generation()));
+    ASSERT_TRUE(download(query, d));
+    EXPECT_EQ(d.flags & flag_delta, flag_delta);
+    EXPECT_EQ(d.num_params, 0);
+    EXPECT_EQ(d.values.size(), 0U);
+}
+
+/*
+  compact encoding sends zero with no data and small integers in one
+  byte
+ */
+TEST(AP_Param, compact)
+{
+    test_int8.set(-7);
+    test_int16.set(0);
+    test_float.set(2.25f);
+    test_vector.set(Vector3f(0.0f, 100.0f, -300.0f));
+
+    ParamDownload d;
+    ASSERT_TRUE(download("?compact=1", d));
+    EXPECT_EQ(d.magic, 0x671d);
+    EXPECT_EQ(d.flags & (flag_delta | flag_compact), flag_compact);
+    EXPECT_EQ(d.num_params, d.total_params);
+    EXPECT_EQ(d.values.size(), 6U);
+
+    EXPECT_FLOAT_EQ(d.values["TEST_I8"], -7);
+    EXPECT_EQ(d.value_lengths["TEST_I8"], 1);
+    EXPECT_FLOAT_EQ(d.values["TEST_I16"], 0);
+    EXPECT_EQ(d.value_lengths["TEST_I16"], 0);
+    EXPECT_FLOAT_EQ(d.values["TEST_FLT"], 2.25f);
+    EXPECT_EQ(d.value_lengths["TEST_FLT"], 4);
+    EXPECT_FLOAT_EQ(d.values["TEST_VEC_X"], 0);
+    EXPECT_EQ(d.value_lengths["TEST_VEC_X"], 0);
+    EXPECT_FLOAT_EQ(d.values["TEST_VEC_Y"], 100);
+    EXPECT_EQ(d.value_lengths["TEST_VEC_Y"], 1);
+    EXPECT_FLOAT_EQ(d.values["TEST_VEC_Z"], -300);
+    EXPECT_EQ(d.value_lengths["TEST_VEC_Z"], 4);
+}
+
+/*
+  once the change history has wrapped a delta from before it can't
+  be given, but a delta from within it can
+ */
+TEST(AP_Param, delta_history_wrap)
+{
+    char query[40];
+    ParamDownload d;
+
+    const uint32_t before_wrap = AP_Param::get_generation();
+    for (uint8_t i=0; i<10; i++) {
+        AP_Param_Test::note_change(test_int16, AP_PARAM_INT16);
+    }
+    const uint32_t in_history = AP_Param::get_generation();
+    for (uint8_t i=0; i<AP_PARAM_CHANGE_HISTORY_LEN-1; i++) {
+        AP_Param_Test::note_change(test_float, AP_PARAM_FLOAT);
+    }
+    AP_Param_Test::note_change(test_int8, AP_PARAM_INT8);
+
+    snprintf(query, sizeof(query), "?since=%u", unsigned(before_wrap));
+    ASSERT_TRUE(download(query, d));
+    EXPECT_EQ(d.flags & flag_delta, 0);
+    EXPECT_EQ(d.num_params, d.total_params);
+    EXPECT_EQ(d.values.size(), 6U);
+
+    snprintf(query, sizeof(query), "?since=%u", unsigned(in_history));
+    ASSERT_TRUE(download(query, d));
+    EXPECT_EQ(d.flags & flag_delta, flag_delta);
+    EXPECT_EQ(d.num_params, 2);
+    EXPECT_EQ(d.values.size(), 2U);
+    EXPECT_EQ(d.values.count("TEST_FLT"), 1U);
+    EXPECT_EQ(d.values.count("TEST_I8"), 1U);
+}
+
+/*
+  a change to the set of parameters forces a full download
+ */
+TEST(AP_Param, delta_invalidate)
+{
+    char query[40];
+    ParamDownload d;
+
+    const uint32_t since = AP_Param::get_generation();
+    AP_Param_Test::note_change(test_int8, AP_PARAM_INT8);
+    AP_Param::invalidate_count();
+    EXPECT_NE(AP_Param::get_generation(), since);
+
+    snprintf(query, sizeof(query), "?since=%u", unsigned(since));
+    ASSERT_TRUE(download(query, d));
+    EXPECT_EQ(d.flags & flag_delta, 0);
+    EXPECT_EQ(d.num_params, d.total_params);
+    EXPECT_EQ(d.values.size(), 6U);
+
+    // changes after the invalidate give a delta again
+    const uint32_t after = AP_Param::get_generation();
+    AP_Param_Test::note_change(test_int16, AP_PARAM_INT16);
+    snprintf(query, sizeof(query), "?since=%u", unsigned(after));
+    ASSERT_TRUE(download(query, d));
+    EXPECT_EQ(d.flags & flag_delta, flag_delta);
+    EXPECT_EQ(d.num_params, 1);
+    EXPECT_EQ(d.values.count("TEST_I16"), 1U);
+}
+
+/*
+  invalidating the count changes the index version, and lookups by
+  index then use the new numbering
+ */
+TEST(AP_Param, index_version)
+{
+    const uint16_t count = AP_Param::count_parameters();
+    const uint16_t version = AP_Param::get_index_version();
+
+    AP_Param::ParamToken token {};
+    enum ap_var_type ptype;
+    EXPECT_EQ(AP_Param::find_by_index(3, &ptype, &token), (AP_Param *)&test_vector);
+    EXPECT_EQ(AP_Param::get_index_version(), version);
+
+    AP_Param::invalidate_count();
+    EXPECT_NE(AP_Param::get_index_version(), version);
+    EXPECT_EQ(AP_Param::count_parameters(), count);
+
+    // walk by index as a download does, all the way to the end
+    AP_Param *ap = AP_Param::find_by_index(0, &ptype, &token);
+    uint16_t n = 0;
+    while (ap != nullptr) {
+        char name[AP_MAX_NAME_SIZE+1];
+        ap->copy_name_token(token, name, sizeof(name), true);
+        AP_Param::ParamToken token2 {};
+        EXPECT_EQ(AP_Param::find_by_index(n, &ptype, &token2), ap);
+        ap = AP_Param::next_scalar_by_index(n, &token, &ptype);
+        n++;
+    }
+    EXPECT_EQ(n, count);
+}
+
+#endif  // AP_PARAM_CHANGE_HISTORY_LEN > 0 && AP_FILESYSTEM_PARAM_ENABLED
+
+AP_GTEST_MAIN()
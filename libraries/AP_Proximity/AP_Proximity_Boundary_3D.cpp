@@ -27,28 +27,48 @@ AP_Proximity_Boundary_3D::AP_Proximity_Boundary_3D()
     init();
 }
 
-// initialise the boundary and sector_edge_vector array used for object avoidance
-//   should be called if the sector_middle_deg or _sector_width_deg arrays are changed
+// initialise the boundary and the tables of sector edge directions used for object avoidance
 void AP_Proximity_Boundary_3D::init()
 {
+    for (uint8_t sector=0; sector < PROXIMITY_NUM_SECTORS; sector++) {
+        const float middle_deg = sector * PROXIMITY_SECTOR_WIDTH_DEG;
+        const float edge_rad = radians(middle_deg + (PROXIMITY_SECTOR_WIDTH_DEG * 0.5f));
+        _edge_cos_yaw[sector] = cosf(edge_rad);
+        _edge_sin_yaw[sector] = sinf(edge_rad);
+        _sector_direction[sector] = uint8_t(wrap_360(middle_deg + 22.5f) / 45.0f) % PROXIMITY_MAX_DIRECTION;
+    }
     for (uint8_t layer=0; layer < PROXIMITY_NUM_LAYERS; layer++) {
-        const float pitch = ((float)_pitch_middle_deg[layer]);
+        const float pitch_rad = radians((layer - PROXIMITY_MIDDLE_LAYER) * PROXIMITY_PITCH_WIDTH_DEG);
+        _edge_cos_pitch[layer] = cosf(pitch_rad) * 100.0f;
+        _edge_sin_pitch[layer] = sinf(pitch_rad) * 100.0f;
         for (uint8_t sector=0; sector < PROXIMITY_NUM_SECTORS; sector++) {
-            const float angle_rad = ((float)_sector_middle_deg[sector]+(PROXIMITY_SECTOR_WIDTH_DEG/2.0f));
-            _sector_edge_vector[layer][sector].offset_bearing(angle_rad, pitch, 100.0f);
-            _boundary_points[layer][sector] = _sector_edge_vector[layer][sector] * PROXIMITY_BOUNDARY_DIST_DEFAULT;
+            set_boundary_point(layer, sector, PROXIMITY_BOUNDARY_DIST_DEFAULT);
         }
     }
 }
 
+// body frame vector (in cm) to the boundary point on the CW edge of a sector
+Vector3f AP_Proximity_Boundary_3D::get_boundary_point(uint8_t layer, uint8_t sector) const
+{
+    const float distance = _boundary_distance[layer][sector];
+    const float horizontal = _edge_cos_pitch[layer] * distance;
+    return Vector3f{_edge_cos_yaw[sector] * horizontal, _edge_sin_yaw[sector] * horizontal, _edge_sin_pitch[layer] * distance};
+}
+
 // returns face corresponding to the provided yaw and (optionally) pitch
 // pitch is the vertical body-frame angle (in degrees) to the obstacle (0=directly ahead, 90 is above the vehicle)
 // yaw is the horizontal body-frame angle (in degrees) to the obstacle (0=directly ahead of the vehicle, 90 is to the right of the vehicle)
 AP_Proximity_Boundary_3D::Face AP_Proximity_Boundary_3D::get_face(float pitch, float yaw) const
 {
-    const uint8_t sector = wrap_360(yaw + (PROXIMITY_SECTOR_WIDTH_DEG * 0.5f)) / 45.0f;
-    const float pitch_limited = constrain_float(pitch, -75.0f, 74.9f);
-    const uint8_t layer = (pitch_limited + 75.0f)/PROXIMITY_PITCH_WIDTH_DEG;
+    // sector 0 starts half a sector CCW of directly ahead. Sensors
+    // mostly pass angles already within 0 to 360, which need no wrap
+    float yaw_from_edge = yaw + (PROXIMITY_SECTOR_WIDTH_DEG * 0.5f);
+    if (yaw_from_edge < 0 || yaw_from_edge >= 360.0f) {
+        yaw_from_edge = wrap_360(yaw_from_edge);
+    }
+    const uint8_t sector = MIN(uint16_t(yaw_from_edge / PROXIMITY_SECTOR_WIDTH_DEG), PROXIMITY_NUM_SECTORS-1);
+    const float pitch_limited = constrain_float(pitch, -PROXIMITY_PITCH_RANGE_DEG * 0.5f, PROXIMITY_PITCH_RANGE_DEG * 0.5f);
+    const uint8_t layer = MIN(uint16_t((pitch_limited + PROXIMITY_PITCH_RANGE_DEG * 0.5f) / PROXIMITY_PITCH_WIDTH_DEG), PROXIMITY_NUM_LAYERS-1);
     return Face{layer, sector};
 }
 
@@ -64,7 +84,7 @@ void AP_Proximity_Boundary_3D::set_face_attributes(const Face &face, float pitch
     }
 
     // ignore update if another instance has provided a shorter distance within the last 0.2 seconds
-    if ((prx_instance != _prx_instance[face.layer][face.sector]) && _distance_valid[face.layer][face.sector] && (_filtered_distance[face.layer][face.sector].get() < distance)) {
+    if ((prx_instance != _prx_instance[face.layer][face.sector]) && _distance_valid[face.layer][face.sector] && (_filtered_distance[face.layer][face.sector] < distance)) {
         // check if recent
         const uint32_t now_ms = AP_HAL::millis();
         if (now_ms - _last_update_ms[face.layer][face.sector] < PROXIMITY_FACE_RESET_MS) {
@@ -85,34 +105,22 @@ void AP_Proximity_Boundary_3D::set_face_attributes(const Face &face, float pitch
     update_boundary(face);
 }
 
-// apply a new cutoff_freq to low-pass filter
-void AP_Proximity_Boundary_3D::apply_filter_freq(float cutoff_freq)
-{
-    for (uint8_t layer=0; layer < PROXIMITY_NUM_LAYERS; layer++) {
-        for (uint8_t sector=0; sector < PROXIMITY_NUM_SECTORS; sector++) {
-            _filtered_distance[layer][sector].set_cutoff_frequency(cutoff_freq);
-        }
-    }
-}
-
 // Apply low pass filter on the raw distance
 void AP_Proximity_Boundary_3D::set_filtered_distance(const Face &face, float distance)
 {
     if (!face.valid()) {
         return;
     }
-    if (!is_equal(_filtered_distance[face.layer][face.sector].get_cutoff_freq(), _filter_freq)) {
-        // cutoff freq has changed
-        apply_filter_freq(_filter_freq);
-    }
 
     const uint32_t now_ms = AP_HAL::millis();
-    const uint32_t dt = now_ms - _last_update_ms[face.layer][face.sector];
-    if (dt < PROXIMITY_FILT_RESET_TIME) {
-        _filtered_distance[face.layer][face.sector].apply(distance, dt* 0.001f);
+    const uint32_t last_update_ms = _last_update_ms[face.layer][face.sector];
+    const uint32_t dt = now_ms - last_update_ms;
+    float &filtered_distance = _filtered_distance[face.layer][face.sector];
+    if ((last_update_ms != 0) && (dt < PROXIMITY_FILT_RESET_TIME)) {
+        filtered_distance += (distance - filtered_distance) * calc_lowpass_alpha_dt(dt * 0.001f, _filter_freq);
     } else {
         // reset filter since last distance was passed a long time back
-        _filtered_distance[face.layer][face.sector].reset(distance);
+        filtered_distance = distance;
     }
     _last_update_ms[face.layer][face.sector] = now_ms;
 }
@@ -136,38 +144,38 @@ void AP_Proximity_Boundary_3D::update_boundary(const Face &face)
     // boundary point lies on the line between the two sectors at the shorter distance found in the two sectors
     float shortest_distance = PROXIMITY_BOUNDARY_DIST_DEFAULT;
     if (_distance_valid[layer][sector] && _distance_valid[layer][next_sector]) {
-        shortest_distance = MIN(_filtered_distance[layer][sector].get(), _filtered_distance[layer][next_sector].get());
+        shortest_distance = MIN(_filtered_distance[layer][sector], _filtered_distance[layer][next_sector]);
     } else if (_distance_valid[layer][sector]) {
-        shortest_distance = _filtered_distance[layer][sector].get();
+        shortest_distance = _filtered_distance[layer][sector];
     } else if (_distance_valid[layer][next_sector]) {
-        shortest_distance = _filtered_distance[layer][next_sector].get();
+        shortest_distance = _filtered_distance[layer][next_sector];
     }
     if (shortest_distance < PROXIMITY_BOUNDARY_DIST_MIN) {
         shortest_distance = PROXIMITY_BOUNDARY_DIST_MIN;
     }
-    _boundary_points[layer][sector] = _sector_edge_vector[layer][sector] * shortest_distance;
+    set_boundary_point(layer, sector, shortest_distance);
 
     // if the next sector (clockwise) has an invalid distance, set boundary to create a cup like boundary
     if (!_distance_valid[layer][next_sector]) {
-        _boundary_points[layer][next_sector] = _sector_edge_vector[layer][next_sector] * shortest_distance;
+        set_boundary_point(layer, next_sector, shortest_distance);
     }
 
     // repeat for edge between sector and previous sector
     const uint8_t prev_sector = get_prev_sector(sector);
     shortest_distance = PROXIMITY_BOUNDARY_DIST_DEFAULT;
     if (_distance_valid[layer][prev_sector] && _distance_valid[layer][sector]) {
-        shortest_distance = MIN(_filtered_distance[layer][prev_sector].get(), _filtered_distance[layer][sector].get());
+        shortest_distance = MIN(_filtered_distance[layer][prev_sector], _filtered_distance[layer][sector]);
     } else if (_distance_valid[layer][prev_sector]) {
-        shortest_distance = _filtered_distance[layer][prev_sector].get();
+        shortest_distance = _filtered_distance[layer][prev_sector];
     } else if (_distance_valid[layer][sector]) {
-        shortest_distance = _filtered_distance[layer][sector].get();
+        shortest_distance = _filtered_distance[layer][sector];
     }
-    _boundary_points[layer][prev_sector] = _sector_edge_vector[layer][prev_sector] * shortest_distance;
+    set_boundary_point(layer, prev_sector, shortest_distance);
 
     // if the sector counter-clockwise from the previous sector has an invalid distance, set boundary to create a cup-like boundary
     const uint8_t prev_sector_ccw = get_prev_sector(prev_sector);
     if (!_distance_valid[layer][prev_sector_ccw]) {
-        _boundary_points[layer][prev_sector_ccw] = _sector_edge_vector[layer][prev_sector_ccw] * shortest_distance;
+        set_boundary_point(layer, prev_sector_ccw, shortest_distance);
     }
 }
 
@@ -247,7 +255,7 @@ bool AP_Proximity_Boundary_3D::get_distance(const Face &face, float &distance) c
 }
 
 // get the total number of obstacles 
-uint8_t AP_Proximity_Boundary_3D::get_obstacle_count() const
+uint16_t AP_Proximity_Boundary_3D::get_obstacle_count() const
 {
     return PROXIMITY_NUM_LAYERS * PROXIMITY_NUM_SECTORS;
 }
@@ -257,8 +265,12 @@ uint8_t AP_Proximity_Boundary_3D::get_obstacle_count() const
 // "update_boundary" method manipulates two sectors ccw and one sector cw from any valid face.
 // Any boundary that does not fall into these manipulated faces are useless, and will be marked as false
 // The resultant is packed into a Boundary Location object and returned by reference as "face"
-bool AP_Proximity_Boundary_3D::convert_obstacle_num_to_face(uint8_t obstacle_num, Face& face) const
+bool AP_Proximity_Boundary_3D::convert_obstacle_num_to_face(uint16_t obstacle_num, Face& face) const
 {
+    if (obstacle_num >= get_obstacle_count()) {
+        return false;
+    }
+
     // obstacle num is just "flattened layers, and sectors"
     const uint8_t layer = obstacle_num / PROXIMITY_NUM_SECTORS;
     const uint8_t sector = obstacle_num % PROXIMITY_NUM_SECTORS;
@@ -284,7 +296,7 @@ bool AP_Proximity_Boundary_3D::convert_obstacle_num_to_face(uint8_t obstacle_num
 // Then returns the closest point on this line from vehicle, in body-frame. 
 // Used by GPS based Simple Avoidance  
 // False is returned if the obstacle_num provided does not produce a valid obstacle 
-bool AP_Proximity_Boundary_3D::get_obstacle(uint8_t obstacle_num, Vector3f& vec_to_obstacle) const
+bool AP_Proximity_Boundary_3D::get_obstacle(uint16_t obstacle_num, Vector3f& vec_to_obstacle) const
 {
     Face face;
     if (!convert_obstacle_num_to_face(obstacle_num, face)) {
@@ -294,8 +306,8 @@ bool AP_Proximity_Boundary_3D::get_obstacle(uint8_t obstacle_num, Vector3f& vec_
     const uint8_t sector_end = face.sector;
     const uint8_t sector_start = get_next_sector(face.sector);
     
-    const Vector3f start = _boundary_points[face.layer][sector_start];
-    const Vector3f end = _boundary_points[face.layer][sector_end];
+    const Vector3f start = get_boundary_point(face.layer, sector_start);
+    const Vector3f end = get_boundary_point(face.layer, sector_end);
     vec_to_obstacle = Vector3f::point_on_line_closest_to_other_point(start, end, Vector3f{});
     return true;
 }
@@ -308,7 +320,7 @@ bool AP_Proximity_Boundary_3D::get_obstacle(uint8_t obstacle_num, Vector3f& vec_
 // This helps us know if the passed line segment was in the direction of the boundary, or going in a different direction.
 // Used by GPS based Simple Avoidance  - for "brake mode"
 // False is returned if the obstacle_num provided does not produce a valid obstacle
-bool AP_Proximity_Boundary_3D::closest_point_from_segment_to_obstacle(uint8_t obstacle_num, const Vector3f& seg_start, const Vector3f& seg_end, Vector3f& closest_point) const
+bool AP_Proximity_Boundary_3D::closest_point_from_segment_to_obstacle(uint16_t obstacle_num, const Vector3f& seg_start, const Vector3f& seg_end, Vector3f& closest_point) const
 {
     Face face;
     if (!convert_obstacle_num_to_face(obstacle_num, face)) {
@@ -318,8 +330,8 @@ bool AP_Proximity_Boundary_3D::closest_point_from_segment_to_obstacle(uint8_t ob
 
     const uint8_t sector_end = face.sector;
     const uint8_t sector_start = get_next_sector(face.sector);
-    const Vector3f start = _boundary_points[face.layer][sector_start];
-    const Vector3f end = _boundary_points[face.layer][sector_end];
+    const Vector3f start = get_boundary_point(face.layer, sector_start);
+    const Vector3f end = get_boundary_point(face.layer, sector_end);
 
     // closest point between passed line segment and boundary
     Vector3f::segment_to_segment_closest_point(seg_start, seg_end, start, end, closest_point);
@@ -373,7 +385,7 @@ bool AP_Proximity_Boundary_3D::get_horizontal_object_angle_and_distance(uint8_t
 {
     if ((object_number < PROXIMITY_NUM_SECTORS) && _distance_valid[PROXIMITY_MIDDLE_LAYER][object_number]) {
         angle_deg = _angle[PROXIMITY_MIDDLE_LAYER][object_number];
-        distance = _filtered_distance[PROXIMITY_MIDDLE_LAYER][object_number].get();
+        distance = _filtered_distance[PROXIMITY_MIDDLE_LAYER][object_number];
         return true;
     }
     return false;
@@ -381,15 +393,18 @@ bool AP_Proximity_Boundary_3D::get_horizontal_object_angle_and_distance(uint8_t
 
 // get an obstacle info for AP_Periph
 // returns false if no angle or distance could be returned for some reason
-bool AP_Proximity_Boundary_3D::get_obstacle_info(uint8_t obstacle_num, float &angle_deg, float &pitch_deg, float &distance) const
+bool AP_Proximity_Boundary_3D::get_obstacle_info(uint16_t obstacle_num, float &angle_deg, float &pitch_deg, float &distance) const
 {
+    if (obstacle_num >= get_obstacle_count()) {
+        return false;
+    }
     // obstacle num is just "flattened layers, and sectors"
     const uint8_t layer = obstacle_num / PROXIMITY_NUM_SECTORS;
     const uint8_t sector = obstacle_num % PROXIMITY_NUM_SECTORS;
     if (_distance_valid[layer][sector]) {
         angle_deg = _angle[layer][sector];
         pitch_deg = _pitch[layer][sector];
-        distance = _filtered_distance[layer][sector].get();
+        distance = _filtered_distance[layer][sector];
         return true;
     }
 
@@ -408,35 +423,44 @@ bool AP_Proximity_Boundary_3D::get_filtered_distance(const Face &face, float &di
         return false;
     }
 
-    distance = _filtered_distance[face.layer][face.sector].get();
+    distance = _filtered_distance[face.layer][face.sector];
     return true;
 }
 
 // Get raw and filtered distances in 8 directions per layer
+// each direction holds the closest of the sectors centred within 22.5 degrees of it
 bool AP_Proximity_Boundary_3D::get_layer_distances(uint8_t layer_number, float dist_max, Proximity_Distance_Array &prx_dist_array, Proximity_Distance_Array &prx_filt_dist_array) const
 {
-    // cycle through all sectors filling in distances and orientations
+    if (layer_number >= PROXIMITY_NUM_LAYERS) {
+        return false;
+    }
+
     // see MAV_SENSOR_ORIENTATION for orientations (0 = forward, 1 = 45 degree clockwise from north, etc)
-    bool valid_distances = false;
     prx_dist_array.offset_valid = 0;
     prx_filt_dist_array.offset_valid = 0;
     for (uint8_t i=0; i<PROXIMITY_MAX_DIRECTION; i++) {
         prx_dist_array.orientation[i] = i;
-        const AP_Proximity_Boundary_3D::Face face(layer_number, i);
-        if (!face.valid()) {
-            return false;
+        prx_dist_array.distance[i] = dist_max;
+        prx_filt_dist_array.distance[i] = dist_max;
+    }
+
+    // cycle through all sectors filling in the closest distance in each direction
+    for (uint8_t sector=0; sector<PROXIMITY_NUM_SECTORS; sector++) {
+        const AP_Proximity_Boundary_3D::Face face(layer_number, sector);
+        float distance, filtered_distance;
+        if (!get_distance(face, distance) || !get_filtered_distance(face, filtered_distance)) {
+            continue;
         }
-        if (get_distance(face, prx_dist_array.distance[i]) && get_filtered_distance(face, prx_filt_dist_array.distance[i])) {
-            valid_distances = true;
+        const uint8_t i = _sector_direction[sector];
+        if (!prx_dist_array.valid(i) || (distance < prx_dist_array.distance[i])) {
+            prx_dist_array.distance[i] = distance;
+            prx_filt_dist_array.distance[i] = filtered_distance;
             prx_dist_array.offset_valid |= (1U << i);
             prx_filt_dist_array.offset_valid |= (1U << i);
-        } else {
-            prx_dist_array.distance[i] = dist_max;
-            prx_filt_dist_array.distance[i] = dist_max;
         }
     }
 
-    return valid_distances;
+    return prx_dist_array.offset_valid != 0;
 }
 
 // reset the temporary boundary. This fills in distances with FLT_MAX
@@ -0,0 +1,92 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Proximity/AP_Proximity_Boundary_3D.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  cost of updating and querying the 3D proximity boundary. The boundary
+  size is set when building, compare sizes by configuring with e.g.
+  --define PROXIMITY_NUM_SECTORS=36 --define PROXIMITY_NUM_LAYERS=9
+ */
+
+static AP_Proximity_Boundary_3D boundary;
+
+static void set_size_label(benchmark::State &state)
+{
+    char label[16];
+    snprintf(label, sizeof(label), "%ux%u", unsigned(PROXIMITY_NUM_SECTORS), unsigned(PROXIMITY_NUM_LAYERS));
+    state.SetLabel(label);
+}
+
+// face lookup for readings spread around the vehicle
+static void BM_ProximityGetFace(benchmark::State &state)
+{
+    set_size_label(state);
+    const uint16_t readings = state.range(0);
+    const float step_deg = 360.0f / readings;
+    while (state.KeepRunning()) {
+        for (uint16_t i=0; i<readings; i++) {
+            AP_Proximity_Boundary_3D::Face face = boundary.get_face((i % 9) * 10.0f - 40.0f, i * step_deg);
+            gbenchmark_escape(&face);
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * readings);
+}
+BENCHMARK(BM_ProximityGetFace)->Arg(360)->Arg(1440);
+
+// one revolution of a scanning lidar, updating each face with the
+// closest reading within it as the backends do
+static void BM_ProximityUpdate(benchmark::State &state)
+{
+    set_size_label(state);
+    boundary.set_filter_freq(0.25f);
+    const uint16_t readings = state.range(0);
+    const float step_deg = 360.0f / readings;
+    while (state.KeepRunning()) {
+        AP_Proximity_Boundary_3D::Face face;
+        float face_distance = FLT_MAX;
+        float face_yaw_deg = 0.0f;
+        for (uint16_t i=0; i<readings; i++) {
+            const float yaw_deg = i * step_deg;
+            const float distance = 5.0f + 3.0f * sinf(radians(yaw_deg * 3.0f));
+            const AP_Proximity_Boundary_3D::Face latest_face = boundary.get_face(yaw_deg);
+            if (latest_face != face) {
+                if (face.valid()) {
+                    boundary.set_face_attributes(face, face_yaw_deg, face_distance, 0);
+                }
+                face = latest_face;
+                face_distance = FLT_MAX;
+            }
+            if (distance < face_distance) {
+                face_distance = distance;
+                face_yaw_deg = yaw_deg;
+            }
+        }
+        boundary.set_face_attributes(face, face_yaw_deg, face_distance, 0);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * readings);
+}
+BENCHMARK(BM_ProximityUpdate)->Arg(360)->Arg(1440);
+
+// the obstacles read by AC_Avoid's adjust_velocity_proximity() each loop
+static void BM_ProximityObstacles(benchmark::State &state)
+{
+    set_size_label(state);
+    for (uint16_t yaw_deg=0; yaw_deg<360; yaw_deg+=5) {
+        boundary.set_face_attributes(boundary.get_face(yaw_deg), yaw_deg, 4.0f + yaw_deg * 0.01f, 0);
+    }
+    const uint16_t obstacle_count = boundary.get_obstacle_count();
+    while (state.KeepRunning()) {
+        for (uint16_t i=0; i<obstacle_count; i++) {
+            Vector3f vec_to_obstacle;
+            if (boundary.get_obstacle(i, vec_to_obstacle)) {
+                gbenchmark_escape(&vec_to_obstacle);
+            }
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * obstacle_count);
+}
+BENCHMARK(BM_ProximityObstacles);
+
+BENCHMARK_MAIN();
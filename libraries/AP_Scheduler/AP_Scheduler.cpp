@@ -70,7 +70,7 @@ const AP_Param::GroupInfo AP_Scheduler::var_info[] = {
     // @Param: OPTIONS
     // @DisplayName: Scheduling options
     // @Description: This controls optional aspects of the scheduler.
-    // @Bitmask: 0:Enable per-task perf info
+    // @Bitmask: 0:Enable per-task perf info, 1:Use event driven task queue
     // @User: Advanced
     AP_GROUPINFO("OPTIONS",  2, AP_Scheduler, _options, 0),
 
@@ -157,6 +157,127 @@ void AP_Scheduler::init(const AP_Scheduler::Task *tasks, uint8_t num_tasks, uint
         }
         old = _vehicle_tasks[i].priority;
     }
+
+    // the task queue needs the priority ordering checked above
+    if ((_options & uint8_t(Options::EVENT_TASK_QUEUE)) && !queue_init()) {
+        DEV_PRINTF("Unable to allocate scheduler task queue\n");
+    }
+}
+
+/*
+  setup the event driven task queue. The merged task table and the
+  interval between runs of each task are fixed at init, as the loop
+  rate can only be changed on reboot
+ */
+bool AP_Scheduler::queue_init(void)
+{
+    TaskQueue *q = NEW_NOTHROW TaskQueue;
+    if (q == nullptr) {
+        return false;
+    }
+    q->tasks = NEW_NOTHROW const Task*[_num_tasks];
+    q->interval_ticks = NEW_NOTHROW uint16_t[_num_tasks];
+    q->next_due = NEW_NOTHROW uint32_t[_num_tasks];
+    q->heap = NEW_NOTHROW uint8_t[_num_tasks];
+    if (q->tasks == nullptr || q->interval_ticks == nullptr ||
+        q->next_due == nullptr || q->heap == nullptr) {
+        delete[] q->tasks;
+        delete[] q->interval_ticks;
+        delete[] q->next_due;
+        delete[] q->heap;
+        delete q;
+        return false;
+    }
+    _queue = q;
+
+    // merge the vehicle and common tables in the same order as run_scan()
+    uint8_t vehicle_tasks_offset = 0;
+    uint8_t common_tasks_offset = 0;
+    for (uint8_t i=0; i<_num_tasks; i++) {
+        const Task &task = next_task_in_order(vehicle_tasks_offset, common_tasks_offset);
+        q->tasks[i] = &task;
+
+        if (task.priority <= MAX_FAST_TASK_PRIORITIES) {
+            // fast tasks run every loop, so are always ready
+            q->interval_ticks[i] = 1;
+            q->ready[i/32] |= 1U<<(i%32);
+            continue;
+        }
+
+        // we allow 0 to mean loop rate
+        uint32_t interval_ticks = (is_zero(task.rate_hz) ? 1 : _loop_rate_hz / task.rate_hz);
+        q->interval_ticks[i] = constrain_uint32(interval_ticks, 1, UINT16_MAX);
+        q->next_due[i] = _tick_counter32 + q->interval_ticks[i];
+        queue_push(i);
+    }
+
+    return true;
+}
+
+/*
+  return the next task from the merged vehicle and common task
+  tables. In case of a priority tie the vehicle-specific entry wins
+ */
+const AP_Scheduler::Task &AP_Scheduler::next_task_in_order(uint8_t &vehicle_tasks_offset, uint8_t &common_tasks_offset) const
+{
+    bool use_vehicle_task;
+    if (vehicle_tasks_offset < _num_vehicle_tasks &&
+        common_tasks_offset < _num_common_tasks) {
+        use_vehicle_task = _vehicle_tasks[vehicle_tasks_offset].priority <= _common_tasks[common_tasks_offset].priority;
+    } else {
+        use_vehicle_task = vehicle_tasks_offset < _num_vehicle_tasks;
+    }
+    return use_vehicle_task ? _vehicle_tasks[vehicle_tasks_offset++] : _common_tasks[common_tasks_offset++];
+}
+
+/*
+  return true if task a should come off the queue before task b. Ties
+  are broken on task index, which is priority order
+ */
+bool AP_Scheduler::queue_before(uint8_t a, uint8_t b) const
+{
+    const int32_t diff = int32_t(_queue->next_due[a] - _queue->next_due[b]);
+    return diff < 0 || (diff == 0 && a < b);
+}
+
+// add a task to the heap of pending tasks
+void AP_Scheduler::queue_push(uint8_t i)
+{
+    uint8_t *heap = _queue->heap;
+    uint8_t n = _queue->heap_len++;
+    while (n > 0) {
+        const uint8_t parent = (n-1)/2;
+        if (!queue_before(i, heap[parent])) {
+            break;
+        }
+        heap[n] = heap[parent];
+        n = parent;
+    }
+    heap[n] = i;
+}
+
+// remove the task at the top of the heap of pending tasks
+void AP_Scheduler::queue_pop(void)
+{
+    uint8_t *heap = _queue->heap;
+    const uint8_t len = --_queue->heap_len;
+    const uint8_t last = heap[len];
+    uint8_t n = 0;
+    while (true) {
+        uint8_t child = 2*n+1;
+        if (child >= len) {
+            break;
+        }
+        if (child+1 < len && queue_before(heap[child+1], heap[child])) {
+            child++;
+        }
+        if (!queue_before(heap[child], last)) {
+            break;
+        }
+        heap[n] = heap[child];
+        n = child;
+    }
+    heap[n] = last;
 }
 
 // one tick has passed
@@ -184,129 +305,207 @@ static void fill_nanf_stack(void)
  */
 void AP_Scheduler::run(uint32_t time_available)
 {
-    uint32_t run_started_usec = AP_HAL::micros();
-    uint32_t now = run_started_usec;
+    const uint32_t run_started_usec = AP_HAL::micros();
+    _task_time_total = 0;
+    _tasks_run = 0;
+    _longest_task = 0;
+    _longest_task_us = 0;
+
+    if (_queue != nullptr) {
+        run_queue(time_available);
+    } else {
+        run_scan(time_available);
+    }
+
+    // update number of spare microseconds
+    _spare_micros += time_available;
+
+    _spare_ticks++;
+    if (_spare_ticks == 32) {
+        _spare_ticks /= 2;
+        _spare_micros /= 2;
+    }
+
+    // time not spent inside tasks is scheduling overhead
+    const uint32_t run_time_us = AP_HAL::micros() - run_started_usec;
+    const uint32_t overhead_us = run_time_us - _task_time_total;
+    perf_info.update_sched_overhead(overhead_us);
+
+    const AP::PerfInfo::TickTrace trace = {
+        tick : _tick_counter32,
+        loop_start_us : uint32_t(_loop_sample_time_us),
+        loop_time_us : uint16_t(MIN(_last_loop_time_s * 1.0e6f, UINT16_MAX)),
+        run_time_us : uint16_t(MIN(run_time_us, UINT16_MAX)),
+        sched_overhead_us : uint16_t(MIN(overhead_us, UINT16_MAX)),
+        longest_task_us : _longest_task_us,
+        longest_task : _longest_task,
+        tasks_run : _tasks_run,
+    };
+    perf_info.record_tick(trace);
+}
+
+/*
+  run tasks by walking the complete task table, checking each task to
+  see if it is due
+ */
+void AP_Scheduler::run_scan(uint32_t &time_available)
+{
+    uint32_t now = AP_HAL::micros();
 
     uint8_t vehicle_tasks_offset = 0;
     uint8_t common_tasks_offset = 0;
 
     for (uint8_t i=0; i<_num_tasks; i++) {
-        // determine which of the common task / vehicle task to run
-        bool run_vehicle_task = false;
-        if (vehicle_tasks_offset < _num_vehicle_tasks &&
-            common_tasks_offset < _num_common_tasks) {
-            // still have entries on both lists; compare the
-            // priorities.  In case of a tie the vehicle-specific
-            // entry wins.
-            const Task &vehicle_task = _vehicle_tasks[vehicle_tasks_offset];
-            const Task &common_task = _common_tasks[common_tasks_offset];
-            if (vehicle_task.priority <= common_task.priority) {
-                run_vehicle_task = true;
-            }
-        } else if (vehicle_tasks_offset < _num_vehicle_tasks) {
-            // out of common tasks to run
-            run_vehicle_task = true;
-        } else if (common_tasks_offset < _num_common_tasks) {
-            // out of vehicle tasks to run
-            run_vehicle_task = false;
-        } else {
-            // this is an error; the outside loop should have terminated
-            INTERNAL_ERROR(AP_InternalError::error_t::flow_of_control);
-            break;
-        }
-
-        const AP_Scheduler::Task &task = run_vehicle_task ? _vehicle_tasks[vehicle_tasks_offset] : _common_tasks[common_tasks_offset];
-        if (run_vehicle_task) {
-            vehicle_tasks_offset++;
-        } else {
-            common_tasks_offset++;
-        }
+        const AP_Scheduler::Task &task = next_task_in_order(vehicle_tasks_offset, common_tasks_offset);
 
         if (task.priority > MAX_FAST_TASK_PRIORITIES) {
-            const uint16_t dt = _tick_counter - _last_run[i];
             // we allow 0 to mean loop rate
             uint32_t interval_ticks = (is_zero(task.rate_hz) ? 1 : _loop_rate_hz / task.rate_hz);
             if (interval_ticks < 1) {
                 interval_ticks = 1;
             }
-            if (dt < interval_ticks) {
-                // this task is not yet scheduled to run again
+            if (!task_due(i, interval_ticks, task.max_time_micros, time_available)) {
                 continue;
             }
-            // this task is due to run. Do we have enough time to run it?
-            _task_time_allowed = task.max_time_micros;
+        } else {
+            _task_time_allowed = get_loop_period_us();
+        }
 
-            if (dt >= interval_ticks*2) {
-                perf_info.task_slipped(i);
-            }
+        run_task(task, i, now, time_available);
+    }
+}
 
-            if (dt >= interval_ticks*max_task_slowdown) {
-                // we are going beyond the maximum slowdown factor for a
-                // task. This will trigger increasing the time budget
-                task_not_achieved++;
+/*
+  run tasks from the event driven task queue. Only tasks which have
+  become due are looked at, in the same priority order as run_scan()
+ */
+void AP_Scheduler::run_queue(uint32_t &time_available)
+{
+    uint32_t now = AP_HAL::micros();
+    TaskQueue &q = *_queue;
+
+    // move tasks that have become due onto the ready mask
+    while (q.heap_len > 0 && int32_t(_tick_counter32 - q.next_due[q.heap[0]]) >= 0) {
+        const uint8_t i = q.heap[0];
+        queue_pop();
+        q.ready[i/32] |= 1U<<(i%32);
+    }
+
+    for (uint8_t w=0; w<ARRAY_SIZE(q.ready); w++) {
+        uint32_t bits = q.ready[w];
+        while (bits != 0) {
+            const uint8_t i = w*32 + __builtin_ctz(bits);
+            bits &= bits - 1;
+
+            const Task &task = *q.tasks[i];
+            if (task.priority > MAX_FAST_TASK_PRIORITIES) {
+                if (!task_due(i, q.interval_ticks[i], task.max_time_micros, time_available)) {
+                    // stays on the ready mask until there is time to run it
+                    continue;
+                }
+            } else {
+                _task_time_allowed = get_loop_period_us();
             }
 
-            if (_task_time_allowed > time_available) {
-                // not enough time to run this task.  Continue loop -
-                // maybe another task will fit into time remaining
-                continue;
+            run_task(task, i, now, time_available);
+
+            if (task.priority > MAX_FAST_TASK_PRIORITIES) {
+                q.ready[w] &= ~(1U<<(i%32));
+                q.next_due[i] = _tick_counter32 + q.interval_ticks[i];
+                queue_push(i);
             }
-        } else {
-            _task_time_allowed = get_loop_period_us();
         }
+    }
+}
+
+/*
+  check if a non-fast task is due to run and whether we have enough
+  time to run it
+ */
+bool AP_Scheduler::task_due(uint8_t i, uint32_t interval_ticks, uint16_t max_time_micros, uint32_t time_available)
+{
+    const uint16_t dt = _tick_counter - _last_run[i];
+    if (dt < interval_ticks) {
+        // this task is not yet scheduled to run again
+        return false;
+    }
+    // this task is due to run. Do we have enough time to run it?
+    _task_time_allowed = max_time_micros;
+
+    if (dt >= interval_ticks*2) {
+        perf_info.task_slipped(i);
+    }
+
+    if (dt >= interval_ticks*max_task_slowdown) {
+        // we are going beyond the maximum slowdown factor for a
+        // task. This will trigger increasing the time budget
+        task_not_achieved++;
+    }
+
+    if (_task_time_allowed > time_available) {
+        // not enough time to run this task.  Continue loop -
+        // maybe another task will fit into time remaining
+        return false;
+    }
+    return true;
+}
 
-        // run it
-        _task_time_started = now;
-        hal.util->persistent_data.scheduler_task = i;
+/*
+  run a single task and update timing statistics
+ */
+void AP_Scheduler::run_task(const Task &task, uint8_t i, uint32_t &now, uint32_t &time_available)
+{
+    // run it
+    _task_time_started = now;
+    hal.util->persistent_data.scheduler_task = i;
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
-        fill_nanf_stack();
+    fill_nanf_stack();
 #endif
-        task.function();
-        hal.util->persistent_data.scheduler_task = -1;
-
-        // record the tick counter when we ran. This drives
-        // when we next run the event
-        _last_run[i] = _tick_counter;
-
-        // work out how long the event actually took
-        now = AP_HAL::micros();
-        uint32_t time_taken = now - _task_time_started;
-        bool overrun = false;
-        if (time_taken > _task_time_allowed) {
-            overrun = true;
-            // the event overran!
-            debug(3, "Scheduler overrun task[%u-%s] (%u/%u)\n",
-                  (unsigned)i,
-                  task.name,
-                  (unsigned)time_taken,
-                  (unsigned)_task_time_allowed);
-        }
+    if (task.priority <= MAX_FAST_TASK_PRIORITIES) {
+        perf_info.update_task_start(i, _task_time_started, get_loop_period_us());
+    }
+    task.function();
+    hal.util->persistent_data.scheduler_task = -1;
 
-        perf_info.update_task_info(i, time_taken, overrun);
-
-        if (time_taken >= time_available) {
-            /*
-              we are out of time, but we need to keep walking the task
-              table in case there is another fast loop task after this
-              task, plus we need to update the accouting so we can
-              work out if we need to allocate extra time for the loop
-              (lower the loop rate)
-              Just set time_available to zero, which means we will
-              only run fast tasks after this one
-             */
-            time_available = 0;
-        } else {
-            time_available -= time_taken;
-        }
+    // record the tick counter when we ran. This drives
+    // when we next run the event
+    _last_run[i] = _tick_counter;
+
+    // work out how long the event actually took
+    now = AP_HAL::micros();
+    uint32_t time_taken = now - _task_time_started;
+    _task_time_total += time_taken;
+    _tasks_run++;
+    if (time_taken > _longest_task_us) {
+        _longest_task = i;
+        _longest_task_us = MIN(time_taken, UINT16_MAX);
+    }
+    bool overrun = false;
+    if (time_taken > _task_time_allowed) {
+        overrun = true;
+        // the event overran!
+        debug(3, "Scheduler overrun task[%u-%s] (%u/%u)\n",
+              (unsigned)i,
+              task.name,
+              (unsigned)time_taken,
+              (unsigned)_task_time_allowed);
     }
 
-    // update number of spare microseconds
-    _spare_micros += time_available;
+    perf_info.update_task_info(i, time_taken, overrun);
 
-    _spare_ticks++;
-    if (_spare_ticks == 32) {
-        _spare_ticks /= 2;
-        _spare_micros /= 2;
+    if (time_taken >= time_available) {
+        /*
+          we are out of time, but we need to keep walking the task
+          table in case there is another fast loop task after this
+          task, plus we need to update the accouting so we can
+          work out if we need to allocate extra time for the loop
+          (lower the loop rate)
+          Just set time_available to zero, which means we will
+          only run fast tasks after this one
+         */
+        time_available = 0;
+    } else {
+        time_available -= time_taken;
     }
 }
 
@@ -415,7 +614,14 @@ void AP_Scheduler::loop()
     }
 
     // check loop time
-    perf_info.check_loop_time(sample_time_us - _loop_timer_start_us);
+    const uint32_t loop_time_us = sample_time_us - _loop_timer_start_us;
+    perf_info.check_loop_time(loop_time_us);
+#if HAL_LOGGING_ENABLED
+    if (perf_info.is_long_running(loop_time_us)) {
+        // log the ticks leading up to the long loop
+        perf_info.log_trace();
+    }
+#endif
         
     _loop_timer_start_us = sample_time_us;
 
@@ -505,40 +711,35 @@ void AP_Scheduler::task_info(ExpandingString &str)
 
     for (uint8_t i = 0; i < _num_tasks; i++) {
         const AP::PerfInfo::TaskInfo* ti = perf_info.get_task_info(i);
-        const char *task_name;
-
-        // determine which of the common task / vehicle task to run
-        bool run_vehicle_task = false;
-        if (vehicle_tasks_offset < _num_vehicle_tasks &&
-            common_tasks_offset < _num_common_tasks) {
-            // still have entries on both lists; compare the
-            // priorities.  In case of a tie the vehicle-specific
-            // entry wins.
-            const Task &vehicle_task = _vehicle_tasks[vehicle_tasks_offset];
-            const Task &common_task = _common_tasks[common_tasks_offset];
-            if (vehicle_task.priority <= common_task.priority) {
-                run_vehicle_task = true;
-            }
-        } else if (vehicle_tasks_offset < _num_vehicle_tasks) {
-            // out of common tasks to run
-            run_vehicle_task = true;
-        } else if (common_tasks_offset < _num_common_tasks) {
-            // out of vehicle tasks to run
-            run_vehicle_task = false;
-        } else {
-            // this is an error; the outside loop should have terminated
-            INTERNAL_ERROR(AP_InternalError::error_t::flow_of_control);
-            return;
-        }
-
-        if (run_vehicle_task) {
-            task_name = _vehicle_tasks[vehicle_tasks_offset++].name;
-        } else {
-            task_name = _common_tasks[common_tasks_offset++].name;
-        }
+        const char *task_name = next_task_in_order(vehicle_tasks_offset, common_tasks_offset).name;
 
         ti->print(task_name, total_time, str);
     }
+
+    // scheduling overhead, to allow comparison of the scan and queue modes
+    str.printf("SCHED MODE=%s OVH AVG=%4u MAX=%4u\n",
+               _queue != nullptr ? "QUEUE" : "SCAN",
+               unsigned(perf_info.get_avg_sched_overhead_us()),
+               unsigned(perf_info.get_max_sched_overhead_us()));
+    perf_info.print_offload_info(str);
+
+    // run time histograms, bucket n is [2^n, 2^(n+1)) microseconds
+    str.printf("HIST");
+    for (uint8_t b = 0; b < AP::PerfInfo::HIST_BUCKETS; b++) {
+        str.printf(" %5u", unsigned(1U<<b));
+    }
+    str.printf("\n");
+    vehicle_tasks_offset = 0;
+    common_tasks_offset = 0;
+    for (uint8_t i = 0; i < _num_tasks; i++) {
+        const Task &task = next_task_in_order(vehicle_tasks_offset, common_tasks_offset);
+        const AP::PerfInfo::TaskHist* th = perf_info.get_task_hist(i);
+        if (th != nullptr) {
+            th->print(task.name, str);
+        }
+    }
+
+    perf_info.print_trace(str);
 }
 
 namespace AP {
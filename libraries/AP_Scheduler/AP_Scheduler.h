@@ -93,7 +93,8 @@ public:
     };
 
     enum class Options : uint8_t {
-        RECORD_TASK_INFO = 1 << 0
+        RECORD_TASK_INFO = 1 << 0,
+        EVENT_TASK_QUEUE = 1 << 1,
     };
 
     enum FastTaskPriorities {
@@ -239,6 +240,15 @@ private:
     // the time in microseconds when the task started
     uint32_t _task_time_started;
 
+    // total microseconds spent inside tasks in the current run()
+    uint32_t _task_time_total;
+
+    // number of tasks run and the longest task in the current run(),
+    // for the tick trace
+    uint8_t _tasks_run;
+    uint8_t _longest_task;
+    uint16_t _longest_task_us;
+
     // number of spare microseconds accumulated
     uint32_t _spare_micros;
 
@@ -273,6 +283,44 @@ private:
 
     // semaphore that is held while not waiting for ins samples
     HAL_Semaphore _rsem;
+
+    // return the next task from the merged vehicle and common task tables
+    const Task &next_task_in_order(uint8_t &vehicle_tasks_offset, uint8_t &common_tasks_offset) const;
+
+    // check if a non-fast task is due and fits in the time
+    // available, updating the slip accounting
+    bool task_due(uint8_t i, uint32_t interval_ticks, uint16_t max_time_micros, uint32_t time_available);
+
+    // run a single task, updating timing statistics
+    void run_task(const Task &task, uint8_t i, uint32_t &now, uint32_t &time_available);
+
+    // run tasks by scanning the complete task table
+    void run_scan(uint32_t &time_available);
+
+    /*
+      event driven task queue. Tasks that are not yet due sit in a
+      min-heap keyed on the tick at which they next become due. Each
+      tick the due tasks are moved to a ready bitmask, which is then
+      walked in priority order so priority and max_time_micros
+      semantics match the table scan
+     */
+    struct TaskQueue {
+        const Task **tasks;         // merged task table in priority order
+        uint16_t *interval_ticks;   // precomputed interval between runs
+        uint32_t *next_due;         // tick at which each task is next due
+        uint8_t *heap;              // task indexes ordered on next_due
+        uint8_t heap_len;
+        uint32_t ready[8];          // bitmask of tasks ready to run
+    } *_queue;
+
+    // setup the event driven task queue, returns false on allocation failure
+    bool queue_init(void);
+    void queue_push(uint8_t i);
+    void queue_pop(void);
+    bool queue_before(uint8_t a, uint8_t b) const;
+
+    // run tasks from the event driven task queue
+    void run_queue(uint32_t &time_available);
 };
 
 namespace AP {
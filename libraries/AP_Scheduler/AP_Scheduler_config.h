@@ -9,3 +9,8 @@
 #ifndef AP_SCHEDULER_EXTENDED_TASKINFO_ENABLED
 #define AP_SCHEDULER_EXTENDED_TASKINFO_ENABLED 1
 #endif
+
+// number of scheduler ticks kept in the trace ring buffer
+#ifndef AP_SCHEDULER_TRACE_LEN
+#define AP_SCHEDULER_TRACE_LEN 32
+#endif
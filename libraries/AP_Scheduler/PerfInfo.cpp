@@ -31,6 +31,12 @@ void AP::PerfInfo::reset()
     long_running = 0;
     sigma_time = 0;
     sigmasquared_time = 0;
+    sched_overhead_sum_us = 0;
+    sched_overhead_max_us = 0;
+    sched_overhead_count = 0;
+    offload_sum_us = 0;
+    offload_max_us = 0;
+    offload_count = 0;
     if (_task_info != nullptr) {
         memset(_task_info, 0, (_num_tasks) * sizeof(TaskInfo));
     }
@@ -46,9 +52,11 @@ void AP::PerfInfo::ignore_this_loop()
 void AP::PerfInfo::allocate_task_info(uint8_t num_tasks)
 {
     _task_info = NEW_NOTHROW TaskInfo[num_tasks];
-    if (_task_info == nullptr) {
+    _task_hist = NEW_NOTHROW TaskHist[num_tasks];
+    _trace = NEW_NOTHROW TickTrace[AP_SCHEDULER_TRACE_LEN];
+    if (_task_info == nullptr || _task_hist == nullptr || _trace == nullptr) {
         DEV_PRINTF("Unable to allocate scheduler TaskInfo\n");
-        _num_tasks = 0;
+        free_task_info();
         return;
     }
     _num_tasks = num_tasks;
@@ -58,6 +66,12 @@ void AP::PerfInfo::free_task_info()
 {
     delete[] _task_info;
     _task_info = nullptr;
+    delete[] _task_hist;
+    _task_hist = nullptr;
+    delete[] _trace;
+    _trace = nullptr;
+    _trace_head = 0;
+    _trace_count = 0;
     _num_tasks = 0;
 }
 
@@ -74,8 +88,121 @@ void AP::PerfInfo::update_task_info(uint8_t task_index, uint16_t task_time_us, b
     }
     TaskInfo& ti = _task_info[task_index];
     ti.update(task_time_us, overrun);
+    _task_hist[task_index].update(task_time_us);
+}
+
+// add a task run time to the log2 histogram
+void AP::PerfInfo::TaskHist::update(uint16_t task_time_us)
+{
+    uint8_t b = 0;
+    if (task_time_us > 1) {
+        b = MIN(uint8_t(31 - __builtin_clz(task_time_us)), uint8_t(HIST_BUCKETS-1));
+    }
+    if (bucket[b] == UINT16_MAX) {
+        // halve all counts so the shape of the distribution is kept
+        for (uint8_t i=0; i<HIST_BUCKETS; i++) {
+            bucket[i] /= 2;
+        }
+    }
+    bucket[b]++;
+}
+
+// track deviation of the interval between task starts from the loop period
+void AP::PerfInfo::TaskHist::update_start(uint32_t start_us, uint32_t period_us)
+{
+    if (last_start_us != 0) {
+        const uint32_t interval_us = start_us - last_start_us;
+        const uint32_t jitter_us = MIN(interval_us > period_us ? interval_us - period_us : period_us - interval_us, UINT16_MAX);
+        jitter_max_us = MAX(jitter_max_us, uint16_t(jitter_us));
+        if (jitter_count == UINT16_MAX) {
+            jitter_count /= 2;
+            jitter_sum_us /= 2;
+        }
+        jitter_count++;
+        jitter_sum_us += jitter_us;
+    }
+    last_start_us = start_us;
 }
 
+void AP::PerfInfo::TaskHist::print(const char* task_name, ExpandingString& str) const
+{
+#if AP_SCHEDULER_EXTENDED_TASKINFO_ENABLED
+    str.printf("%-32.32s", task_name);
+#else
+    str.printf("%-16.16s", task_name);
+#endif
+    for (uint8_t i=0; i<HIST_BUCKETS; i++) {
+        str.printf(" %5u", unsigned(bucket[i]));
+    }
+    if (jitter_count > 0) {
+        str.printf(" JIT AVG=%4u MAX=%4u", unsigned(jitter_sum_us / jitter_count), unsigned(jitter_max_us));
+    }
+    str.printf("\n");
+}
+
+// add a tick to the trace ring buffer
+void AP::PerfInfo::record_tick(const TickTrace &trace)
+{
+    if (_trace == nullptr) {
+        return;
+    }
+    _trace[_trace_head] = trace;
+    _trace_head = (_trace_head + 1) % AP_SCHEDULER_TRACE_LEN;
+    if (_trace_count < AP_SCHEDULER_TRACE_LEN) {
+        _trace_count++;
+    }
+}
+
+// print the trace ring buffer, oldest tick first
+void AP::PerfInfo::print_trace(ExpandingString& str) const
+{
+    if (_trace == nullptr) {
+        return;
+    }
+    str.printf("TRACE TICK START LOOP RUN OVH NRUN LONGEST LONGT\n");
+    for (uint8_t i=0; i<_trace_count; i++) {
+        const TickTrace &t = _trace[(_trace_head + AP_SCHEDULER_TRACE_LEN - _trace_count + i) % AP_SCHEDULER_TRACE_LEN];
+        str.printf("TRACE %lu %lu %u %u %u %u %u %u\n",
+                   (unsigned long)t.tick, (unsigned long)t.loop_start_us,
+                   unsigned(t.loop_time_us), unsigned(t.run_time_us),
+                   unsigned(t.sched_overhead_us), unsigned(t.tasks_run),
+                   unsigned(t.longest_task), unsigned(t.longest_task_us));
+    }
+}
+
+#if HAL_LOGGING_ENABLED
+/*
+  write the trace ring buffer to the log. This is called on a long
+  running loop, so is rate limited to avoid flooding the log when the
+  CPU is overloaded
+ */
+void AP::PerfInfo::log_trace()
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    if (_trace == nullptr || now_ms - _last_trace_log_ms < 5000) {
+        return;
+    }
+    _last_trace_log_ms = now_ms;
+    const uint64_t now_us = AP_HAL::micros64();
+    for (uint8_t i=0; i<_trace_count; i++) {
+        const TickTrace &t = _trace[(_trace_head + AP_SCHEDULER_TRACE_LEN - _trace_count + i) % AP_SCHEDULER_TRACE_LEN];
+        const struct log_SchedTrace pkt = {
+            LOG_PACKET_HEADER_INIT(LOG_SCHED_TRACE_MSG),
+            time_us          : now_us,
+            tick             : t.tick,
+            loop_start_us    : t.loop_start_us,
+            loop_time_us     : t.loop_time_us,
+            run_time_us      : t.run_time_us,
+            sched_overhead_us: t.sched_overhead_us,
+            tasks_run        : t.tasks_run,
+            longest_task     : t.longest_task,
+            longest_task_us  : t.longest_task_us,
+        };
+        AP::logger().WriteBlock(&pkt, sizeof(pkt));
+    }
+}
+#endif  // HAL_LOGGING_ENABLED
+
 void AP::PerfInfo::TaskInfo::update(uint16_t task_time_us, bool overrun)
 {
     max_time_us = MAX(max_time_us, task_time_us);
@@ -158,6 +285,48 @@ void AP::PerfInfo::check_loop_time(uint32_t time_in_micros)
     }
 }
 
+// update_sched_overhead - record time spent by the scheduler itself in one tick
+void AP::PerfInfo::update_sched_overhead(uint32_t overhead_us)
+{
+    if (sched_overhead_count == UINT16_MAX) {
+        return;
+    }
+    sched_overhead_count++;
+    sched_overhead_sum_us += overhead_us;
+    sched_overhead_max_us = MAX(sched_overhead_max_us, overhead_us);
+}
+
+// get_avg_sched_overhead_us - return average scheduling overhead per tick
+uint32_t AP::PerfInfo::get_avg_sched_overhead_us() const
+{
+    if (sched_overhead_count == 0) {
+        return 0;
+    }
+    return sched_overhead_sum_us / sched_overhead_count;
+}
+
+// update_offload_time - record time taken by work moved off the main loop
+void AP::PerfInfo::update_offload_time(uint32_t time_us)
+{
+    offload_sum_us += time_us;
+    offload_max_us = MAX(offload_max_us, time_us);
+    offload_count++;
+}
+
+// print_offload_info - display offloaded work timing for @SYS/tasks.txt
+void AP::PerfInfo::print_offload_info(ExpandingString& str) const
+{
+    const uint32_t count = offload_count;
+    if (count == 0 && offload_drop_count == 0) {
+        return;
+    }
+    str.printf("OFFLOAD AVG=%4u MAX=%4u N=%lu DROP=%lu\n",
+               unsigned(count > 0 ? offload_sum_us / count : 0),
+               unsigned(offload_max_us),
+               (unsigned long)count,
+               (unsigned long)offload_drop_count);
+}
+
 // get_num_loops: return number of loops used for recording performance
 uint16_t AP::PerfInfo::get_num_loops() const
 {
@@ -6,6 +6,7 @@
 
 #include <stdint.h>
 #include <AP_Common/ExpandingString.h>
+#include <AP_Logger/AP_Logger_config.h>
 
 namespace AP {
 
@@ -26,6 +27,38 @@ public:
         void print(const char* task_name, uint32_t total_time, ExpandingString& str) const;
     };
 
+    // number of log2 buckets in the per-task time histogram. Bucket
+    // n counts run times in [2^n, 2^(n+1)) microseconds, with the
+    // last bucket collecting everything longer
+    static const uint8_t HIST_BUCKETS = 13;
+
+    // per-task run time histogram and start time jitter. Unlike
+    // TaskInfo these are not reset each second, instead all counts
+    // are halved when one would overflow
+    struct TaskHist {
+        uint16_t bucket[HIST_BUCKETS];
+        uint32_t last_start_us;
+        uint16_t jitter_max_us;
+        uint16_t jitter_count;
+        uint32_t jitter_sum_us;
+
+        void update(uint16_t task_time_us);
+        void update_start(uint32_t start_us, uint32_t period_us);
+        void print(const char* task_name, ExpandingString& str) const;
+    };
+
+    // record of one scheduler tick for the trace ring buffer
+    struct TickTrace {
+        uint32_t tick;
+        uint32_t loop_start_us;
+        uint16_t loop_time_us;      // time since the previous loop start
+        uint16_t run_time_us;       // time spent in AP_Scheduler::run()
+        uint16_t sched_overhead_us; // run time not spent inside tasks
+        uint16_t longest_task_us;
+        uint8_t longest_task;
+        uint8_t tasks_run;
+    };
+
     /* Do not allow copies */
     CLASS_NO_COPY(PerfInfo);
 
@@ -55,6 +88,28 @@ public:
     }
     // called after each run of a task to update its statistics based on measurements taken by the scheduler
     void update_task_info(uint8_t task_index, uint16_t task_time_us, bool overrun);
+    // called with the start time of each run of a fast task to track jitter
+    void update_task_start(uint8_t task_index, uint32_t start_us, uint32_t period_us) {
+        if (_task_hist && task_index < _num_tasks) {
+            _task_hist[task_index].update_start(start_us, period_us);
+        }
+    }
+    const TaskHist* get_task_hist(uint8_t task_index) const {
+        return (_task_hist && task_index < _num_tasks) ? &_task_hist[task_index] : nullptr;
+    }
+    // add a tick to the trace ring buffer
+    void record_tick(const TickTrace &trace);
+    // print the trace ring buffer, oldest tick first
+    void print_trace(ExpandingString& str) const;
+#if HAL_LOGGING_ENABLED
+    // write the trace ring buffer to the log
+    void log_trace();
+#endif
+    // return true if a loop time counts as long running
+    bool is_long_running(uint32_t time_in_micros) const {
+        return time_in_micros > overtime_threshold_micros;
+    }
+
     // record that a task slipped
     void task_slipped(uint8_t task_index) {
         if (_task_info && task_index < _num_tasks) {
@@ -62,6 +117,18 @@ public:
         }
     }
 
+    // record the time spent in the scheduler outside of tasks for one tick
+    void update_sched_overhead(uint32_t overhead_us);
+    uint32_t get_avg_sched_overhead_us() const;
+    uint32_t get_max_sched_overhead_us() const { return sched_overhead_max_us; }
+
+    // record the time taken by work moved off the main loop onto
+    // another thread, such as IMU filtering on the INS filter thread
+    void update_offload_time(uint32_t time_us);
+    // record that offloaded work was dropped as the thread fell behind
+    void offload_dropped() { offload_drop_count++; }
+    void print_offload_info(ExpandingString& str) const;
+
 private:
     uint16_t loop_rate_hz;
     uint16_t overtime_threshold_micros;
@@ -74,9 +141,24 @@ private:
     uint32_t last_check_us;
     float filtered_loop_time;
     bool ignore_loop;
+    // scheduling overhead
+    uint32_t sched_overhead_sum_us;
+    uint32_t sched_overhead_max_us;
+    uint16_t sched_overhead_count;
+    // offloaded work, updated from other threads so only approximate
+    uint32_t offload_sum_us;
+    uint32_t offload_max_us;
+    uint32_t offload_count;
+    uint32_t offload_drop_count;
     // performance monitoring
     uint8_t _num_tasks;
     TaskInfo* _task_info;
+    TaskHist* _task_hist;
+    // ring buffer of recent scheduler ticks
+    TickTrace* _trace;
+    uint8_t _trace_head;
+    uint8_t _trace_count;
+    uint32_t _last_trace_log_ms;
 };
 
 };
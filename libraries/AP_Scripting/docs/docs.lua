@@ -3822,6 +3822,20 @@ function poscontrol:get_vel_target() end
 ---@return Vector3f_ud|nil
 function poscontrol:get_accel_target() end
 
+-- copter whole-mission time and distance estimates
+mission_plan = {}
+
+-- get the time in seconds and distance in meters to fly the whole mission
+---@return number|nil
+---@return number|nil
+function mission_plan:get_total() end
+
+-- get the time in seconds, distance in meters and energy in watt-hours needed to complete the mission from the current position
+---@return number|nil
+---@return number|nil
+---@return number|nil
+function mission_plan:get_remaining() end
+
 -- precision landing access
 precland = {}
 
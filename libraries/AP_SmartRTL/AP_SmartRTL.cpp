@@ -30,8 +30,8 @@ const AP_Param::GroupInfo AP_SmartRTL::var_info[] = {
 
     // @Param: POINTS
     // @DisplayName: SmartRTL maximum number of points on path
-    // @Description: SmartRTL maximum number of points on path. Set to 0 to disable SmartRTL.  100 points consumes about 3k of memory.
-    // @Range: 0 500
+    // @Description: SmartRTL maximum number of points on path. Set to 0 to disable SmartRTL.  100 points consumes about 3.5k of memory. Boards with less memory are limited to 500 points.
+    // @Range: 0 5000
     // @User: Advanced
     // @RebootRequired: True
     AP_GROUPINFO("POINTS", 1, AP_SmartRTL, _points_max, SMARTRTL_POINTS_DEFAULT),
@@ -64,8 +64,14 @@ const AP_Param::GroupInfo AP_SmartRTL::var_info[] = {
 *    (p2,p3) will get very close (they touch), but there would be nothing to
 *    trim between them.
 *
+*    To avoid checking every pair of segments, the segments are kept in a
+*    hashed grid of cells several times the accuracy parameter wide, and each
+*    new segment is only checked against the segments in the cells it passes
+*    through.
+*
 *    2. Simplification uses the Ramer-Douglas-Peucker algorithm. See Wikipedia
-*    for a more complete description.
+*    for a more complete description. Only the points added since the last
+*    simplification are simplified.
 *
 *    The simplification and pruning algorithms run in the background and do not
 *    alter the path in memory.  Two definitions, SMARTRTL_SIMPLIFY_TIME_US and
@@ -127,6 +133,9 @@ void AP_SmartRTL::init()
 
     _path_points_max = _points_max;
 
+    // without the loop finding grid every pair of segments is checked
+    IGNORE_RETURN(prune_grid_init());
+
     // when running the example sketch, we want the cleanup tasks to run when we tell them to, not in the background (so that they can be timed.)
     if (!_example_mode){
         // register background cleanup to run in IO thread
@@ -367,6 +376,9 @@ void AP_SmartRTL::run_background_cleanup()
     _path_points_completed_limit = SMARTRTL_POINTS_MAX;
     _path_sem.give();
 
+    // points popped from the path may be replaced by new points
+    prune_grid_remove_from(path_points_completed_limit);
+
     // check if thorough cleanup is required
     if (_thorough_clean_request_ms > 0) {
         // check if we have already completed the request
@@ -507,6 +519,7 @@ void AP_SmartRTL::detect_simplifications()
         _simplify.stack[0].start = (_simplify.path_points_completed > 0) ? _simplify.path_points_completed - 1 : 0;
         _simplify.stack[0].finish = _simplify.path_points_count-1;
         _simplify.stack_count++;
+        _simplify.path_points_start = _simplify.stack[0].start + 1;
     }
 
     const uint32_t start_time_us = AP_HAL::micros();
@@ -562,6 +575,8 @@ void AP_SmartRTL::detect_simplifications()
 *   This method runs for the allotted time, and detects loops in a path. Any detected loops are added to _prune.loops,
 *   this function does not alter the path in memory. It works by comparing the line segment between any two sequential points
 *   to the line segment between any other two sequential points. If they get close enough, anything between them could be pruned.
+*   Only the segments in the grid cells a segment passes through are compared with it, the earliest close segment
+*   is used as the start of the loop.
 *
 *   reset_pruning should have been called at least once before this function is called to setup the indexes (_prune.i, etc)
 */
@@ -573,6 +588,76 @@ void AP_SmartRTL::detect_loops()
         return;
     }
 
+    if (_prune.grid.buckets == nullptr) {
+        detect_loops_all_segments();
+        return;
+    }
+
+    // the grid's padding depends on the accuracy parameter
+    if (!is_equal(_prune.grid.accuracy, _accuracy.get())) {
+        prune_grid_clear();
+    }
+
+    // capture start time
+    const uint32_t start_time_us = AP_HAL::micros();
+
+    // run for defined amount of time
+    while (AP_HAL::micros() - start_time_us < SMARTRTL_PRUNING_LOOP_TIME_US) {
+
+        // complete when outer loop has run out of new points to check
+        if (_prune.i < 4 || _prune.i < _prune.path_points_completed) {
+            _prune.complete = true;
+            _prune.path_points_completed = _prune.path_points_count;
+            return;
+        }
+
+        // segment i is checked against segments 1 to i-2, add any of these not yet in the grid
+        if (_prune.grid.segments_count < _prune.i - 2) {
+            prune_grid_add(_prune.grid.segments_count + 1);
+            continue;
+        }
+
+        // find the segments to check against segment i
+        if (_prune.j == 0) {
+            prune_grid_find_candidates(_prune.i);
+            _prune.closest_j = 0;
+            _prune.j = 1;
+            continue;
+        }
+
+        // check the next candidate, skipping any after the earliest close segment found so far
+        if (_prune.j <= _prune.grid.candidates_count) {
+            const uint16_t j = _prune.grid.candidates[_prune.j - 1];
+            _prune.j++;
+            if (_prune.closest_j == 0 || j < _prune.closest_j) {
+                const dist_point dp = segment_segment_dist(_path[_prune.i], _path[_prune.i-1], _path[j-1], _path[j]);
+                if (dp.distance < SMARTRTL_PRUNING_DELTA) {
+                    _prune.closest_j = j;
+                }
+            }
+            continue;
+        }
+
+        // if there is a loop here, add to loop array
+        if (_prune.closest_j != 0) {
+            const uint16_t j = _prune.closest_j;
+            const dist_point dp = segment_segment_dist(_path[_prune.i], _path[_prune.i-1], _path[j-1], _path[j]);
+            if (!add_loop(j, _prune.i-1, dp.midpoint)) {
+                // if the buffer is full, stop trying to prune
+                _prune.complete = true;
+                return;
+            }
+        }
+
+        // move to the next segment
+        _prune.i--;
+        _prune.j = 0;
+    }
+}
+
+// detect loops by checking each new segment against every earlier segment
+void AP_SmartRTL::detect_loops_all_segments()
+{
     // capture start time
     const uint32_t start_time_us = AP_HAL::micros();
 
@@ -635,6 +720,7 @@ void AP_SmartRTL::restart_simplification(uint16_t path_points_count)
     _simplify.bitmask.setall();
     _simplify.stack_count = 0;
     _simplify.path_points_count = path_points_count;
+    _simplify.path_points_start = 0;
 }
 
 // reset simplification algorithm so that it will re-check all points in the path
@@ -659,6 +745,167 @@ void AP_SmartRTL::reset_pruning()
     restart_pruning(0);
     _prune.loops_count = 0; // clear the loops that we've recorded
     _prune.path_points_completed = 0;
+    prune_grid_clear();
+}
+
+// allocate the loop finding grid, returns false on failure
+bool AP_SmartRTL::prune_grid_init()
+{
+    uint16_t num_buckets = 16;
+    while (num_buckets < _path_points_max / 2) {
+        num_buckets *= 2;
+    }
+    _prune.grid.buckets_mask = num_buckets - 1;
+    _prune.grid.buckets = (uint16_t*)calloc(num_buckets, sizeof(uint16_t));
+
+    _prune.grid.entries_max = _path_points_max * SMARTRTL_PRUNING_GRID_ENTRY_MULT;
+    _prune.grid.entries = (prune_grid_entry_t*)calloc(_prune.grid.entries_max, sizeof(prune_grid_entry_t));
+
+    _prune.grid.long_segments = (uint16_t*)calloc(_path_points_max, sizeof(uint16_t));
+    _prune.grid.candidates = (uint16_t*)calloc(_path_points_max, sizeof(uint16_t));
+
+    if (_prune.grid.buckets == nullptr || _prune.grid.entries == nullptr || _prune.grid.long_segments == nullptr || _prune.grid.candidates == nullptr) {
+        free(_prune.grid.buckets);
+        free(_prune.grid.entries);
+        free(_prune.grid.long_segments);
+        free(_prune.grid.candidates);
+        _prune.grid.buckets = nullptr;
+        return false;
+    }
+
+    prune_grid_clear();
+    return true;
+}
+
+// remove all segments from the loop finding grid
+void AP_SmartRTL::prune_grid_clear()
+{
+    if (_prune.grid.buckets == nullptr) {
+        return;
+    }
+    memset(_prune.grid.buckets, 0xFF, (_prune.grid.buckets_mask + 1U) * sizeof(uint16_t));
+    _prune.grid.entries_count = 0;
+    _prune.grid.long_count = 0;
+    _prune.grid.segments_count = 0;
+    _prune.grid.accuracy = _accuracy.get();
+    _prune.grid.cell_size_inv = 1.0f / (_prune.grid.accuracy * SMARTRTL_PRUNING_GRID_CELL_MULT);
+
+    // candidates for the current segment may have come from the grid
+    _prune.j = 0;
+}
+
+// remove the grid's segments which use points from point onwards, as they have changed
+void AP_SmartRTL::prune_grid_remove_from(uint16_t point)
+{
+    auto &grid = _prune.grid;
+    if (grid.buckets == nullptr || grid.segments_count < point) {
+        return;
+    }
+    const uint16_t first = MAX(point, 1);
+
+    // segments are added in order so their entries are at the start of each bucket and the end of the entries
+    for (uint16_t b = 0; b <= grid.buckets_mask; b++) {
+        while (grid.buckets[b] != SMARTRTL_PRUNING_GRID_NONE && grid.entries[grid.buckets[b]].segment >= first) {
+            grid.buckets[b] = grid.entries[grid.buckets[b]].next;
+        }
+    }
+    while (grid.entries_count > 0 && grid.entries[grid.entries_count-1].segment >= first) {
+        grid.entries_count--;
+    }
+    while (grid.long_count > 0 && grid.long_segments[grid.long_count-1] >= first) {
+        grid.long_count--;
+    }
+    grid.segments_count = first - 1;
+
+    // candidates for the current segment may have been removed
+    _prune.j = 0;
+}
+
+// get the range of grid cells covered by a segment padded by pad meters. returns false if this is too many cells
+bool AP_SmartRTL::prune_grid_cells(uint16_t segment, float pad, int32_t &x0, int32_t &y0, int32_t &x1, int32_t &y1) const
+{
+    const Vector3f &p1 = _path[segment-1];
+    const Vector3f &p2 = _path[segment];
+    const float cell_size_inv = _prune.grid.cell_size_inv;
+    x0 = floorf((MIN(p1.x, p2.x) - pad) * cell_size_inv);
+    y0 = floorf((MIN(p1.y, p2.y) - pad) * cell_size_inv);
+    x1 = floorf((MAX(p1.x, p2.x) + pad) * cell_size_inv);
+    y1 = floorf((MAX(p1.y, p2.y) + pad) * cell_size_inv);
+    return (x1 - x0 + 1) * (y1 - y0 + 1) <= SMARTRTL_PRUNING_GRID_CELLS_MAX;
+}
+
+uint16_t AP_SmartRTL::prune_grid_bucket(int32_t x, int32_t y) const
+{
+    return ((uint32_t)x * 73856093U ^ (uint32_t)y * 19349663U) & _prune.grid.buckets_mask;
+}
+
+// add a segment to the loop finding grid, in each cell within SMARTRTL_PRUNING_DELTA of it
+void AP_SmartRTL::prune_grid_add(uint16_t segment)
+{
+    auto &grid = _prune.grid;
+    grid.segments_count = segment;
+
+    int32_t x0, y0, x1, y1;
+    if (prune_grid_cells(segment, SMARTRTL_PRUNING_DELTA, x0, y0, x1, y1) &&
+        (grid.entries_count + (x1 - x0 + 1) * (y1 - y0 + 1) <= grid.entries_max)) {
+        for (int32_t x = x0; x <= x1; x++) {
+            for (int32_t y = y0; y <= y1; y++) {
+                const uint16_t bucket = prune_grid_bucket(x, y);
+                grid.entries[grid.entries_count] = prune_grid_entry_t {segment, grid.buckets[bucket]};
+                grid.buckets[bucket] = grid.entries_count++;
+            }
+        }
+        return;
+    }
+
+    // segments covering many cells, or which do not fit in the grid, are checked against every segment
+    grid.long_segments[grid.long_count++] = segment;
+}
+
+// find the segments before segment-1 which may come within SMARTRTL_PRUNING_DELTA of segment
+// segments may be listed more than once
+void AP_SmartRTL::prune_grid_find_candidates(uint16_t segment)
+{
+    auto &grid = _prune.grid;
+    const uint16_t last = segment - 2;
+    grid.candidates_count = 0;
+
+    int32_t x0, y0, x1, y1;
+    bool found_all = prune_grid_cells(segment, 0.0f, x0, y0, x1, y1);
+    for (int32_t x = x0; found_all && x <= x1; x++) {
+        for (int32_t y = y0; found_all && y <= y1; y++) {
+            for (uint16_t e = grid.buckets[prune_grid_bucket(x, y)]; e != SMARTRTL_PRUNING_GRID_NONE; e = grid.entries[e].next) {
+                const uint16_t j = grid.entries[e].segment;
+                if (j > last) {
+                    continue;
+                }
+                if (grid.candidates_count >= _path_points_max) {
+                    found_all = false;
+                    break;
+                }
+                grid.candidates[grid.candidates_count++] = j;
+            }
+        }
+    }
+    for (uint16_t k = 0; found_all && k < grid.long_count; k++) {
+        const uint16_t j = grid.long_segments[k];
+        if (j > last) {
+            continue;
+        }
+        if (grid.candidates_count >= _path_points_max) {
+            found_all = false;
+            break;
+        }
+        grid.candidates[grid.candidates_count++] = j;
+    }
+
+    // long segments, and segments with too many nearby segments, are checked against every earlier segment
+    if (!found_all) {
+        for (uint16_t j = 1; j <= last; j++) {
+            grid.candidates[j-1] = j;
+        }
+        grid.candidates_count = last;
+    }
 }
 
 // remove all simplify-able points from the path
@@ -668,11 +915,16 @@ void AP_SmartRTL::remove_points_by_simplify_bitmask()
     if (!_path_sem.take_nonblocking()) {
         return;
     }
-    uint16_t dest = 1;
+    // points before the simplified part of the path are left in place
+    const uint16_t start = MAX(_simplify.path_points_start, 1);
+    uint16_t dest = start;
     uint16_t removed = 0;
-    for (uint16_t src = 1; src < _path_points_count; src++) {
+    for (uint16_t src = start; src < _path_points_count; src++) {
         if (!_simplify.bitmask.get(src)) {
             log_action(Action::POINT_SIMPLIFY, _path[src]);
+            if (removed == 0) {
+                prune_grid_remove_from(src);
+            }
             removed++;
         } else {
             _path[dest] = _path[src];
@@ -720,6 +972,7 @@ bool AP_SmartRTL::remove_points_by_loops(uint16_t num_points_to_remove)
 
         // midpoint goes into start_index (this is the end point of the first segment)
         _path[loop.start_index] = loop.midpoint;
+        prune_grid_remove_from(loop.start_index);
 
         // shift points after the end of the loop down by the number of points in the loop
         uint16_t loop_num_points_to_remove = loop.end_index - loop.start_index;
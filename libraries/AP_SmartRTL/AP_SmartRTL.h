@@ -7,8 +7,14 @@
 
 // definitions and macros
 #define SMARTRTL_ACCURACY_DEFAULT        2.0f   // default _ACCURACY parameter value.  Points will be no closer than this distance (in meters) together.
-#define SMARTRTL_POINTS_DEFAULT          300    // default _POINTS parameter value.  High numbers improve path pruning but use more memory and CPU for cleanup. Memory used will be 20bytes * this number.
+#define SMARTRTL_POINTS_DEFAULT          300    // default _POINTS parameter value.  High numbers improve path pruning but use more memory and CPU for cleanup. Memory used will be 34bytes * this number.
+#ifndef SMARTRTL_POINTS_MAX
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_500
+#define SMARTRTL_POINTS_MAX              5000   // the absolute maximum number of points this library can support.
+#else
 #define SMARTRTL_POINTS_MAX              500    // the absolute maximum number of points this library can support.
+#endif
+#endif
 #define SMARTRTL_TIMEOUT                 15000  // the time in milliseconds with no points saved to the path (for whatever reason), before SmartRTL is disabled for the flight
 #define SMARTRTL_CLEANUP_POINT_TRIGGER   50     // simplification will trigger when this many points are added to the path
 #define SMARTRTL_CLEANUP_START_MARGIN    10     // routine cleanup algorithms begin when the path array has only this many empty slots remaining
@@ -21,6 +27,10 @@
 #define SMARTRTL_PRUNING_DELTA (_accuracy * 0.99)   // How many meters apart must two points be, such that we can assume that there is no obstacle between them.  must be smaller than _ACCURACY parameter
 #define SMARTRTL_PRUNING_LOOP_BUFFER_LEN_MULT 0.25f // pruning loop buffer size as compared to maximum number of points
 #define SMARTRTL_PRUNING_LOOP_TIME_US    200    // maximum time (in microseconds) that the loop finding algorithm will run before returning
+#define SMARTRTL_PRUNING_GRID_CELL_MULT  8.0f   // loop finding grid cell size as compared to the _ACCURACY parameter
+#define SMARTRTL_PRUNING_GRID_CELLS_MAX  9      // segments covering more grid cells than this are checked against every other segment
+#define SMARTRTL_PRUNING_GRID_ENTRY_MULT 2      // loop finding grid entries as compared to maximum number of points
+#define SMARTRTL_PRUNING_GRID_NONE       0xFFFF // marks the end of a loop finding grid bucket
 
 class AP_SmartRTL {
 
@@ -147,6 +157,21 @@ private:
     // reset pruning algorithm so that it will re-check all points in the path
     void reset_pruning();
 
+    // detect loops by checking each new segment against every earlier segment, used if the grid could not be allocated
+    void detect_loops_all_segments();
+
+    // loop finding grid. Segment n runs from point n-1 to point n
+    bool prune_grid_init();
+    void prune_grid_clear();
+    void prune_grid_add(uint16_t segment);
+    // remove the grid's segments which use points from point onwards, as they have changed
+    void prune_grid_remove_from(uint16_t point);
+    // get the range of grid cells covered by a segment padded by pad meters. returns false if this is too many cells
+    bool prune_grid_cells(uint16_t segment, float pad, int32_t &x0, int32_t &y0, int32_t &x1, int32_t &y1) const;
+    uint16_t prune_grid_bucket(int32_t x, int32_t y) const;
+    // find the segments before segment-1 which may come within SMARTRTL_PRUNING_DELTA of segment
+    void prune_grid_find_candidates(uint16_t segment);
+
     // remove all simplify-able points from the path
     void remove_points_by_simplify_bitmask();
 
@@ -214,6 +239,7 @@ private:
         bool removal_required;  // true if some simplify-able points have been found on the path, set true by detect_simplifications, set false by remove_points_by_simplify_bitmask
         uint16_t path_points_count; // copy of _path_points_count taken when the simply algorithm started
         uint16_t path_points_completed = SMARTRTL_POINTS_MAX; // number of points in that path that have already been simplified and should be ignored
+        uint16_t path_points_start; // first point which may be simplified, points before it are left in place when removing points
         simplify_start_finish_t* stack;
         uint16_t stack_max;     // maximum number of elements in the _simplify_stack array
         uint16_t stack_count;   // number of elements in _simplify_stack array
@@ -227,15 +253,37 @@ private:
         Vector3f midpoint;      // midpoint which should replace the first point when the loop is removed
         float length_squared;   // length squared (in meters) of the loop (used so we can remove the longest loops)
     } prune_loop_t;
+    typedef struct {
+        uint16_t segment;       // segment in this grid cell
+        uint16_t next;          // next entry in the same bucket, SMARTRTL_PRUNING_GRID_NONE if none
+    } prune_grid_entry_t;
     struct {
         bool complete;
         uint16_t path_points_count;  // copy of _path_points_count taken when the prune algorithm started
         uint16_t path_points_completed; // number of points in that path that have already been checked for loops and should be ignored
         uint16_t i;     // loop search's outer loop index
-        uint16_t j;     // loop search's inner loop index
+        uint16_t j;     // loop search's inner loop index, or with the grid one more than the next candidate to check
+        uint16_t closest_j; // with the grid, the earliest segment found within SMARTRTL_PRUNING_DELTA of segment i, zero if none
         prune_loop_t* loops;// the result of the pruning algorithm
         uint16_t loops_max; // maximum number of elements in the _prunable_loops array
         uint16_t loops_count;   // number of elements in the _prunable_loops array
+
+        // hashed horizontal grid of the segments checked against each new segment, so only nearby
+        // segments need to be checked. Segments 1 to segments_count are in the grid
+        struct {
+            uint16_t* buckets;      // first entry of each bucket, SMARTRTL_PRUNING_GRID_NONE if empty
+            uint16_t buckets_mask;  // number of buckets minus one
+            prune_grid_entry_t* entries;
+            uint16_t entries_max;
+            uint16_t entries_count;
+            uint16_t* long_segments;    // segments covering too many cells, checked against every segment
+            uint16_t long_count;
+            uint16_t* candidates;   // segments which may be close to segment i
+            uint16_t candidates_count;
+            uint16_t segments_count;
+            float accuracy;         // _ACCURACY parameter value when the grid was cleared
+            float cell_size_inv;    // one over the cell size in meters
+        } grid;
     } _prune;
 
     // returns true if the two loops overlap (used within add_loop to determine which loops to keep or throw away)
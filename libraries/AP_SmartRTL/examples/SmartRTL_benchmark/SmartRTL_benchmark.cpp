@@ -0,0 +1,116 @@
+/*
+  time the SmartRTL background cleanup while flying long paths which
+  fill the path buffer
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_BoardConfig/AP_BoardConfig.h>
+#include <AP_SmartRTL/AP_SmartRTL.h>
+#include <AP_AHRS/AP_AHRS.h>
+#include <AP_Baro/AP_Baro.h>
+#include <AP_Compass/AP_Compass.h>
+#include <AP_GPS/AP_GPS.h>
+#include <AP_InertialSensor/AP_InertialSensor.h>
+#include <AP_SerialManager/AP_SerialManager.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+static AP_InertialSensor ins;
+static Compass compass;
+static AP_GPS gps;
+static AP_Baro barometer;
+static AP_SerialManager serial_manager;
+
+class DummyVehicle {
+public:
+    AP_AHRS ahrs{AP_AHRS::FLAG_ALWAYS_USE_EKF};
+};
+
+static DummyVehicle vehicle;
+
+AP_AHRS &ahrs(vehicle.ahrs);
+AP_SmartRTL smart_rtl{true};
+AP_BoardConfig board_config;
+
+void setup();
+void loop();
+
+// number of points flown for each point the path can hold
+static const uint8_t points_flown_mult = 3;
+// background cleanup calls for each point flown
+static const uint8_t cleanups_per_point = 4;
+
+// random walk with 4m steps, which crosses itself often
+static Vector3f random_walk(uint32_t i)
+{
+    static Vector3f pos;
+    static float heading;
+    if (i == 0) {
+        pos.zero();
+        heading = 0;
+    }
+    heading += rand_float() * 0.75f;
+    pos += Vector3f(cosf(heading), sinf(heading), rand_float() * 0.1f) * 4.0f;
+    return pos;
+}
+
+// survey of 20 lanes 200m long and 10m apart, flown repeatedly
+static Vector3f survey(uint32_t i)
+{
+    const uint32_t lane = (i / 50) % 20;
+    const float along = (i % 50) * 4.0f;
+    return Vector3f(lane * 10.0f, (lane & 1) ? 200.0f - along : along, -20.0f);
+}
+
+static void run_path(const char *name, Vector3f (*path)(uint32_t))
+{
+    smart_rtl.set_home(true, Vector3f{0.0f, 0.0f, 0.0f});
+
+    const uint32_t num_points = uint32_t(SMARTRTL_POINTS_MAX) * points_flown_mult;
+    uint32_t total_us = 0;
+    uint32_t max_us = 0;
+    for (uint32_t i = 0; i < num_points; i++) {
+        smart_rtl.update(true, path(i));
+        for (uint8_t c = 0; c < cleanups_per_point; c++) {
+            const uint32_t start_us = AP_HAL::micros();
+            smart_rtl.run_background_cleanup();
+            const uint32_t dt_us = AP_HAL::micros() - start_us;
+            total_us += dt_us;
+            max_us = MAX(max_us, dt_us);
+        }
+    }
+
+    hal.console->printf("%s: %u points flown, cleanup total:%u us max:%u us, %u points kept, %s\n",
+                        name,
+                        (unsigned)num_points,
+                        (unsigned)total_us,
+                        (unsigned)max_us,
+                        (unsigned)smart_rtl.get_num_points(),
+                        smart_rtl.is_active() ? "active" : "deactivated");
+}
+
+void setup()
+{
+    hal.console->printf("SmartRTL benchmark\n");
+    board_config.init();
+    if (!AP_Param::set_object_value(&smart_rtl, smart_rtl.var_info, "POINTS", SMARTRTL_POINTS_MAX)) {
+        hal.console->printf("Failed to set SRTL_POINTS\n");
+    }
+    smart_rtl.init();
+}
+
+void loop()
+{
+    if (!hal.console->is_initialized()) {
+        return;
+    }
+
+    hal.console->printf("--------------------\n");
+    run_path("random walk", random_walk);
+    run_path("survey", survey);
+
+    // delay before next display
+    hal.scheduler->delay(5e3); // 5 seconds
+}
+
+AP_HAL_MAIN();
@@ -18,6 +18,7 @@
 #include <AR_Motors/AP_MotorsUGV.h>
 #include <AP_CheckFirmware/AP_CheckFirmware.h>
 #include <GCS_MAVLink/GCS.h>
+#include <StorageManager/StorageManager.h>
 #if CONFIG_HAL_BOARD == HAL_BOARD_CHIBIOS
 #include <AP_HAL_ChibiOS/sdcard.h>
 #include <AP_HAL_ChibiOS/hwdef/common/stm32_util.h>
@@ -942,6 +943,9 @@ void AP_Vehicle::reboot(bool hold_in_bootloader)
 
     // flush pending parameter writes
     AP_Param::flush();
+#if AP_STORAGE_WRITEBACK_ENABLED
+    StorageManager::sync();
+#endif
 
     // do not process incoming mavlink messages while we delay:
     hal.scheduler->register_delay_callback(nullptr, 5);
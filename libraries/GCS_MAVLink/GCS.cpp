@@ -67,6 +67,24 @@ const AP_Param::GroupInfo GCS::var_info[] {
     // @Increment: 1
     AP_GROUPINFO("_TELEM_DELAY",    4,      GCS, mav_telem_delay, 0),
 
+    // @Param: _ROUTES
+    // @DisplayName: MAVLink routing table size
+    // @Description: The maximum number of sysid/compid routes that can be learned for forwarding MAVLink messages between links. Messages for components that could not be learned are only processed locally or broadcast
+    // @Range: 1 1000
+    // @Increment: 1
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("_ROUTES",    5,      GCS, mav_routes, MAVLINK_MAX_ROUTES),
+
+    // @Param: _ROUTE_AGE
+    // @DisplayName: MAVLink route timeout
+    // @Description: Learned routes which have not had a message for this time are removed from the routing table. Zero keeps routes until reboot
+    // @Units: s
+    // @Range: 0 3600
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_ROUTE_AGE",    6,      GCS, mav_route_age, 0),
+
 #if MAVLINK_COMM_NUM_BUFFERS > 0
     // @Group: 1
     // @Path: GCS_MAVLink_Parameters.cpp
@@ -202,7 +202,14 @@ public:
         // there were concerns over return a too-large value for
         // txspace (in case we tried to do too much with the space in
         // a single loop):
+#if AP_MAVLINK_BATCH_WRITES_ENABLED
+        // allow for packets waiting in the batch buffer
+        const uint32_t space = _port->txspace();
+        const uint16_t pending = comm_send_batch_pending(chan);
+        return MIN(space > pending ? space - pending : 0, 8192U);
+#else
         return MIN(_port->txspace(), 8192U);
+#endif
     }
 
     bool check_payload_size(uint16_t max_payload_len);
@@ -453,10 +460,24 @@ public:
       returns true if a match is found
      */
     static bool find_by_mavtype_and_compid(uint8_t mav_type, uint8_t compid, uint8_t &sysid, mavlink_channel_t &channel) { return routing.find_by_mavtype_and_compid(mav_type, compid, sysid, channel); }
+
     // same as above, but returns a pointer to the GCS_MAVLINK object
     // corresponding to the channel
     static GCS_MAVLINK *find_by_mavtype_and_compid(uint8_t mav_type, uint8_t compid, uint8_t &sysid);
 
+    // display the routing table
+    static void routes_info(class ExpandingString &str) { routing.routes_info(str); }
+
+#if AP_MAVLINK_BANDWIDTH_BUDGET_ENABLED
+    // display the requested and achieved message rates on each link
+    static void rates_info(class ExpandingString &str);
+#endif
+
+#if AP_MAVLINK_BATCH_WRITES_ENABLED
+    // display packets-per-write statistics for each channel
+    static void batch_info(class ExpandingString &str);
+#endif
+
     // update signing timestamp on GPS lock
     static void update_signing_timestamp(uint64_t timestamp_usec);
 
@@ -563,6 +584,7 @@ protected:
     void handle_common_param_message(const mavlink_message_t &msg);
     void handle_param_set(const mavlink_message_t &msg);
     void handle_param_request_list(const mavlink_message_t &msg);
+    void queued_param_start();
     void handle_param_request_read(const mavlink_message_t &msg);
     virtual bool params_ready() const { return true; }
     void handle_rc_channels_override(const mavlink_message_t &msg);
@@ -807,6 +829,9 @@ private:
     uint16_t                    _queued_parameter_count; ///< saved count of
                                                          // parameters for
                                                          // queued send
+    uint16_t                    _queued_parameter_version; ///< parameter
+                                                           // numbering the
+                                                           // queued send uses
     uint32_t                    _queued_parameter_send_time_ms;
 
     // number of extra ms to add to slow things down for the radio
@@ -841,6 +866,9 @@ private:
         Bitmask<MSG_LAST> ap_message_ids;
         uint16_t interval_ms;
         uint16_t last_sent_ms; // from AP_HAL::millis16()
+#if AP_MAVLINK_BANDWIDTH_BUDGET_ENABLED
+        uint16_t budget_interval_ms; // interval imposed by the bandwidth budget, 0 if none
+#endif
     };
     deferred_message_bucket_t deferred_message_bucket[10];
     static const uint8_t no_bucket_to_send = -1;
@@ -875,6 +903,10 @@ private:
     // try_send_message, will cause a mavlink message with that id to
     // be emitted.  Returns MSG_LAST if no such mapping exists.
     ap_message mavlink_id_to_ap_message_id(const uint32_t mavlink_id) const;
+    // map an ap_message to the mavlink ID it emits.  Returns
+    // MAVLINK_ID_NONE if no such mapping exists, as 0 is HEARTBEAT.
+    static constexpr uint32_t MAVLINK_ID_NONE = UINT32_MAX;
+    static uint32_t ap_message_to_mavlink_id(const ap_message id);
     // set the interval at which an ap_message should be emitted (in ms)
     bool set_ap_message_interval(enum ap_message id, uint16_t interval_ms);
     // call set_ap_message_interval for each entry in a stream,
@@ -899,6 +931,36 @@ private:
 
     bool do_try_send_message(const ap_message id);
 
+#if AP_MAVLINK_BANDWIDTH_BUDGET_ENABLED
+    // percentage of the link bandwidth streamed messages may use, 0 to disable
+    AP_Int8 bw_pct;
+
+    struct bandwidth_msg_stats_t {
+        uint16_t size;          // bytes emitted by the last send
+        uint16_t count;         // sends in the current window
+        float achieved_hz;      // send rate over the last window
+    };
+    struct {
+        bandwidth_msg_stats_t *msg_stats; // MSG_LAST entries, allocated when the budget is enabled
+        uint32_t window_start_ms;
+        uint32_t window_start_tx_bytes;
+        uint16_t no_space;      // sends which failed for lack of txspace in this window
+        uint16_t min_txspace;   // smallest txspace seen in this window
+        float nominal_bps;      // bandwidth the budget may use, bytes/s
+        float budget_bps;       // current budget, bytes/s
+        float bucket_bps;       // bytes/s sent from message buckets in the last window
+        float other_bps;        // bytes/s sent outside the buckets in the last window
+    } bandwidth;
+
+    // measure the link once per second and reallocate the budget
+    void bandwidth_update();
+    // stretch bucket intervals so the buckets fit in the budget
+    void bandwidth_allocate();
+    // record the bytes emitted by a successful send of id
+    void bandwidth_record_send(ap_message id, uint32_t bytes);
+    void bandwidth_info(class ExpandingString &str) const;
+#endif
+
     // time when we missed sending a parameter for GCS
     static uint32_t reserve_param_space_start_ms;
     
@@ -1291,6 +1353,10 @@ public:
     uint8_t sysid_this_mav() const { return sysid; }
     uint32_t telem_delay() const { return mav_telem_delay; }
 
+    // routing table size and route timeout
+    uint16_t max_routes() const { return (uint16_t)constrain_int16(mav_routes, 1, 1000); }
+    uint32_t route_timeout_ms() const { return uint32_t(MAX(mav_route_age.get(), 0)) * 1000U; }
+
 #if AP_SCRIPTING_ENABLED
     // lua access to command_int
     MAV_RESULT lua_command_int_packet(const mavlink_command_int_t &packet);
@@ -1319,6 +1385,8 @@ protected:
     AP_Int16                 mav_gcs_sysid;
     AP_Enum16<Option>        mav_options;
     AP_Int8                  mav_telem_delay;
+    AP_Int16                 mav_routes;
+    AP_Int16                 mav_route_age;
 
 private:
 
@@ -0,0 +1,237 @@
+/*
+  per-link bandwidth budget for streamed messages
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  When SRn_BW_PCT is non-zero the bytes sent on the link are measured
+  once per second and compared against a budget derived from the link
+  bandwidth.  The deferred message buckets are then allocated budget
+  in order of their requested interval, fastest first, and any bucket
+  which does not fit has its interval stretched so its share of the
+  budget is not exceeded.  The budget backs off when sends fail for
+  lack of transmit space and recovers while the link keeps draining.
+ */
+
+#include "GCS_config.h"
+
+#if AP_MAVLINK_BANDWIDTH_BUDGET_ENABLED
+
+#include "GCS.h"
+#include <AP_Common/ExpandingString.h>
+
+extern const AP_HAL::HAL& hal;
+
+void GCS_MAVLINK::bandwidth_update()
+{
+    if (bw_pct <= 0) {
+        if (is_positive(bandwidth.budget_bps)) {
+            // budget has been disabled; go back to the requested intervals
+            for (auto &bucket : deferred_message_bucket) {
+                bucket.budget_interval_ms = 0;
+            }
+            bandwidth.budget_bps = 0;
+        }
+        return;
+    }
+
+    const uint32_t now_ms = AP_HAL::millis();
+    if (bandwidth.msg_stats == nullptr) {
+        bandwidth.msg_stats = NEW_NOTHROW bandwidth_msg_stats_t[MSG_LAST];
+        if (bandwidth.msg_stats == nullptr) {
+            return;
+        }
+        bandwidth.window_start_ms = now_ms;
+        bandwidth.window_start_tx_bytes = comm_get_tx_bytes(chan);
+        bandwidth.min_txspace = UINT16_MAX;
+        return;
+    }
+
+    bandwidth.min_txspace = MIN(bandwidth.min_txspace, txspace());
+
+    const uint32_t dt_ms = now_ms - bandwidth.window_start_ms;
+    if (dt_ms < 1000) {
+        return;
+    }
+
+    // the link bandwidth is the baud rate where we know it, otherwise
+    // whatever the port tells us (e.g. the rate a radio reports)
+    uint32_t link_bps = _port->get_baud_rate() / 10;
+    if (link_bps == 0) {
+        link_bps = _port->bw_in_bytes_per_second();
+    }
+    bandwidth.nominal_bps = link_bps * MIN(bw_pct.get(), 100) * 0.01;
+
+    // back off quickly when the link is full, recover slowly
+    const bool congested = bandwidth.no_space > 0 || bandwidth.min_txspace < MAVLINK_MAX_PACKET_LEN;
+    if (!is_positive(bandwidth.budget_bps)) {
+        bandwidth.budget_bps = bandwidth.nominal_bps;
+    } else if (congested) {
+        bandwidth.budget_bps = MAX(bandwidth.budget_bps * 0.8, bandwidth.nominal_bps * 0.1);
+    } else {
+        bandwidth.budget_bps = MIN(bandwidth.budget_bps * 1.05, bandwidth.nominal_bps);
+    }
+
+    // work out what the buckets actually sent in this window
+    const float dt = dt_ms * 0.001;
+    uint32_t bucket_bytes = 0;
+    for (const auto &bucket : deferred_message_bucket) {
+        if (bucket.ap_message_ids.count() == 0) {
+            continue;
+        }
+        for (uint16_t id=0; id<MSG_LAST; id++) {
+            if (bucket.ap_message_ids.get(id)) {
+                const auto &stats = bandwidth.msg_stats[id];
+                bucket_bytes += uint32_t(stats.count) * stats.size;
+            }
+        }
+    }
+    for (uint16_t id=0; id<MSG_LAST; id++) {
+        auto &stats = bandwidth.msg_stats[id];
+        stats.achieved_hz = stats.count / dt;
+        stats.count = 0;
+    }
+    const uint32_t tx_bytes = comm_get_tx_bytes(chan);
+    const uint32_t window_bytes = tx_bytes - bandwidth.window_start_tx_bytes;
+    bandwidth.bucket_bps = bucket_bytes / dt;
+    bandwidth.other_bps = window_bytes > bucket_bytes ? (window_bytes - bucket_bytes) / dt : 0;
+
+    bandwidth.window_start_ms = now_ms;
+    bandwidth.window_start_tx_bytes = tx_bytes;
+    bandwidth.no_space = 0;
+    bandwidth.min_txspace = UINT16_MAX;
+
+    bandwidth_allocate();
+}
+
+void GCS_MAVLINK::bandwidth_allocate()
+{
+    // bytes/s each bucket would use at its requested interval
+    float demand_bps[ARRAY_SIZE(deferred_message_bucket)];
+    // buckets ordered fastest requested interval first, cheapest
+    // first where the intervals are the same
+    uint8_t order[ARRAY_SIZE(deferred_message_bucket)];
+    uint8_t count = 0;
+
+    for (uint8_t i=0; i<ARRAY_SIZE(deferred_message_bucket); i++) {
+        const auto &bucket = deferred_message_bucket[i];
+        if (bucket.ap_message_ids.count() == 0 || bucket.interval_ms == 0) {
+            continue;
+        }
+        uint32_t bytes = 0;
+        for (uint16_t id=0; id<MSG_LAST; id++) {
+            if (bucket.ap_message_ids.get(id)) {
+                bytes += bandwidth.msg_stats[id].size;
+            }
+        }
+        demand_bps[i] = bytes * 1000.0 / bucket.interval_ms;
+
+        uint8_t j = count;
+        while (j > 0) {
+            const auto &prev = deferred_message_bucket[order[j-1]];
+            if (prev.interval_ms < bucket.interval_ms ||
+                (prev.interval_ms == bucket.interval_ms && demand_bps[order[j-1]] <= demand_bps[i])) {
+                break;
+            }
+            order[j] = order[j-1];
+            j--;
+        }
+        order[j] = i;
+        count++;
+    }
+
+    // everything not sent from a bucket (heartbeats, parameters,
+    // mission items, FTP...) comes off the top
+    float remaining_bps = bandwidth.budget_bps - bandwidth.other_bps;
+    // no bucket is starved completely
+    const float min_share_bps = bandwidth.budget_bps * 0.05;
+
+    for (uint8_t i=0; i<count; i++) {
+        auto &bucket = deferred_message_bucket[order[i]];
+        const float demand = demand_bps[order[i]];
+        if (demand <= remaining_bps) {
+            bucket.budget_interval_ms = 0;
+            remaining_bps -= demand;
+            continue;
+        }
+        const float share_bps = MAX(remaining_bps, min_share_bps);
+        bucket.budget_interval_ms = uint16_t(MIN(bucket.interval_ms * demand / share_bps, 60000.0f));
+        remaining_bps -= share_bps;
+    }
+}
+
+void GCS_MAVLINK::bandwidth_record_send(ap_message id, uint32_t bytes)
+{
+    if (bandwidth.msg_stats == nullptr || id >= MSG_LAST) {
+        return;
+    }
+    auto &stats = bandwidth.msg_stats[id];
+    stats.size = MIN(bytes, uint32_t(UINT16_MAX));
+    stats.count++;
+}
+
+void GCS_MAVLINK::bandwidth_info(ExpandingString &str) const
+{
+    str.printf("chan%u", unsigned(chan));
+    if (bandwidth.msg_stats != nullptr && bw_pct > 0) {
+        str.printf(" budget=%uB/s nominal=%uB/s streams=%uB/s other=%uB/s",
+                   unsigned(bandwidth.budget_bps),
+                   unsigned(bandwidth.nominal_bps),
+                   unsigned(bandwidth.bucket_bps),
+                   unsigned(bandwidth.other_bps));
+    }
+    str.printf("\n");
+
+    for (const auto &bucket : deferred_message_bucket) {
+        if (bucket.ap_message_ids.count() == 0 || bucket.interval_ms == 0) {
+            continue;
+        }
+        const uint16_t interval_ms = MAX(bucket.interval_ms, bucket.budget_interval_ms);
+        for (uint16_t id=0; id<MSG_LAST; id++) {
+            if (!bucket.ap_message_ids.get(id)) {
+                continue;
+            }
+            // messages without a single MAVLink id are shown by
+            // ap_message id alone
+            const uint32_t mavlink_id = ap_message_to_mavlink_id(ap_message(id));
+            if (mavlink_id != MAVLINK_ID_NONE) {
+                str.printf("  msg=%u", unsigned(mavlink_id));
+            } else {
+                str.printf("  ");
+            }
+            str.printf(" id=%u req=%.1fHz sched=%.1fHz",
+                       unsigned(id),
+                       1000.0 / bucket.interval_ms,
+                       1000.0 / interval_ms);
+            if (bandwidth.msg_stats != nullptr) {
+                const auto &stats = bandwidth.msg_stats[id];
+                str.printf(" achieved=%.1fHz size=%u", stats.achieved_hz, unsigned(stats.size));
+            }
+            str.printf("\n");
+        }
+    }
+}
+
+void GCS_MAVLINK::rates_info(ExpandingString &str)
+{
+    for (uint8_t i=0; i<gcs().num_gcs(); i++) {
+        const GCS_MAVLINK *link = gcs().chan(i);
+        if (link != nullptr) {
+            link->bandwidth_info(str);
+        }
+    }
+}
+
+#endif  // AP_MAVLINK_BANDWIDTH_BUDGET_ENABLED
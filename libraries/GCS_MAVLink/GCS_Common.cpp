@@ -990,186 +990,199 @@ void GCS_MAVLINK::handle_mission_item(const mavlink_message_t &msg)
     prot->handle_mission_item(msg, mission_item_int);
 }
 
-ap_message GCS_MAVLINK::mavlink_id_to_ap_message_id(const uint32_t mavlink_id) const
-{
-    // MSG_NEXT_MISSION_REQUEST doesn't correspond to a mavlink message directly.
-    // It is used to request the next waypoint after receiving one.
-
-    // MSG_NEXT_PARAM doesn't correspond to a mavlink message directly.
-    // It is used to send the next parameter in a stream after sending one
-
-    // MSG_NAMED_FLOAT messages can't really be "streamed"...
-
-    static const struct {
-        uint32_t mavlink_id;
-        ap_message msg_id;
-    } map[] {
-        { MAVLINK_MSG_ID_HEARTBEAT,             MSG_HEARTBEAT},
-        { MAVLINK_MSG_ID_HOME_POSITION,         MSG_HOME},
-        { MAVLINK_MSG_ID_GPS_GLOBAL_ORIGIN,     MSG_ORIGIN},
-        { MAVLINK_MSG_ID_SYS_STATUS,            MSG_SYS_STATUS},
-        { MAVLINK_MSG_ID_POWER_STATUS,          MSG_POWER_STATUS},
+// mapping between mavlink message IDs and ap_message IDs
+// MSG_NEXT_MISSION_REQUEST doesn't correspond to a mavlink message directly.
+// It is used to request the next waypoint after receiving one.
+
+// MSG_NEXT_PARAM doesn't correspond to a mavlink message directly.
+// It is used to send the next parameter in a stream after sending one
+
+// MSG_NAMED_FLOAT messages can't really be "streamed"...
+
+static const struct {
+    uint32_t mavlink_id;
+    ap_message msg_id;
+} ap_message_map[] {
+    { MAVLINK_MSG_ID_HEARTBEAT,             MSG_HEARTBEAT},
+    { MAVLINK_MSG_ID_HOME_POSITION,         MSG_HOME},
+    { MAVLINK_MSG_ID_GPS_GLOBAL_ORIGIN,     MSG_ORIGIN},
+    { MAVLINK_MSG_ID_SYS_STATUS,            MSG_SYS_STATUS},
+    { MAVLINK_MSG_ID_POWER_STATUS,          MSG_POWER_STATUS},
 #if HAL_WITH_MCU_MONITORING
-        { MAVLINK_MSG_ID_MCU_STATUS,            MSG_MCU_STATUS},
+    { MAVLINK_MSG_ID_MCU_STATUS,            MSG_MCU_STATUS},
 #endif
-        { MAVLINK_MSG_ID_MEMINFO,               MSG_MEMINFO},
-        { MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT, MSG_NAV_CONTROLLER_OUTPUT},
-        { MAVLINK_MSG_ID_MISSION_CURRENT,       MSG_CURRENT_WAYPOINT},
-        { MAVLINK_MSG_ID_SERVO_OUTPUT_RAW,      MSG_SERVO_OUTPUT_RAW},
-        { MAVLINK_MSG_ID_RC_CHANNELS,           MSG_RC_CHANNELS},
+    { MAVLINK_MSG_ID_MEMINFO,               MSG_MEMINFO},
+    { MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT, MSG_NAV_CONTROLLER_OUTPUT},
+    { MAVLINK_MSG_ID_MISSION_CURRENT,       MSG_CURRENT_WAYPOINT},
+    { MAVLINK_MSG_ID_SERVO_OUTPUT_RAW,      MSG_SERVO_OUTPUT_RAW},
+    { MAVLINK_MSG_ID_RC_CHANNELS,           MSG_RC_CHANNELS},
 #if AP_MAVLINK_MSG_RC_CHANNELS_RAW_ENABLED
-        { MAVLINK_MSG_ID_RC_CHANNELS_RAW,       MSG_RC_CHANNELS_RAW},
+    { MAVLINK_MSG_ID_RC_CHANNELS_RAW,       MSG_RC_CHANNELS_RAW},
 #endif
-        { MAVLINK_MSG_ID_RAW_IMU,               MSG_RAW_IMU},
-        { MAVLINK_MSG_ID_SCALED_IMU,            MSG_SCALED_IMU},
-        { MAVLINK_MSG_ID_SCALED_IMU2,           MSG_SCALED_IMU2},
-        { MAVLINK_MSG_ID_SCALED_IMU3,           MSG_SCALED_IMU3},
+    { MAVLINK_MSG_ID_RAW_IMU,               MSG_RAW_IMU},
+    { MAVLINK_MSG_ID_SCALED_IMU,            MSG_SCALED_IMU},
+    { MAVLINK_MSG_ID_SCALED_IMU2,           MSG_SCALED_IMU2},
+    { MAVLINK_MSG_ID_SCALED_IMU3,           MSG_SCALED_IMU3},
 #if AP_MAVLINK_MSG_HIGHRES_IMU_ENABLED
-        { MAVLINK_MSG_ID_HIGHRES_IMU,           MSG_HIGHRES_IMU},
+    { MAVLINK_MSG_ID_HIGHRES_IMU,           MSG_HIGHRES_IMU},
 #endif
-        { MAVLINK_MSG_ID_SCALED_PRESSURE,       MSG_SCALED_PRESSURE},
-        { MAVLINK_MSG_ID_SCALED_PRESSURE2,      MSG_SCALED_PRESSURE2},
-        { MAVLINK_MSG_ID_SCALED_PRESSURE3,      MSG_SCALED_PRESSURE3},
+    { MAVLINK_MSG_ID_SCALED_PRESSURE,       MSG_SCALED_PRESSURE},
+    { MAVLINK_MSG_ID_SCALED_PRESSURE2,      MSG_SCALED_PRESSURE2},
+    { MAVLINK_MSG_ID_SCALED_PRESSURE3,      MSG_SCALED_PRESSURE3},
 #if AP_GPS_GPS_RAW_INT_SENDING_ENABLED
-        { MAVLINK_MSG_ID_GPS_RAW_INT,           MSG_GPS_RAW},
+    { MAVLINK_MSG_ID_GPS_RAW_INT,           MSG_GPS_RAW},
 #endif
 #if AP_GPS_GPS_RTK_SENDING_ENABLED
-        { MAVLINK_MSG_ID_GPS_RTK,               MSG_GPS_RTK},
+    { MAVLINK_MSG_ID_GPS_RTK,               MSG_GPS_RTK},
 #endif
 #if AP_GPS_GPS2_RAW_SENDING_ENABLED
-        { MAVLINK_MSG_ID_GPS2_RAW,              MSG_GPS2_RAW},
+    { MAVLINK_MSG_ID_GPS2_RAW,              MSG_GPS2_RAW},
 #endif
 #if AP_GPS_GPS2_RTK_SENDING_ENABLED
-        { MAVLINK_MSG_ID_GPS2_RTK,              MSG_GPS2_RTK},
+    { MAVLINK_MSG_ID_GPS2_RTK,              MSG_GPS2_RTK},
 #endif
-        { MAVLINK_MSG_ID_SYSTEM_TIME,           MSG_SYSTEM_TIME},
+    { MAVLINK_MSG_ID_SYSTEM_TIME,           MSG_SYSTEM_TIME},
 #if APM_BUILD_TYPE(APM_BUILD_Rover)
-        { MAVLINK_MSG_ID_RC_CHANNELS_SCALED,    MSG_SERVO_OUT},
+    { MAVLINK_MSG_ID_RC_CHANNELS_SCALED,    MSG_SERVO_OUT},
 #endif  // APM_BUILD_TYPE(APM_BUILD_Rover)
-        { MAVLINK_MSG_ID_PARAM_VALUE,           MSG_NEXT_PARAM},
+    { MAVLINK_MSG_ID_PARAM_VALUE,           MSG_NEXT_PARAM},
 #if AP_FENCE_ENABLED
-        { MAVLINK_MSG_ID_FENCE_STATUS,          MSG_FENCE_STATUS},
+    { MAVLINK_MSG_ID_FENCE_STATUS,          MSG_FENCE_STATUS},
 #endif
 #if AP_SIM_ENABLED
-        { MAVLINK_MSG_ID_SIMSTATE,              MSG_SIMSTATE},
-        { MAVLINK_MSG_ID_SIM_STATE,             MSG_SIM_STATE},
+    { MAVLINK_MSG_ID_SIMSTATE,              MSG_SIMSTATE},
+    { MAVLINK_MSG_ID_SIM_STATE,             MSG_SIM_STATE},
 #endif
 #if AP_AHRS_ENABLED
-        { MAVLINK_MSG_ID_AHRS2,                 MSG_AHRS2},
-        { MAVLINK_MSG_ID_AHRS,                  MSG_AHRS},
-        { MAVLINK_MSG_ID_ATTITUDE,              MSG_ATTITUDE},
-        { MAVLINK_MSG_ID_ATTITUDE_QUATERNION,   MSG_ATTITUDE_QUATERNION},
-        { MAVLINK_MSG_ID_GLOBAL_POSITION_INT,   MSG_LOCATION},
-        { MAVLINK_MSG_ID_LOCAL_POSITION_NED,    MSG_LOCAL_POSITION},
-        { MAVLINK_MSG_ID_VFR_HUD,               MSG_VFR_HUD},
-#endif
-        { MAVLINK_MSG_ID_HWSTATUS,              MSG_HWSTATUS},
-        { MAVLINK_MSG_ID_WIND,                  MSG_WIND},
+    { MAVLINK_MSG_ID_AHRS2,                 MSG_AHRS2},
+    { MAVLINK_MSG_ID_AHRS,                  MSG_AHRS},
+    { MAVLINK_MSG_ID_ATTITUDE,              MSG_ATTITUDE},
+    { MAVLINK_MSG_ID_ATTITUDE_QUATERNION,   MSG_ATTITUDE_QUATERNION},
+    { MAVLINK_MSG_ID_GLOBAL_POSITION_INT,   MSG_LOCATION},
+    { MAVLINK_MSG_ID_LOCAL_POSITION_NED,    MSG_LOCAL_POSITION},
+    { MAVLINK_MSG_ID_VFR_HUD,               MSG_VFR_HUD},
+#endif
+    { MAVLINK_MSG_ID_HWSTATUS,              MSG_HWSTATUS},
+    { MAVLINK_MSG_ID_WIND,                  MSG_WIND},
 #if AP_RANGEFINDER_ENABLED
-        { MAVLINK_MSG_ID_RANGEFINDER,           MSG_RANGEFINDER},
+    { MAVLINK_MSG_ID_RANGEFINDER,           MSG_RANGEFINDER},
 #endif
-        { MAVLINK_MSG_ID_DISTANCE_SENSOR,       MSG_DISTANCE_SENSOR},
+    { MAVLINK_MSG_ID_DISTANCE_SENSOR,       MSG_DISTANCE_SENSOR},
 #if AP_TERRAIN_AVAILABLE
-        { MAVLINK_MSG_ID_TERRAIN_REQUEST,       MSG_TERRAIN_REQUEST},
-        { MAVLINK_MSG_ID_TERRAIN_REPORT,        MSG_TERRAIN_REPORT},
+    { MAVLINK_MSG_ID_TERRAIN_REQUEST,       MSG_TERRAIN_REQUEST},
+    { MAVLINK_MSG_ID_TERRAIN_REPORT,        MSG_TERRAIN_REPORT},
 #endif
 #if AP_CAMERA_ENABLED
-        { MAVLINK_MSG_ID_CAMERA_FEEDBACK,       MSG_CAMERA_FEEDBACK},
-        { MAVLINK_MSG_ID_CAMERA_INFORMATION,    MSG_CAMERA_INFORMATION},
-        { MAVLINK_MSG_ID_CAMERA_SETTINGS,       MSG_CAMERA_SETTINGS},
+    { MAVLINK_MSG_ID_CAMERA_FEEDBACK,       MSG_CAMERA_FEEDBACK},
+    { MAVLINK_MSG_ID_CAMERA_INFORMATION,    MSG_CAMERA_INFORMATION},
+    { MAVLINK_MSG_ID_CAMERA_SETTINGS,       MSG_CAMERA_SETTINGS},
 #if AP_CAMERA_SEND_FOV_STATUS_ENABLED
-        { MAVLINK_MSG_ID_CAMERA_FOV_STATUS,     MSG_CAMERA_FOV_STATUS},
+    { MAVLINK_MSG_ID_CAMERA_FOV_STATUS,     MSG_CAMERA_FOV_STATUS},
 #endif
-        { MAVLINK_MSG_ID_CAMERA_CAPTURE_STATUS, MSG_CAMERA_CAPTURE_STATUS},
+    { MAVLINK_MSG_ID_CAMERA_CAPTURE_STATUS, MSG_CAMERA_CAPTURE_STATUS},
 #if AP_CAMERA_SEND_THERMAL_RANGE_ENABLED
-        { MAVLINK_MSG_ID_CAMERA_THERMAL_RANGE,  MSG_CAMERA_THERMAL_RANGE},
+    { MAVLINK_MSG_ID_CAMERA_THERMAL_RANGE,  MSG_CAMERA_THERMAL_RANGE},
 #endif // AP_CAMERA_SEND_THERMAL_RANGE_ENABLED
 #if AP_MAVLINK_MSG_VIDEO_STREAM_INFORMATION_ENABLED
-        { MAVLINK_MSG_ID_VIDEO_STREAM_INFORMATION, MSG_VIDEO_STREAM_INFORMATION},
+    { MAVLINK_MSG_ID_VIDEO_STREAM_INFORMATION, MSG_VIDEO_STREAM_INFORMATION},
 #endif // AP_MAVLINK_MSG_VIDEO_STREAM_INFORMATION_ENABLED
 #endif // AP_CAMERA_ENABLED
 #if HAL_MOUNT_ENABLED
-        { MAVLINK_MSG_ID_GIMBAL_DEVICE_ATTITUDE_STATUS, MSG_GIMBAL_DEVICE_ATTITUDE_STATUS},
-        { MAVLINK_MSG_ID_AUTOPILOT_STATE_FOR_GIMBAL_DEVICE, MSG_AUTOPILOT_STATE_FOR_GIMBAL_DEVICE},
-        { MAVLINK_MSG_ID_GIMBAL_MANAGER_INFORMATION, MSG_GIMBAL_MANAGER_INFORMATION},
-        { MAVLINK_MSG_ID_GIMBAL_MANAGER_STATUS, MSG_GIMBAL_MANAGER_STATUS},
+    { MAVLINK_MSG_ID_GIMBAL_DEVICE_ATTITUDE_STATUS, MSG_GIMBAL_DEVICE_ATTITUDE_STATUS},
+    { MAVLINK_MSG_ID_AUTOPILOT_STATE_FOR_GIMBAL_DEVICE, MSG_AUTOPILOT_STATE_FOR_GIMBAL_DEVICE},
+    { MAVLINK_MSG_ID_GIMBAL_MANAGER_INFORMATION, MSG_GIMBAL_MANAGER_INFORMATION},
+    { MAVLINK_MSG_ID_GIMBAL_MANAGER_STATUS, MSG_GIMBAL_MANAGER_STATUS},
 #endif
 #if AP_OPTICALFLOW_ENABLED
-        { MAVLINK_MSG_ID_OPTICAL_FLOW,          MSG_OPTICAL_FLOW},
+    { MAVLINK_MSG_ID_OPTICAL_FLOW,          MSG_OPTICAL_FLOW},
 #endif
 #if COMPASS_CAL_ENABLED
-        { MAVLINK_MSG_ID_MAG_CAL_PROGRESS,      MSG_MAG_CAL_PROGRESS},
-        { MAVLINK_MSG_ID_MAG_CAL_REPORT,        MSG_MAG_CAL_REPORT},
+    { MAVLINK_MSG_ID_MAG_CAL_PROGRESS,      MSG_MAG_CAL_PROGRESS},
+    { MAVLINK_MSG_ID_MAG_CAL_REPORT,        MSG_MAG_CAL_REPORT},
 #endif
-        { MAVLINK_MSG_ID_EKF_STATUS_REPORT,     MSG_EKF_STATUS_REPORT},
-        { MAVLINK_MSG_ID_PID_TUNING,            MSG_PID_TUNING},
-        { MAVLINK_MSG_ID_VIBRATION,             MSG_VIBRATION},
+    { MAVLINK_MSG_ID_EKF_STATUS_REPORT,     MSG_EKF_STATUS_REPORT},
+    { MAVLINK_MSG_ID_PID_TUNING,            MSG_PID_TUNING},
+    { MAVLINK_MSG_ID_VIBRATION,             MSG_VIBRATION},
 #if AP_RPM_ENABLED
-        { MAVLINK_MSG_ID_RPM,                   MSG_RPM},
+    { MAVLINK_MSG_ID_RPM,                   MSG_RPM},
 #endif
-        { MAVLINK_MSG_ID_MISSION_ITEM_REACHED,  MSG_MISSION_ITEM_REACHED},
-        { MAVLINK_MSG_ID_ATTITUDE_TARGET,       MSG_ATTITUDE_TARGET},
-        { MAVLINK_MSG_ID_POSITION_TARGET_GLOBAL_INT,  MSG_POSITION_TARGET_GLOBAL_INT},
-        { MAVLINK_MSG_ID_POSITION_TARGET_LOCAL_NED,  MSG_POSITION_TARGET_LOCAL_NED},
+    { MAVLINK_MSG_ID_MISSION_ITEM_REACHED,  MSG_MISSION_ITEM_REACHED},
+    { MAVLINK_MSG_ID_ATTITUDE_TARGET,       MSG_ATTITUDE_TARGET},
+    { MAVLINK_MSG_ID_POSITION_TARGET_GLOBAL_INT,  MSG_POSITION_TARGET_GLOBAL_INT},
+    { MAVLINK_MSG_ID_POSITION_TARGET_LOCAL_NED,  MSG_POSITION_TARGET_LOCAL_NED},
 #if HAL_ADSB_ENABLED
-        { MAVLINK_MSG_ID_ADSB_VEHICLE,          MSG_ADSB_VEHICLE},
+    { MAVLINK_MSG_ID_ADSB_VEHICLE,          MSG_ADSB_VEHICLE},
 #endif
 #if AP_BATTERY_ENABLED
-        { MAVLINK_MSG_ID_BATTERY_STATUS,        MSG_BATTERY_STATUS},
+    { MAVLINK_MSG_ID_BATTERY_STATUS,        MSG_BATTERY_STATUS},
 #endif
 #if APM_BUILD_TYPE(APM_BUILD_ArduPlane)
-        { MAVLINK_MSG_ID_AOA_SSA,               MSG_AOA_SSA},
+    { MAVLINK_MSG_ID_AOA_SSA,               MSG_AOA_SSA},
 #endif  // APM_BUILD_ArduPlane
 #if HAL_LANDING_DEEPSTALL_ENABLED && APM_BUILD_TYPE(APM_BUILD_ArduPlane)
-        { MAVLINK_MSG_ID_DEEPSTALL,             MSG_LANDING},
+    { MAVLINK_MSG_ID_DEEPSTALL,             MSG_LANDING},
 #endif
-        { MAVLINK_MSG_ID_EXTENDED_SYS_STATE,    MSG_EXTENDED_SYS_STATE},
-        { MAVLINK_MSG_ID_AUTOPILOT_VERSION,     MSG_AUTOPILOT_VERSION},
+    { MAVLINK_MSG_ID_EXTENDED_SYS_STATE,    MSG_EXTENDED_SYS_STATE},
+    { MAVLINK_MSG_ID_AUTOPILOT_VERSION,     MSG_AUTOPILOT_VERSION},
 #if HAL_EFI_ENABLED
-        { MAVLINK_MSG_ID_EFI_STATUS,            MSG_EFI_STATUS},
+    { MAVLINK_MSG_ID_EFI_STATUS,            MSG_EFI_STATUS},
 #endif
 #if HAL_GENERATOR_ENABLED
-        { MAVLINK_MSG_ID_GENERATOR_STATUS,      MSG_GENERATOR_STATUS},
+    { MAVLINK_MSG_ID_GENERATOR_STATUS,      MSG_GENERATOR_STATUS},
 #endif
 #if AP_WINCH_ENABLED
-        { MAVLINK_MSG_ID_WINCH_STATUS,          MSG_WINCH_STATUS},
+    { MAVLINK_MSG_ID_WINCH_STATUS,          MSG_WINCH_STATUS},
 #endif
 #if HAL_WITH_ESC_TELEM
-        { MAVLINK_MSG_ID_ESC_TELEMETRY_1_TO_4,  MSG_ESC_TELEMETRY},
+    { MAVLINK_MSG_ID_ESC_TELEMETRY_1_TO_4,  MSG_ESC_TELEMETRY},
 #endif
 #if AP_RANGEFINDER_ENABLED && APM_BUILD_TYPE(APM_BUILD_Rover)
-        { MAVLINK_MSG_ID_WATER_DEPTH,           MSG_WATER_DEPTH},
+    { MAVLINK_MSG_ID_WATER_DEPTH,           MSG_WATER_DEPTH},
 #endif
 #if HAL_HIGH_LATENCY2_ENABLED
-        { MAVLINK_MSG_ID_HIGH_LATENCY2,         MSG_HIGH_LATENCY2},
+    { MAVLINK_MSG_ID_HIGH_LATENCY2,         MSG_HIGH_LATENCY2},
 #endif
 #if AP_AIS_ENABLED
-        { MAVLINK_MSG_ID_AIS_VESSEL,            MSG_AIS_VESSEL},
+    { MAVLINK_MSG_ID_AIS_VESSEL,            MSG_AIS_VESSEL},
 #endif
 #if AP_MAVLINK_MSG_UAVIONIX_ADSB_OUT_STATUS_ENABLED
-        { MAVLINK_MSG_ID_UAVIONIX_ADSB_OUT_STATUS, MSG_UAVIONIX_ADSB_OUT_STATUS},
+    { MAVLINK_MSG_ID_UAVIONIX_ADSB_OUT_STATUS, MSG_UAVIONIX_ADSB_OUT_STATUS},
 #endif
 #if AP_MAVLINK_MSG_RELAY_STATUS_ENABLED
-        { MAVLINK_MSG_ID_RELAY_STATUS, MSG_RELAY_STATUS},
+    { MAVLINK_MSG_ID_RELAY_STATUS, MSG_RELAY_STATUS},
 #endif
 #if AP_AIRSPEED_ENABLED
-        { MAVLINK_MSG_ID_AIRSPEED, MSG_AIRSPEED},
+    { MAVLINK_MSG_ID_AIRSPEED, MSG_AIRSPEED},
 #endif
-        { MAVLINK_MSG_ID_AVAILABLE_MODES, MSG_AVAILABLE_MODES},
-        { MAVLINK_MSG_ID_AVAILABLE_MODES_MONITOR, MSG_AVAILABLE_MODES_MONITOR},
+    { MAVLINK_MSG_ID_AVAILABLE_MODES, MSG_AVAILABLE_MODES},
+    { MAVLINK_MSG_ID_AVAILABLE_MODES_MONITOR, MSG_AVAILABLE_MODES_MONITOR},
 #if AP_MAVLINK_MSG_FLIGHT_INFORMATION_ENABLED
-        { MAVLINK_MSG_ID_FLIGHT_INFORMATION, MSG_FLIGHT_INFORMATION},
+    { MAVLINK_MSG_ID_FLIGHT_INFORMATION, MSG_FLIGHT_INFORMATION},
 #endif
-    };
+};
 
-    for (uint8_t i=0; i<ARRAY_SIZE(map); i++) {
-        if (map[i].mavlink_id == mavlink_id) {
-            return map[i].msg_id;
+ap_message GCS_MAVLINK::mavlink_id_to_ap_message_id(const uint32_t mavlink_id) const
+{
+    for (uint8_t i=0; i<ARRAY_SIZE(ap_message_map); i++) {
+        if (ap_message_map[i].mavlink_id == mavlink_id) {
+            return ap_message_map[i].msg_id;
         }
     }
     return MSG_LAST;
 }
 
+// return the mavlink message ID for an ap_message, or MAVLINK_ID_NONE
+// if there is no direct mapping
+uint32_t GCS_MAVLINK::ap_message_to_mavlink_id(const ap_message id)
+{
+    for (uint8_t i=0; i<ARRAY_SIZE(ap_message_map); i++) {
+        if (ap_message_map[i].msg_id == id) {
+            return ap_message_map[i].mavlink_id;
+        }
+    }
+    return MAVLINK_ID_NONE;
+}
+
 bool GCS_MAVLINK::set_mavlink_message_id_interval(const uint32_t mavlink_id,
                                                   const uint16_t interval_ms)
 {
@@ -1206,6 +1219,9 @@ bool GCS_MAVLINK::should_send_message_in_delay_callback(const ap_message id) con
 uint16_t GCS_MAVLINK::get_reschedule_interval_ms(const deferred_message_bucket_t &deferred) const
 {
     uint32_t interval_ms = deferred.interval_ms;
+#if AP_MAVLINK_BANDWIDTH_BUDGET_ENABLED
+    interval_ms = MAX(interval_ms, deferred.budget_interval_ms);
+#endif
 
     interval_ms += stream_slowdown_ms;
 
@@ -1319,15 +1335,24 @@ bool GCS_MAVLINK::do_try_send_message(const ap_message id)
 #if GCS_DEBUG_SEND_MESSAGE_TIMINGS
     void *data = hal.scheduler->disable_interrupts_save();
     uint32_t start_send_message_us = AP_HAL::micros();
+#endif
+#if AP_MAVLINK_BANDWIDTH_BUDGET_ENABLED
+    const uint32_t start_tx_bytes = comm_get_tx_bytes(chan);
 #endif
     if (!try_send_message(id)) {
         // didn't fit in buffer...
 #if GCS_DEBUG_SEND_MESSAGE_TIMINGS
         try_send_message_stats.no_space_for_message++;
         hal.scheduler->restore_interrupts(data);
+#endif
+#if AP_MAVLINK_BANDWIDTH_BUDGET_ENABLED
+        bandwidth.no_space++;
 #endif
         return false;
     }
+#if AP_MAVLINK_BANDWIDTH_BUDGET_ENABLED
+    bandwidth_record_send(id, comm_get_tx_bytes(chan) - start_tx_bytes);
+#endif
 #if GCS_DEBUG_SEND_MESSAGE_TIMINGS
     const uint32_t delta_us = AP_HAL::micros() - start_send_message_us;
     hal.scheduler->restore_interrupts(data);
@@ -1537,6 +1562,15 @@ void GCS_MAVLINK::update_send()
     // check for any in-progress tasks; check_tasks does its own rate-limiting
     GCS_MAVLINK_InProgress::check_tasks();
 
+#if AP_MAVLINK_BANDWIDTH_BUDGET_ENABLED
+    bandwidth_update();
+#endif
+
+#if AP_MAVLINK_BATCH_WRITES_ENABLED
+    // pack everything sent in this pass into as few UART writes as possible
+    comm_send_batch_begin(chan);
+#endif
+
     const uint32_t start = AP_HAL::millis();
     const uint16_t start16 = start & 0xFFFF;
     while (AP_HAL::millis() - start < 5) { // spend a max of 5ms sending messages.  This should never trigger - out_of_time() should become true
@@ -1629,6 +1663,9 @@ void GCS_MAVLINK::update_send()
         }
         break;
     }
+#if AP_MAVLINK_BATCH_WRITES_ENABLED
+    comm_send_batch_end(chan);
+#endif
 #if GCS_DEBUG_SEND_MESSAGE_TIMINGS
     const uint32_t stop = AP_HAL::micros();
     const uint32_t delta = stop - retry_deferred_body_start;
@@ -1652,6 +1689,9 @@ void GCS_MAVLINK::remove_message_from_bucket(int8_t bucket, ap_message id)
         // bucket empty.  Free it:
         deferred_message_bucket[bucket].interval_ms = 0;
         deferred_message_bucket[bucket].last_sent_ms = 0;
+#if AP_MAVLINK_BANDWIDTH_BUDGET_ENABLED
+        deferred_message_bucket[bucket].budget_interval_ms = 0;
+#endif
     }
 
     if (bucket == sending_bucket_id) {
@@ -28,6 +28,7 @@ This provides some support code and variables for MAVLink enabled sketches
 #include "GCS_MAVLink.h"
 
 #include <AP_Common/AP_Common.h>
+#include <AP_Common/ExpandingString.h>
 #include <AP_HAL/AP_HAL.h>
 
 extern const AP_HAL::HAL& hal;
@@ -75,6 +76,25 @@ bool gcs_alternative_active[MAVLINK_COMM_NUM_BUFFERS];
 // per-channel lock
 static HAL_Semaphore chan_locks[MAVLINK_COMM_NUM_BUFFERS];
 static bool chan_discard[MAVLINK_COMM_NUM_BUFFERS];
+// bytes written to each channel
+static uint32_t chan_tx_bytes[MAVLINK_COMM_NUM_BUFFERS];
+
+#if AP_MAVLINK_BATCH_WRITES_ENABLED
+/*
+  per-channel output coalescing buffer. The mavlink library writes
+  each packet in several pieces; while a batch is open on a channel
+  those pieces are packed into this buffer and handed to the UART in
+  one write when the batch is closed or the buffer fills. The buffer
+  is only accessed with the channel lock held.
+ */
+static struct {
+    uint8_t *buf;
+    uint16_t len;
+    bool active;
+    uint32_t packets;   // packets sent on the channel
+    uint32_t writes;    // UART writes made for the channel
+} chan_batch[MAVLINK_COMM_NUM_BUFFERS];
+#endif
 
 mavlink_system_t mavlink_system = {7,1};
 
@@ -127,6 +147,122 @@ uint16_t comm_get_txspace(mavlink_channel_t chan)
     return link->txspace();
 }
 
+uint32_t comm_get_tx_bytes(mavlink_channel_t chan)
+{
+    if (!valid_channel(chan)) {
+        return 0;
+    }
+    return chan_tx_bytes[chan];
+}
+
+/*
+  write bytes to the UART for a channel
+ */
+static void comm_write(uint8_t chan, const uint8_t *buf, uint16_t len)
+{
+    const size_t written = mavlink_comm_port[chan]->write(buf, len);
+    chan_tx_bytes[chan] += written;
+#if AP_MAVLINK_BATCH_WRITES_ENABLED
+    chan_batch[chan].writes++;
+#endif
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+    if (written < len && !mavlink_comm_port[chan]->is_write_locked()) {
+        AP_HAL::panic("Short write on UART: %lu < %u", (unsigned long)written, len);
+    }
+#endif
+}
+
+/*
+  return the space available on the UART for a channel, less anything
+  waiting in the channel's batch buffer
+ */
+static uint32_t comm_port_txspace(uint8_t chan)
+{
+    const uint32_t space = mavlink_comm_port[chan]->txspace();
+#if AP_MAVLINK_BATCH_WRITES_ENABLED
+    const uint16_t pending = chan_batch[chan].len;
+    return space > pending ? space - pending : 0;
+#else
+    return space;
+#endif
+}
+
+#if AP_MAVLINK_BATCH_WRITES_ENABLED
+/*
+  write out anything waiting in a channel's batch buffer. Called with
+  the channel lock held
+ */
+static void comm_batch_flush(uint8_t chan)
+{
+    auto &batch = chan_batch[chan];
+    if (batch.len > 0) {
+        comm_write(chan, batch.buf, batch.len);
+        batch.len = 0;
+    }
+}
+
+/*
+  open a batch on a channel. Packets sent on the channel are held
+  until comm_send_batch_end() is called
+ */
+void comm_send_batch_begin(mavlink_channel_t chan)
+{
+    if (!valid_channel(chan) || mavlink_comm_port[chan] == nullptr) {
+        return;
+    }
+    WITH_SEMAPHORE(chan_locks[chan]);
+    auto &batch = chan_batch[chan];
+    if (batch.buf == nullptr) {
+        batch.buf = NEW_NOTHROW uint8_t[AP_MAVLINK_BATCH_BUFFER_SIZE];
+        if (batch.buf == nullptr) {
+            return;
+        }
+    }
+    batch.active = true;
+}
+
+/*
+  close a batch on a channel, writing out the packets sent since
+  comm_send_batch_begin()
+ */
+void comm_send_batch_end(mavlink_channel_t chan)
+{
+    if (!valid_channel(chan) || mavlink_comm_port[chan] == nullptr) {
+        return;
+    }
+    WITH_SEMAPHORE(chan_locks[chan]);
+    comm_batch_flush(chan);
+    chan_batch[chan].active = false;
+}
+
+uint16_t comm_send_batch_pending(mavlink_channel_t chan)
+{
+    if (!valid_channel(chan)) {
+        return 0;
+    }
+    return chan_batch[chan].len;
+}
+
+/*
+  display packets-per-write statistics for each channel
+ */
+void GCS_MAVLINK::batch_info(ExpandingString &str)
+{
+    for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
+        const auto &batch = chan_batch[i];
+        if (mavlink_comm_port[i] == nullptr) {
+            continue;
+        }
+        str.printf("chan%u packets=%lu writes=%lu packets/write=%.2f buffer=%s\n",
+                   unsigned(i),
+                   (unsigned long)batch.packets,
+                   (unsigned long)batch.writes,
+                   batch.writes > 0 ? double(batch.packets) / batch.writes : 0.0,
+                   batch.buf != nullptr ? "yes" : "no");
+    }
+}
+#endif  // AP_MAVLINK_BATCH_WRITES_ENABLED
+
 /*
   send a buffer out a MAVLink channel
  */
@@ -146,14 +282,18 @@ void comm_send_buffer(mavlink_channel_t chan, const uint8_t *buf, uint8_t len)
         // an alternative protocol is active
         return;
     }
-    const size_t written = mavlink_comm_port[chan]->write(buf, len);
-#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
-    if (written < len && !mavlink_comm_port[chan]->is_write_locked()) {
-        AP_HAL::panic("Short write on UART: %lu < %u", (unsigned long)written, len);
+#if AP_MAVLINK_BATCH_WRITES_ENABLED
+    auto &batch = chan_batch[chan];
+    if (batch.active && batch.buf != nullptr) {
+        if (batch.len + len > AP_MAVLINK_BATCH_BUFFER_SIZE) {
+            comm_batch_flush(chan);
+        }
+        memcpy(&batch.buf[batch.len], buf, len);
+        batch.len += len;
+        return;
     }
-#else
-    (void)written;
 #endif
+    comm_write(chan, buf, len);
 }
 
 /*
@@ -166,7 +306,7 @@ void comm_send_lock(mavlink_channel_t chan_m, uint16_t size)
 {
     const uint8_t chan = uint8_t(chan_m);
     chan_locks[chan].take_blocking();
-    if (mavlink_comm_port[chan]->txspace() < size) {
+    if (comm_port_txspace(chan) < size) {
         chan_discard[chan] = true;
         gcs_out_of_space_to_send(chan_m);
     }
@@ -178,6 +318,11 @@ void comm_send_lock(mavlink_channel_t chan_m, uint16_t size)
 void comm_send_unlock(mavlink_channel_t chan_m)
 {
     const uint8_t chan = uint8_t(chan_m);
+#if AP_MAVLINK_BATCH_WRITES_ENABLED
+    if (!chan_discard[chan]) {
+        chan_batch[chan].packets++;
+    }
+#endif
     chan_discard[chan] = false;
     chan_locks[chan].give();
 }
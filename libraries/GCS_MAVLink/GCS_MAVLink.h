@@ -3,6 +3,7 @@
 #pragma once
 
 #include <AP_HAL/AP_HAL_Boards.h>
+#include "GCS_config.h"
 #include <AP_Networking/AP_Networking_Config.h>
 
 // we have separate helpers disabled to make it possible
@@ -69,6 +70,28 @@ void comm_send_buffer(mavlink_channel_t chan, const uint8_t *buf, uint8_t len);
 /// @returns		Number of bytes available
 uint16_t comm_get_txspace(mavlink_channel_t chan);
 
+/// Total bytes written to the nominated MAVLink channel
+///
+/// @param chan		Channel to check
+/// @returns		Number of bytes written since boot
+uint32_t comm_get_tx_bytes(mavlink_channel_t chan);
+
+#if AP_MAVLINK_BATCH_WRITES_ENABLED
+/// Open and close a batch of packets on the nominated MAVLink
+/// channel. Packets sent while a batch is open are written to the
+/// UART together when the batch is closed.
+///
+/// @param chan		Channel to batch
+void comm_send_batch_begin(mavlink_channel_t chan);
+void comm_send_batch_end(mavlink_channel_t chan);
+
+/// Bytes waiting to be written in the channel's batch
+///
+/// @param chan		Channel to check
+/// @returns		Number of bytes waiting
+uint16_t comm_send_batch_pending(mavlink_channel_t chan);
+#endif
+
 #define MAVLINK_USE_CONVENIENCE_FUNCTIONS
 #include "include/mavlink/v2.0/all/mavlink.h"
 
@@ -202,6 +202,17 @@ const AP_Param::GroupInfo GCS_MAVLINK::var_info[] = {
     // @RebootRequired: True
     // @User: Advanced
     AP_GROUPINFO("_ADSB",   10, GCS_MAVLINK, streamRates[GCS_MAVLINK::STREAM_ADSB], DRATE(GCS_MAVLINK::STREAM_ADSB)),
+
+#if AP_MAVLINK_BANDWIDTH_BUDGET_ENABLED
+    // @Param: _BW_PCT
+    // @DisplayName: Stream bandwidth budget
+    // @Description: Percentage of the link bandwidth that streamed messages may use. When non-zero the link is measured once per second and the stream intervals are stretched so the messages fit in the budget, keeping the fastest requested messages closest to their requested rate. The budget shrinks when the link runs out of transmit space and recovers when it drains. The link bandwidth is taken from the serial baud rate, or the radio's reported bandwidth when the baud rate is not known. 0 disables the budget.
+    // @Units: %
+    // @Range: 0 100
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_BW_PCT",  11, GCS_MAVLINK, bw_pct, 0),
+#endif
     AP_GROUPEND
 };
 #undef DRATE
@@ -76,6 +76,15 @@ GCS_MAVLINK::queued_param_send()
     count -= async_replies_sent_count;
 
     while (count && _queued_parameter != nullptr && last_txbuf_is_greater(33)) {
+        if (_queued_parameter_version != AP_Param::get_index_version()) {
+            // the parameters have been renumbered, e.g. by enabling a
+            // subsystem. Start again so the indexes we send match the
+            // new numbering and the GCS sees the new count
+            queued_param_start();
+            if (_queued_parameter == nullptr) {
+                break;
+            }
+        }
         char param_name[AP_MAX_NAME_SIZE];
         _queued_parameter->copy_name_token(_queued_parameter_token, param_name, sizeof(param_name), true);
 
@@ -87,8 +96,13 @@ GCS_MAVLINK::queued_param_send()
             _queued_parameter_count,
             _queued_parameter_index);
 
-        _queued_parameter = AP_Param::next_scalar(&_queued_parameter_token, &_queued_parameter_type);
+        _queued_parameter = AP_Param::next_scalar_by_index(_queued_parameter_index, &_queued_parameter_token, &_queued_parameter_type);
         _queued_parameter_index++;
+        if (_queued_parameter == nullptr &&
+            _queued_parameter_version != AP_Param::get_index_version()) {
+            // renumbered before we got to the end
+            queued_param_start();
+        }
 
         if (AP_HAL::micros() - tstart > 1000) {
             // don't use more than 1ms sending blocks of parameters
@@ -216,10 +230,19 @@ void GCS_MAVLINK::handle_param_request_list(const mavlink_message_t &msg)
     send_banner();
 
     // Start sending parameters - next call to ::update will kick the first one out
+    queued_param_start();
+    _queued_parameter_send_time_ms = AP_HAL::millis(); // avoid initial flooding
+}
+
+/*
+  start the queued parameter send from the first parameter
+ */
+void GCS_MAVLINK::queued_param_start()
+{
+    _queued_parameter_version = AP_Param::get_index_version();
+    _queued_parameter_count = AP_Param::count_parameters();
     _queued_parameter = AP_Param::first(&_queued_parameter_token, &_queued_parameter_type);
     _queued_parameter_index = 0;
-    _queued_parameter_count = AP_Param::count_parameters();
-    _queued_parameter_send_time_ms = AP_HAL::millis(); // avoid initial flooding
 }
 
 void GCS_MAVLINK::handle_param_request_read(const mavlink_message_t &msg)
@@ -387,6 +410,7 @@ void GCS_MAVLINK::param_io_timer(void)
     struct pending_param_reply reply;
     AP_Param *vp;
 
+    const uint16_t index_version = AP_Param::get_index_version();
     if (req.param_index != -1) {
         AP_Param::ParamToken token {};
         vp = AP_Param::find_by_index(req.param_index, &reply.p_type, &token);
@@ -407,6 +431,12 @@ void GCS_MAVLINK::param_io_timer(void)
     reply.value = vp->cast_to_float(reply.p_type);
     reply.param_index = req.param_index;
     reply.count = AP_Param::count_parameters();
+    if (req.param_index != -1 && index_version != AP_Param::get_index_version()) {
+        // the parameters were renumbered during the lookup, so the
+        // index may not match the name or count. Drop the request and
+        // let the GCS retry it
+        return;
+    }
 
     // queue for transmission
     param_replies.push(reply);
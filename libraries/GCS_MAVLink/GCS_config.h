@@ -115,3 +115,18 @@
 #ifndef AP_MAVLINK_MSG_FLIGHT_INFORMATION_ENABLED
 #define AP_MAVLINK_MSG_FLIGHT_INFORMATION_ENABLED HAL_GCS_ENABLED && AP_ARMING_ENABLED
 #endif
+
+// per-link bandwidth budget for streamed messages, see SRn_BW_PCT
+#ifndef AP_MAVLINK_BANDWIDTH_BUDGET_ENABLED
+#define AP_MAVLINK_BANDWIDTH_BUDGET_ENABLED HAL_GCS_ENABLED && (HAL_PROGRAM_SIZE_LIMIT_KB > 1024)
+#endif
+
+// pack the packets sent in each update_send() pass into a single
+// UART write rather than several writes per packet
+#ifndef AP_MAVLINK_BATCH_WRITES_ENABLED
+#define AP_MAVLINK_BATCH_WRITES_ENABLED HAL_GCS_ENABLED && (HAL_PROGRAM_SIZE_LIMIT_KB > 1024)
+#endif
+
+#ifndef AP_MAVLINK_BATCH_BUFFER_SIZE
+#define AP_MAVLINK_BATCH_BUFFER_SIZE 512
+#endif
@@ -27,13 +27,135 @@
 #include "MAVLink_routing.h"
 
 #include <AP_ADSB/AP_ADSB.h>
+#include <AP_Common/ExpandingString.h>
 
 extern const AP_HAL::HAL& hal;
 
 #define ROUTING_DEBUG 0
 
 // constructor
-MAVLink_routing::MAVLink_routing(void) : num_routes(0) {}
+MAVLink_routing::MAVLink_routing(void) :
+    num_routes(0),
+    max_routes(0),
+    bucket_mask(0),
+    route_chan_mask(0),
+    broadcasts_forwarded{},
+    last_expire_ms(0),
+    dropped_routes(0),
+    init_done(false),
+    no_route_mask(0),
+    gopro_status_check(false)
+{}
+
+MAVLink_routing::~MAVLink_routing(void)
+{
+    delete[] routes;
+    delete[] buckets;
+}
+
+/*
+  allocate the routing table. The number of hash buckets is a power
+  of two, capped at 256 as routes are bucketed by sysid
+*/
+bool MAVLink_routing::init(uint16_t _max_routes)
+{
+    if (init_done) {
+        return routes != nullptr;
+    }
+    init_done = true;
+
+    uint16_t num_buckets = 16;
+    while (num_buckets < _max_routes && num_buckets < 256) {
+        num_buckets <<= 1;
+    }
+    routes = NEW_NOTHROW route[_max_routes];
+    buckets = NEW_NOTHROW uint16_t[num_buckets];
+    if (routes == nullptr || buckets == nullptr) {
+        delete[] routes;
+        delete[] buckets;
+        routes = nullptr;
+        buckets = nullptr;
+        DEV_PRINTF("MAVLink: failed to allocate %u routes\n", unsigned(_max_routes));
+        return false;
+    }
+    max_routes = _max_routes;
+    bucket_mask = num_buckets - 1;
+    for (uint16_t i=0; i<num_buckets; i++) {
+        buckets[i] = NO_ROUTE;
+    }
+    return true;
+}
+
+// return the first route for a sysid
+uint16_t MAVLink_routing::first_route(uint8_t sysid) const
+{
+    if (buckets == nullptr) {
+        return NO_ROUTE;
+    }
+    uint16_t i = buckets[bucket(sysid)];
+    while (i != NO_ROUTE && routes[i].sysid != sysid) {
+        i = routes[i].next;
+    }
+    return i;
+}
+
+// return the next route with the same sysid as route i
+uint16_t MAVLink_routing::next_route(uint16_t i) const
+{
+    const uint8_t sysid = routes[i].sysid;
+    i = routes[i].next;
+    while (i != NO_ROUTE && routes[i].sysid != sysid) {
+        i = routes[i].next;
+    }
+    return i;
+}
+
+/*
+  rebuild the bucket chains and channel mask after routes have been removed
+*/
+void MAVLink_routing::rebuild_index()
+{
+    for (uint16_t b=0; b<=bucket_mask; b++) {
+        buckets[b] = NO_ROUTE;
+    }
+    route_chan_mask = 0;
+    for (uint16_t i=0; i<num_routes; i++) {
+        route &r = routes[i];
+        const uint16_t b = bucket(r.sysid);
+        r.next = buckets[b];
+        buckets[b] = i;
+        route_chan_mask |= 1U<<(r.channel-MAVLINK_COMM_0);
+    }
+}
+
+/*
+  remove routes which have not been heard from for timeout_ms,
+  keeping the remaining routes in the order they were learned
+*/
+void MAVLink_routing::expire_routes(uint32_t now_ms, uint32_t timeout_ms)
+{
+    last_expire_ms = now_ms;
+    uint16_t n = 0;
+    for (uint16_t i=0; i<num_routes; i++) {
+        if (now_ms - routes[i].last_seen_ms > timeout_ms) {
+#if ROUTING_DEBUG
+            ::printf("expired route %u %u via %u\n",
+                     (unsigned)routes[i].sysid,
+                     (unsigned)routes[i].compid,
+                     (unsigned)routes[i].channel);
+#endif
+            continue;
+        }
+        if (n != i) {
+            routes[n] = routes[i];
+        }
+        n++;
+    }
+    if (n != num_routes) {
+        num_routes = n;
+        rebuild_index();
+    }
+}
 
 /*
   forward a MAVLink message to the right port. This also
@@ -173,41 +295,70 @@ bool MAVLink_routing::check_and_forward(GCS_MAVLINK &in_link, const mavlink_mess
 
     // forward on any channels matching the targets
     bool forwarded = false;
-    bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS];
-    memset(sent_to_chan, 0, sizeof(sent_to_chan));
-    for (uint8_t i=0; i<num_routes; i++) {
-
-        // Skip if channel is private and the target system or component IDs do not match
-        GCS_MAVLINK *out_link = gcs().chan(routes[i].channel);
-        if (out_link == nullptr) {
-            // this is bad
-            continue;
-        }
-        if (out_link->is_private() &&
-            (target_system != routes[i].sysid ||
-             target_component != routes[i].compid)) {
-            continue;
+    if (broadcast_system) {
+        // broadcasts go to every channel we have learned a route on,
+        // other than private channels which only get messages
+        // targeted at a route on that channel
+        for (uint8_t c=0; c<MAVLINK_COMM_NUM_BUFFERS; c++) {
+            if ((route_chan_mask & (1U<<c)) == 0) {
+                continue;
+            }
+            const mavlink_channel_t channel = (mavlink_channel_t)(MAVLINK_COMM_0 + c);
+            GCS_MAVLINK *out_link = gcs().chan(channel);
+            if (out_link == nullptr || out_link->is_private() || &in_link == out_link) {
+                continue;
+            }
+            if (out_link->check_payload_size(msg.len)) {
+#if ROUTING_DEBUG
+                ::printf("fwd msg %u from chan %u on chan %u sysid=%d compid=%d\n",
+                         msg.msgid,
+                         (unsigned)in_link.get_chan(),
+                         (unsigned)channel,
+                         (int)target_system,
+                         (int)target_component);
+#endif
+                _mavlink_resend_uart(channel, &msg);
+                broadcasts_forwarded[c]++;
+            }
+            forwarded = true;
         }
+    } else {
+        // only routes for the target system need to be checked
+        uint16_t sent_mask = 0;
+        for (uint16_t i=first_route(target_system); i!=NO_ROUTE; i=next_route(i)) {
+            route &r = routes[i];
+
+            // Skip if channel is private and the target component ID does not match
+            GCS_MAVLINK *out_link = gcs().chan(r.channel);
+            if (out_link == nullptr) {
+                // this is bad
+                continue;
+            }
+            if (out_link->is_private() && target_component != r.compid) {
+                continue;
+            }
 
-        if (broadcast_system || (target_system == routes[i].sysid &&
-                                 (broadcast_component || 
-                                  target_component == routes[i].compid ||
-                                  !match_system))) {
+            if (broadcast_component ||
+                target_component == r.compid ||
+                !match_system) {
 
-            if (&in_link != out_link && !sent_to_chan[routes[i].channel]) {
-                if (out_link->check_payload_size(msg.len)) {
+                const uint16_t chan_bit = 1U<<(r.channel-MAVLINK_COMM_0);
+                if (&in_link != out_link && (sent_mask & chan_bit) == 0) {
+                    if (out_link->check_payload_size(msg.len)) {
 #if ROUTING_DEBUG
-                    ::printf("fwd msg %u from chan %u on chan %u sysid=%d compid=%d\n",
-                             msg.msgid,
-                             (unsigned)in_link.get_chan(),
-                             (unsigned)routes[i].channel,
-                             (int)target_system,
-                             (int)target_component);
+                        ::printf("fwd msg %u from chan %u on chan %u sysid=%d compid=%d\n",
+                                 msg.msgid,
+                                 (unsigned)in_link.get_chan(),
+                                 (unsigned)r.channel,
+                                 (int)target_system,
+                                 (int)target_component);
 #endif
-                    _mavlink_resend_uart(routes[i].channel, &msg);
+                        _mavlink_resend_uart(r.channel, &msg);
+                        r.forwarded++;
+                    }
+                    sent_mask |= chan_bit;
+                    forwarded = true;
                 }
-                sent_to_chan[routes[i].channel] = true;
-                forwarded = true;
             }
         }
     }
@@ -238,12 +389,8 @@ void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entr
 {
     bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS] {};
 
-    // check learned routes
-    for (uint8_t i=0; i<num_routes; i++) {
-        if (routes[i].sysid != mavlink_system.sysid) {
-            // our system ID hasn't been seen on this link
-            continue;
-        }
+    // check learned routes for our system ID
+    for (uint16_t i=first_route(mavlink_system.sysid); i!=NO_ROUTE; i=next_route(i)) {
         if (sent_to_chan[routes[i].channel]) {
             // we've already send it on this link
             continue;
@@ -283,7 +430,7 @@ void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entr
 bool MAVLink_routing::find_by_mavtype(uint8_t mavtype, uint8_t &sysid, uint8_t &compid, mavlink_channel_t &channel)
 {
     // check learned routes
-    for (uint8_t i=0; i<num_routes; i++) {
+    for (uint16_t i=0; i<num_routes; i++) {
         if (routes[i].mavtype == mavtype) {
             sysid = routes[i].sysid;
             compid = routes[i].compid;
@@ -302,7 +449,7 @@ bool MAVLink_routing::find_by_mavtype(uint8_t mavtype, uint8_t &sysid, uint8_t &
  */
 bool MAVLink_routing::find_by_mavtype_and_compid(uint8_t mavtype, uint8_t compid, uint8_t &sysid, mavlink_channel_t &channel) const
 {
-    for (uint8_t i=0; i<num_routes; i++) {
+    for (uint16_t i=0; i<num_routes; i++) {
         if ((routes[i].mavtype == mavtype) && (routes[i].compid == compid)) {
             sysid = routes[i].sysid;
             channel = routes[i].channel;
@@ -317,7 +464,6 @@ bool MAVLink_routing::find_by_mavtype_and_compid(uint8_t mavtype, uint8_t compid
 */
 void MAVLink_routing::learn_route(GCS_MAVLINK &in_link, const mavlink_message_t &msg)
 {
-    uint8_t i;
     if (msg.sysid == 0) {
         // don't learn routes to the broadcast system
         return;
@@ -334,32 +480,54 @@ void MAVLink_routing::learn_route(GCS_MAVLINK &in_link, const mavlink_message_t
         // should also process them locally.
         return;
     }
+    if (!init_done) {
+        init(gcs().max_routes());
+    }
+
+    const uint32_t now_ms = AP_HAL::millis();
+    const uint32_t timeout_ms = gcs().route_timeout_ms();
+    if (timeout_ms != 0 && now_ms - last_expire_ms >= 1000U) {
+        expire_routes(now_ms, timeout_ms);
+    }
+
     const mavlink_channel_t in_channel = in_link.get_chan();
-    for (i=0; i<num_routes; i++) {
-        if (routes[i].sysid == msg.sysid &&
-            routes[i].compid == msg.compid &&
-            routes[i].channel == in_channel) {
-            if (routes[i].mavtype == 0 && msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
+    for (uint16_t i=first_route(msg.sysid); i!=NO_ROUTE; i=next_route(i)) {
+        route &r = routes[i];
+        if (r.compid == msg.compid &&
+            r.channel == in_channel) {
+            if (r.mavtype == 0 && msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+                r.mavtype = mavlink_msg_heartbeat_get_type(&msg);
             }
-            break;
+            r.last_seen_ms = now_ms;
+            return;
         }
     }
-    if (i == num_routes && i<MAVLINK_MAX_ROUTES) {
-        routes[i].sysid = msg.sysid;
-        routes[i].compid = msg.compid;
-        routes[i].channel = in_channel;
-        if (msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-            routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
-        }
-        num_routes++;
+    if (num_routes >= max_routes) {
+        // table is full, this route is only reachable by broadcast
+        dropped_routes++;
+        return;
+    }
+    route &r = routes[num_routes];
+    r.sysid = msg.sysid;
+    r.compid = msg.compid;
+    r.channel = in_channel;
+    r.mavtype = 0;
+    if (msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+        r.mavtype = mavlink_msg_heartbeat_get_type(&msg);
+    }
+    r.last_seen_ms = now_ms;
+    r.forwarded = 0;
+    const uint16_t b = bucket(r.sysid);
+    r.next = buckets[b];
+    buckets[b] = num_routes;
+    route_chan_mask |= 1U<<(in_channel-MAVLINK_COMM_0);
+    num_routes++;
 #if ROUTING_DEBUG
-        ::printf("learned route %u %u via %u\n",
-                 (unsigned)msg.sysid,
-                 (unsigned)msg.compid,
-                 (unsigned)in_channel);
+    ::printf("learned route %u %u via %u\n",
+             (unsigned)msg.sysid,
+             (unsigned)msg.compid,
+             (unsigned)in_channel);
 #endif
-    }
 }
 
 
@@ -382,8 +550,8 @@ void MAVLink_routing::handle_heartbeat(GCS_MAVLINK &link, const mavlink_message_
     mask &= ~no_route_mask;
     
     // mask out channels that are known sources for this sysid/compid
-    for (uint8_t i=0; i<num_routes; i++) {
-        if (routes[i].sysid == msg.sysid && routes[i].compid == msg.compid) {
+    for (uint16_t i=first_route(msg.sysid); i!=NO_ROUTE; i=next_route(i)) {
+        if (routes[i].compid == msg.compid) {
             mask &= ~(1U<<((unsigned)(routes[i].channel-MAVLINK_COMM_0)));
         }
     }
@@ -413,6 +581,35 @@ void MAVLink_routing::handle_heartbeat(GCS_MAVLINK &link, const mavlink_message_
 }
 
 
+/*
+  display the routing table
+*/
+void MAVLink_routing::routes_info(ExpandingString &str) const
+{
+    str.printf("Routes: %u/%u dropped=%u\n",
+               unsigned(num_routes),
+               unsigned(max_routes),
+               unsigned(dropped_routes));
+    const uint32_t now_ms = AP_HAL::millis();
+    for (uint16_t i=0; i<num_routes; i++) {
+        const route &r = routes[i];
+        str.printf("%3u/%3u chan=%u type=%3u age=%6ums fwd=%u\n",
+                   unsigned(r.sysid),
+                   unsigned(r.compid),
+                   unsigned(r.channel),
+                   unsigned(r.mavtype),
+                   unsigned(now_ms - r.last_seen_ms),
+                   unsigned(r.forwarded));
+    }
+    for (uint8_t c=0; c<MAVLINK_COMM_NUM_BUFFERS; c++) {
+        if (broadcasts_forwarded[c] != 0) {
+            str.printf("chan=%u broadcast fwd=%u\n",
+                       unsigned(c),
+                       unsigned(broadcasts_forwarded[c]));
+        }
+    }
+}
+
 /*
   extract target sysid and compid from a message. int16_t is used so
   that the caller can set them to -1 and know when a sysid or compid
@@ -5,9 +5,11 @@
 #include <AP_Common/AP_Common.h>
 #include "GCS_MAVLink.h"
 
-// 20 routes should be enough for now. This may need to increase as
-// we make more extensive use of MAVLink forwarding
+// default size of the routing table. The table is allocated on the
+// first learned route, sized from the MAV_ROUTES parameter
+#ifndef MAVLINK_MAX_ROUTES
 #define MAVLINK_MAX_ROUTES 20
+#endif
 
 /*
   object to handle MAVLink packet routing
@@ -18,6 +20,17 @@ class MAVLink_routing
     
 public:
     MAVLink_routing(void);
+    ~MAVLink_routing(void);
+
+    /* Do not allow copies */
+    CLASS_NO_COPY(MAVLink_routing);
+
+    /*
+      allocate the routing table for up to max_routes routes. This is
+      normally done on the first learned route using the MAV_ROUTES
+      parameter, and can only be done once
+    */
+    bool init(uint16_t max_routes);
 
     /*
       forward a MAVLink message to the right port. This also
@@ -49,17 +62,63 @@ public:
      */
     bool find_by_mavtype_and_compid(uint8_t mavtype, uint8_t compid, uint8_t &sysid, mavlink_channel_t &channel) const;
 
+    // number of learned routes
+    uint16_t get_num_routes() const { return num_routes; }
+
+    // number of messages from sources which could not be learned as the table was full
+    uint32_t get_dropped_routes() const { return dropped_routes; }
+
+    // display the routing table
+    void routes_info(class ExpandingString &str) const;
+
 private:
-    // a simple linear routing table. We don't expect to have a lot of
-    // routes, so a scalable structure isn't worthwhile yet.
-    uint8_t num_routes;
+    static constexpr uint16_t NO_ROUTE = 0xFFFF;
+
+    // routes are stored densely so that broadcast and mavtype
+    // searches are linear over the learned routes only. Routes with
+    // the same sysid hash to the same bucket and are chained through
+    // next, so a targeted message only looks at routes for its
+    // target system
+    uint16_t num_routes;
+    uint16_t max_routes;
     struct route {
         uint8_t sysid;
         uint8_t compid;
         mavlink_channel_t channel;
         uint8_t mavtype;
-    } routes[MAVLINK_MAX_ROUTES];
-    
+        uint16_t next;
+        uint32_t last_seen_ms;
+        uint32_t forwarded; // targeted messages forwarded to this route
+    } *routes = nullptr;
+
+    // heads of the per-bucket route chains
+    uint16_t *buckets = nullptr;
+    uint16_t bucket_mask;
+
+    // mask of channels we have learned any route on
+    uint16_t route_chan_mask;
+
+    // broadcasts forwarded on each channel. A broadcast is sent once
+    // per channel rather than to a route, so is counted here
+    uint32_t broadcasts_forwarded[MAVLINK_COMM_NUM_BUFFERS];
+
+    // route aging
+    uint32_t last_expire_ms;
+    uint32_t dropped_routes;
+    bool init_done;
+
+    uint16_t bucket(uint8_t sysid) const { return sysid & bucket_mask; }
+
+    // first route for a sysid, then next route with the same sysid
+    uint16_t first_route(uint8_t sysid) const;
+    uint16_t next_route(uint16_t i) const;
+
+    // remove routes that have not been seen for timeout_ms
+    void expire_routes(uint32_t now_ms, uint32_t timeout_ms);
+
+    // rebuild the bucket chains and channel mask
+    void rebuild_index();
+
     // a channel mask to block routing as required
     uint8_t no_route_mask;
     
@@ -22,11 +22,16 @@ extern mavlink_system_t mavlink_system;
 static MAVLink_routing routing;
 static mavlink_status_t status;
 
+static void bench_routes(uint16_t num_routes);
+
 void setup(void)
 {
     hal.console->printf("routing test startup...");
+    _serialmanager.init();
     gcs().init();
     gcs().setup_console();
+    // a second link for the benchmark's routes to be learned on
+    gcs().setup_uarts();
 }
 
 void loop(void)
@@ -95,7 +100,69 @@ void loop(void)
     if (err_count == 0) {
         hal.console->printf("All OK\n");
     }
+
+    bench_routes(5);
+    bench_routes(50);
+    bench_routes(500);
+
     hal.scheduler->delay(1000);
 }
 
+/*
+  measure the per-message cost of check_and_forward() with a routing
+  table holding num_routes routes. The routes are learned on a second
+  link so that the messages, which arrive on the first link, are
+  forwarded
+ */
+static void bench_routes(uint16_t num_routes)
+{
+    MAVLink_routing bench;
+    if (!bench.init(num_routes)) {
+        hal.console->printf("failed to allocate %u routes\n", unsigned(num_routes));
+        return;
+    }
+
+    GCS_MAVLINK *in_link = gcs().chan(0);
+    GCS_MAVLINK *route_link = gcs().chan(1);
+    if (in_link == nullptr || route_link == nullptr) {
+        hal.console->printf("need two MAVLink links to benchmark forwarding\n");
+        return;
+    }
+    mavlink_message_t msg;
+    mavlink_heartbeat_t heartbeat {};
+
+    // learn one route per sysid/compid, skipping our own sysid
+    for (uint16_t i=0; i<num_routes; i++) {
+        uint8_t sysid = 2 + (i % 250);
+        if (sysid == mavlink_system.sysid) {
+            sysid = 253;
+        }
+        const uint8_t compid = 1 + (i / 250);
+        mavlink_msg_heartbeat_encode_status(sysid, compid, &status, &msg, &heartbeat);
+        bench.check_and_forward(*route_link, msg);
+    }
+
+    // messages targeted at routes spread across the table
+    const uint8_t num_msgs = 16;
+    mavlink_message_t msgs[num_msgs];
+    for (uint8_t i=0; i<num_msgs; i++) {
+        mavlink_param_set_t param_set {};
+        param_set.target_system = 2 + ((i * num_routes / num_msgs) % 250);
+        param_set.target_component = 1;
+        mavlink_msg_param_set_encode_status(255, 190, &status, &msgs[i], &param_set);
+    }
+
+    const uint32_t count = 20000;
+    const uint64_t start_us = AP_HAL::micros64();
+    for (uint32_t i=0; i<count; i++) {
+        bench.check_and_forward(*in_link, msgs[i % num_msgs]);
+    }
+    const uint64_t dt_us = AP_HAL::micros64() - start_us;
+
+    hal.console->printf("routes=%3u learned=%3u %.3f us/msg\n",
+                        unsigned(num_routes),
+                        unsigned(bench.get_num_routes()),
+                        double(dt_us) / count);
+}
+
 AP_HAL_MAIN();
@@ -16,6 +16,10 @@
     Dump logged AIS data to the serial port
     ./Tools/autotest/sim_vehicle.py -v Rover -A --serial5=sim:AIS --custom-location 51.58689798356386,-3.9044570193067965,0,0 --map
 
+    To replay a captured NMEA AIS feed at the full receiver data rate
+    give the file after the device name:
+    --serial5=sim:AIS:/path/to/feed.nmea
+
     param set SERIAL5_PROTOCOL 40
     param set AIS_TYPE 1
     reboot
@@ -36,20 +40,44 @@ extern const AP_HAL::HAL& hal;
 using namespace SITL;
 
 
-AIS::AIS() : SerialDevice::SerialDevice()
+AIS::AIS(const char *path) : SerialDevice::SerialDevice()
 {
-    char* file_path;
-    IGNORE_RETURN(asprintf(&file_path, AP_BUILD_ROOT "/libraries/SITL/SIM_AIS_data.txt"));
-
-    file = fopen(file_path,"r");
+    if (path != nullptr && path[0] != 0) {
+        file = fopen(path, "r");
+        full_rate = true;
+    } else {
+        char* file_path;
+        IGNORE_RETURN(asprintf(&file_path, AP_BUILD_ROOT "/libraries/SITL/SIM_AIS_data.txt"));
+        file = fopen(file_path,"r");
+        free(file_path);
+    }
 
     if (file == nullptr) {
         AP_HAL::panic("AIS could not open data file");
     }
+}
 
-    // seek past the header line
-    char line[100];
-    IGNORE_RETURN(fgets(line, sizeof(line), file));
+// read the next NMEA sentence into line, going back to the start of
+// the file at the end. Anything else in the file is skipped
+bool AIS::read_line()
+{
+    bool rewound = false;
+    while (true) {
+        if (!fgets(line, sizeof(line), file)) {
+            if (rewound) {
+                return false;
+            }
+            // got to the end of the file, circle back
+            fseek(file,0,SEEK_SET);
+            rewound = true;
+            continue;
+        }
+        if (line[0] == '!' || line[0] == '$') {
+            line_len = strlen(line);
+            line_ofs = 0;
+            return true;
+        }
+    }
 }
 
 void AIS::update()
@@ -58,27 +86,46 @@ void AIS::update()
         AP_HAL::panic("AIS lost data file");
     }
 
-    // just send a line of data at 1Hz:
     const uint32_t now = AP_HAL::millis();
-    if (now - last_sent_ms < 1000) {
-        return;
-    }
-    last_sent_ms = now;
 
-    char line[100];
-
-    if (!fgets(line, sizeof(line), file)) {
-        // got to the end of the file, circle back
-        fseek(file,0,SEEK_SET);
-        if (!fgets(line, sizeof(line), file)) {
+    if (!full_rate) {
+        // just send a line of data at 1Hz:
+        if (now - last_sent_ms < 1000) {
+            return;
+        }
+        last_sent_ms = now;
+        if (!read_line()) {
             AP_HAL::panic("AIS lost data file");
         }
+        //hal.console->printf("%s",line);
+        write_to_autopilot(line, line_len);
         return;
     }
 
-    //hal.console->printf("%s",line);
-    write_to_autopilot(line, strlen(line));
+    // send as many bytes as 38400 baud allows since the last update,
+    // 10 bits to a byte
+    if (last_sent_ms == 0) {
+        last_sent_ms = now;
+        return;
+    }
+    uint32_t budget = (now - last_sent_ms) * (38400 / 10) / 1000;
+    if (budget == 0) {
+        return;
+    }
+    last_sent_ms += budget * 1000 / (38400 / 10);
 
+    while (budget > 0) {
+        if (line_ofs >= line_len && !read_line()) {
+            AP_HAL::panic("AIS lost data file");
+        }
+        const ssize_t n = write_to_autopilot(&line[line_ofs], MIN(budget, uint32_t(line_len - line_ofs)));
+        if (n <= 0) {
+            // autopilot isn't keeping up, the receiver would drop data
+            break;
+        }
+        line_ofs += n;
+        budget -= n;
+    }
 }
 
 #endif  // HAL_SIM_AIS_ENABLED
@@ -38,7 +38,10 @@ namespace SITL {
 class AIS : public SerialDevice {
 public:
 
-    AIS();
+    // with a path the file is replayed as fast as a 38400 baud
+    // receiver would send it, otherwise the bundled data at one line
+    // per second
+    AIS(const char *path = nullptr);
 
     void update();
 
@@ -47,6 +50,14 @@ private:
 
     uint32_t last_sent_ms;
 
+    // replaying a full feed from a file
+    bool full_rate;
+    char line[100];
+    uint8_t line_len;
+    uint8_t line_ofs;
+
+    bool read_line(void);
+
 };
 
 }
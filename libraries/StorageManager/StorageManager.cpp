@@ -26,6 +26,7 @@
 #include <AP_BoardConfig/AP_BoardConfig.h>
 #include <AP_Filesystem/AP_Filesystem.h>
 #include <GCS_MAVLink/GCS.h>
+#include <AP_Common/ExpandingString.h>
 
 #include "StorageManager.h"
 
@@ -35,6 +36,10 @@ extern const AP_HAL::HAL& hal;
 
 bool StorageManager::last_io_failed;
 
+#if AP_STORAGE_WRITEBACK_ENABLED
+StorageWriteBack StorageManager::writeback;
+#endif
+
 /*
   the layouts below are carefully designed to ensure backwards
   compatibility with older firmwares
@@ -108,11 +113,33 @@ const StorageManager::StorageArea StorageManager::layout[STORAGE_NUM_AREAS] = {
  */
 void StorageManager::erase(void)
 {
+#if AP_STORAGE_WRITEBACK_ENABLED
+    writeback.discard();
+#endif
     if (!hal.storage->erase()) {
         ::printf("StorageManager: erase failed\n");
     }
 }
 
+#if AP_STORAGE_WRITEBACK_ENABLED
+/*
+  display write-back cache statistics
+ */
+void StorageManager::writeback_info(ExpandingString &str)
+{
+    StorageWriteBack::Stats stats;
+    writeback.get_stats(stats);
+    str.printf("enabled=%u dirty=%u writes=%lu flushes=%lu backend_writes=%lu flush_us=%lu max_flush_us=%lu\n",
+               unsigned(writeback.enabled()),
+               unsigned(stats.dirty_bytes),
+               (unsigned long)stats.writes,
+               (unsigned long)stats.flushes,
+               (unsigned long)stats.backend_writes,
+               (unsigned long)stats.last_flush_us,
+               (unsigned long)stats.max_flush_us);
+}
+#endif
+
 /*
   constructor for StorageAccess
  */
@@ -169,7 +196,11 @@ bool StorageAccess::read_block(void *data, uint16_t addr, size_t n) const
             // the data crosses a boundary between two areas
             count = length - addr;
         }
+#if AP_STORAGE_WRITEBACK_ENABLED
+        StorageManager::writeback.read(addr+offset, b, count);
+#else
         hal.storage->read_block(b, addr+offset, count);
+#endif
         n -= count;
 
         if (n == 0) {
@@ -227,7 +258,11 @@ bool StorageAccess::write_block(uint16_t addr, const void *data, size_t n) const
             // the data crosses a boundary between two areas
             count = length - addr;
         }
+#if AP_STORAGE_WRITEBACK_ENABLED
+        StorageManager::writeback.write(addr+offset, b, count);
+#else
         hal.storage->write_block(addr+offset, b, count);
+#endif
         n -= count;
 
         if (n == 0) {
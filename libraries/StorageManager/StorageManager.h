@@ -22,6 +22,7 @@
 
 #include <AP_HAL/AP_HAL.h>
 #include <AP_BoardConfig/AP_BoardConfig_config.h>
+#include "StorageWriteBack.h"
 
 /*
   use just one area per storage type for boards with 4k of
@@ -69,9 +70,26 @@ public:
         return last_io_failed;
     }
 
+#if AP_STORAGE_WRITEBACK_ENABLED
+    // enable or disable the write-back cache in front of hal.storage
+    static void set_writeback(bool enable) { writeback.set_enabled(enable); }
+
+    // write any cached writes out to hal.storage
+    static void sync(void) { writeback.sync(); }
+
+    static void get_writeback_stats(StorageWriteBack::Stats &stats) { writeback.get_stats(stats); }
+
+    // display write-back cache statistics
+    static void writeback_info(class ExpandingString &str);
+#endif
+
 private:
     static bool last_io_failed;
 
+#if AP_STORAGE_WRITEBACK_ENABLED
+    static StorageWriteBack writeback;
+#endif
+
     struct StorageArea {
         StorageType type;
         uint16_t    offset;
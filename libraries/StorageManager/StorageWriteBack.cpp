@@ -0,0 +1,234 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  optional write-back cache between StorageAccess and hal.storage
+ */
+
+#include "StorageWriteBack.h"
+
+#if AP_STORAGE_WRITEBACK_ENABLED
+
+#include <AP_Math/AP_Math.h>
+
+extern const AP_HAL::HAL& hal;
+
+/*
+  enable or disable the cache. Disabling writes out anything dirty
+ */
+void StorageWriteBack::set_enabled(bool enable)
+{
+    WITH_SEMAPHORE(sem);
+    if (!enable) {
+        flush_locked();
+        _enabled = false;
+        return;
+    }
+    if (lines == nullptr) {
+        lines = NEW_NOTHROW Line[AP_STORAGE_WRITEBACK_LINES];
+        if (lines == nullptr) {
+            return;
+        }
+    }
+    if (!timer_registered) {
+        hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&StorageWriteBack::timer, void));
+        timer_registered = true;
+    }
+    _enabled = true;
+}
+
+/*
+  find the line for a line-aligned address, adding it if there is
+  room. Returns nullptr if the cache is full
+ */
+StorageWriteBack::Line *StorageWriteBack::get_line(uint16_t addr)
+{
+    uint8_t i = 0;
+    while (i < num_lines && lines[i].addr < addr) {
+        i++;
+    }
+    if (i < num_lines && lines[i].addr == addr) {
+        return &lines[i];
+    }
+    if (num_lines >= AP_STORAGE_WRITEBACK_LINES) {
+        return nullptr;
+    }
+    // keep the lines in address order so flushes go out in order
+    memmove(&lines[i+1], &lines[i], (num_lines-i)*sizeof(Line));
+    num_lines++;
+    lines[i].addr = addr;
+    lines[i].dirty = 0;
+    return &lines[i];
+}
+
+void StorageWriteBack::write(uint16_t offset, const uint8_t *data, uint16_t n)
+{
+    if (!_enabled) {
+        hal.storage->write_block(offset, data, n);
+        return;
+    }
+    WITH_SEMAPHORE(sem);
+    if (!_enabled) {
+        hal.storage->write_block(offset, data, n);
+        return;
+    }
+
+    if (stats.dirty_bytes == 0) {
+        first_dirty_ms = AP_HAL::millis();
+    }
+    while (n > 0) {
+        const uint16_t line_addr = offset & ~uint16_t(LINE_SIZE-1);
+        const uint8_t ofs = offset - line_addr;
+        const uint8_t count = MIN(n, uint16_t(LINE_SIZE - ofs));
+        Line *line = get_line(line_addr);
+        if (line == nullptr) {
+            // cache is full, make room
+            flush_locked();
+            first_dirty_ms = AP_HAL::millis();
+            line = get_line(line_addr);
+        }
+        memcpy(&line->data[ofs], data, count);
+        for (uint8_t i=0; i<count; i++) {
+            const uint64_t bit = 1ULL << (ofs+i);
+            if ((line->dirty & bit) == 0) {
+                line->dirty |= bit;
+                stats.dirty_bytes++;
+            }
+        }
+        offset += count;
+        data += count;
+        n -= count;
+    }
+    last_write_ms = AP_HAL::millis();
+    stats.writes++;
+}
+
+void StorageWriteBack::read(uint16_t offset, uint8_t *data, uint16_t n)
+{
+    if (!_enabled) {
+        hal.storage->read_block(data, offset, n);
+        return;
+    }
+    // hold the lock over the read so a flush can't land between the
+    // read and the overlay
+    WITH_SEMAPHORE(sem);
+    hal.storage->read_block(data, offset, n);
+
+    const uint32_t end = uint32_t(offset) + n;
+    for (uint8_t i=0; i<num_lines; i++) {
+        const Line &line = lines[i];
+        if (line.dirty == 0 ||
+            uint32_t(line.addr) + LINE_SIZE <= offset ||
+            line.addr >= end) {
+            continue;
+        }
+        for (uint8_t b=0; b<LINE_SIZE; b++) {
+            const uint32_t addr = uint32_t(line.addr) + b;
+            if ((line.dirty & (1ULL<<b)) != 0 && addr >= offset && addr < end) {
+                data[addr - offset] = line.data[b];
+            }
+        }
+    }
+}
+
+/*
+  write all dirty bytes to hal.storage in address order, merging
+  adjacent bytes into a single write
+ */
+void StorageWriteBack::flush_locked()
+{
+    if (stats.dirty_bytes == 0) {
+        num_lines = 0;
+        return;
+    }
+    const uint32_t start_us = AP_HAL::micros();
+
+    uint8_t run[128];
+    uint16_t run_addr = 0;
+    uint16_t run_len = 0;
+    for (uint8_t i=0; i<num_lines; i++) {
+        const Line &line = lines[i];
+        if (line.dirty == 0) {
+            continue;
+        }
+        for (uint8_t b=0; b<LINE_SIZE; b++) {
+            if ((line.dirty & (1ULL<<b)) == 0) {
+                continue;
+            }
+            const uint16_t addr = line.addr + b;
+            if (run_len > 0 && (addr != run_addr + run_len || run_len == sizeof(run))) {
+                hal.storage->write_block(run_addr, run, run_len);
+                stats.backend_writes++;
+                run_len = 0;
+            }
+            if (run_len == 0) {
+                run_addr = addr;
+            }
+            run[run_len++] = line.data[b];
+        }
+    }
+    if (run_len > 0) {
+        hal.storage->write_block(run_addr, run, run_len);
+        stats.backend_writes++;
+    }
+
+    num_lines = 0;
+    stats.dirty_bytes = 0;
+    stats.flushes++;
+    stats.last_flush_us = AP_HAL::micros() - start_us;
+    stats.max_flush_us = MAX(stats.max_flush_us, stats.last_flush_us);
+}
+
+void StorageWriteBack::sync()
+{
+    WITH_SEMAPHORE(sem);
+    flush_locked();
+}
+
+void StorageWriteBack::discard()
+{
+    WITH_SEMAPHORE(sem);
+    num_lines = 0;
+    stats.dirty_bytes = 0;
+}
+
+void StorageWriteBack::get_stats(Stats &_stats)
+{
+    WITH_SEMAPHORE(sem);
+    _stats = stats;
+}
+
+/*
+  flush once the writer has gone quiet, when data has been held too
+  long, or on disarm
+ */
+void StorageWriteBack::timer()
+{
+    const bool armed = hal.util->get_soft_armed();
+    const bool disarmed = was_armed && !armed;
+    was_armed = armed;
+
+    if (!_enabled || stats.dirty_bytes == 0) {
+        return;
+    }
+    const uint32_t now_ms = AP_HAL::millis();
+    if (disarmed ||
+        now_ms - last_write_ms >= AP_STORAGE_WRITEBACK_HOLD_MS ||
+        now_ms - first_dirty_ms >= AP_STORAGE_WRITEBACK_MAX_AGE_MS) {
+        WITH_SEMAPHORE(sem);
+        flush_locked();
+    }
+}
+
+#endif  // AP_STORAGE_WRITEBACK_ENABLED
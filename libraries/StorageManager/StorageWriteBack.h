@@ -0,0 +1,107 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  optional write-back cache between StorageAccess and hal.storage
+ */
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+
+#ifndef AP_STORAGE_WRITEBACK_ENABLED
+#define AP_STORAGE_WRITEBACK_ENABLED (HAL_PROGRAM_SIZE_LIMIT_KB > 1024)
+#endif
+
+#if AP_STORAGE_WRITEBACK_ENABLED
+
+// number of 64 byte lines that can be held dirty
+#ifndef AP_STORAGE_WRITEBACK_LINES
+#define AP_STORAGE_WRITEBACK_LINES 32
+#endif
+
+// flush once no writes have arrived for this long
+#ifndef AP_STORAGE_WRITEBACK_HOLD_MS
+#define AP_STORAGE_WRITEBACK_HOLD_MS 500
+#endif
+
+// never hold a dirty byte for longer than this
+#ifndef AP_STORAGE_WRITEBACK_MAX_AGE_MS
+#define AP_STORAGE_WRITEBACK_MAX_AGE_MS 5000
+#endif
+
+/*
+  Writes are held in RAM in 64 byte lines with a per-byte dirty mask,
+  and written to hal.storage in address order once the writer goes
+  quiet, on disarm, when the cache fills or on an explicit sync(),
+  with adjacent dirty bytes merged into a single write. This turns a
+  burst of small writes (e.g. a mission upload) into a few large
+  ones, so backends which write out or erase whole lines do so once
+  per burst rather than once per item.
+
+  Offsets are hal.storage offsets. Reads through StorageAccess are
+  overlaid with any dirty bytes, so callers always see their writes.
+ */
+class StorageWriteBack {
+public:
+    struct Stats {
+        uint32_t writes;            // writes taken into the cache
+        uint32_t flushes;           // flushes which wrote data
+        uint32_t backend_writes;    // hal.storage writes made by flushes
+        uint32_t last_flush_us;     // duration of the last flush
+        uint32_t max_flush_us;      // longest flush
+        uint16_t dirty_bytes;       // bytes waiting to be written
+    };
+
+    void set_enabled(bool enable);
+    bool enabled() const { return _enabled; }
+
+    // write to hal.storage, through the cache when it is enabled
+    void write(uint16_t offset, const uint8_t *data, uint16_t n);
+
+    // read from hal.storage, overlaid with any dirty bytes
+    void read(uint16_t offset, uint8_t *data, uint16_t n);
+
+    // write out all dirty bytes now
+    void sync();
+
+    // drop all dirty bytes, used when storage is erased
+    void discard();
+
+    void get_stats(Stats &stats);
+
+private:
+    static constexpr uint8_t LINE_SIZE = 64;
+
+    struct Line {
+        uint16_t addr;          // hal.storage offset of the start of the line
+        uint64_t dirty;         // one bit per byte
+        uint8_t data[LINE_SIZE];
+    };
+
+    HAL_Semaphore sem;
+    Line *lines;                // sorted by address
+    uint8_t num_lines;
+    bool _enabled;
+    bool timer_registered;
+    bool was_armed;
+    uint32_t last_write_ms;
+    uint32_t first_dirty_ms;
+    Stats stats;
+
+    Line *get_line(uint16_t addr);
+    void flush_locked();
+    void timer();
+};
+
+#endif  // AP_STORAGE_WRITEBACK_ENABLED
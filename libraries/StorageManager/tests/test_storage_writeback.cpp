@@ -0,0 +1,137 @@
+#include <AP_gtest.h>
+#include <AP_HAL/AP_HAL.h>
+
+#include <StorageManager/StorageManager.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_STORAGE_WRITEBACK_ENABLED
+
+static StorageAccess mission_storage(StorageManager::StorageMission);
+
+// start each test with the cache enabled and clean
+static void start_clean()
+{
+    StorageManager::set_writeback(true);
+    StorageManager::sync();
+}
+
+TEST(StorageWriteBack, ReadsSeeHeldWrites)
+{
+    start_clean();
+
+    uint8_t data[100];
+    for (uint8_t i=0; i<sizeof(data); i++) {
+        data[i] = i ^ 0x5A;
+    }
+    StorageWriteBack::Stats before, after;
+    StorageManager::get_writeback_stats(before);
+    mission_storage.write_block(0, data, sizeof(data));
+    StorageManager::get_writeback_stats(after);
+
+    // held, not yet written out
+    EXPECT_EQ(sizeof(data), after.dirty_bytes);
+    EXPECT_EQ(before.backend_writes, after.backend_writes);
+
+    uint8_t readback[sizeof(data)] {};
+    EXPECT_TRUE(mission_storage.read_block(readback, 0, sizeof(readback)));
+    EXPECT_EQ(0, memcmp(data, readback, sizeof(data)));
+
+    // partial overlapping reads see the held bytes too
+    EXPECT_EQ(data[70], mission_storage.read_byte(70));
+
+    StorageManager::sync();
+    StorageManager::get_writeback_stats(after);
+    EXPECT_EQ(0U, after.dirty_bytes);
+    EXPECT_LT(before.backend_writes, after.backend_writes);
+
+    // with the cache disabled reads come straight from the backend
+    StorageManager::set_writeback(false);
+    memset(readback, 0, sizeof(readback));
+    EXPECT_TRUE(mission_storage.read_block(readback, 0, sizeof(readback)));
+    EXPECT_EQ(0, memcmp(data, readback, sizeof(data)));
+}
+
+TEST(StorageWriteBack, AdjacentWritesMerge)
+{
+    start_clean();
+
+    // a run of small adjacent writes, as a mission upload would make,
+    // crossing a line boundary
+    StorageWriteBack::Stats before, after;
+    StorageManager::get_writeback_stats(before);
+    for (uint16_t ofs=40; ofs<120; ofs+=4) {
+        mission_storage.write_uint32(ofs, 0x01020304U + ofs);
+    }
+    StorageManager::sync();
+    StorageManager::get_writeback_stats(after);
+
+    EXPECT_EQ(before.writes + 20, after.writes);
+    EXPECT_EQ(before.flushes + 1, after.flushes);
+    EXPECT_EQ(before.backend_writes + 1, after.backend_writes);
+
+    for (uint16_t ofs=40; ofs<120; ofs+=4) {
+        EXPECT_EQ(0x01020304U + ofs, mission_storage.read_uint32(ofs));
+    }
+}
+
+TEST(StorageWriteBack, RewritesKeepLatestValue)
+{
+    start_clean();
+
+    for (uint8_t i=0; i<10; i++) {
+        mission_storage.write_uint16(200, i);
+    }
+    StorageWriteBack::Stats stats;
+    StorageManager::get_writeback_stats(stats);
+    EXPECT_EQ(2U, stats.dirty_bytes);
+    EXPECT_EQ(9U, mission_storage.read_uint16(200));
+
+    StorageManager::sync();
+    StorageManager::set_writeback(false);
+    EXPECT_EQ(9U, mission_storage.read_uint16(200));
+}
+
+TEST(StorageWriteBack, FullCacheFlushes)
+{
+    start_clean();
+
+    // one byte in more lines than the cache holds
+    const uint16_t lines = AP_STORAGE_WRITEBACK_LINES + 4;
+    ASSERT_LT(lines * 64U, mission_storage.size());
+    StorageWriteBack::Stats before, after;
+    StorageManager::get_writeback_stats(before);
+    for (uint16_t i=0; i<lines; i++) {
+        mission_storage.write_byte(i*64, uint8_t(i));
+    }
+    StorageManager::get_writeback_stats(after);
+    EXPECT_EQ(before.flushes + 1, after.flushes);
+    EXPECT_EQ(4U, after.dirty_bytes);
+
+    for (uint16_t i=0; i<lines; i++) {
+        EXPECT_EQ(uint8_t(i), mission_storage.read_byte(i*64));
+    }
+    StorageManager::sync();
+    StorageManager::set_writeback(false);
+    for (uint16_t i=0; i<lines; i++) {
+        EXPECT_EQ(uint8_t(i), mission_storage.read_byte(i*64));
+    }
+}
+
+TEST(StorageWriteBack, DisabledWritesThrough)
+{
+    StorageManager::set_writeback(false);
+
+    StorageWriteBack::Stats before, after;
+    StorageManager::get_writeback_stats(before);
+    mission_storage.write_uint32(300, 0xDEADBEEF);
+    StorageManager::get_writeback_stats(after);
+
+    EXPECT_EQ(before.writes, after.writes);
+    EXPECT_EQ(0U, after.dirty_bytes);
+    EXPECT_EQ(0xDEADBEEFU, mission_storage.read_uint32(300));
+}
+
+#endif  // AP_STORAGE_WRITEBACK_ENABLED
+
+AP_GTEST_MAIN()